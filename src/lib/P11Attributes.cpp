@@ -40,9 +40,8 @@
 #include <stdlib.h>
 
 // Constructor
-P11Attribute::P11Attribute(OSObject* inobject)
+P11Attribute::P11Attribute()
 {
-	osobject = inobject;
 	type = CKA_VENDOR_DEFINED;
 	size = (CK_ULONG)-1;
 	checks = 0;
@@ -53,7 +52,7 @@ P11Attribute::~P11Attribute()
 {
 }
 
-CK_RV P11Attribute::updateAttr(Token *token, bool isPrivate, CK_VOID_PTR pValue, CK_ULONG ulValueLen, int /*op*/)
+CK_RV P11Attribute::updateAttr(OSObject* osobject, Token *token, bool isPrivate, CK_VOID_PTR pValue, CK_ULONG ulValueLen, int /*op*/)
 {
 	ByteString value;
 	if (isPrivate)
@@ -69,7 +68,7 @@ CK_RV P11Attribute::updateAttr(Token *token, bool isPrivate, CK_VOID_PTR pValue,
 	return CKR_OK;
 }
 
-bool P11Attribute::isModifiable()
+bool P11Attribute::isModifiable(OSObject* osobject)
 {
 	// Get the CKA_MODIFIABLE attribute, when the attribute is
 	// not present return the default value which is CK_TRUE.
@@ -78,7 +77,7 @@ bool P11Attribute::isModifiable()
 	return osobject->getBooleanValue(CKA_MODIFIABLE, true);
 }
 
-bool P11Attribute::isSensitive()
+bool P11Attribute::isSensitive(OSObject* osobject)
 {
 	// Get the CKA_SENSITIVE attribute, when the attribute is not present
 	// assume the object is not sensitive.
@@ -87,7 +86,7 @@ bool P11Attribute::isSensitive()
 	return osobject->getBooleanValue(CKA_SENSITIVE, false);
 }
 
-bool P11Attribute::isExtractable()
+bool P11Attribute::isExtractable(OSObject* osobject)
 {
 	// Get the CKA_EXTRACTABLE attribute, when the attribute is
 	// not present assume the object allows extraction.
@@ -96,7 +95,7 @@ bool P11Attribute::isExtractable()
 	return osobject->getBooleanValue(CKA_EXTRACTABLE, true);
 }
 
-bool P11Attribute::isTrusted()
+bool P11Attribute::isTrusted(OSObject* osobject)
 {
 	// Get the CKA_TRUSTED attribute, when the attribute is
 	// not present assume the object is not trusted.
@@ -106,14 +105,14 @@ bool P11Attribute::isTrusted()
 }
 
 // Initialize the attribute
-bool P11Attribute::init()
+bool P11Attribute::init(OSObject* osobject)
 {
 	if (osobject == NULL) return false;
 
 	// Create a default value if the attribute does not exist
 	if (osobject->attributeExists(type) == false)
 	{
-		return setDefault();
+		return setDefault(osobject);
 	}
 
 	return true;
@@ -228,11 +227,11 @@ static CK_RV retrieveArray(CK_ATTRIBUTE_PTR pTemplate, const std::map<CK_ATTRIBU
 }
 
 // Retrieve the value if allowed
-CK_RV P11Attribute::retrieve(Token *token, bool isPrivate, CK_VOID_PTR pValue, CK_ULONG_PTR pulValueLen)
+CK_RV P11Attribute::retrieve(OSObject* osobject, Token *token, bool isPrivate, CK_VOID_PTR pValue, CK_ULONG_PTR pulValueLen)
 {
 
 	if (osobject == NULL) {
-		ERROR_MSG("Internal error: osobject field contains NULL_PTR");
+		ERROR_MSG("Internal error: osobject argument contains NULL_PTR");
 		return CKR_GENERAL_ERROR;
 	}
 
@@ -251,7 +250,7 @@ CK_RV P11Attribute::retrieve(Token *token, bool isPrivate, CK_VOID_PTR pValue, C
 	// [PKCS#11 v2.3 pg. 62 table 15]
 	//  7  Cannot be revealed if object has its CKA_SENSITIVE attribute
 	//     set to CK_TRUE or its CKA_EXTRACTABLE attribute set to CK_FALSE.
-	if ((checks & ck7) == ck7 && (isSensitive() || !isExtractable())) {
+	if ((checks & ck7) == ck7 && (isSensitive(osobject) || !isExtractable(osobject))) {
 		*pulValueLen = (CK_ULONG)-1;
 		return CKR_ATTRIBUTE_SENSITIVE;
 	}
@@ -362,10 +361,10 @@ CK_RV P11Attribute::retrieve(Token *token, bool isPrivate, CK_VOID_PTR pValue, C
 }
 
 // Update the value if allowed
-CK_RV P11Attribute::update(Token* token, bool isPrivate, CK_VOID_PTR pValue, CK_ULONG ulValueLen, int op)
+CK_RV P11Attribute::update(OSObject* osobject, Token* token, bool isPrivate, CK_VOID_PTR pValue, CK_ULONG ulValueLen, int op)
 {
 	if (osobject == NULL) {
-		ERROR_MSG("Internal error: osobject field contains NULL_PTR");
+		ERROR_MSG("Internal error: osobject argument contains NULL_PTR");
 		return CKR_GENERAL_ERROR;
 	}
 
@@ -398,13 +397,13 @@ CK_RV P11Attribute::update(Token* token, bool isPrivate, CK_VOID_PTR pValue, CK_
 
 
 	// Attributes cannot be changed if CKA_MODIFIABLE is set to false
-	if (!isModifiable() && op != OBJECT_OP_GENERATE && op != OBJECT_OP_CREATE) {
+	if (!isModifiable(osobject) && op != OBJECT_OP_GENERATE && op != OBJECT_OP_CREATE) {
 		ERROR_MSG("An object is with CKA_MODIFIABLE set to false is not modifiable");
 		return CKR_ATTRIBUTE_READ_ONLY;
 	}
 
 	// Attributes cannot be modified if CKA_TRUSTED is true on a certificate object.
-	if (isTrusted() && op != OBJECT_OP_GENERATE && op != OBJECT_OP_CREATE) {
+	if (isTrusted(osobject) && op != OBJECT_OP_GENERATE && op != OBJECT_OP_CREATE) {
 		if (osobject->getUnsignedLongValue(CKA_CLASS, CKO_VENDOR_DEFINED) == CKO_CERTIFICATE)
 		{
 			ERROR_MSG("A trusted certificate cannot be modified");
@@ -450,7 +449,7 @@ CK_RV P11Attribute::update(Token* token, bool isPrivate, CK_VOID_PTR pValue, CK_
 	{
 		if (OBJECT_OP_SET==op || OBJECT_OP_COPY==op)
 		{
-			return updateAttr(token, isPrivate, pValue, ulValueLen, op);
+			return updateAttr(osobject, token, isPrivate, pValue, ulValueLen, op);
 		}
 	}
 
@@ -459,7 +458,7 @@ CK_RV P11Attribute::update(Token* token, bool isPrivate, CK_VOID_PTR pValue, CK_
 	{
 		if (OBJECT_OP_COPY==op)
 		{
-			return updateAttr(token, isPrivate, pValue, ulValueLen, op);
+			return updateAttr(osobject, token, isPrivate, pValue, ulValueLen, op);
 		}
 	}
 
@@ -467,7 +466,7 @@ CK_RV P11Attribute::update(Token* token, bool isPrivate, CK_VOID_PTR pValue, CK_
 	// during create/derive/generate/unwrap, we allow them to be modified.
 	if (OBJECT_OP_CREATE==op || OBJECT_OP_DERIVE==op || OBJECT_OP_GENERATE==op || OBJECT_OP_UNWRAP==op)
 	{
-		return updateAttr(token, isPrivate, pValue, ulValueLen, op);
+		return updateAttr(osobject, token, isPrivate, pValue, ulValueLen, op);
 	}
 
 	return CKR_ATTRIBUTE_READ_ONLY;
@@ -478,14 +477,14 @@ CK_RV P11Attribute::update(Token* token, bool isPrivate, CK_VOID_PTR pValue, CK_
  *****************************************/
 
 // Set default value
-bool P11AttrClass::setDefault()
+bool P11AttrClass::setDefault(OSObject* osobject)
 {
 	OSAttribute attrClass((unsigned long)CKO_VENDOR_DEFINED);
 	return osobject->setAttribute(type, attrClass);
 }
 
 // Update the value if allowed
-CK_RV P11AttrClass::updateAttr(Token* /*token*/, bool /*isPrivate*/, CK_VOID_PTR pValue, CK_ULONG ulValueLen, int /*op*/)
+CK_RV P11AttrClass::updateAttr(OSObject* osobject, Token* /*token*/, bool /*isPrivate*/, CK_VOID_PTR pValue, CK_ULONG ulValueLen, int /*op*/)
 {
 	// Attribute specific checks
 
@@ -507,14 +506,14 @@ CK_RV P11AttrClass::updateAttr(Token* /*token*/, bool /*isPrivate*/, CK_VOID_PTR
  *****************************************/
 
 // Set default value
-bool P11AttrKeyType::setDefault()
+bool P11AttrKeyType::setDefault(OSObject* osobject)
 {
 	OSAttribute attr((unsigned long)CKK_VENDOR_DEFINED);
 	return osobject->setAttribute(type, attr);
 }
 
 // Update the value if allowed
-CK_RV P11AttrKeyType::updateAttr(Token* /*token*/, bool /*isPrivate*/, CK_VOID_PTR pValue, CK_ULONG ulValueLen, int /*op*/)
+CK_RV P11AttrKeyType::updateAttr(OSObject* osobject, Token* /*token*/, bool /*isPrivate*/, CK_VOID_PTR pValue, CK_ULONG ulValueLen, int /*op*/)
 {
 	// Attribute specific checks
 
@@ -538,14 +537,14 @@ CK_RV P11AttrKeyType::updateAttr(Token* /*token*/, bool /*isPrivate*/, CK_VOID_P
  *****************************************/
 
 // Set default value
-bool P11AttrCertificateType::setDefault()
+bool P11AttrCertificateType::setDefault(OSObject* osobject)
 {
 	OSAttribute attr((unsigned long)CKC_VENDOR_DEFINED);
 	return osobject->setAttribute(type, attr);
 }
 
 // Update the value if allowed
-CK_RV P11AttrCertificateType::updateAttr(Token* /*token*/, bool /*isPrivate*/, CK_VOID_PTR pValue, CK_ULONG ulValueLen, int /*op*/)
+CK_RV P11AttrCertificateType::updateAttr(OSObject* osobject, Token* /*token*/, bool /*isPrivate*/, CK_VOID_PTR pValue, CK_ULONG ulValueLen, int /*op*/)
 {
 	// Attribute specific checks
 
@@ -567,14 +566,14 @@ CK_RV P11AttrCertificateType::updateAttr(Token* /*token*/, bool /*isPrivate*/, C
  *****************************************/
 
 // Set default value
-bool P11AttrToken::setDefault()
+bool P11AttrToken::setDefault(OSObject* osobject)
 {
 	OSAttribute attr(false);
 	return osobject->setAttribute(type, attr);
 }
 
 // Update the value if allowed
-CK_RV P11AttrToken::updateAttr(Token* /*token*/, bool /*isPrivate*/, CK_VOID_PTR pValue, CK_ULONG ulValueLen, int /*op*/)
+CK_RV P11AttrToken::updateAttr(OSObject* osobject, Token* /*token*/, bool /*isPrivate*/, CK_VOID_PTR pValue, CK_ULONG ulValueLen, int /*op*/)
 {
 	OSAttribute attrTrue(true);
 	OSAttribute attrFalse(false);
@@ -605,14 +604,14 @@ CK_RV P11AttrToken::updateAttr(Token* /*token*/, bool /*isPrivate*/, CK_VOID_PTR
  *****************************************/
 
 // Set default value
-bool P11AttrPrivate::setDefault()
+bool P11AttrPrivate::setDefault(OSObject* osobject)
 {
 	OSAttribute attr(true);
 	return osobject->setAttribute(type, attr);
 }
 
 // Update the value if allowed
-CK_RV P11AttrPrivate::updateAttr(Token* /*token*/, bool /*isPrivate*/, CK_VOID_PTR pValue, CK_ULONG ulValueLen, int /*op*/)
+CK_RV P11AttrPrivate::updateAttr(OSObject* osobject, Token* /*token*/, bool /*isPrivate*/, CK_VOID_PTR pValue, CK_ULONG ulValueLen, int /*op*/)
 {
 	OSAttribute attrTrue(true);
 	OSAttribute attrFalse(false);
@@ -643,14 +642,14 @@ CK_RV P11AttrPrivate::updateAttr(Token* /*token*/, bool /*isPrivate*/, CK_VOID_P
  *****************************************/
 
 // Set default value
-bool P11AttrModifiable::setDefault()
+bool P11AttrModifiable::setDefault(OSObject* osobject)
 {
 	OSAttribute attr(true);
 	return osobject->setAttribute(type, attr);
 }
 
 // Update the value if allowed
-CK_RV P11AttrModifiable::updateAttr(Token* /*token*/, bool /*isPrivate*/, CK_VOID_PTR pValue, CK_ULONG ulValueLen, int /*op*/)
+CK_RV P11AttrModifiable::updateAttr(OSObject* osobject, Token* /*token*/, bool /*isPrivate*/, CK_VOID_PTR pValue, CK_ULONG ulValueLen, int /*op*/)
 {
 	OSAttribute attrTrue(true);
 	OSAttribute attrFalse(false);
@@ -681,7 +680,7 @@ CK_RV P11AttrModifiable::updateAttr(Token* /*token*/, bool /*isPrivate*/, CK_VOI
  *****************************************/
 
 // Set default value
-bool P11AttrLabel::setDefault()
+bool P11AttrLabel::setDefault(OSObject* osobject)
 {
 	OSAttribute attr(ByteString(""));
 	return osobject->setAttribute(type, attr);
@@ -692,14 +691,14 @@ bool P11AttrLabel::setDefault()
  *****************************************/
 
 // Set default value
-bool P11AttrCopyable::setDefault()
+bool P11AttrCopyable::setDefault(OSObject* osobject)
 {
 	OSAttribute attr(true);
 	return osobject->setAttribute(type, attr);
 }
 
 // Update the value if allowed
-CK_RV P11AttrCopyable::updateAttr(Token* /*token*/, bool /*isPrivate*/, CK_VOID_PTR pValue, CK_ULONG ulValueLen, int /*op*/)
+CK_RV P11AttrCopyable::updateAttr(OSObject* osobject, Token* /*token*/, bool /*isPrivate*/, CK_VOID_PTR pValue, CK_ULONG ulValueLen, int /*op*/)
 {
 	OSAttribute attrTrue(true);
 	OSAttribute attrFalse(false);
@@ -733,7 +732,7 @@ CK_RV P11AttrCopyable::updateAttr(Token* /*token*/, bool /*isPrivate*/, CK_VOID_
  *****************************************/
 
 // Set default value
-bool P11AttrApplication::setDefault()
+bool P11AttrApplication::setDefault(OSObject* osobject)
 {
 	OSAttribute attr(ByteString(""));
 	return osobject->setAttribute(type, attr);
@@ -744,7 +743,7 @@ bool P11AttrApplication::setDefault()
  *****************************************/
 
 // Set default value
-bool P11AttrObjectID::setDefault()
+bool P11AttrObjectID::setDefault(OSObject* osobject)
 {
 	OSAttribute attr(ByteString(""));
 	return osobject->setAttribute(type, attr);
@@ -755,14 +754,14 @@ bool P11AttrObjectID::setDefault()
  *****************************************/
 
 // Set default value
-bool P11AttrCheckValue::setDefault()
+bool P11AttrCheckValue::setDefault(OSObject* osobject)
 {
 	OSAttribute attr(ByteString(""));
 	return osobject->setAttribute(type, attr);
 }
 
 // Update the value if allowed
-CK_RV P11AttrCheckValue::updateAttr(Token *token, bool isPrivate, CK_VOID_PTR pValue, CK_ULONG ulValueLen, int /*op*/)
+CK_RV P11AttrCheckValue::updateAttr(OSObject* osobject, Token *token, bool isPrivate, CK_VOID_PTR pValue, CK_ULONG ulValueLen, int /*op*/)
 {
 	ByteString plaintext((unsigned char*)pValue, ulValueLen);
 	ByteString value;
@@ -852,7 +851,7 @@ CK_RV P11AttrCheckValue::updateAttr(Token *token, bool isPrivate, CK_VOID_PTR pV
  *****************************************/
 
 // Set default value
-bool P11AttrID::setDefault()
+bool P11AttrID::setDefault(OSObject* osobject)
 {
 	OSAttribute attr(ByteString(""));
 	return osobject->setAttribute(type, attr);
@@ -863,14 +862,14 @@ bool P11AttrID::setDefault()
  *****************************************/
 
 // Set default value
-bool P11AttrValue::setDefault()
+bool P11AttrValue::setDefault(OSObject* osobject)
 {
 	OSAttribute attr(ByteString(""));
 	return osobject->setAttribute(type, attr);
 }
 
 // Update the value if allowed
-CK_RV P11AttrValue::updateAttr(Token *token, bool isPrivate, CK_VOID_PTR pValue, CK_ULONG ulValueLen, int op)
+CK_RV P11AttrValue::updateAttr(OSObject* osobject, Token *token, bool isPrivate, CK_VOID_PTR pValue, CK_ULONG ulValueLen, int op)
 {
 	ByteString plaintext((unsigned char*)pValue, ulValueLen);
 	ByteString value;
@@ -1003,7 +1002,7 @@ CK_RV P11AttrValue::updateAttr(Token *token, bool isPrivate, CK_VOID_PTR pValue,
  *****************************************/
 
 // Set default value
-bool P11AttrSubject::setDefault()
+bool P11AttrSubject::setDefault(OSObject* osobject)
 {
 	OSAttribute attr(ByteString(""));
 	return osobject->setAttribute(type, attr);
@@ -1014,7 +1013,7 @@ bool P11AttrSubject::setDefault()
  *****************************************/
 
 // Set default value
-bool P11AttrIssuer::setDefault()
+bool P11AttrIssuer::setDefault(OSObject* osobject)
 {
 	OSAttribute attr(ByteString(""));
 	return osobject->setAttribute(type, attr);
@@ -1025,14 +1024,14 @@ bool P11AttrIssuer::setDefault()
  *****************************************/
 
 // Set default value
-bool P11AttrTrusted::setDefault()
+bool P11AttrTrusted::setDefault(OSObject* osobject)
 {
 	OSAttribute attr(false);
 	return osobject->setAttribute(type, attr);
 }
 
 // Update the value if allowed
-CK_RV P11AttrTrusted::updateAttr(Token *token, bool /*isPrivate*/, CK_VOID_PTR pValue, CK_ULONG ulValueLen, int /*op*/)
+CK_RV P11AttrTrusted::updateAttr(OSObject* osobject, Token *token, bool /*isPrivate*/, CK_VOID_PTR pValue, CK_ULONG ulValueLen, int /*op*/)
 {
 	OSAttribute attrTrue(true);
 	OSAttribute attrFalse(false);
@@ -1068,14 +1067,14 @@ CK_RV P11AttrTrusted::updateAttr(Token *token, bool /*isPrivate*/, CK_VOID_PTR p
  *****************************************/
 
 // Set default value
-bool P11AttrCertificateCategory::setDefault()
+bool P11AttrCertificateCategory::setDefault(OSObject* osobject)
 {
 	OSAttribute attr((unsigned long)0);
 	return osobject->setAttribute(type, attr);
 }
 
 // Update the value if allowed
-CK_RV P11AttrCertificateCategory::updateAttr(Token* /*token*/, bool /*isPrivate*/, CK_VOID_PTR pValue, CK_ULONG ulValueLen, int /*op*/)
+CK_RV P11AttrCertificateCategory::updateAttr(OSObject* osobject, Token* /*token*/, bool /*isPrivate*/, CK_VOID_PTR pValue, CK_ULONG ulValueLen, int /*op*/)
 {
 	// Attribute specific checks
 
@@ -1095,14 +1094,14 @@ CK_RV P11AttrCertificateCategory::updateAttr(Token* /*token*/, bool /*isPrivate*
  *****************************************/
 
 // Set default value
-bool P11AttrStartDate::setDefault()
+bool P11AttrStartDate::setDefault(OSObject* osobject)
 {
 	OSAttribute attr(ByteString(""));
 	return osobject->setAttribute(type, attr);
 }
 
 // Update the value if allowed
-CK_RV P11AttrStartDate::updateAttr(Token* /*token*/, bool /*isPrivate*/, CK_VOID_PTR pValue, CK_ULONG ulValueLen, int /*op*/)
+CK_RV P11AttrStartDate::updateAttr(OSObject* osobject, Token* /*token*/, bool /*isPrivate*/, CK_VOID_PTR pValue, CK_ULONG ulValueLen, int /*op*/)
 {
 	// Attribute specific checks
 
@@ -1122,14 +1121,14 @@ CK_RV P11AttrStartDate::updateAttr(Token* /*token*/, bool /*isPrivate*/, CK_VOID
  *****************************************/
 
 // Set default value
-bool P11AttrEndDate::setDefault()
+bool P11AttrEndDate::setDefault(OSObject* osobject)
 {
 	OSAttribute attr(ByteString(""));
 	return osobject->setAttribute(type, attr);
 }
 
 // Update the value if allowed
-CK_RV P11AttrEndDate::updateAttr(Token* /*token*/, bool /*isPrivate*/, CK_VOID_PTR pValue, CK_ULONG ulValueLen, int /*op*/)
+CK_RV P11AttrEndDate::updateAttr(OSObject* osobject, Token* /*token*/, bool /*isPrivate*/, CK_VOID_PTR pValue, CK_ULONG ulValueLen, int /*op*/)
 {
 	// Attribute specific checks
 
@@ -1149,7 +1148,7 @@ CK_RV P11AttrEndDate::updateAttr(Token* /*token*/, bool /*isPrivate*/, CK_VOID_P
  *****************************************/
 
 // Set default value
-bool P11AttrSerialNumber::setDefault()
+bool P11AttrSerialNumber::setDefault(OSObject* osobject)
 {
 	OSAttribute attr(ByteString(""));
 	return osobject->setAttribute(type, attr);
@@ -1160,7 +1159,7 @@ bool P11AttrSerialNumber::setDefault()
  *****************************************/
 
 // Set default value
-bool P11AttrURL::setDefault()
+bool P11AttrURL::setDefault(OSObject* osobject)
 {
 	OSAttribute attr(ByteString(""));
 	return osobject->setAttribute(type, attr);
@@ -1171,7 +1170,7 @@ bool P11AttrURL::setDefault()
  *****************************************/
 
 // Set default value
-bool P11AttrHashOfSubjectPublicKey::setDefault()
+bool P11AttrHashOfSubjectPublicKey::setDefault(OSObject* osobject)
 {
 	OSAttribute attr(ByteString(""));
 	return osobject->setAttribute(type, attr);
@@ -1182,7 +1181,7 @@ bool P11AttrHashOfSubjectPublicKey::setDefault()
  *****************************************/
 
 // Set default value
-bool P11AttrHashOfIssuerPublicKey::setDefault()
+bool P11AttrHashOfIssuerPublicKey::setDefault(OSObject* osobject)
 {
 	OSAttribute attr(ByteString(""));
 	return osobject->setAttribute(type, attr);
@@ -1193,14 +1192,14 @@ bool P11AttrHashOfIssuerPublicKey::setDefault()
  *****************************************/
 
 // Set default value
-bool P11AttrJavaMidpSecurityDomain::setDefault()
+bool P11AttrJavaMidpSecurityDomain::setDefault(OSObject* osobject)
 {
 	OSAttribute attr((unsigned long)0);
 	return osobject->setAttribute(type, attr);
 }
 
 // Update the value if allowed
-CK_RV P11AttrJavaMidpSecurityDomain::updateAttr(Token* /*token*/, bool /*isPrivate*/, CK_VOID_PTR pValue, CK_ULONG ulValueLen, int /*op*/)
+CK_RV P11AttrJavaMidpSecurityDomain::updateAttr(OSObject* osobject, Token* /*token*/, bool /*isPrivate*/, CK_VOID_PTR pValue, CK_ULONG ulValueLen, int /*op*/)
 {
 	// Attribute specific checks
 
@@ -1220,14 +1219,14 @@ CK_RV P11AttrJavaMidpSecurityDomain::updateAttr(Token* /*token*/, bool /*isPriva
  *****************************************/
 
 // Set default value
-bool P11AttrNameHashAlgorithm::setDefault()
+bool P11AttrNameHashAlgorithm::setDefault(OSObject* osobject)
 {
 	OSAttribute attr((unsigned long)CKM_SHA_1);
 	return osobject->setAttribute(type, attr);
 }
 
 // Update the value if allowed
-CK_RV P11AttrNameHashAlgorithm::updateAttr(Token* /*token*/, bool /*isPrivate*/, CK_VOID_PTR pValue, CK_ULONG ulValueLen, int /*op*/)
+CK_RV P11AttrNameHashAlgorithm::updateAttr(OSObject* osobject, Token* /*token*/, bool /*isPrivate*/, CK_VOID_PTR pValue, CK_ULONG ulValueLen, int /*op*/)
 {
 	// Attribute specific checks
 
@@ -1247,14 +1246,14 @@ CK_RV P11AttrNameHashAlgorithm::updateAttr(Token* /*token*/, bool /*isPrivate*/,
  *****************************************/
 
 // Set default value
-bool P11AttrDerive::setDefault()
+bool P11AttrDerive::setDefault(OSObject* osobject)
 {
 	OSAttribute attr(false);
 	return osobject->setAttribute(type, attr);
 }
 
 // Update the value if allowed
-CK_RV P11AttrDerive::updateAttr(Token* /*token*/, bool /*isPrivate*/, CK_VOID_PTR pValue, CK_ULONG ulValueLen, int /*op*/)
+CK_RV P11AttrDerive::updateAttr(OSObject* osobject, Token* /*token*/, bool /*isPrivate*/, CK_VOID_PTR pValue, CK_ULONG ulValueLen, int /*op*/)
 {
 	OSAttribute attrTrue(true);
 	OSAttribute attrFalse(false);
@@ -1285,14 +1284,14 @@ CK_RV P11AttrDerive::updateAttr(Token* /*token*/, bool /*isPrivate*/, CK_VOID_PT
  *****************************************/
 
 // Set default value
-bool P11AttrEncrypt::setDefault()
+bool P11AttrEncrypt::setDefault(OSObject* osobject)
 {
 	OSAttribute attr(true);
 	return osobject->setAttribute(type, attr);
 }
 
 // Update the value if allowed
-CK_RV P11AttrEncrypt::updateAttr(Token* /*token*/, bool /*isPrivate*/, CK_VOID_PTR pValue, CK_ULONG ulValueLen, int /*op*/)
+CK_RV P11AttrEncrypt::updateAttr(OSObject* osobject, Token* /*token*/, bool /*isPrivate*/, CK_VOID_PTR pValue, CK_ULONG ulValueLen, int /*op*/)
 {
 	OSAttribute attrTrue(true);
 	OSAttribute attrFalse(false);
@@ -1323,14 +1322,14 @@ CK_RV P11AttrEncrypt::updateAttr(Token* /*token*/, bool /*isPrivate*/, CK_VOID_P
  *****************************************/
 
 // Set default value
-bool P11AttrVerify::setDefault()
+bool P11AttrVerify::setDefault(OSObject* osobject)
 {
 	OSAttribute attr(true);
 	return osobject->setAttribute(type, attr);
 }
 
 // Update the value if allowed
-CK_RV P11AttrVerify::updateAttr(Token* /*token*/, bool /*isPrivate*/, CK_VOID_PTR pValue, CK_ULONG ulValueLen, int /*op*/)
+CK_RV P11AttrVerify::updateAttr(OSObject* osobject, Token* /*token*/, bool /*isPrivate*/, CK_VOID_PTR pValue, CK_ULONG ulValueLen, int /*op*/)
 {
 	OSAttribute attrTrue(true);
 	OSAttribute attrFalse(false);
@@ -1361,14 +1360,14 @@ CK_RV P11AttrVerify::updateAttr(Token* /*token*/, bool /*isPrivate*/, CK_VOID_PT
  *****************************************/
 
 // Set default value
-bool P11AttrVerifyRecover::setDefault()
+bool P11AttrVerifyRecover::setDefault(OSObject* osobject)
 {
 	OSAttribute attr(true);
 	return osobject->setAttribute(type, attr);
 }
 
 // Update the value if allowed
-CK_RV P11AttrVerifyRecover::updateAttr(Token* /*token*/, bool /*isPrivate*/, CK_VOID_PTR pValue, CK_ULONG ulValueLen, int /*op*/)
+CK_RV P11AttrVerifyRecover::updateAttr(OSObject* osobject, Token* /*token*/, bool /*isPrivate*/, CK_VOID_PTR pValue, CK_ULONG ulValueLen, int /*op*/)
 {
 	OSAttribute attrTrue(true);
 	OSAttribute attrFalse(false);
@@ -1399,14 +1398,14 @@ CK_RV P11AttrVerifyRecover::updateAttr(Token* /*token*/, bool /*isPrivate*/, CK_
  *****************************************/
 
 // Set default value
-bool P11AttrWrap::setDefault()
+bool P11AttrWrap::setDefault(OSObject* osobject)
 {
 	OSAttribute attr(true);
 	return osobject->setAttribute(type, attr);
 }
 
 // Update the value if allowed
-CK_RV P11AttrWrap::updateAttr(Token* /*token*/, bool /*isPrivate*/, CK_VOID_PTR pValue, CK_ULONG ulValueLen, int /*op*/)
+CK_RV P11AttrWrap::updateAttr(OSObject* osobject, Token* /*token*/, bool /*isPrivate*/, CK_VOID_PTR pValue, CK_ULONG ulValueLen, int /*op*/)
 {
 	OSAttribute attrTrue(true);
 	OSAttribute attrFalse(false);
@@ -1437,14 +1436,14 @@ CK_RV P11AttrWrap::updateAttr(Token* /*token*/, bool /*isPrivate*/, CK_VOID_PTR
  *****************************************/
 
 // Set default value
-bool P11AttrDecrypt::setDefault()
+bool P11AttrDecrypt::setDefault(OSObject* osobject)
 {
 	OSAttribute attr(true);
 	return osobject->setAttribute(type, attr);
 }
 
 // Update the value if allowed
-CK_RV P11AttrDecrypt::updateAttr(Token* /*token*/, bool /*isPrivate*/, CK_VOID_PTR pValue, CK_ULONG ulValueLen, int /*op*/)
+CK_RV P11AttrDecrypt::updateAttr(OSObject* osobject, Token* /*token*/, bool /*isPrivate*/, CK_VOID_PTR pValue, CK_ULONG ulValueLen, int /*op*/)
 {
 	OSAttribute attrTrue(true);
 	OSAttribute attrFalse(false);
@@ -1475,14 +1474,14 @@ CK_RV P11AttrDecrypt::updateAttr(Token* /*token*/, bool /*isPrivate*/, CK_VOID_P
  *****************************************/
 
 // Set default value
-bool P11AttrSign::setDefault()
+bool P11AttrSign::setDefault(OSObject* osobject)
 {
 	OSAttribute attr(true);
 	return osobject->setAttribute(type, attr);
 }
 
 // Update the value if allowed
-CK_RV P11AttrSign::updateAttr(Token* /*token*/, bool /*isPrivate*/, CK_VOID_PTR pValue, CK_ULONG ulValueLen, int /*op*/)
+CK_RV P11AttrSign::updateAttr(OSObject* osobject, Token* /*token*/, bool /*isPrivate*/, CK_VOID_PTR pValue, CK_ULONG ulValueLen, int /*op*/)
 {
 	OSAttribute attrTrue(true);
 	OSAttribute attrFalse(false);
@@ -1513,14 +1512,14 @@ CK_RV P11AttrSign::updateAttr(Token* /*token*/, bool /*isPrivate*/, CK_VOID_PTR
  *****************************************/
 
 // Set default value
-bool P11AttrSignRecover::setDefault()
+bool P11AttrSignRecover::setDefault(OSObject* osobject)
 {
 	OSAttribute attr(true);
 	return osobject->setAttribute(type, attr);
 }
 
 // Update the value if allowed
-CK_RV P11AttrSignRecover::updateAttr(Token* /*token*/, bool /*isPrivate*/, CK_VOID_PTR pValue, CK_ULONG ulValueLen, int /*op*/)
+CK_RV P11AttrSignRecover::updateAttr(OSObject* osobject, Token* /*token*/, bool /*isPrivate*/, CK_VOID_PTR pValue, CK_ULONG ulValueLen, int /*op*/)
 {
 	OSAttribute attrTrue(true);
 	OSAttribute attrFalse(false);
@@ -1551,14 +1550,14 @@ CK_RV P11AttrSignRecover::updateAttr(Token* /*token*/, bool /*isPrivate*/, CK_VO
  *****************************************/
 
 // Set default value
-bool P11AttrUnwrap::setDefault()
+bool P11AttrUnwrap::setDefault(OSObject* osobject)
 {
 	OSAttribute attr(true);
 	return osobject->setAttribute(type, attr);
 }
 
 // Update the value if allowed
-CK_RV P11AttrUnwrap::updateAttr(Token* /*token*/, bool /*isPrivate*/, CK_VOID_PTR pValue, CK_ULONG ulValueLen, int /*op*/)
+CK_RV P11AttrUnwrap::updateAttr(OSObject* osobject, Token* /*token*/, bool /*isPrivate*/, CK_VOID_PTR pValue, CK_ULONG ulValueLen, int /*op*/)
 {
 	OSAttribute attrTrue(true);
 	OSAttribute attrFalse(false);
@@ -1589,14 +1588,14 @@ CK_RV P11AttrUnwrap::updateAttr(Token* /*token*/, bool /*isPrivate*/, CK_VOID_PT
  *****************************************/
 
 // Set default value
-bool P11AttrLocal::setDefault()
+bool P11AttrLocal::setDefault(OSObject* osobject)
 {
 	OSAttribute attr(false);
 	return osobject->setAttribute(type, attr);
 }
 
 // Update the value if allowed
-CK_RV P11AttrLocal::updateAttr(Token* /*token*/, bool /*isPrivate*/, CK_VOID_PTR /*pValue*/, CK_ULONG /*ulValueLen*/, int /*op*/)
+CK_RV P11AttrLocal::updateAttr(OSObject* /*osobject*/, Token* /*token*/, bool /*isPrivate*/, CK_VOID_PTR /*pValue*/, CK_ULONG /*ulValueLen*/, int /*op*/)
 {
 	return CKR_ATTRIBUTE_READ_ONLY;
 }
@@ -1606,14 +1605,14 @@ CK_RV P11AttrLocal::updateAttr(Token* /*token*/, bool /*isPrivate*/, CK_VOID_PTR
  *****************************************/
 
 // Set default value
-bool P11AttrKeyGenMechanism::setDefault()
+bool P11AttrKeyGenMechanism::setDefault(OSObject* osobject)
 {
 	OSAttribute attr((unsigned long)CK_UNAVAILABLE_INFORMATION);
 	return osobject->setAttribute(type, attr);
 }
 
 // Update the value if allowed
-CK_RV P11AttrKeyGenMechanism::updateAttr(Token* /*token*/, bool /*isPrivate*/, CK_VOID_PTR /*pValue*/, CK_ULONG /*ulValueLen*/, int /*op*/)
+CK_RV P11AttrKeyGenMechanism::updateAttr(OSObject* /*osobject*/, Token* /*token*/, bool /*isPrivate*/, CK_VOID_PTR /*pValue*/, CK_ULONG /*ulValueLen*/, int /*op*/)
 {
 	return CKR_ATTRIBUTE_READ_ONLY;
 }
@@ -1623,14 +1622,14 @@ CK_RV P11AttrKeyGenMechanism::updateAttr(Token* /*token*/, bool /*isPrivate*/, C
  *****************************************/
 
 // Set default value
-bool P11AttrAlwaysSensitive::setDefault()
+bool P11AttrAlwaysSensitive::setDefault(OSObject* osobject)
 {
 	OSAttribute attr(false);
 	return osobject->setAttribute(type, attr);
 }
 
 // Update the value if allowed
-CK_RV P11AttrAlwaysSensitive::updateAttr(Token* /*token*/, bool /*isPrivate*/, CK_VOID_PTR /*pValue*/, CK_ULONG /*ulValueLen*/, int /*op*/)
+CK_RV P11AttrAlwaysSensitive::updateAttr(OSObject* /*osobject*/, Token* /*token*/, bool /*isPrivate*/, CK_VOID_PTR /*pValue*/, CK_ULONG /*ulValueLen*/, int /*op*/)
 {
 	return CKR_ATTRIBUTE_READ_ONLY;
 }
@@ -1640,14 +1639,14 @@ CK_RV P11AttrAlwaysSensitive::updateAttr(Token* /*token*/, bool /*isPrivate*/, C
  *****************************************/
 
 // Set default value
-bool P11AttrNeverExtractable::setDefault()
+bool P11AttrNeverExtractable::setDefault(OSObject* osobject)
 {
 	OSAttribute attr(true);
 	return osobject->setAttribute(type, attr);
 }
 
 // Update the value if allowed
-CK_RV P11AttrNeverExtractable::updateAttr(Token* /*token*/, bool /*isPrivate*/, CK_VOID_PTR /*pValue*/, CK_ULONG /*ulValueLen*/, int /*op*/)
+CK_RV P11AttrNeverExtractable::updateAttr(OSObject* /*osobject*/, Token* /*token*/, bool /*isPrivate*/, CK_VOID_PTR /*pValue*/, CK_ULONG /*ulValueLen*/, int /*op*/)
 {
 	return CKR_ATTRIBUTE_READ_ONLY;
 }
@@ -1657,7 +1656,7 @@ CK_RV P11AttrNeverExtractable::updateAttr(Token* /*token*/, bool /*isPrivate*/,
  *****************************************/
 
 // Set default value
-bool P11AttrSensitive::setDefault()
+bool P11AttrSensitive::setDefault(OSObject* osobject)
 {
 	// We default to false because we want to handle the secret keys in a correct way
 	OSAttribute attr(false);
@@ -1665,7 +1664,7 @@ bool P11AttrSensitive::setDefault()
 }
 
 // Update the value if allowed
-CK_RV P11AttrSensitive::updateAttr(Token* /*token*/, bool /*isPrivate*/, CK_VOID_PTR pValue, CK_ULONG ulValueLen, int op)
+CK_RV P11AttrSensitive::updateAttr(OSObject* osobject, Token* /*token*/, bool /*isPrivate*/, CK_VOID_PTR pValue, CK_ULONG ulValueLen, int op)
 {
 	OSAttribute attrTrue(true);
 	OSAttribute attrFalse(false);
@@ -1711,14 +1710,14 @@ CK_RV P11AttrSensitive::updateAttr(Token* /*token*/, bool /*isPrivate*/, CK_VOID
  *****************************************/
 
 // Set default value
-bool P11AttrExtractable::setDefault()
+bool P11AttrExtractable::setDefault(OSObject* osobject)
 {
 	OSAttribute attr(false);
 	return osobject->setAttribute(type, attr);
 }
 
 // Update the value if allowed
-CK_RV P11AttrExtractable::updateAttr(Token* /*token*/, bool /*isPrivate*/, CK_VOID_PTR pValue, CK_ULONG ulValueLen, int op)
+CK_RV P11AttrExtractable::updateAttr(OSObject* osobject, Token* /*token*/, bool /*isPrivate*/, CK_VOID_PTR pValue, CK_ULONG ulValueLen, int op)
 {
 	OSAttribute attrTrue(true);
 	OSAttribute attrFalse(false);
@@ -1758,14 +1757,14 @@ CK_RV P11AttrExtractable::updateAttr(Token* /*token*/, bool /*isPrivate*/, CK_VO
  *****************************************/
 
 // Set default value
-bool P11AttrWrapWithTrusted::setDefault()
+bool P11AttrWrapWithTrusted::setDefault(OSObject* osobject)
 {
 	OSAttribute attr(false);
 	return osobject->setAttribute(type, attr);
 }
 
 // Update the value if allowed
-CK_RV P11AttrWrapWithTrusted::updateAttr(Token* /*token*/, bool /*isPrivate*/, CK_VOID_PTR pValue, CK_ULONG ulValueLen, int op)
+CK_RV P11AttrWrapWithTrusted::updateAttr(OSObject* osobject, Token* /*token*/, bool /*isPrivate*/, CK_VOID_PTR pValue, CK_ULONG ulValueLen, int op)
 {
 	OSAttribute attrTrue(true);
 	OSAttribute attrFalse(false);
@@ -1804,14 +1803,14 @@ CK_RV P11AttrWrapWithTrusted::updateAttr(Token* /*token*/, bool /*isPrivate*/, C
  *****************************************/
 
 // Set default value
-bool P11AttrAlwaysAuthenticate::setDefault()
+bool P11AttrAlwaysAuthenticate::setDefault(OSObject* osobject)
 {
 	OSAttribute attr(false);
 	return osobject->setAttribute(type, attr);
 }
 
 // Update the value if allowed
-CK_RV P11AttrAlwaysAuthenticate::updateAttr(Token* /*token*/, bool isPrivate, CK_VOID_PTR pValue, CK_ULONG ulValueLen, int /*op*/)
+CK_RV P11AttrAlwaysAuthenticate::updateAttr(OSObject* osobject, Token* /*token*/, bool isPrivate, CK_VOID_PTR pValue, CK_ULONG ulValueLen, int /*op*/)
 {
 	OSAttribute attrTrue(true);
 	OSAttribute attrFalse(false);
@@ -1847,14 +1846,14 @@ CK_RV P11AttrAlwaysAuthenticate::updateAttr(Token* /*token*/, bool isPrivate, CK
  *****************************************/
 
 // Set default value
-bool P11AttrModulus::setDefault()
+bool P11AttrModulus::setDefault(OSObject* osobject)
 {
 	OSAttribute attr(ByteString(""));
 	return osobject->setAttribute(type, attr);
 }
 
 // Update the value if allowed
-CK_RV P11AttrModulus::updateAttr(Token *token, bool isPrivate, CK_VOID_PTR pValue, CK_ULONG ulValueLen, int op)
+CK_RV P11AttrModulus::updateAttr(OSObject* osobject, Token *token, bool isPrivate, CK_VOID_PTR pValue, CK_ULONG ulValueLen, int op)
 {
 	ByteString plaintext((unsigned char*)pValue, ulValueLen);
 	ByteString value;
@@ -1894,7 +1893,7 @@ CK_RV P11AttrModulus::updateAttr(Token *token, bool isPrivate, CK_VOID_PTR pValu
  *****************************************/
 
 // Set default value
-bool P11AttrPublicExponent::setDefault()
+bool P11AttrPublicExponent::setDefault(OSObject* osobject)
 {
 	OSAttribute attr(ByteString(""));
 	return osobject->setAttribute(type, attr);
@@ -1905,7 +1904,7 @@ bool P11AttrPublicExponent::setDefault()
  *****************************************/
 
 // Set default value
-bool P11AttrPrivateExponent::setDefault()
+bool P11AttrPrivateExponent::setDefault(OSObject* osobject)
 {
 	OSAttribute attr(ByteString(""));
 	return osobject->setAttribute(type, attr);
@@ -1916,7 +1915,7 @@ bool P11AttrPrivateExponent::setDefault()
  *****************************************/
 
 // Set default value
-bool P11AttrPrime1::setDefault()
+bool P11AttrPrime1::setDefault(OSObject* osobject)
 {
 	OSAttribute attr(ByteString(""));
 	return osobject->setAttribute(type, attr);
@@ -1927,7 +1926,7 @@ bool P11AttrPrime1::setDefault()
  *****************************************/
 
 // Set default value
-bool P11AttrPrime2::setDefault()
+bool P11AttrPrime2::setDefault(OSObject* osobject)
 {
 	OSAttribute attr(ByteString(""));
 	return osobject->setAttribute(type, attr);
@@ -1938,7 +1937,7 @@ bool P11AttrPrime2::setDefault()
  *****************************************/
 
 // Set default value
-bool P11AttrExponent1::setDefault()
+bool P11AttrExponent1::setDefault(OSObject* osobject)
 {
 	OSAttribute attr(ByteString(""));
 	return osobject->setAttribute(type, attr);
@@ -1949,7 +1948,7 @@ bool P11AttrExponent1::setDefault()
  *****************************************/
 
 // Set default value
-bool P11AttrExponent2::setDefault()
+bool P11AttrExponent2::setDefault(OSObject* osobject)
 {
 	OSAttribute attr(ByteString(""));
 	return osobject->setAttribute(type, attr);
@@ -1960,7 +1959,7 @@ bool P11AttrExponent2::setDefault()
  *****************************************/
 
 // Set default value
-bool P11AttrCoefficient::setDefault()
+bool P11AttrCoefficient::setDefault(OSObject* osobject)
 {
 	OSAttribute attr(ByteString(""));
 	return osobject->setAttribute(type, attr);
@@ -1971,14 +1970,14 @@ bool P11AttrCoefficient::setDefault()
  *****************************************/
 
 // Set default value
-bool P11AttrModulusBits::setDefault()
+bool P11AttrModulusBits::setDefault(OSObject* osobject)
 {
 	OSAttribute attr((unsigned long)0);
 	return osobject->setAttribute(type, attr);
 }
 
 // Update the value if allowed
-CK_RV P11AttrModulusBits::updateAttr(Token* /*token*/, bool /*isPrivate*/, CK_VOID_PTR pValue, CK_ULONG ulValueLen, int op)
+CK_RV P11AttrModulusBits::updateAttr(OSObject* osobject, Token* /*token*/, bool /*isPrivate*/, CK_VOID_PTR pValue, CK_ULONG ulValueLen, int op)
 {
 	// Attribute specific checks
 
@@ -2004,14 +2003,14 @@ CK_RV P11AttrModulusBits::updateAttr(Token* /*token*/, bool /*isPrivate*/, CK_VO
  *****************************************/
 
 // Set default value
-bool P11AttrPrime::setDefault()
+bool P11AttrPrime::setDefault(OSObject* osobject)
 {
 	OSAttribute attr(ByteString(""));
 	return osobject->setAttribute(type, attr);
 }
 
 // Update the value if allowed
-CK_RV P11AttrPrime::updateAttr(Token *token, bool isPrivate, CK_VOID_PTR pValue, CK_ULONG ulValueLen, int op)
+CK_RV P11AttrPrime::updateAttr(OSObject* osobject, Token *token, bool isPrivate, CK_VOID_PTR pValue, CK_ULONG ulValueLen, int op)
 {
 	ByteString plaintext((unsigned char*)pValue, ulValueLen);
 	ByteString value;
@@ -2051,7 +2050,7 @@ CK_RV P11AttrPrime::updateAttr(Token *token, bool isPrivate, CK_VOID_PTR pValue,
  *****************************************/
 
 // Set default value
-bool P11AttrSubPrime::setDefault()
+bool P11AttrSubPrime::setDefault(OSObject* osobject)
 {
 	OSAttribute attr(ByteString(""));
 	return osobject->setAttribute(type, attr);
@@ -2062,7 +2061,7 @@ bool P11AttrSubPrime::setDefault()
  *****************************************/
 
 // Set default value
-bool P11AttrBase::setDefault()
+bool P11AttrBase::setDefault(OSObject* osobject)
 {
 	OSAttribute attr(ByteString(""));
 	return osobject->setAttribute(type, attr);
@@ -2073,14 +2072,14 @@ bool P11AttrBase::setDefault()
  *****************************************/
 
 // Set default value
-bool P11AttrPrimeBits::setDefault()
+bool P11AttrPrimeBits::setDefault(OSObject* osobject)
 {
 	OSAttribute attr((unsigned long)0);
 	return osobject->setAttribute(type, attr);
 }
 
 // Update the value if allowed
-CK_RV P11AttrPrimeBits::updateAttr(Token* /*token*/, bool /*isPrivate*/, CK_VOID_PTR pValue, CK_ULONG ulValueLen, int op)
+CK_RV P11AttrPrimeBits::updateAttr(OSObject* osobject, Token* /*token*/, bool /*isPrivate*/, CK_VOID_PTR pValue, CK_ULONG ulValueLen, int op)
 {
 	// Attribute specific checks
 
@@ -2106,14 +2105,14 @@ CK_RV P11AttrPrimeBits::updateAttr(Token* /*token*/, bool /*isPrivate*/, CK_VOID
  *****************************************/
 
 // Set default value
-bool P11AttrValueBits::setDefault()
+bool P11AttrValueBits::setDefault(OSObject* osobject)
 {
 	OSAttribute attr((unsigned long)0);
 	return osobject->setAttribute(type, attr);
 }
 
 // Update the value if allowed
-CK_RV P11AttrValueBits::updateAttr(Token* /*token*/, bool /*isPrivate*/, CK_VOID_PTR pValue, CK_ULONG ulValueLen, int op)
+CK_RV P11AttrValueBits::updateAttr(OSObject* osobject, Token* /*token*/, bool /*isPrivate*/, CK_VOID_PTR pValue, CK_ULONG ulValueLen, int op)
 {
 	// Attribute specific checks
 
@@ -2139,7 +2138,7 @@ CK_RV P11AttrValueBits::updateAttr(Token* /*token*/, bool /*isPrivate*/, CK_VOID
  *****************************************/
 
 // Set default value
-bool P11AttrEcParams::setDefault()
+bool P11AttrEcParams::setDefault(OSObject* osobject)
 {
 	OSAttribute attr(ByteString(""));
 	return osobject->setAttribute(type, attr);
@@ -2150,7 +2149,7 @@ bool P11AttrEcParams::setDefault()
  *****************************************/
 
 // Set default value
-bool P11AttrEcPoint::setDefault()
+bool P11AttrEcPoint::setDefault(OSObject* osobject)
 {
 	OSAttribute attr(ByteString(""));
 	return osobject->setAttribute(type, attr);
@@ -2161,7 +2160,7 @@ bool P11AttrEcPoint::setDefault()
  *****************************************/
 
 // Set default value
-bool P11AttrGostR3410Params::setDefault()
+bool P11AttrGostR3410Params::setDefault(OSObject* osobject)
 {
 	OSAttribute attr(ByteString(""));
 	return osobject->setAttribute(type, attr);
@@ -2172,7 +2171,7 @@ bool P11AttrGostR3410Params::setDefault()
  *****************************************/
 
 // Set default value
-bool P11AttrGostR3411Params::setDefault()
+bool P11AttrGostR3411Params::setDefault(OSObject* osobject)
 {
 	OSAttribute attr(ByteString(""));
 	return osobject->setAttribute(type, attr);
@@ -2183,7 +2182,7 @@ bool P11AttrGostR3411Params::setDefault()
  *****************************************/
 
 // Set default value
-bool P11AttrGost28147Params::setDefault()
+bool P11AttrGost28147Params::setDefault(OSObject* osobject)
 {
 	OSAttribute attr(ByteString(""));
 	return osobject->setAttribute(type, attr);
@@ -2194,14 +2193,14 @@ bool P11AttrGost28147Params::setDefault()
  *****************************************/
 
 // Set default value
-bool P11AttrValueLen::setDefault()
+bool P11AttrValueLen::setDefault(OSObject* osobject)
 {
 	OSAttribute attr((unsigned long)0);
 	return osobject->setAttribute(type, attr);
 }
 
 // Update the value if allowed
-CK_RV P11AttrValueLen::updateAttr(Token* /*token*/, bool /*isPrivate*/, CK_VOID_PTR pValue, CK_ULONG ulValueLen, int op)
+CK_RV P11AttrValueLen::updateAttr(OSObject* osobject, Token* /*token*/, bool /*isPrivate*/, CK_VOID_PTR pValue, CK_ULONG ulValueLen, int op)
 {
 	// Attribute specific checks
 
@@ -2227,7 +2226,7 @@ CK_RV P11AttrValueLen::updateAttr(Token* /*token*/, bool /*isPrivate*/, CK_VOID_
  *****************************************/
 
 // Set default value
-bool P11AttrWrapTemplate::setDefault()
+bool P11AttrWrapTemplate::setDefault(OSObject* osobject)
 {
 	std::map<CK_ATTRIBUTE_TYPE,OSAttribute> empty;
 	OSAttribute attr(empty);
@@ -2235,7 +2234,7 @@ bool P11AttrWrapTemplate::setDefault()
 }
 
 // Update the value
-CK_RV P11AttrWrapTemplate::updateAttr(Token* /*token*/, bool /*isPrivate*/, CK_VOID_PTR pValue, CK_ULONG ulValueLen, int /*op*/)
+CK_RV P11AttrWrapTemplate::updateAttr(OSObject* osobject, Token* /*token*/, bool /*isPrivate*/, CK_VOID_PTR pValue, CK_ULONG ulValueLen, int /*op*/)
 {
 	// Attribute specific checks
 	if ((ulValueLen % sizeof(CK_ATTRIBUTE)) != 0)
@@ -2326,7 +2325,7 @@ CK_RV P11AttrWrapTemplate::updateAttr(Token* /*token*/, bool /*isPrivate*/, CK_V
  *****************************************/
 
 // Set default value
-bool P11AttrUnwrapTemplate::setDefault()
+bool P11AttrUnwrapTemplate::setDefault(OSObject* osobject)
 {
 	std::map<CK_ATTRIBUTE_TYPE,OSAttribute> empty;
 	OSAttribute attr(empty);
@@ -2334,7 +2333,7 @@ bool P11AttrUnwrapTemplate::setDefault()
 }
 
 // Update the value
-CK_RV P11AttrUnwrapTemplate::updateAttr(Token* /*token*/, bool /*isPrivate*/, CK_VOID_PTR pValue, CK_ULONG ulValueLen, int /*op*/)
+CK_RV P11AttrUnwrapTemplate::updateAttr(OSObject* osobject, Token* /*token*/, bool /*isPrivate*/, CK_VOID_PTR pValue, CK_ULONG ulValueLen, int /*op*/)
 {
 	// Attribute specific checks
 	if ((ulValueLen % sizeof(CK_ATTRIBUTE)) != 0)
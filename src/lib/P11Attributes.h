@@ -52,8 +52,8 @@ public:
 	// Destructor
 	virtual ~P11Attribute();
 
-	// Initialize the attribute
-	bool init();
+	// Initialize the attribute of the object
+	bool init(OSObject* osobject);
 
 	// Return the attribute type
 	CK_ATTRIBUTE_TYPE getType();
@@ -62,10 +62,10 @@ public:
 	CK_ULONG getChecks();
 
 	// Retrieve the value if allowed
-	CK_RV retrieve(Token *token, bool isPrivate, CK_VOID_PTR pValue, CK_ULONG_PTR pulValueLen);
+	CK_RV retrieve(OSObject* osobject, Token *token, bool isPrivate, CK_VOID_PTR pValue, CK_ULONG_PTR pulValueLen);
 
 	// Update the value if allowed
-	CK_RV update(Token *token, bool isPrivate, CK_VOID_PTR pValue, CK_ULONG ulValueLen, int op);
+	CK_RV update(OSObject* osobject, Token *token, bool isPrivate, CK_VOID_PTR pValue, CK_ULONG ulValueLen, int op);
 
 	// Checks are determined by footnotes from table 15 on page 62 in the PKCS#11 v2.3 spec.
 	// Table 15 contains common footnotes for object attribute tables that determine the checks to perform on attributes.
@@ -102,10 +102,7 @@ public:
 	};
 protected:
 	// Constructor
-	P11Attribute(OSObject* inobject);
-
-	// The object
-	OSObject* osobject;
+	P11Attribute();
 
 	// The attribute type
 	CK_ATTRIBUTE_TYPE type;
@@ -117,16 +114,16 @@ protected:
 	CK_ULONG size;
 
 	// Set the default value of the attribute
-	virtual bool setDefault() = 0;
+	virtual bool setDefault(OSObject* osobject) = 0;
 
 	// Update the value if allowed
-	virtual CK_RV updateAttr(Token *token, bool isPrivate, CK_VOID_PTR pValue, CK_ULONG ulValueLen, int op);
+	virtual CK_RV updateAttr(OSObject* osobject, Token *token, bool isPrivate, CK_VOID_PTR pValue, CK_ULONG ulValueLen, int op);
 
 	// Helper functions
-	bool isModifiable();
-	bool isSensitive();
-	bool isExtractable();
-	bool isTrusted();
+	bool isModifiable(OSObject* osobject);
+	bool isSensitive(OSObject* osobject);
+	bool isExtractable(OSObject* osobject);
+	bool isTrusted(OSObject* osobject);
 };
 
 /*****************************************
@@ -137,14 +134,14 @@ class P11AttrClass : public P11Attribute
 {
 public:
 	// Constructor
-	P11AttrClass(OSObject* inobject) : P11Attribute(inobject) { type = CKA_CLASS; size = sizeof(CK_OBJECT_CLASS); checks = ck1; }
+	P11AttrClass() : P11Attribute() { type = CKA_CLASS; size = sizeof(CK_OBJECT_CLASS); checks = ck1; }
 
 protected:
 	// Set the default value of the attribute
-	virtual bool setDefault();
+	virtual bool setDefault(OSObject* osobject);
 
 	// Update the value if allowed
-	virtual CK_RV updateAttr(Token *token, bool isPrivate, CK_VOID_PTR pValue, CK_ULONG ulValueLen, int op);
+	virtual CK_RV updateAttr(OSObject* osobject, Token *token, bool isPrivate, CK_VOID_PTR pValue, CK_ULONG ulValueLen, int op);
 };
 
 /*****************************************
@@ -155,14 +152,14 @@ class P11AttrKeyType : public P11Attribute
 {
 public:
 	// Constructor
-	P11AttrKeyType(OSObject* inobject, CK_ULONG inchecks = 0) : P11Attribute(inobject) { type = CKA_KEY_TYPE; size = sizeof(CK_KEY_TYPE); checks = ck1|inchecks; }
+	P11AttrKeyType(CK_ULONG inchecks = 0) : P11Attribute() { type = CKA_KEY_TYPE; size = sizeof(CK_KEY_TYPE); checks = ck1|inchecks; }
 
 protected:
 	// Set the default value of the attribute
-	virtual bool setDefault();
+	virtual bool setDefault(OSObject* osobject);
 
 	// Update the value if allowed
-	virtual CK_RV updateAttr(Token *token, bool isPrivate, CK_VOID_PTR pValue, CK_ULONG ulValueLen, int op);
+	virtual CK_RV updateAttr(OSObject* osobject, Token *token, bool isPrivate, CK_VOID_PTR pValue, CK_ULONG ulValueLen, int op);
 };
 
 /*****************************************
@@ -173,14 +170,14 @@ class P11AttrCertificateType : public P11Attribute
 {
 public:
 	// Constructor
-	P11AttrCertificateType(OSObject* inobject) : P11Attribute(inobject) { type = CKA_CERTIFICATE_TYPE; size = sizeof(CK_CERTIFICATE_TYPE); checks = ck1; }
+	P11AttrCertificateType() : P11Attribute() { type = CKA_CERTIFICATE_TYPE; size = sizeof(CK_CERTIFICATE_TYPE); checks = ck1; }
 
 protected:
 	// Set the default value of the attribute
-	virtual bool setDefault();
+	virtual bool setDefault(OSObject* osobject);
 
 	// Update the value if allowed
-	virtual CK_RV updateAttr(Token *token, bool isPrivate, CK_VOID_PTR pValue, CK_ULONG ulValueLen, int op);
+	virtual CK_RV updateAttr(OSObject* osobject, Token *token, bool isPrivate, CK_VOID_PTR pValue, CK_ULONG ulValueLen, int op);
 };
 
 /*****************************************
@@ -191,14 +188,14 @@ class P11AttrToken : public P11Attribute
 {
 public:
 	// Constructor
-	P11AttrToken(OSObject* inobject) : P11Attribute(inobject) { type = CKA_TOKEN; size = sizeof(CK_BBOOL); checks = ck17; }
+	P11AttrToken() : P11Attribute() { type = CKA_TOKEN; size = sizeof(CK_BBOOL); checks = ck17; }
 
 protected:
 	// Set the default value of the attribute
-	virtual bool setDefault();
+	virtual bool setDefault(OSObject* osobject);
 
 	// Update the value if allowed
-	virtual CK_RV updateAttr(Token *token, bool isPrivate, CK_VOID_PTR pValue, CK_ULONG ulValueLen, int op);
+	virtual CK_RV updateAttr(OSObject* osobject, Token *token, bool isPrivate, CK_VOID_PTR pValue, CK_ULONG ulValueLen, int op);
 };
 
 /*****************************************
@@ -209,14 +206,14 @@ class P11AttrPrivate : public P11Attribute
 {
 public:
 	// Constructor
-	P11AttrPrivate(OSObject* inobject) : P11Attribute(inobject) { type = CKA_PRIVATE; size = sizeof(CK_BBOOL); checks = ck17; }
+	P11AttrPrivate() : P11Attribute() { type = CKA_PRIVATE; size = sizeof(CK_BBOOL); checks = ck17; }
 
 protected:
 	// Set the default value of the attribute
-	virtual bool setDefault();
+	virtual bool setDefault(OSObject* osobject);
 
 	// Update the value if allowed
-	virtual CK_RV updateAttr(Token *token, bool isPrivate, CK_VOID_PTR pValue, CK_ULONG ulValueLen, int op);
+	virtual CK_RV updateAttr(OSObject* osobject, Token *token, bool isPrivate, CK_VOID_PTR pValue, CK_ULONG ulValueLen, int op);
 };
 
 /*****************************************
@@ -227,14 +224,14 @@ class P11AttrModifiable : public P11Attribute
 {
 public:
 	// Constructor
-	P11AttrModifiable(OSObject* inobject) : P11Attribute(inobject) { type = CKA_MODIFIABLE; size = sizeof(CK_BBOOL); checks = ck17; }
+	P11AttrModifiable() : P11Attribute() { type = CKA_MODIFIABLE; size = sizeof(CK_BBOOL); checks = ck17; }
 
 protected:
 	// Set the default value of the attribute
-	virtual bool setDefault();
+	virtual bool setDefault(OSObject* osobject);
 
 	// Update the value if allowed
-	virtual CK_RV updateAttr(Token *token, bool isPrivate, CK_VOID_PTR pValue, CK_ULONG ulValueLen, int op);
+	virtual CK_RV updateAttr(OSObject* osobject, Token *token, bool isPrivate, CK_VOID_PTR pValue, CK_ULONG ulValueLen, int op);
 };
 
 /*****************************************
@@ -245,11 +242,11 @@ class P11AttrLabel : public P11Attribute
 {
 public:
 	// Constructor
-	P11AttrLabel(OSObject* inobject) : P11Attribute(inobject) { type = CKA_LABEL;  checks = ck8; }
+	P11AttrLabel() : P11Attribute() { type = CKA_LABEL;  checks = ck8; }
 
 protected:
 	// Set the default value of the attribute
-	virtual bool setDefault();
+	virtual bool setDefault(OSObject* osobject);
 };
 
 /*****************************************
@@ -260,14 +257,14 @@ class P11AttrCopyable : public P11Attribute
 {
 public:
 	// Constructor
-	P11AttrCopyable(OSObject* inobject) : P11Attribute(inobject) { type = CKA_COPYABLE; size = sizeof(CK_BBOOL); checks = ck12; }
+	P11AttrCopyable() : P11Attribute() { type = CKA_COPYABLE; size = sizeof(CK_BBOOL); checks = ck12; }
 
 protected:
 	// Set the default value of the attribute
-	virtual bool setDefault();
+	virtual bool setDefault(OSObject* osobject);
 
 	// Update the value if allowed
-	virtual CK_RV updateAttr(Token *token, bool isPrivate, CK_VOID_PTR pValue, CK_ULONG ulValueLen, int op);
+	virtual CK_RV updateAttr(OSObject* osobject, Token *token, bool isPrivate, CK_VOID_PTR pValue, CK_ULONG ulValueLen, int op);
 };
 
 /*****************************************
@@ -278,11 +275,11 @@ class P11AttrApplication : public P11Attribute
 {
 public:
 	// Constructor
-	P11AttrApplication(OSObject* inobject) : P11Attribute(inobject) { type = CKA_APPLICATION; checks = 0; }
+	P11AttrApplication() : P11Attribute() { type = CKA_APPLICATION; checks = 0; }
 
 protected:
 	// Set the default value of the attribute
-	virtual bool setDefault();
+	virtual bool setDefault(OSObject* osobject);
 };
 
 /*****************************************
@@ -293,11 +290,11 @@ class P11AttrObjectID : public P11Attribute
 {
 public:
 	// Constructor
-	P11AttrObjectID(OSObject* inobject) : P11Attribute(inobject) { type = CKA_OBJECT_ID; checks = 0; }
+	P11AttrObjectID() : P11Attribute() { type = CKA_OBJECT_ID; checks = 0; }
 
 protected:
 	// Set the default value of the attribute
-	virtual bool setDefault();
+	virtual bool setDefault(OSObject* osobject);
 };
 
 /*****************************************
@@ -308,15 +305,15 @@ class P11AttrCheckValue : public P11Attribute
 {
 public:
 	// Constructor
-	P11AttrCheckValue(OSObject* inobject, CK_ULONG inchecks) : P11Attribute(inobject) { type = CKA_CHECK_VALUE; checks = inchecks; }
+	P11AttrCheckValue(CK_ULONG inchecks) : P11Attribute() { type = CKA_CHECK_VALUE; checks = inchecks; }
 
 protected:
 	// Set the default value of the attribute
-	virtual bool setDefault();
+	virtual bool setDefault(OSObject* osobject);
 
 
 	// Update the value if allowed
-	virtual CK_RV updateAttr(Token *token, bool isPrivate, CK_VOID_PTR pValue, CK_ULONG ulValueLen, int op);
+	virtual CK_RV updateAttr(OSObject* osobject, Token *token, bool isPrivate, CK_VOID_PTR pValue, CK_ULONG ulValueLen, int op);
 };
 
 /*****************************************
@@ -327,11 +324,11 @@ class P11AttrID : public P11Attribute
 {
 public:
 	// Constructor
-	P11AttrID(OSObject* inobject) : P11Attribute(inobject) { type = CKA_ID; checks = ck8; }
+	P11AttrID() : P11Attribute() { type = CKA_ID; checks = ck8; }
 
 protected:
 	// Set the default value of the attribute
-	virtual bool setDefault();
+	virtual bool setDefault(OSObject* osobject);
 };
 
 /*****************************************
@@ -342,14 +339,14 @@ class P11AttrValue : public P11Attribute
 {
 public:
 	// Constructor
-	P11AttrValue(OSObject* inobject, CK_ULONG inchecks) : P11Attribute(inobject) { type = CKA_VALUE; checks = inchecks; }
+	P11AttrValue(CK_ULONG inchecks) : P11Attribute() { type = CKA_VALUE; checks = inchecks; }
 
 protected:
 	// Set the default value of the attribute
-	virtual bool setDefault();
+	virtual bool setDefault(OSObject* osobject);
 
 	// Update the value if allowed
-	virtual CK_RV updateAttr(Token *token, bool isPrivate, CK_VOID_PTR pValue, CK_ULONG ulValueLen, int op);
+	virtual CK_RV updateAttr(OSObject* osobject, Token *token, bool isPrivate, CK_VOID_PTR pValue, CK_ULONG ulValueLen, int op);
 };
 
 /*****************************************
@@ -360,11 +357,11 @@ class P11AttrSubject : public P11Attribute
 {
 public:
 	// Constructor
-	P11AttrSubject(OSObject* inobject, CK_ULONG inchecks) : P11Attribute(inobject) { type = CKA_SUBJECT; checks = inchecks; }
+	P11AttrSubject(CK_ULONG inchecks) : P11Attribute() { type = CKA_SUBJECT; checks = inchecks; }
 
 protected:
 	// Set the default value of the attribute
-	virtual bool setDefault();
+	virtual bool setDefault(OSObject* osobject);
 };
 
 /*****************************************
@@ -375,11 +372,11 @@ class P11AttrIssuer : public P11Attribute
 {
 public:
 	// Constructor
-	P11AttrIssuer(OSObject* inobject) : P11Attribute(inobject) { type = CKA_ISSUER; checks = ck8; }
+	P11AttrIssuer() : P11Attribute() { type = CKA_ISSUER; checks = ck8; }
 
 protected:
 	// Set the default value of the attribute
-	virtual bool setDefault();
+	virtual bool setDefault(OSObject* osobject);
 };
 
 /*****************************************
@@ -390,14 +387,14 @@ class P11AttrTrusted : public P11Attribute
 {
 public:
 	// Constructor
-	P11AttrTrusted(OSObject* inobject) : P11Attribute(inobject) { type = CKA_TRUSTED; size = sizeof(CK_BBOOL); checks = ck10; }
+	P11AttrTrusted() : P11Attribute() { type = CKA_TRUSTED; size = sizeof(CK_BBOOL); checks = ck10; }
 
 protected:
 	// Set the default value of the attribute
-	virtual bool setDefault();
+	virtual bool setDefault(OSObject* osobject);
 
 	// Update the value if allowed
-	virtual CK_RV updateAttr(Token *token, bool isPrivate, CK_VOID_PTR pValue, CK_ULONG ulValueLen, int op);
+	virtual CK_RV updateAttr(OSObject* osobject, Token *token, bool isPrivate, CK_VOID_PTR pValue, CK_ULONG ulValueLen, int op);
 };
 
 /*****************************************
@@ -408,14 +405,14 @@ class P11AttrCertificateCategory : public P11Attribute
 {
 public:
 	// Constructor
-	P11AttrCertificateCategory(OSObject* inobject) : P11Attribute(inobject) { type = CKA_CERTIFICATE_CATEGORY; size = sizeof(CK_ULONG); checks = 0; }
+	P11AttrCertificateCategory() : P11Attribute() { type = CKA_CERTIFICATE_CATEGORY; size = sizeof(CK_ULONG); checks = 0; }
 
 protected:
 	// Set the default value of the attribute
-	virtual bool setDefault();
+	virtual bool setDefault(OSObject* osobject);
 
 	// Update the value if allowed
-	virtual CK_RV updateAttr(Token *token, bool isPrivate, CK_VOID_PTR pValue, CK_ULONG ulValueLen, int op);
+	virtual CK_RV updateAttr(OSObject* osobject, Token *token, bool isPrivate, CK_VOID_PTR pValue, CK_ULONG ulValueLen, int op);
 };
 
 /*****************************************
@@ -426,14 +423,14 @@ class P11AttrStartDate : public P11Attribute
 {
 public:
 	// Constructor
-	P11AttrStartDate(OSObject* inobject, CK_ULONG inchecks) : P11Attribute(inobject) { type = CKA_START_DATE; checks = inchecks; }
+	P11AttrStartDate(CK_ULONG inchecks) : P11Attribute() { type = CKA_START_DATE; checks = inchecks; }
 
 protected:
 	// Set the default value of the attribute
-	virtual bool setDefault();
+	virtual bool setDefault(OSObject* osobject);
 
 	// Update the value if allowed
-	virtual CK_RV updateAttr(Token *token, bool isPrivate, CK_VOID_PTR pValue, CK_ULONG ulValueLen, int op);
+	virtual CK_RV updateAttr(OSObject* osobject, Token *token, bool isPrivate, CK_VOID_PTR pValue, CK_ULONG ulValueLen, int op);
 };
 
 /*****************************************
@@ -444,14 +441,14 @@ class P11AttrEndDate : public P11Attribute
 {
 public:
 	// Constructor
-	P11AttrEndDate(OSObject* inobject, CK_ULONG inchecks) : P11Attribute(inobject) { type = CKA_END_DATE; checks = inchecks; }
+	P11AttrEndDate(CK_ULONG inchecks) : P11Attribute() { type = CKA_END_DATE; checks = inchecks; }
 
 protected:
 	// Set the default value of the attribute
-	virtual bool setDefault();
+	virtual bool setDefault(OSObject* osobject);
 
 	// Update the value if allowed
-	virtual CK_RV updateAttr(Token *token, bool isPrivate, CK_VOID_PTR pValue, CK_ULONG ulValueLen, int op);
+	virtual CK_RV updateAttr(OSObject* osobject, Token *token, bool isPrivate, CK_VOID_PTR pValue, CK_ULONG ulValueLen, int op);
 };
 
 /*****************************************
@@ -462,11 +459,11 @@ class P11AttrSerialNumber : public P11Attribute
 {
 public:
 	// Constructor
-	P11AttrSerialNumber(OSObject* inobject) : P11Attribute(inobject) { type = CKA_SERIAL_NUMBER; checks = ck8; }
+	P11AttrSerialNumber() : P11Attribute() { type = CKA_SERIAL_NUMBER; checks = ck8; }
 
 protected:
 	// Set the default value of the attribute
-	virtual bool setDefault();
+	virtual bool setDefault(OSObject* osobject);
 };
 
 /*****************************************
@@ -477,11 +474,11 @@ class P11AttrURL : public P11Attribute
 {
 public:
 	// Constructor
-	P11AttrURL(OSObject* inobject) : P11Attribute(inobject) { type = CKA_URL; checks = ck15; }
+	P11AttrURL() : P11Attribute() { type = CKA_URL; checks = ck15; }
 
 protected:
 	// Set the default value of the attribute
-	virtual bool setDefault();
+	virtual bool setDefault(OSObject* osobject);
 };
 
 /*****************************************
@@ -492,11 +489,11 @@ class P11AttrHashOfSubjectPublicKey : public P11Attribute
 {
 public:
 	// Constructor
-	P11AttrHashOfSubjectPublicKey(OSObject* inobject) : P11Attribute(inobject) { type = CKA_HASH_OF_SUBJECT_PUBLIC_KEY; checks = ck16; }
+	P11AttrHashOfSubjectPublicKey() : P11Attribute() { type = CKA_HASH_OF_SUBJECT_PUBLIC_KEY; checks = ck16; }
 
 protected:
 	// Set the default value of the attribute
-	virtual bool setDefault();
+	virtual bool setDefault(OSObject* osobject);
 };
 
 /*****************************************
@@ -507,11 +504,11 @@ class P11AttrHashOfIssuerPublicKey : public P11Attribute
 {
 public:
 	// Constructor
-	P11AttrHashOfIssuerPublicKey(OSObject* inobject) : P11Attribute(inobject) { type = CKA_HASH_OF_ISSUER_PUBLIC_KEY; checks = ck16; }
+	P11AttrHashOfIssuerPublicKey() : P11Attribute() { type = CKA_HASH_OF_ISSUER_PUBLIC_KEY; checks = ck16; }
 
 protected:
 	// Set the default value of the attribute
-	virtual bool setDefault();
+	virtual bool setDefault(OSObject* osobject);
 };
 
 /*****************************************
@@ -522,14 +519,14 @@ class P11AttrJavaMidpSecurityDomain : public P11Attribute
 {
 public:
 	// Constructor
-	P11AttrJavaMidpSecurityDomain(OSObject* inobject) : P11Attribute(inobject) { type = CKA_JAVA_MIDP_SECURITY_DOMAIN; size = sizeof(CK_ULONG); checks = 0; }
+	P11AttrJavaMidpSecurityDomain() : P11Attribute() { type = CKA_JAVA_MIDP_SECURITY_DOMAIN; size = sizeof(CK_ULONG); checks = 0; }
 
 protected:
 	// Set the default value of the attribute
-	virtual bool setDefault();
+	virtual bool setDefault(OSObject* osobject);
 
 	// Update the value if allowed
-	virtual CK_RV updateAttr(Token *token, bool isPrivate, CK_VOID_PTR pValue, CK_ULONG ulValueLen, int op);
+	virtual CK_RV updateAttr(OSObject* osobject, Token *token, bool isPrivate, CK_VOID_PTR pValue, CK_ULONG ulValueLen, int op);
 };
 
 /*****************************************
@@ -540,14 +537,14 @@ class P11AttrNameHashAlgorithm : public P11Attribute
 {
 public:
 	// Constructor
-	P11AttrNameHashAlgorithm(OSObject* inobject) : P11Attribute(inobject) { type = CKA_NAME_HASH_ALGORITHM; size = sizeof(CK_MECHANISM_TYPE); checks = 0; }
+	P11AttrNameHashAlgorithm() : P11Attribute() { type = CKA_NAME_HASH_ALGORITHM; size = sizeof(CK_MECHANISM_TYPE); checks = 0; }
 
 protected:
 	// Set the default value of the attribute
-	virtual bool setDefault();
+	virtual bool setDefault(OSObject* osobject);
 
 	// Update the value if allowed
-	virtual CK_RV updateAttr(Token *token, bool isPrivate, CK_VOID_PTR pValue, CK_ULONG ulValueLen, int op);
+	virtual CK_RV updateAttr(OSObject* osobject, Token *token, bool isPrivate, CK_VOID_PTR pValue, CK_ULONG ulValueLen, int op);
 };
 
 /*****************************************
@@ -558,14 +555,14 @@ class P11AttrDerive : public P11Attribute
 {
 public:
 	// Constructor
-	P11AttrDerive(OSObject* inobject) : P11Attribute(inobject) { type = CKA_DERIVE; size = sizeof(CK_BBOOL); checks = ck8;}
+	P11AttrDerive() : P11Attribute() { type = CKA_DERIVE; size = sizeof(CK_BBOOL); checks = ck8;}
 
 protected:
 	// Set the default value of the attribute
-	virtual bool setDefault();
+	virtual bool setDefault(OSObject* osobject);
 
 	// Update the value if allowed
-	virtual CK_RV updateAttr(Token *token, bool isPrivate, CK_VOID_PTR pValue, CK_ULONG ulValueLen, int op);
+	virtual CK_RV updateAttr(OSObject* osobject, Token *token, bool isPrivate, CK_VOID_PTR pValue, CK_ULONG ulValueLen, int op);
 };
 
 /*****************************************
@@ -576,14 +573,14 @@ class P11AttrEncrypt : public P11Attribute
 {
 public:
 	// Constructor
-	P11AttrEncrypt(OSObject* inobject) : P11Attribute(inobject) { type = CKA_ENCRYPT; size = sizeof(CK_BBOOL); checks = ck8|ck9; }
+	P11AttrEncrypt() : P11Attribute() { type = CKA_ENCRYPT; size = sizeof(CK_BBOOL); checks = ck8|ck9; }
 
 protected:
 	// Set the default value of the attribute
-	virtual bool setDefault();
+	virtual bool setDefault(OSObject* osobject);
 
 	// Update the value if allowed
-	virtual CK_RV updateAttr(Token *token, bool isPrivate, CK_VOID_PTR pValue, CK_ULONG ulValueLen, int op);
+	virtual CK_RV updateAttr(OSObject* osobject, Token *token, bool isPrivate, CK_VOID_PTR pValue, CK_ULONG ulValueLen, int op);
 };
 
 /*****************************************
@@ -594,14 +591,14 @@ class P11AttrVerify : public P11Attribute
 {
 public:
 	// Constructor
-	P11AttrVerify(OSObject* inobject) : P11Attribute(inobject) { type = CKA_VERIFY; size = sizeof(CK_BBOOL); checks = ck8|ck9; }
+	P11AttrVerify() : P11Attribute() { type = CKA_VERIFY; size = sizeof(CK_BBOOL); checks = ck8|ck9; }
 
 protected:
 	// Set the default value of the attribute
-	virtual bool setDefault();
+	virtual bool setDefault(OSObject* osobject);
 
 	// Update the value if allowed
-	virtual CK_RV updateAttr(Token *token, bool isPrivate, CK_VOID_PTR pValue, CK_ULONG ulValueLen, int op);
+	virtual CK_RV updateAttr(OSObject* osobject, Token *token, bool isPrivate, CK_VOID_PTR pValue, CK_ULONG ulValueLen, int op);
 };
 
 /*****************************************
@@ -612,14 +609,14 @@ class P11AttrVerifyRecover : public P11Attribute
 {
 public:
 	// Constructor
-	P11AttrVerifyRecover(OSObject* inobject) : P11Attribute(inobject) { type = CKA_VERIFY_RECOVER; size = sizeof(CK_BBOOL); checks = ck8|ck9; }
+	P11AttrVerifyRecover() : P11Attribute() { type = CKA_VERIFY_RECOVER; size = sizeof(CK_BBOOL); checks = ck8|ck9; }
 
 protected:
 	// Set the default value of the attribute
-	virtual bool setDefault();
+	virtual bool setDefault(OSObject* osobject);
 
 	// Update the value if allowed
-	virtual CK_RV updateAttr(Token *token, bool isPrivate, CK_VOID_PTR pValue, CK_ULONG ulValueLen, int op);
+	virtual CK_RV updateAttr(OSObject* osobject, Token *token, bool isPrivate, CK_VOID_PTR pValue, CK_ULONG ulValueLen, int op);
 };
 
 /*****************************************
@@ -630,14 +627,14 @@ class P11AttrWrap : public P11Attribute
 {
 public:
 	// Constructor
-	P11AttrWrap(OSObject* inobject) : P11Attribute(inobject) { type = CKA_WRAP; size = sizeof(CK_BBOOL); checks = ck8|ck9; }
+	P11AttrWrap() : P11Attribute() { type = CKA_WRAP; size = sizeof(CK_BBOOL); checks = ck8|ck9; }
 
 protected:
 	// Set the default value of the attribute
-	virtual bool setDefault();
+	virtual bool setDefault(OSObject* osobject);
 
 	// Update the value if allowed
-	virtual CK_RV updateAttr(Token *token, bool isPrivate, CK_VOID_PTR pValue, CK_ULONG ulValueLen, int op);
+	virtual CK_RV updateAttr(OSObject* osobject, Token *token, bool isPrivate, CK_VOID_PTR pValue, CK_ULONG ulValueLen, int op);
 };
 
 /*****************************************
@@ -648,14 +645,14 @@ class P11AttrDecrypt : public P11Attribute
 {
 public:
 	// Constructor
-	P11AttrDecrypt(OSObject* inobject) : P11Attribute(inobject) { type = CKA_DECRYPT; size = sizeof(CK_BBOOL); checks = ck8|ck9; }
+	P11AttrDecrypt() : P11Attribute() { type = CKA_DECRYPT; size = sizeof(CK_BBOOL); checks = ck8|ck9; }
 
 protected:
 	// Set the default value of the attribute
-	virtual bool setDefault();
+	virtual bool setDefault(OSObject* osobject);
 
 	// Update the value if allowed
-	virtual CK_RV updateAttr(Token *token, bool isPrivate, CK_VOID_PTR pValue, CK_ULONG ulValueLen, int op);
+	virtual CK_RV updateAttr(OSObject* osobject, Token *token, bool isPrivate, CK_VOID_PTR pValue, CK_ULONG ulValueLen, int op);
 };
 
 /*****************************************
@@ -666,14 +663,14 @@ class P11AttrSign : public P11Attribute
 {
 public:
 	// Constructor
-	P11AttrSign(OSObject* inobject) : P11Attribute(inobject) { type = CKA_SIGN; size = sizeof(CK_BBOOL); checks = ck8|ck9; }
+	P11AttrSign() : P11Attribute() { type = CKA_SIGN; size = sizeof(CK_BBOOL); checks = ck8|ck9; }
 
 protected:
 	// Set the default value of the attribute
-	virtual bool setDefault();
+	virtual bool setDefault(OSObject* osobject);
 
 	// Update the value if allowed
-	virtual CK_RV updateAttr(Token *token, bool isPrivate, CK_VOID_PTR pValue, CK_ULONG ulValueLen, int op);
+	virtual CK_RV updateAttr(OSObject* osobject, Token *token, bool isPrivate, CK_VOID_PTR pValue, CK_ULONG ulValueLen, int op);
 };
 
 /*****************************************
@@ -684,14 +681,14 @@ class P11AttrSignRecover : public P11Attribute
 {
 public:
 	// Constructor
-	P11AttrSignRecover(OSObject* inobject) : P11Attribute(inobject) { type = CKA_SIGN_RECOVER; size = sizeof(CK_BBOOL); checks = ck8|ck9; }
+	P11AttrSignRecover() : P11Attribute() { type = CKA_SIGN_RECOVER; size = sizeof(CK_BBOOL); checks = ck8|ck9; }
 
 protected:
 	// Set the default value of the attribute
-	virtual bool setDefault();
+	virtual bool setDefault(OSObject* osobject);
 
 	// Update the value if allowed
-	virtual CK_RV updateAttr(Token *token, bool isPrivate, CK_VOID_PTR pValue, CK_ULONG ulValueLen, int op);
+	virtual CK_RV updateAttr(OSObject* osobject, Token *token, bool isPrivate, CK_VOID_PTR pValue, CK_ULONG ulValueLen, int op);
 };
 
 /*****************************************
@@ -702,14 +699,14 @@ class P11AttrUnwrap : public P11Attribute
 {
 public:
 	// Constructor
-	P11AttrUnwrap(OSObject* inobject) : P11Attribute(inobject) { type = CKA_UNWRAP; size = sizeof(CK_BBOOL); checks = ck8|ck9; }
+	P11AttrUnwrap() : P11Attribute() { type = CKA_UNWRAP; size = sizeof(CK_BBOOL); checks = ck8|ck9; }
 
 protected:
 	// Set the default value of the attribute
-	virtual bool setDefault();
+	virtual bool setDefault(OSObject* osobject);
 
 	// Update the value if allowed
-	virtual CK_RV updateAttr(Token *token, bool isPrivate, CK_VOID_PTR pValue, CK_ULONG ulValueLen, int op);
+	virtual CK_RV updateAttr(OSObject* osobject, Token *token, bool isPrivate, CK_VOID_PTR pValue, CK_ULONG ulValueLen, int op);
 };
 
 /*****************************************
@@ -720,14 +717,14 @@ class P11AttrLocal : public P11Attribute
 {
 public:
 	// Constructor
-	P11AttrLocal(OSObject* inobject, CK_ULONG inchecks = 0) : P11Attribute(inobject) { type = CKA_LOCAL; size = sizeof(CK_BBOOL); checks = ck2|ck4|inchecks; }
+	P11AttrLocal(CK_ULONG inchecks = 0) : P11Attribute() { type = CKA_LOCAL; size = sizeof(CK_BBOOL); checks = ck2|ck4|inchecks; }
 
 protected:
 	// Set the default value of the attribute
-	virtual bool setDefault();
+	virtual bool setDefault(OSObject* osobject);
 
 	// Update the value if allowed
-	virtual CK_RV updateAttr(Token *token, bool isPrivate, CK_VOID_PTR pValue, CK_ULONG ulValueLen, int op);
+	virtual CK_RV updateAttr(OSObject* osobject, Token *token, bool isPrivate, CK_VOID_PTR pValue, CK_ULONG ulValueLen, int op);
 };
 
 /*****************************************
@@ -738,14 +735,14 @@ class P11AttrKeyGenMechanism : public P11Attribute
 {
 public:
 	// Constructor
-	P11AttrKeyGenMechanism(OSObject* inobject) : P11Attribute(inobject) { type = CKA_KEY_GEN_MECHANISM; size = sizeof(CK_MECHANISM_TYPE); checks = ck2|ck4|ck6; }
+	P11AttrKeyGenMechanism() : P11Attribute() { type = CKA_KEY_GEN_MECHANISM; size = sizeof(CK_MECHANISM_TYPE); checks = ck2|ck4|ck6; }
 
 protected:
 	// Set the default value of the attribute
-	virtual bool setDefault();
+	virtual bool setDefault(OSObject* osobject);
 
 	// Update the value if allowed
-	virtual CK_RV updateAttr(Token *token, bool isPrivate, CK_VOID_PTR pValue, CK_ULONG ulValueLen, int op);
+	virtual CK_RV updateAttr(OSObject* osobject, Token *token, bool isPrivate, CK_VOID_PTR pValue, CK_ULONG ulValueLen, int op);
 };
 
 /*****************************************
@@ -756,14 +753,14 @@ class P11AttrAlwaysSensitive : public P11Attribute
 {
 public:
 	// Constructor
-	P11AttrAlwaysSensitive(OSObject* inobject) : P11Attribute(inobject) { type = CKA_ALWAYS_SENSITIVE; size = sizeof(CK_BBOOL); checks = ck2|ck4|ck6; }
+	P11AttrAlwaysSensitive() : P11Attribute() { type = CKA_ALWAYS_SENSITIVE; size = sizeof(CK_BBOOL); checks = ck2|ck4|ck6; }
 
 protected:
 	// Set the default value of the attribute
-	virtual bool setDefault();
+	virtual bool setDefault(OSObject* osobject);
 
 	// Update the value if allowed
-	virtual CK_RV updateAttr(Token *token, bool isPrivate, CK_VOID_PTR pValue, CK_ULONG ulValueLen, int op);
+	virtual CK_RV updateAttr(OSObject* osobject, Token *token, bool isPrivate, CK_VOID_PTR pValue, CK_ULONG ulValueLen, int op);
 };
 
 /*****************************************
@@ -774,14 +771,14 @@ class P11AttrNeverExtractable : public P11Attribute
 {
 public:
 	// Constructor
-	P11AttrNeverExtractable(OSObject* inobject) : P11Attribute(inobject) { type = CKA_NEVER_EXTRACTABLE; size = sizeof(CK_BBOOL); checks = ck2|ck4|ck6; }
+	P11AttrNeverExtractable() : P11Attribute() { type = CKA_NEVER_EXTRACTABLE; size = sizeof(CK_BBOOL); checks = ck2|ck4|ck6; }
 
 protected:
 	// Set the default value of the attribute
-	virtual bool setDefault();
+	virtual bool setDefault(OSObject* osobject);
 
 	// Update the value if allowed
-	virtual CK_RV updateAttr(Token *token, bool isPrivate, CK_VOID_PTR pValue, CK_ULONG ulValueLen, int op);
+	virtual CK_RV updateAttr(OSObject* osobject, Token *token, bool isPrivate, CK_VOID_PTR pValue, CK_ULONG ulValueLen, int op);
 };
 
 /*****************************************
@@ -792,14 +789,14 @@ class P11AttrSensitive : public P11Attribute
 {
 public:
 	// Constructor
-	P11AttrSensitive(OSObject* inobject) : P11Attribute(inobject) { type = CKA_SENSITIVE; size = sizeof(CK_BBOOL); checks = ck8|ck9|ck11; }
+	P11AttrSensitive() : P11Attribute() { type = CKA_SENSITIVE; size = sizeof(CK_BBOOL); checks = ck8|ck9|ck11; }
 
 protected:
 	// Set the default value of the attribute
-	virtual bool setDefault();
+	virtual bool setDefault(OSObject* osobject);
 
 	// Update the value if allowed
-	virtual CK_RV updateAttr(Token *token, bool isPrivate, CK_VOID_PTR pValue, CK_ULONG ulValueLen, int op);
+	virtual CK_RV updateAttr(OSObject* osobject, Token *token, bool isPrivate, CK_VOID_PTR pValue, CK_ULONG ulValueLen, int op);
 };
 
 /*****************************************
@@ -810,14 +807,14 @@ class P11AttrExtractable : public P11Attribute
 {
 public:
 	// Constructor
-	P11AttrExtractable(OSObject* inobject) : P11Attribute(inobject) { type = CKA_EXTRACTABLE; size = sizeof(CK_BBOOL); checks = ck8|ck9|ck12; }
+	P11AttrExtractable() : P11Attribute() { type = CKA_EXTRACTABLE; size = sizeof(CK_BBOOL); checks = ck8|ck9|ck12; }
 
 protected:
 	// Set the default value of the attribute
-	virtual bool setDefault();
+	virtual bool setDefault(OSObject* osobject);
 
 	// Update the value if allowed
-	virtual CK_RV updateAttr(Token *token, bool isPrivate, CK_VOID_PTR pValue, CK_ULONG ulValueLen, int op);
+	virtual CK_RV updateAttr(OSObject* osobject, Token *token, bool isPrivate, CK_VOID_PTR pValue, CK_ULONG ulValueLen, int op);
 };
 
 /*****************************************
@@ -828,14 +825,14 @@ class P11AttrWrapWithTrusted : public P11Attribute
 {
 public:
 	// Constructor
-	P11AttrWrapWithTrusted(OSObject* inobject) : P11Attribute(inobject) { type = CKA_WRAP_WITH_TRUSTED; size = sizeof(CK_BBOOL); checks = ck11; }
+	P11AttrWrapWithTrusted() : P11Attribute() { type = CKA_WRAP_WITH_TRUSTED; size = sizeof(CK_BBOOL); checks = ck11; }
 
 protected:
 	// Set the default value of the attribute
-	virtual bool setDefault();
+	virtual bool setDefault(OSObject* osobject);
 
 	// Update the value if allowed
-	virtual CK_RV updateAttr(Token *token, bool isPrivate, CK_VOID_PTR pValue, CK_ULONG ulValueLen, int op);
+	virtual CK_RV updateAttr(OSObject* osobject, Token *token, bool isPrivate, CK_VOID_PTR pValue, CK_ULONG ulValueLen, int op);
 };
 
 /*****************************************
@@ -846,14 +843,14 @@ class P11AttrAlwaysAuthenticate : public P11Attribute
 {
 public:
 	// Constructor
-	P11AttrAlwaysAuthenticate(OSObject* inobject) : P11Attribute(inobject) { type = CKA_ALWAYS_AUTHENTICATE; size = sizeof(CK_BBOOL); checks = 0; }
+	P11AttrAlwaysAuthenticate() : P11Attribute() { type = CKA_ALWAYS_AUTHENTICATE; size = sizeof(CK_BBOOL); checks = 0; }
 
 protected:
 	// Set the default value of the attribute
-	virtual bool setDefault();
+	virtual bool setDefault(OSObject* osobject);
 
 	// Update the value if allowed
-	virtual CK_RV updateAttr(Token *token, bool isPrivate, CK_VOID_PTR pValue, CK_ULONG ulValueLen, int op);
+	virtual CK_RV updateAttr(OSObject* osobject, Token *token, bool isPrivate, CK_VOID_PTR pValue, CK_ULONG ulValueLen, int op);
 };
 
 /*****************************************
@@ -864,14 +861,14 @@ class P11AttrModulus : public P11Attribute
 {
 public:
 	// Constructor
-	P11AttrModulus(OSObject* inobject, CK_ULONG inchecks = 0) : P11Attribute(inobject) { type = CKA_MODULUS; checks = ck1|ck4|inchecks; }
+	P11AttrModulus(CK_ULONG inchecks = 0) : P11Attribute() { type = CKA_MODULUS; checks = ck1|ck4|inchecks; }
 
 protected:
 	// Set the default value of the attribute
-	virtual bool setDefault();
+	virtual bool setDefault(OSObject* osobject);
 
 	// Update the value if allowed
-	virtual CK_RV updateAttr(Token *token, bool isPrivate, CK_VOID_PTR pValue, CK_ULONG ulValueLen, int op);
+	virtual CK_RV updateAttr(OSObject* osobject, Token *token, bool isPrivate, CK_VOID_PTR pValue, CK_ULONG ulValueLen, int op);
 };
 
 /*****************************************
@@ -882,11 +879,11 @@ class P11AttrPublicExponent : public P11Attribute
 {
 public:
 	// Constructor
-	P11AttrPublicExponent(OSObject* inobject, CK_ULONG inchecks) : P11Attribute(inobject) { type = CKA_PUBLIC_EXPONENT; checks = inchecks; }
+	P11AttrPublicExponent(CK_ULONG inchecks) : P11Attribute() { type = CKA_PUBLIC_EXPONENT; checks = inchecks; }
 
 protected:
 	// Set the default value of the attribute
-	virtual bool setDefault();
+	virtual bool setDefault(OSObject* osobject);
 };
 
 /*****************************************
@@ -897,11 +894,11 @@ class P11AttrPrivateExponent : public P11Attribute
 {
 public:
 	// Constructor
-	P11AttrPrivateExponent(OSObject* inobject) : P11Attribute(inobject) { type = CKA_PRIVATE_EXPONENT; checks = ck1|ck4|ck6|ck7; }
+	P11AttrPrivateExponent() : P11Attribute() { type = CKA_PRIVATE_EXPONENT; checks = ck1|ck4|ck6|ck7; }
 
 protected:
 	// Set the default value of the attribute
-	virtual bool setDefault();
+	virtual bool setDefault(OSObject* osobject);
 };
 
 /*****************************************
@@ -912,11 +909,11 @@ class P11AttrPrime1 : public P11Attribute
 {
 public:
 	// Constructor
-	P11AttrPrime1(OSObject* inobject) : P11Attribute(inobject) { type = CKA_PRIME_1; checks = ck4|ck6|ck7; }
+	P11AttrPrime1() : P11Attribute() { type = CKA_PRIME_1; checks = ck4|ck6|ck7; }
 
 protected:
 	// Set the default value of the attribute
-	virtual bool setDefault();
+	virtual bool setDefault(OSObject* osobject);
 };
 
 /*****************************************
@@ -927,11 +924,11 @@ class P11AttrPrime2 : public P11Attribute
 {
 public:
 	// Constructor
-	P11AttrPrime2(OSObject* inobject) : P11Attribute(inobject) { type = CKA_PRIME_2; checks = ck4|ck6|ck7; }
+	P11AttrPrime2() : P11Attribute() { type = CKA_PRIME_2; checks = ck4|ck6|ck7; }
 
 protected:
 	// Set the default value of the attribute
-	virtual bool setDefault();
+	virtual bool setDefault(OSObject* osobject);
 };
 
 /*****************************************
@@ -942,11 +939,11 @@ class P11AttrExponent1 : public P11Attribute
 {
 public:
 	// Constructor
-	P11AttrExponent1(OSObject* inobject) : P11Attribute(inobject) { type = CKA_EXPONENT_1; checks = ck4|ck6|ck7; }
+	P11AttrExponent1() : P11Attribute() { type = CKA_EXPONENT_1; checks = ck4|ck6|ck7; }
 
 protected:
 	// Set the default value of the attribute
-	virtual bool setDefault();
+	virtual bool setDefault(OSObject* osobject);
 };
 
 /*****************************************
@@ -957,11 +954,11 @@ class P11AttrExponent2 : public P11Attribute
 {
 public:
 	// Constructor
-	P11AttrExponent2(OSObject* inobject) : P11Attribute(inobject) { type = CKA_EXPONENT_2; checks = ck4|ck6|ck7; }
+	P11AttrExponent2() : P11Attribute() { type = CKA_EXPONENT_2; checks = ck4|ck6|ck7; }
 
 protected:
 	// Set the default value of the attribute
-	virtual bool setDefault();
+	virtual bool setDefault(OSObject* osobject);
 };
 
 /*****************************************
@@ -972,11 +969,11 @@ class P11AttrCoefficient : public P11Attribute
 {
 public:
 	// Constructor
-	P11AttrCoefficient(OSObject* inobject) : P11Attribute(inobject) { type = CKA_COEFFICIENT; checks = ck4|ck6|ck7; }
+	P11AttrCoefficient() : P11Attribute() { type = CKA_COEFFICIENT; checks = ck4|ck6|ck7; }
 
 protected:
 	// Set the default value of the attribute
-	virtual bool setDefault();
+	virtual bool setDefault(OSObject* osobject);
 };
 
 /*****************************************
@@ -987,14 +984,14 @@ class P11AttrModulusBits : public P11Attribute
 {
 public:
 	// Constructor
-	P11AttrModulusBits(OSObject* inobject) : P11Attribute(inobject) { type = CKA_MODULUS_BITS; size = sizeof(CK_ULONG); checks = ck2|ck3;}
+	P11AttrModulusBits() : P11Attribute() { type = CKA_MODULUS_BITS; size = sizeof(CK_ULONG); checks = ck2|ck3;}
 
 protected:
 	// Set the default value of the attribute
-	virtual bool setDefault();
+	virtual bool setDefault(OSObject* osobject);
 
 	// Update the value if allowed
-	virtual CK_RV updateAttr(Token *token, bool isPrivate, CK_VOID_PTR pValue, CK_ULONG ulValueLen, int op);
+	virtual CK_RV updateAttr(OSObject* osobject, Token *token, bool isPrivate, CK_VOID_PTR pValue, CK_ULONG ulValueLen, int op);
 };
 
 /*****************************************
@@ -1005,14 +1002,14 @@ class P11AttrPrime : public P11Attribute
 {
 public:
 	// Constructor
-	P11AttrPrime(OSObject* inobject, CK_ULONG inchecks = 0) : P11Attribute(inobject) { type = CKA_PRIME; checks = ck1|inchecks; }
+	P11AttrPrime(CK_ULONG inchecks = 0) : P11Attribute() { type = CKA_PRIME; checks = ck1|inchecks; }
 
 protected:
 	// Set the default value of the attribute
-	virtual bool setDefault();
+	virtual bool setDefault(OSObject* osobject);
 
 	// Update the value if allowed
-	virtual CK_RV updateAttr(Token *token, bool isPrivate, CK_VOID_PTR pValue, CK_ULONG ulValueLen, int op);
+	virtual CK_RV updateAttr(OSObject* osobject, Token *token, bool isPrivate, CK_VOID_PTR pValue, CK_ULONG ulValueLen, int op);
 };
 
 /*****************************************
@@ -1023,11 +1020,11 @@ class P11AttrSubPrime : public P11Attribute
 {
 public:
 	// Constructor
-	P11AttrSubPrime(OSObject* inobject, CK_ULONG inchecks = 0) : P11Attribute(inobject) { type = CKA_SUBPRIME; checks = ck1|inchecks; }
+	P11AttrSubPrime(CK_ULONG inchecks = 0) : P11Attribute() { type = CKA_SUBPRIME; checks = ck1|inchecks; }
 
 protected:
 	// Set the default value of the attribute
-	virtual bool setDefault();
+	virtual bool setDefault(OSObject* osobject);
 };
 
 /*****************************************
@@ -1038,11 +1035,11 @@ class P11AttrBase : public P11Attribute
 {
 public:
 	// Constructor
-	P11AttrBase(OSObject* inobject, CK_ULONG inchecks = 0) : P11Attribute(inobject) { type = CKA_BASE; checks = ck1|inchecks; }
+	P11AttrBase(CK_ULONG inchecks = 0) : P11Attribute() { type = CKA_BASE; checks = ck1|inchecks; }
 
 protected:
 	// Set the default value of the attribute
-	virtual bool setDefault();
+	virtual bool setDefault(OSObject* osobject);
 };
 
 /*****************************************
@@ -1053,14 +1050,14 @@ class P11AttrPrimeBits : public P11Attribute
 {
 public:
 	// Constructor
-	P11AttrPrimeBits(OSObject* inobject) : P11Attribute(inobject) { type = CKA_PRIME_BITS; size = sizeof(CK_ULONG); checks = ck2|ck3;}
+	P11AttrPrimeBits() : P11Attribute() { type = CKA_PRIME_BITS; size = sizeof(CK_ULONG); checks = ck2|ck3;}
 
 protected:
 	// Set the default value of the attribute
-	virtual bool setDefault();
+	virtual bool setDefault(OSObject* osobject);
 
 	// Update the value if allowed
-	virtual CK_RV updateAttr(Token *token, bool isPrivate, CK_VOID_PTR pValue, CK_ULONG ulValueLen, int op);
+	virtual CK_RV updateAttr(OSObject* osobject, Token *token, bool isPrivate, CK_VOID_PTR pValue, CK_ULONG ulValueLen, int op);
 };
 
 /*****************************************
@@ -1071,14 +1068,14 @@ class P11AttrValueBits : public P11Attribute
 {
 public:
 	// Constructor
-	P11AttrValueBits(OSObject* inobject) : P11Attribute(inobject) { type = CKA_VALUE_BITS; size = sizeof(CK_ULONG); checks = ck2|ck6;}
+	P11AttrValueBits() : P11Attribute() { type = CKA_VALUE_BITS; size = sizeof(CK_ULONG); checks = ck2|ck6;}
 
 protected:
 	// Set the default value of the attribute
-	virtual bool setDefault();
+	virtual bool setDefault(OSObject* osobject);
 
 	// Update the value if allowed
-	virtual CK_RV updateAttr(Token *token, bool isPrivate, CK_VOID_PTR pValue, CK_ULONG ulValueLen, int op);
+	virtual CK_RV updateAttr(OSObject* osobject, Token *token, bool isPrivate, CK_VOID_PTR pValue, CK_ULONG ulValueLen, int op);
 };
 
 /*****************************************
@@ -1089,11 +1086,11 @@ class P11AttrEcParams : public P11Attribute
 {
 public:
 	// Constructor
-	P11AttrEcParams(OSObject* inobject, CK_ULONG inchecks = 0) : P11Attribute(inobject) { type = CKA_EC_PARAMS; checks = ck1|inchecks; }
+	P11AttrEcParams(CK_ULONG inchecks = 0) : P11Attribute() { type = CKA_EC_PARAMS; checks = ck1|inchecks; }
 
 protected:
 	// Set the default value of the attribute
-	virtual bool setDefault();
+	virtual bool setDefault(OSObject* osobject);
 };
 
 /*****************************************
@@ -1104,11 +1101,11 @@ class P11AttrEcPoint : public P11Attribute
 {
 public:
 	// Constructor
-	P11AttrEcPoint(OSObject* inobject) : P11Attribute(inobject) { type = CKA_EC_POINT; checks = ck1|ck4; }
+	P11AttrEcPoint() : P11Attribute() { type = CKA_EC_POINT; checks = ck1|ck4; }
 
 protected:
 	// Set the default value of the attribute
-	virtual bool setDefault();
+	virtual bool setDefault(OSObject* osobject);
 };
 
 /*****************************************
@@ -1119,11 +1116,11 @@ class P11AttrGostR3410Params : public P11Attribute
 {
 public:
 	// Constructor
-	P11AttrGostR3410Params(OSObject* inobject, CK_ULONG inchecks = 0) : P11Attribute(inobject) { type = CKA_GOSTR3410_PARAMS; checks = ck1|inchecks; }
+	P11AttrGostR3410Params(CK_ULONG inchecks = 0) : P11Attribute() { type = CKA_GOSTR3410_PARAMS; checks = ck1|inchecks; }
 
 protected:
 	// Set the default value of the attribute
-	virtual bool setDefault();
+	virtual bool setDefault(OSObject* osobject);
 };
 
 /*****************************************
@@ -1134,11 +1131,11 @@ class P11AttrGostR3411Params : public P11Attribute
 {
 public:
 	// Constructor
-	P11AttrGostR3411Params(OSObject* inobject, CK_ULONG inchecks = 0) : P11Attribute(inobject) { type = CKA_GOSTR3411_PARAMS; checks = ck1|ck8|inchecks; }
+	P11AttrGostR3411Params(CK_ULONG inchecks = 0) : P11Attribute() { type = CKA_GOSTR3411_PARAMS; checks = ck1|ck8|inchecks; }
 
 protected:
 	// Set the default value of the attribute
-	virtual bool setDefault();
+	virtual bool setDefault(OSObject* osobject);
 };
 
 /*****************************************
@@ -1149,11 +1146,11 @@ class P11AttrGost28147Params : public P11Attribute
 {
 public:
 	// Constructor
-	P11AttrGost28147Params(OSObject* inobject, CK_ULONG inchecks = 0) : P11Attribute(inobject) { type = CKA_GOST28147_PARAMS; checks = inchecks; }
+	P11AttrGost28147Params(CK_ULONG inchecks = 0) : P11Attribute() { type = CKA_GOST28147_PARAMS; checks = inchecks; }
 
 protected:
 	// Set the default value of the attribute
-	virtual bool setDefault();
+	virtual bool setDefault(OSObject* osobject);
 };
 
 /*****************************************
@@ -1164,14 +1161,14 @@ class P11AttrValueLen : public P11Attribute
 {
 public:
 	// Constructor
-	P11AttrValueLen(OSObject* inobject, CK_ULONG inchecks = 0) : P11Attribute(inobject) { type = CKA_VALUE_LEN; size = sizeof(CK_ULONG); checks = ck2|ck3|inchecks; }
+	P11AttrValueLen(CK_ULONG inchecks = 0) : P11Attribute() { type = CKA_VALUE_LEN; size = sizeof(CK_ULONG); checks = ck2|ck3|inchecks; }
 
 protected:
 	// Set the default value of the attribute
-	virtual bool setDefault();
+	virtual bool setDefault(OSObject* osobject);
 
 	// Update the value if allowed
-	virtual CK_RV updateAttr(Token *token, bool isPrivate, CK_VOID_PTR pValue, CK_ULONG ulValueLen, int op);
+	virtual CK_RV updateAttr(OSObject* osobject, Token *token, bool isPrivate, CK_VOID_PTR pValue, CK_ULONG ulValueLen, int op);
 };
 
 /*****************************************
@@ -1182,14 +1179,14 @@ class P11AttrWrapTemplate : public P11Attribute
 {
 public:
 	// Constructor
-	P11AttrWrapTemplate(OSObject* inobject) : P11Attribute(inobject) { type = CKA_WRAP_TEMPLATE; checks = 0; }
+	P11AttrWrapTemplate() : P11Attribute() { type = CKA_WRAP_TEMPLATE; checks = 0; }
 
 protected:
 	// Set the default value of the attribute
-	virtual bool setDefault();
+	virtual bool setDefault(OSObject* osobject);
 
 	// Update the value if allowed
-	virtual CK_RV updateAttr(Token *token, bool isPrivate, CK_VOID_PTR pValue, CK_ULONG ulValueLen, int op);
+	virtual CK_RV updateAttr(OSObject* osobject, Token *token, bool isPrivate, CK_VOID_PTR pValue, CK_ULONG ulValueLen, int op);
 };
 
 /*****************************************
@@ -1200,14 +1197,14 @@ class P11AttrUnwrapTemplate : public P11Attribute
 {
 public:
 	// Constructor
-	P11AttrUnwrapTemplate(OSObject* inobject) : P11Attribute(inobject) { type = CKA_UNWRAP_TEMPLATE; checks = 0; }
+	P11AttrUnwrapTemplate() : P11Attribute() { type = CKA_UNWRAP_TEMPLATE; checks = 0; }
 
 protected:
 	// Set the default value of the attribute
-	virtual bool setDefault();
+	virtual bool setDefault(OSObject* osobject);
 
 	// Update the value if allowed
-	virtual CK_RV updateAttr(Token *token, bool isPrivate, CK_VOID_PTR pValue, CK_ULONG ulValueLen, int op);
+	virtual CK_RV updateAttr(OSObject* osobject, Token *token, bool isPrivate, CK_VOID_PTR pValue, CK_ULONG ulValueLen, int op);
 };
 
 #endif // !_SOFTHSM_V2_P11ATTRIBUTES_H
@@ -35,32 +35,43 @@
 #include <stdio.h>
 #include <stdlib.h>
 
+// The attributes of all objects
+static P11AttrClass objectClass;
+static P11AttrToken objectToken;
+static P11AttrPrivate objectPrivate;
+static P11AttrModifiable objectModifiable;
+static P11AttrLabel objectLabel;
+static P11AttrCopyable objectCopyable;
+static P11Attribute* const objectAttributes[] =
+{
+	&objectClass,
+	&objectToken,
+	&objectPrivate,
+	&objectModifiable,
+	&objectLabel,
+	&objectCopyable
+};
+static const P11AttributeTable objectTable =
+{
+	NULL,
+	objectAttributes,
+	sizeof(objectAttributes) / sizeof(objectAttributes[0])
+};
+
 // Constructor
 P11Object::P11Object()
 {
 	initialized = false;
 	osobject = NULL;
+	attributes = &objectTable;
 }
 
 // Destructor
 P11Object::~P11Object()
 {
-	std::map<CK_ATTRIBUTE_TYPE, P11Attribute*> cleanUp = attributes;
-	attributes.clear();
-
-	for (std::map<CK_ATTRIBUTE_TYPE, P11Attribute*>::iterator i = cleanUp.begin(); i != cleanUp.end(); i++)
-	{
-		if (i->second == NULL)
-		{
-			continue;
-		}
-
-		delete i->second;
-		i->second = NULL;
-	}
 }
 
-// Add attributes
+// Initialize the attributes of the object
 bool P11Object::init(OSObject *inobject)
 {
 	if (initialized) return true;
@@ -68,47 +79,45 @@ bool P11Object::init(OSObject *inobject)
 
 	osobject = inobject;
 
-	// Create attributes
-	P11Attribute* attrClass = new P11AttrClass(osobject);
-	P11Attribute* attrToken = new P11AttrToken(osobject);
-	P11Attribute* attrPrivate = new P11AttrPrivate(osobject);
-	P11Attribute* attrModifiable = new P11AttrModifiable(osobject);
-	P11Attribute* attrLabel = new P11AttrLabel(osobject);
-	P11Attribute* attrCopyable = new P11AttrCopyable(osobject);
-
-	// Initialize the attributes
-	if
-	(
-		!attrClass->init() ||
-		!attrToken->init() ||
-		!attrPrivate->init() ||
-		!attrModifiable->init() ||
-		!attrLabel->init() ||
-		!attrCopyable->init()
-	)
+	// Set the default values of the attributes
+	if (!initAttributes(attributes))
 	{
 		ERROR_MSG("Could not initialize the attribute");
-		delete attrClass;
-		delete attrToken;
-		delete attrPrivate;
-		delete attrModifiable;
-		delete attrLabel;
-		delete attrCopyable;
 		return false;
 	}
 
-	// Add them to the map
-	attributes[attrClass->getType()] = attrClass;
-	attributes[attrToken->getType()] = attrToken;
-	attributes[attrPrivate->getType()] = attrPrivate;
-	attributes[attrModifiable->getType()] = attrModifiable;
-	attributes[attrLabel->getType()] = attrLabel;
-	attributes[attrCopyable->getType()] = attrCopyable;
-
 	initialized = true;
 	return true;
 }
 
+// Find the attribute in the tables of the class hierarchy
+P11Attribute* P11Object::getAttribute(CK_ATTRIBUTE_TYPE type)
+{
+	for (const P11AttributeTable* table = attributes; table != NULL; table = table->parent)
+	{
+		for (size_t i = 0; i < table->count; i++)
+		{
+			if (table->attributes[i]->getType() == type) return table->attributes[i];
+		}
+	}
+
+	return NULL;
+}
+
+// Set the default values of the attributes, starting with the parent table
+bool P11Object::initAttributes(const P11AttributeTable* table)
+{
+	if (table == NULL) return true;
+	if (!initAttributes(table->parent)) return false;
+
+	for (size_t i = 0; i < table->count; i++)
+	{
+		if (!table->attributes[i]->init(osobject)) return false;
+	}
+
+	return true;
+}
+
 CK_RV P11Object::loadTemplate(Token *token, CK_ATTRIBUTE_PTR pTemplate, CK_ULONG ulAttributeCount)
 {
 	bool isPrivate = this->isPrivate();
@@ -141,7 +150,7 @@ CK_RV P11Object::loadTemplate(Token *token, CK_ATTRIBUTE_PTR pTemplate, CK_ULONG
 	// If case 3 or 4 applies to all the requested attributes, then the call will return CKR_OK.
 	for (CK_ULONG i = 0; i < ulAttributeCount; ++i)
 	{
-		P11Attribute* attr = attributes[pTemplate[i].type];
+		P11Attribute* attr = getAttribute(pTemplate[i].type);
 
 		// case 2 of the attribute checks
 		if (attr == NULL) {
@@ -153,7 +162,7 @@ CK_RV P11Object::loadTemplate(Token *token, CK_ATTRIBUTE_PTR pTemplate, CK_ULONG
 		}
 
 		// case 1,3,4 and 5 of the attribute checks are done while retrieving the attribute itself.
-		CK_RV retrieve_rv = attr->retrieve(token, isPrivate, pTemplate[i].pValue, &pTemplate[i].ulValueLen);
+		CK_RV retrieve_rv = attr->retrieve(osobject, token, isPrivate, pTemplate[i].pValue, &pTemplate[i].ulValueLen);
 		if (retrieve_rv == CKR_ATTRIBUTE_SENSITIVE) {
 			// If case 1 applies to any of the requested attributes, then the call should
 			// return the value CKR_ATTRIBUTE_SENSITIVE.
@@ -208,7 +217,7 @@ CK_RV P11Object::saveTemplate(Token *token, bool isPrivate, CK_ATTRIBUTE_PTR pTe
 		//    should fail with the error code CKR_ATTRIBUTE_TYPE_INVALID. An attribute
 		//    is valid if it is either one of the attributes described in the Cryptoki specification or an
 		//    additional vendor-specific attribute supported by the library and token.
-		P11Attribute* attr = attributes[pTemplate[i].type];
+		P11Attribute* attr = getAttribute(pTemplate[i].type);
 
 		if (attr == NULL)
 		{
@@ -217,7 +226,7 @@ CK_RV P11Object::saveTemplate(Token *token, bool isPrivate, CK_ATTRIBUTE_PTR pTe
 		}
 
 		// Additonal checks are done while updating the attributes themselves.
-		CK_RV rv = attr->update(token,isPrivate, pTemplate[i].pValue, pTemplate[i].ulValueLen, op);
+		CK_RV rv = attr->update(osobject, token,isPrivate, pTemplate[i].pValue, pTemplate[i].ulValueLen, op);
 		if (rv != CKR_OK)
 		{
 			osobject->abortTransaction();
@@ -233,33 +242,39 @@ CK_RV P11Object::saveTemplate(Token *token, bool isPrivate, CK_ATTRIBUTE_PTR pTe
 
 	// All attributes that have to be specified are marked as such in the specification.
 	// The following checks are relevant here:
-	for (std::map<CK_ATTRIBUTE_TYPE, P11Attribute*>::iterator i = attributes.begin(); i != attributes.end(); i++)
+	for (const P11AttributeTable* table = attributes; table != NULL; table = table->parent)
 	{
-		CK_ULONG checks = i->second->getChecks();
-
-		//  ck1  Must be specified when object is created with C_CreateObject.
-		//  ck3  Must be specified when object is generated with C_GenerateKey or C_GenerateKeyPair.
-		//  ck5  Must be specified when object is unwrapped with C_UnwrapKey.
-		if (((checks & P11Attribute::ck1) == P11Attribute::ck1 && op == OBJECT_OP_CREATE) ||
-		    ((checks & P11Attribute::ck3) == P11Attribute::ck3 && op == OBJECT_OP_GENERATE) ||
-		    ((checks & P11Attribute::ck5) == P11Attribute::ck5 && op == OBJECT_OP_UNWRAP))
+		for (size_t i = 0; i < table->count; i++)
 		{
-			bool isSpecified = false;
+			P11Attribute* attr = table->attributes[i];
+			CK_ATTRIBUTE_TYPE type = attr->getType();
+
+			CK_ULONG checks = attr->getChecks();
 
-			for (CK_ULONG n = 0; n < ulAttributeCount; n++)
+			//  ck1  Must be specified when object is created with C_CreateObject.
+			//  ck3  Must be specified when object is generated with C_GenerateKey or C_GenerateKeyPair.
+			//  ck5  Must be specified when object is unwrapped with C_UnwrapKey.
+			if (((checks & P11Attribute::ck1) == P11Attribute::ck1 && op == OBJECT_OP_CREATE) ||
+			    ((checks & P11Attribute::ck3) == P11Attribute::ck3 && op == OBJECT_OP_GENERATE) ||
+			    ((checks & P11Attribute::ck5) == P11Attribute::ck5 && op == OBJECT_OP_UNWRAP))
 			{
-				if (i->first == pTemplate[n].type)
+				bool isSpecified = false;
+
+				for (CK_ULONG n = 0; n < ulAttributeCount; n++)
 				{
-					isSpecified = true;
-					break;
+					if (type == pTemplate[n].type)
+					{
+						isSpecified = true;
+						break;
+					}
 				}
-			}
 
-			if (!isSpecified)
-			{
-				ERROR_MSG("Mandatory attribute (0x%08X) was not specified in template", (unsigned int)i->first);
+				if (!isSpecified)
+				{
+					ERROR_MSG("Mandatory attribute (0x%08X) was not specified in template", (unsigned int)type);
 
-				return CKR_TEMPLATE_INCOMPLETE;
+					return CKR_TEMPLATE_INCOMPLETE;
+				}
 			}
 		}
 	}
@@ -314,13 +329,35 @@ bool P11Object::isModifiable()
 	return osobject->getBooleanValue(CKA_MODIFIABLE, true);
 }
 
+// The attributes of P11DataObj
+static P11AttrApplication dataApplication;
+static P11AttrObjectID dataObjectID;
+// NOTE: There is no mention in the PKCS#11 v2.3 spec that for a Data
+//  Object the CKA_VALUE attribute may be modified after creation !
+//  Therefore we assume it is not allowed to change the CKA_VALUE
+//  attribute of a Data Object.
+static P11AttrValue dataValue(0);
+static P11Attribute* const dataAttributes[] =
+{
+	&dataApplication,
+	&dataObjectID,
+	&dataValue
+};
+static const P11AttributeTable dataTable =
+{
+	&objectTable,
+	dataAttributes,
+	sizeof(dataAttributes) / sizeof(dataAttributes[0])
+};
+
 // Constructor
 P11DataObj::P11DataObj()
 {
 	initialized = false;
+	attributes = &dataTable;
 }
 
-// Add attributes
+// Initialize the attributes of the object
 bool P11DataObj::init(OSObject *inobject)
 {
 	if (initialized) return true;
@@ -335,46 +372,45 @@ bool P11DataObj::init(OSObject *inobject)
 	// Create parent
 	if (!P11Object::init(inobject)) return false;
 
-	// Create attributes
-	P11Attribute* attrApplication = new P11AttrApplication(osobject);
-	P11Attribute* attrObjectID = new P11AttrObjectID(osobject);
-	// NOTE: There is no mention in the PKCS#11 v2.3 spec that for a Data
-	//  Object the CKA_VALUE attribute may be modified after creation !
-	//  Therefore we assume it is not allowed to change the CKA_VALUE
-	//  attribute of a Data Object.
-	P11Attribute* attrValue = new P11AttrValue(osobject,0);
-
-	// Initialize the attributes
-	if
-	(
-		!attrApplication->init() ||
-		!attrObjectID->init() ||
-		!attrValue->init()
-	)
-	{
-		ERROR_MSG("Could not initialize the attribute");
-		delete attrApplication;
-		delete attrObjectID;
-		delete attrValue;
-		return false;
-	}
-
-	// Add them to the map
-	attributes[attrApplication->getType()] = attrApplication;
-	attributes[attrObjectID->getType()] = attrObjectID;
-	attributes[attrValue->getType()] = attrValue;
-
 	initialized = true;
 	return true;
 }
 
+// The attributes of P11CertificateObj
+static P11AttrCertificateType certificateCertificateType;
+static P11AttrTrusted certificateTrusted;
+static P11AttrCertificateCategory certificateCertificateCategory;
+// NOTE: Because these attributes are used in a certificate object
+//  where the CKA_VALUE containing the certificate data is not
+//  modifiable, we assume that this attribute is also not modifiable.
+//  There is also no explicit mention of these attributes being modifiable.
+static P11AttrCheckValue certificateCheckValue(0);
+static P11AttrStartDate certificateStartDate(0);
+static P11AttrEndDate certificateEndDate(0);
+static P11Attribute* const certificateAttributes[] =
+{
+	&certificateCertificateType,
+	&certificateTrusted,
+	&certificateCertificateCategory,
+	&certificateCheckValue,
+	&certificateStartDate,
+	&certificateEndDate
+};
+static const P11AttributeTable certificateTable =
+{
+	&objectTable,
+	certificateAttributes,
+	sizeof(certificateAttributes) / sizeof(certificateAttributes[0])
+};
+
 // Constructor
 P11CertificateObj::P11CertificateObj()
 {
 	initialized = false;
+	attributes = &certificateTable;
 }
 
-// Add attributes
+// Initialize the attributes of the object
 bool P11CertificateObj::init(OSObject *inobject)
 {
 	if (initialized) return true;
@@ -389,58 +425,49 @@ bool P11CertificateObj::init(OSObject *inobject)
 	// Create parent
 	if (!P11Object::init(inobject)) return false;
 
-	// Create attributes
-	P11Attribute* attrCertificateType = new P11AttrCertificateType(osobject);
-	P11Attribute* attrTrusted = new P11AttrTrusted(osobject);
-	P11Attribute* attrCertificateCategory = new P11AttrCertificateCategory(osobject);
-	// NOTE: Because these attributes are used in a certificate object
-	//  where the CKA_VALUE containing the certificate data is not
-	//  modifiable, we assume that this attribute is also not modifiable.
-	//  There is also no explicit mention of these attributes being modifiable.
-	P11Attribute* attrCheckValue = new P11AttrCheckValue(osobject, 0);
-	P11Attribute* attrStartDate = new P11AttrStartDate(osobject,0);
-	P11Attribute* attrEndDate = new P11AttrEndDate(osobject,0);
-
-	// Initialize the attributes
-	if
-	(
-		!attrCertificateType->init() ||
-		!attrTrusted->init() ||
-		!attrCertificateCategory->init() ||
-		!attrCheckValue->init() ||
-		!attrStartDate->init() ||
-		!attrEndDate->init()
-	)
-	{
-		ERROR_MSG("Could not initialize the attribute");
-		delete attrCertificateType;
-		delete attrTrusted;
-		delete attrCertificateCategory;
-		delete attrCheckValue;
-		delete attrStartDate;
-		delete attrEndDate;
-		return false;
-	}
-
-	// Add them to the map
-	attributes[attrCertificateType->getType()] = attrCertificateType;
-	attributes[attrTrusted->getType()] = attrTrusted;
-	attributes[attrCertificateCategory->getType()] = attrCertificateCategory;
-	attributes[attrCheckValue->getType()] = attrCheckValue;
-	attributes[attrStartDate->getType()] = attrStartDate;
-	attributes[attrEndDate->getType()] = attrEndDate;
-
 	initialized = true;
 	return true;
 }
 
+// The attributes of P11X509CertificateObj
+static P11AttrSubject x509CertificateSubject(P11Attribute::ck1);
+static P11AttrID x509CertificateID;
+static P11AttrIssuer x509CertificateIssuer;
+static P11AttrSerialNumber x509CertificateSerialNumber;
+static P11AttrValue x509CertificateValue(P11Attribute::ck1|P11Attribute::ck14);
+static P11AttrURL x509CertificateURL;
+static P11AttrHashOfSubjectPublicKey x509CertificateHashOfSubjectPublicKey;
+static P11AttrHashOfIssuerPublicKey x509CertificateHashOfIssuerPublicKey;
+static P11AttrJavaMidpSecurityDomain x509CertificateJavaMidpSecurityDomain;
+static P11AttrNameHashAlgorithm x509CertificateNameHashAlgorithm;
+static P11Attribute* const x509CertificateAttributes[] =
+{
+	&x509CertificateSubject,
+	&x509CertificateID,
+	&x509CertificateIssuer,
+	&x509CertificateSerialNumber,
+	&x509CertificateValue,
+	&x509CertificateURL,
+	&x509CertificateHashOfSubjectPublicKey,
+	&x509CertificateHashOfIssuerPublicKey,
+	&x509CertificateJavaMidpSecurityDomain,
+	&x509CertificateNameHashAlgorithm
+};
+static const P11AttributeTable x509CertificateTable =
+{
+	&certificateTable,
+	x509CertificateAttributes,
+	sizeof(x509CertificateAttributes) / sizeof(x509CertificateAttributes[0])
+};
+
 // Constructor
 P11X509CertificateObj::P11X509CertificateObj()
 {
 	initialized = false;
+	attributes = &x509CertificateTable;
 }
 
-// Add attributes
+// Initialize the attributes of the object
 bool P11X509CertificateObj::init(OSObject *inobject)
 {
 	if (initialized) return true;
@@ -455,69 +482,40 @@ bool P11X509CertificateObj::init(OSObject *inobject)
 	// Create parent
 	if (!P11CertificateObj::init(inobject)) return false;
 
-	// Create attributes
-	P11Attribute* attrSubject = new P11AttrSubject(osobject,P11Attribute::ck1);
-	P11Attribute* attrID = new P11AttrID(osobject);
-	P11Attribute* attrIssuer = new P11AttrIssuer(osobject);
-	P11Attribute* attrSerialNumber = new P11AttrSerialNumber(osobject);
-	P11Attribute* attrValue = new P11AttrValue(osobject,P11Attribute::ck1|P11Attribute::ck14);
-	P11Attribute* attrURL = new P11AttrURL(osobject);
-	P11Attribute* attrHashOfSubjectPublicKey = new P11AttrHashOfSubjectPublicKey(osobject);
-	P11Attribute* attrHashOfIssuerPublicKey = new P11AttrHashOfIssuerPublicKey(osobject);
-	P11Attribute* attrJavaMidpSecurityDomain = new P11AttrJavaMidpSecurityDomain(osobject);
-	P11Attribute* attrNameHashAlgorithm = new P11AttrNameHashAlgorithm(osobject);
-
-	// Initialize the attributes
-	if
-	(
-		!attrSubject->init() ||
-		!attrID->init() ||
-		!attrIssuer->init() ||
-		!attrSerialNumber->init() ||
-		!attrValue->init() ||
-		!attrURL->init() ||
-		!attrHashOfSubjectPublicKey->init() ||
-		!attrHashOfIssuerPublicKey->init() ||
-		!attrJavaMidpSecurityDomain->init() ||
-		!attrNameHashAlgorithm->init()
-	)
-	{
-		ERROR_MSG("Could not initialize the attribute");
-		delete attrSubject;
-		delete attrID;
-		delete attrIssuer;
-		delete attrSerialNumber;
-		delete attrValue;
-		delete attrURL;
-		delete attrHashOfSubjectPublicKey;
-		delete attrHashOfIssuerPublicKey;
-		delete attrJavaMidpSecurityDomain;
-		delete attrNameHashAlgorithm;
-		return false;
-	}
-
-	// Add them to the map
-	attributes[attrSubject->getType()] = attrSubject;
-	attributes[attrID->getType()] = attrID;
-	attributes[attrIssuer->getType()] = attrIssuer;
-	attributes[attrSerialNumber->getType()] = attrSerialNumber;
-	attributes[attrValue->getType()] = attrValue;
-	attributes[attrURL->getType()] = attrURL;
-	attributes[attrHashOfSubjectPublicKey->getType()] = attrHashOfSubjectPublicKey;
-	attributes[attrHashOfIssuerPublicKey->getType()] = attrHashOfIssuerPublicKey;
-	attributes[attrJavaMidpSecurityDomain->getType()] = attrJavaMidpSecurityDomain;
-	attributes[attrNameHashAlgorithm->getType()] = attrNameHashAlgorithm;
-
 	return true;
 }
 
+// The attributes of P11OpenPGPPublicKeyObj
+static P11AttrSubject openPGPPublicKeySubject(P11Attribute::ck1);
+static P11AttrID openPGPPublicKeyID;
+static P11AttrIssuer openPGPPublicKeyIssuer;
+static P11AttrSerialNumber openPGPPublicKeySerialNumber;
+static P11AttrValue openPGPPublicKeyValue(P11Attribute::ck1|P11Attribute::ck14);
+static P11AttrURL openPGPPublicKeyURL;
+static P11Attribute* const openPGPPublicKeyAttributes[] =
+{
+	&openPGPPublicKeySubject,
+	&openPGPPublicKeyID,
+	&openPGPPublicKeyIssuer,
+	&openPGPPublicKeySerialNumber,
+	&openPGPPublicKeyValue,
+	&openPGPPublicKeyURL
+};
+static const P11AttributeTable openPGPPublicKeyTable =
+{
+	&certificateTable,
+	openPGPPublicKeyAttributes,
+	sizeof(openPGPPublicKeyAttributes) / sizeof(openPGPPublicKeyAttributes[0])
+};
+
 // Constructor
 P11OpenPGPPublicKeyObj::P11OpenPGPPublicKeyObj()
 {
 	initialized = false;
+	attributes = &openPGPPublicKeyTable;
 }
 
-// Add attributes
+// Initialize the attributes of the object
 bool P11OpenPGPPublicKeyObj::init(OSObject *inobject)
 {
 	if (initialized) return true;
@@ -532,53 +530,42 @@ bool P11OpenPGPPublicKeyObj::init(OSObject *inobject)
 	// Create parent
 	if (!P11CertificateObj::init(inobject)) return false;
 
-	// Create attributes
-	P11Attribute* attrSubject = new P11AttrSubject(osobject,P11Attribute::ck1);
-	P11Attribute* attrID = new P11AttrID(osobject);
-	P11Attribute* attrIssuer = new P11AttrIssuer(osobject);
-	P11Attribute* attrSerialNumber = new P11AttrSerialNumber(osobject);
-	P11Attribute* attrValue = new P11AttrValue(osobject,P11Attribute::ck1|P11Attribute::ck14);
-	P11Attribute* attrURL = new P11AttrURL(osobject);
-
-	// Initialize the attributes
-	if
-	(
-		!attrSubject->init() ||
-		!attrID->init() ||
-		!attrIssuer->init() ||
-		!attrSerialNumber->init() ||
-		!attrValue->init() ||
-		!attrURL->init()
-	)
-	{
-		ERROR_MSG("Could not initialize the attribute");
-		delete attrSubject;
-		delete attrID;
-		delete attrIssuer;
-		delete attrSerialNumber;
-		delete attrValue;
-		delete attrURL;
-		return false;
-	}
-
-	// Add them to the map
-	attributes[attrSubject->getType()] = attrSubject;
-	attributes[attrID->getType()] = attrID;
-	attributes[attrIssuer->getType()] = attrIssuer;
-	attributes[attrSerialNumber->getType()] = attrSerialNumber;
-	attributes[attrValue->getType()] = attrValue;
-	attributes[attrURL->getType()] = attrURL;
-
 	return true;
 }
 
+// The attributes of P11KeyObj
+static P11AttrKeyType keyKeyType(P11Attribute::ck5);
+static P11AttrID keyID;
+static P11AttrStartDate keyStartDate(P11Attribute::ck8);
+static P11AttrEndDate keyEndDate(P11Attribute::ck8);
+static P11AttrDerive keyDerive;
+static P11AttrLocal keyLocal(P11Attribute::ck6);
+static P11AttrKeyGenMechanism keyKeyGenMechanism;
+static P11Attribute* const keyAttributes[] =
+{
+	&keyKeyType,
+	&keyID,
+	&keyStartDate,
+	&keyEndDate,
+	&keyDerive,
+	&keyLocal,
+	&keyKeyGenMechanism
+};
+static const P11AttributeTable keyTable =
+{
+	&objectTable,
+	keyAttributes,
+	sizeof(keyAttributes) / sizeof(keyAttributes[0])
+};
+
 // Constructor
 P11KeyObj::P11KeyObj()
 {
 	initialized = false;
+	attributes = &keyTable;
 }
 
-// Add attributes
+// Initialize the attributes of the object
 bool P11KeyObj::init(OSObject *inobject)
 {
 	if (initialized) return true;
@@ -587,59 +574,43 @@ bool P11KeyObj::init(OSObject *inobject)
 	// Create parent
 	if (!P11Object::init(inobject)) return false;
 
-	// Create attributes
-	P11Attribute* attrKeyType = new P11AttrKeyType(osobject,P11Attribute::ck5);
-	P11Attribute* attrID = new P11AttrID(osobject);
-	P11Attribute* attrStartDate = new P11AttrStartDate(osobject,P11Attribute::ck8);
-	P11Attribute* attrEndDate = new P11AttrEndDate(osobject,P11Attribute::ck8);
-	P11Attribute* attrDerive = new P11AttrDerive(osobject);
-	P11Attribute* attrLocal = new P11AttrLocal(osobject,P11Attribute::ck6);
-	P11Attribute* attrKeyGenMechanism = new P11AttrKeyGenMechanism(osobject);
-	// TODO: CKA_ALLOWED_MECHANISMS is not supported
-
-	// Initialize the attributes
-	if
-	(
-		!attrKeyType->init() ||
-		!attrID->init() ||
-		!attrStartDate->init() ||
-		!attrEndDate->init() ||
-		!attrDerive->init() ||
-		!attrLocal->init() ||
-		!attrKeyGenMechanism->init()
-	)
-	{
-		ERROR_MSG("Could not initialize the attribute");
-		delete attrKeyType;
-		delete attrID;
-		delete attrStartDate;
-		delete attrEndDate;
-		delete attrDerive;
-		delete attrLocal;
-		delete attrKeyGenMechanism;
-		return false;
-	}
-
-	// Add them to the map
-	attributes[attrKeyType->getType()] = attrKeyType;
-	attributes[attrID->getType()] = attrID;
-	attributes[attrStartDate->getType()] = attrStartDate;
-	attributes[attrEndDate->getType()] = attrEndDate;
-	attributes[attrDerive->getType()] = attrDerive;
-	attributes[attrLocal->getType()] = attrLocal;
-	attributes[attrKeyGenMechanism->getType()] = attrKeyGenMechanism;
-
 	initialized = true;
 	return true;
 }
 
+// The attributes of P11PublicKeyObj
+static P11AttrSubject publicKeySubject(P11Attribute::ck8);
+static P11AttrEncrypt publicKeyEncrypt;
+static P11AttrVerify publicKeyVerify;
+static P11AttrVerifyRecover publicKeyVerifyRecover;
+static P11AttrWrap publicKeyWrap;
+static P11AttrTrusted publicKeyTrusted;
+static P11AttrWrapTemplate publicKeyWrapTemplate;
+static P11Attribute* const publicKeyAttributes[] =
+{
+	&publicKeySubject,
+	&publicKeyEncrypt,
+	&publicKeyVerify,
+	&publicKeyVerifyRecover,
+	&publicKeyWrap,
+	&publicKeyTrusted,
+	&publicKeyWrapTemplate
+};
+static const P11AttributeTable publicKeyTable =
+{
+	&keyTable,
+	publicKeyAttributes,
+	sizeof(publicKeyAttributes) / sizeof(publicKeyAttributes[0])
+};
+
 // Constructor
 P11PublicKeyObj::P11PublicKeyObj()
 {
 	initialized = false;
+	attributes = &publicKeyTable;
 }
 
-// Add attributes
+// Initialize the attributes of the object
 bool P11PublicKeyObj::init(OSObject *inobject)
 {
 	if (initialized) return true;
@@ -655,58 +626,35 @@ bool P11PublicKeyObj::init(OSObject *inobject)
 
 	if (initialized) return true;
 
-	// Create attributes
-	P11Attribute* attrSubject = new P11AttrSubject(osobject,P11Attribute::ck8);
-	P11Attribute* attrEncrypt = new P11AttrEncrypt(osobject);
-	P11Attribute* attrVerify = new P11AttrVerify(osobject);
-	P11Attribute* attrVerifyRecover = new P11AttrVerifyRecover(osobject);
-	P11Attribute* attrWrap = new P11AttrWrap(osobject);
-	P11Attribute* attrTrusted = new P11AttrTrusted(osobject);
-	P11Attribute* attrWrapTemplate = new P11AttrWrapTemplate(osobject);
-
-	// Initialize the attributes
-	if
-	(
-		!attrSubject->init() ||
-		!attrEncrypt->init() ||
-		!attrVerify->init() ||
-		!attrVerifyRecover->init() ||
-		!attrWrap->init() ||
-		!attrTrusted->init() ||
-		!attrWrapTemplate->init()
-	)
-	{
-		ERROR_MSG("Could not initialize the attribute");
-		delete attrSubject;
-		delete attrEncrypt;
-		delete attrVerify;
-		delete attrVerifyRecover;
-		delete attrWrap;
-		delete attrTrusted;
-		delete attrWrapTemplate;
-		return false;
-	}
-
-	// Add them to the map
-	attributes[attrSubject->getType()] = attrSubject;
-	attributes[attrEncrypt->getType()] = attrEncrypt;
-	attributes[attrVerify->getType()] = attrVerify;
-	attributes[attrVerifyRecover->getType()] = attrVerifyRecover;
-	attributes[attrWrap->getType()] = attrWrap;
-	attributes[attrTrusted->getType()] = attrTrusted;
-	attributes[attrWrapTemplate->getType()] = attrWrapTemplate;
-
 	initialized = true;
 	return true;
 }
 
+// The attributes of P11RSAPublicKeyObj
+static P11AttrModulus rsaPublicKeyModulus;
+static P11AttrModulusBits rsaPublicKeyModulusBits;
+static P11AttrPublicExponent rsaPublicKeyPublicExponent(P11Attribute::ck1);
+static P11Attribute* const rsaPublicKeyAttributes[] =
+{
+	&rsaPublicKeyModulus,
+	&rsaPublicKeyModulusBits,
+	&rsaPublicKeyPublicExponent
+};
+static const P11AttributeTable rsaPublicKeyTable =
+{
+	&publicKeyTable,
+	rsaPublicKeyAttributes,
+	sizeof(rsaPublicKeyAttributes) / sizeof(rsaPublicKeyAttributes[0])
+};
+
 // Constructor
 P11RSAPublicKeyObj::P11RSAPublicKeyObj()
 {
 	initialized = false;
+	attributes = &rsaPublicKeyTable;
 }
 
-// Add attributes
+// Initialize the attributes of the object
 bool P11RSAPublicKeyObj::init(OSObject *inobject)
 {
 	if (initialized) return true;
@@ -720,42 +668,37 @@ bool P11RSAPublicKeyObj::init(OSObject *inobject)
 	// Create parent
 	if (!P11PublicKeyObj::init(inobject)) return false;
 
-	// Create attributes
-	P11Attribute* attrModulus = new P11AttrModulus(osobject);
-	P11Attribute* attrModulusBits = new P11AttrModulusBits(osobject);
-	P11Attribute* attrPublicExponent = new P11AttrPublicExponent(osobject,P11Attribute::ck1);
-
-	// Initialize the attributes
-	if
-	(
-		!attrModulus->init() ||
-		!attrModulusBits->init() ||
-		!attrPublicExponent->init()
-	)
-	{
-		ERROR_MSG("Could not initialize the attribute");
-		delete attrModulus;
-		delete attrModulusBits;
-		delete attrPublicExponent;
-		return false;
-	}
-
-	// Add them to the map
-	attributes[attrModulus->getType()] = attrModulus;
-	attributes[attrModulusBits->getType()] = attrModulusBits;
-	attributes[attrPublicExponent->getType()] = attrPublicExponent;
-
 	initialized = true;
 	return true;
 }
 
+// The attributes of P11DSAPublicKeyObj
+static P11AttrPrime dsaPublicKeyPrime(P11Attribute::ck3);
+static P11AttrSubPrime dsaPublicKeySubPrime(P11Attribute::ck3);
+static P11AttrBase dsaPublicKeyBase(P11Attribute::ck3);
+static P11AttrValue dsaPublicKeyValue(P11Attribute::ck1|P11Attribute::ck4);
+static P11Attribute* const dsaPublicKeyAttributes[] =
+{
+	&dsaPublicKeyPrime,
+	&dsaPublicKeySubPrime,
+	&dsaPublicKeyBase,
+	&dsaPublicKeyValue
+};
+static const P11AttributeTable dsaPublicKeyTable =
+{
+	&publicKeyTable,
+	dsaPublicKeyAttributes,
+	sizeof(dsaPublicKeyAttributes) / sizeof(dsaPublicKeyAttributes[0])
+};
+
 // Constructor
 P11DSAPublicKeyObj::P11DSAPublicKeyObj()
 {
 	initialized = false;
+	attributes = &dsaPublicKeyTable;
 }
 
-// Add attributes
+// Initialize the attributes of the object
 bool P11DSAPublicKeyObj::init(OSObject *inobject)
 {
 	if (initialized) return true;
@@ -769,46 +712,33 @@ bool P11DSAPublicKeyObj::init(OSObject *inobject)
 	// Create parent
 	if (!P11PublicKeyObj::init(inobject)) return false;
 
-	// Create attributes
-	P11Attribute* attrPrime = new P11AttrPrime(osobject,P11Attribute::ck3);
-	P11Attribute* attrSubPrime = new P11AttrSubPrime(osobject,P11Attribute::ck3);
-	P11Attribute* attrBase = new P11AttrBase(osobject,P11Attribute::ck3);
-	P11Attribute* attrValue = new P11AttrValue(osobject,P11Attribute::ck1|P11Attribute::ck4);
-
-	// Initialize the attributes
-	if
-	(
-		!attrPrime->init() ||
-		!attrSubPrime->init() ||
-		!attrBase->init() ||
-		!attrValue->init()
-	)
-	{
-		ERROR_MSG("Could not initialize the attribute");
-		delete attrPrime;
-		delete attrSubPrime;
-		delete attrBase;
-		delete attrValue;
-		return false;
-	}
-
-	// Add them to the map
-	attributes[attrPrime->getType()] = attrPrime;
-	attributes[attrSubPrime->getType()] = attrSubPrime;
-	attributes[attrBase->getType()] = attrBase;
-	attributes[attrValue->getType()] = attrValue;
-
 	initialized = true;
 	return true;
 }
 
+// The attributes of P11ECPublicKeyObj
+static P11AttrEcParams ecPublicKeyEcParams(P11Attribute::ck3);
+static P11AttrEcPoint ecPublicKeyEcPoint;
+static P11Attribute* const ecPublicKeyAttributes[] =
+{
+	&ecPublicKeyEcParams,
+	&ecPublicKeyEcPoint
+};
+static const P11AttributeTable ecPublicKeyTable =
+{
+	&publicKeyTable,
+	ecPublicKeyAttributes,
+	sizeof(ecPublicKeyAttributes) / sizeof(ecPublicKeyAttributes[0])
+};
+
 // Constructor
 P11ECPublicKeyObj::P11ECPublicKeyObj()
 {
 	initialized = false;
+	attributes = &ecPublicKeyTable;
 }
 
-// Add attributes
+// Initialize the attributes of the object
 bool P11ECPublicKeyObj::init(OSObject *inobject)
 {
 	if (initialized) return true;
@@ -822,38 +752,35 @@ bool P11ECPublicKeyObj::init(OSObject *inobject)
 	// Create parent
 	if (!P11PublicKeyObj::init(inobject)) return false;
 
-	// Create attributes
-	P11Attribute* attrEcParams = new P11AttrEcParams(osobject,P11Attribute::ck3);
-	P11Attribute* attrEcPoint = new P11AttrEcPoint(osobject);
-
-	// Initialize the attributes
-	if
-	(
-		!attrEcParams->init() ||
-		!attrEcPoint->init()
-	)
-	{
-		ERROR_MSG("Could not initialize the attribute");
-		delete attrEcParams;
-		delete attrEcPoint;
-		return false;
-	}
-
-	// Add them to the map
-	attributes[attrEcParams->getType()] = attrEcParams;
-	attributes[attrEcPoint->getType()] = attrEcPoint;
-
 	initialized = true;
 	return true;
 }
 
+// The attributes of P11DHPublicKeyObj
+static P11AttrPrime dhPublicKeyPrime(P11Attribute::ck3);
+static P11AttrBase dhPublicKeyBase(P11Attribute::ck3);
+static P11AttrValue dhPublicKeyValue(P11Attribute::ck1|P11Attribute::ck4);
+static P11Attribute* const dhPublicKeyAttributes[] =
+{
+	&dhPublicKeyPrime,
+	&dhPublicKeyBase,
+	&dhPublicKeyValue
+};
+static const P11AttributeTable dhPublicKeyTable =
+{
+	&publicKeyTable,
+	dhPublicKeyAttributes,
+	sizeof(dhPublicKeyAttributes) / sizeof(dhPublicKeyAttributes[0])
+};
+
 // Constructor
 P11DHPublicKeyObj::P11DHPublicKeyObj()
 {
 	initialized = false;
+	attributes = &dhPublicKeyTable;
 }
 
-// Add attributes
+// Initialize the attributes of the object
 bool P11DHPublicKeyObj::init(OSObject *inobject)
 {
 	if (initialized) return true;
@@ -867,42 +794,37 @@ bool P11DHPublicKeyObj::init(OSObject *inobject)
 	// Create parent
 	if (!P11PublicKeyObj::init(inobject)) return false;
 
-	// Create attributes
-	P11Attribute* attrPrime = new P11AttrPrime(osobject,P11Attribute::ck3);
-	P11Attribute* attrBase = new P11AttrBase(osobject,P11Attribute::ck3);
-	P11Attribute* attrValue = new P11AttrValue(osobject,P11Attribute::ck1|P11Attribute::ck4);
-
-	// Initialize the attributes
-	if
-	(
-		!attrPrime->init() ||
-		!attrBase->init() ||
-		!attrValue->init()
-	)
-	{
-		ERROR_MSG("Could not initialize the attribute");
-		delete attrPrime;
-		delete attrBase;
-		delete attrValue;
-		return false;
-	}
-
-	// Add them to the map
-	attributes[attrPrime->getType()] = attrPrime;
-	attributes[attrBase->getType()] = attrBase;
-	attributes[attrValue->getType()] = attrValue;
-
 	initialized = true;
 	return true;
 }
 
+// The attributes of P11GOSTPublicKeyObj
+static P11AttrValue gostPublicKeyValue(P11Attribute::ck1|P11Attribute::ck4);
+static P11AttrGostR3410Params gostPublicKeyGostR3410Params(P11Attribute::ck3);
+static P11AttrGostR3411Params gostPublicKeyGostR3411Params(P11Attribute::ck3);
+static P11AttrGost28147Params gostPublicKeyGost28147Params(P11Attribute::ck8);
+static P11Attribute* const gostPublicKeyAttributes[] =
+{
+	&gostPublicKeyValue,
+	&gostPublicKeyGostR3410Params,
+	&gostPublicKeyGostR3411Params,
+	&gostPublicKeyGost28147Params
+};
+static const P11AttributeTable gostPublicKeyTable =
+{
+	&publicKeyTable,
+	gostPublicKeyAttributes,
+	sizeof(gostPublicKeyAttributes) / sizeof(gostPublicKeyAttributes[0])
+};
+
 // Constructor
 P11GOSTPublicKeyObj::P11GOSTPublicKeyObj()
 {
 	initialized = false;
+	attributes = &gostPublicKeyTable;
 }
 
-// Add attributes
+// Initialize the attributes of the object
 bool P11GOSTPublicKeyObj::init(OSObject *inobject)
 {
 	if (initialized) return true;
@@ -916,46 +838,54 @@ bool P11GOSTPublicKeyObj::init(OSObject *inobject)
 	// Create parent
 	if (!P11PublicKeyObj::init(inobject)) return false;
 
-	// Create attributes
-	P11Attribute* attrValue = new P11AttrValue(osobject,P11Attribute::ck1|P11Attribute::ck4);
-	P11Attribute* attrGostR3410Params = new P11AttrGostR3410Params(osobject,P11Attribute::ck3);
-	P11Attribute* attrGostR3411Params = new P11AttrGostR3411Params(osobject,P11Attribute::ck3);
-	P11Attribute* attrGost28147Params = new P11AttrGost28147Params(osobject,P11Attribute::ck8);
-
-	// Initialize the attributes
-	if
-	(
-		!attrValue->init() ||
-		!attrGostR3410Params->init() ||
-		!attrGostR3411Params->init() ||
-		!attrGost28147Params->init()
-	)
-	{
-		ERROR_MSG("Could not initialize the attribute");
-		delete attrValue;
-		delete attrGostR3410Params;
-		delete attrGostR3411Params;
-		delete attrGost28147Params;
-		return false;
-	}
-
-	// Add them to the map
-	attributes[attrValue->getType()] = attrValue;
-	attributes[attrGostR3410Params->getType()] = attrGostR3410Params;
-	attributes[attrGostR3411Params->getType()] = attrGostR3411Params;
-	attributes[attrGost28147Params->getType()] = attrGost28147Params;
-
 	initialized = true;
 	return true;
 }
 
-//constructor
+// The attributes of P11PrivateKeyObj
+static P11AttrSubject privateKeySubject(P11Attribute::ck8);
+static P11AttrSensitive privateKeySensitive;
+static P11AttrDecrypt privateKeyDecrypt;
+static P11AttrSign privateKeySign;
+static P11AttrSignRecover privateKeySignRecover;
+static P11AttrUnwrap privateKeyUnwrap;
+static P11AttrExtractable privateKeyExtractable;
+static P11AttrAlwaysSensitive privateKeyAlwaysSensitive;
+static P11AttrNeverExtractable privateKeyNeverExtractable;
+static P11AttrWrapWithTrusted privateKeyWrapWithTrusted;
+static P11AttrUnwrapTemplate privateKeyUnwrapTemplate;
+// TODO: CKA_ALWAYS_AUTHENTICATE is accepted, but we do not use it
+static P11AttrAlwaysAuthenticate privateKeyAlwaysAuthenticate;
+static P11Attribute* const privateKeyAttributes[] =
+{
+	&privateKeySubject,
+	&privateKeySensitive,
+	&privateKeyDecrypt,
+	&privateKeySign,
+	&privateKeySignRecover,
+	&privateKeyUnwrap,
+	&privateKeyExtractable,
+	&privateKeyAlwaysSensitive,
+	&privateKeyNeverExtractable,
+	&privateKeyWrapWithTrusted,
+	&privateKeyUnwrapTemplate,
+	&privateKeyAlwaysAuthenticate
+};
+static const P11AttributeTable privateKeyTable =
+{
+	&keyTable,
+	privateKeyAttributes,
+	sizeof(privateKeyAttributes) / sizeof(privateKeyAttributes[0])
+};
+
+// Constructor
 P11PrivateKeyObj::P11PrivateKeyObj()
 {
 	initialized = false;
+	attributes = &privateKeyTable;
 }
 
-// Add attributes
+// Initialize the attributes of the object
 bool P11PrivateKeyObj::init(OSObject *inobject)
 {
 	if (initialized) return true;
@@ -969,79 +899,45 @@ bool P11PrivateKeyObj::init(OSObject *inobject)
 	// Create parent
 	if (!P11KeyObj::init(inobject)) return false;
 
-	// Create attributes
-	P11Attribute* attrSubject = new P11AttrSubject(osobject,P11Attribute::ck8);
-	P11Attribute* attrSensitive = new P11AttrSensitive(osobject);
-	P11Attribute* attrDecrypt = new P11AttrDecrypt(osobject);
-	P11Attribute* attrSign = new P11AttrSign(osobject);
-	P11Attribute* attrSignRecover = new P11AttrSignRecover(osobject);
-	P11Attribute* attrUnwrap = new P11AttrUnwrap(osobject);
-	P11Attribute* attrExtractable = new P11AttrExtractable(osobject);
-	P11Attribute* attrAlwaysSensitive = new P11AttrAlwaysSensitive(osobject);
-	P11Attribute* attrNeverExtractable = new P11AttrNeverExtractable(osobject);
-	P11Attribute* attrWrapWithTrusted = new P11AttrWrapWithTrusted(osobject);
-	P11Attribute* attrUnwrapTemplate = new P11AttrUnwrapTemplate(osobject);
-	// TODO: CKA_ALWAYS_AUTHENTICATE is accepted, but we do not use it
-	P11Attribute* attrAlwaysAuthenticate = new P11AttrAlwaysAuthenticate(osobject);
-
-	// Initialize the attributes
-	if
-	(
-		!attrSubject->init() ||
-		!attrSensitive->init() ||
-		!attrDecrypt->init() ||
-		!attrSign->init() ||
-		!attrSignRecover->init() ||
-		!attrUnwrap->init() ||
-		!attrExtractable->init() ||
-		!attrAlwaysSensitive->init() ||
-		!attrNeverExtractable->init() ||
-		!attrWrapWithTrusted->init() ||
-		!attrUnwrapTemplate->init() ||
-		!attrAlwaysAuthenticate->init()
-	)
-	{
-		ERROR_MSG("Could not initialize the attribute");
-		delete attrSubject;
-		delete attrSensitive;
-		delete attrDecrypt;
-		delete attrSign;
-		delete attrSignRecover;
-		delete attrUnwrap;
-		delete attrExtractable;
-		delete attrAlwaysSensitive;
-		delete attrNeverExtractable;
-		delete attrWrapWithTrusted;
-		delete attrUnwrapTemplate;
-		delete attrAlwaysAuthenticate;
-		return false;
-	}
-
-	// Add them to the map
-	attributes[attrSubject->getType()] = attrSubject;
-	attributes[attrSensitive->getType()] = attrSensitive;
-	attributes[attrDecrypt->getType()] = attrDecrypt;
-	attributes[attrSign->getType()] = attrSign;
-	attributes[attrSignRecover->getType()] = attrSignRecover;
-	attributes[attrUnwrap->getType()] = attrUnwrap;
-	attributes[attrExtractable->getType()] = attrExtractable;
-	attributes[attrAlwaysSensitive->getType()] = attrAlwaysSensitive;
-	attributes[attrNeverExtractable->getType()] = attrNeverExtractable;
-	attributes[attrWrapWithTrusted->getType()] = attrWrapWithTrusted;
-	attributes[attrUnwrapTemplate->getType()] = attrUnwrapTemplate;
-	attributes[attrAlwaysAuthenticate->getType()] = attrAlwaysAuthenticate;
-
 	initialized = true;
 	return true;
 }
 
+// The attributes of P11RSAPrivateKeyObj
+static P11AttrModulus rsaPrivateKeyModulus(P11Attribute::ck6);
+static P11AttrPublicExponent rsaPrivateKeyPublicExponent(P11Attribute::ck4|P11Attribute::ck6);
+static P11AttrPrivateExponent rsaPrivateKeyPrivateExponent;
+static P11AttrPrime1 rsaPrivateKeyPrime1;
+static P11AttrPrime2 rsaPrivateKeyPrime2;
+static P11AttrExponent1 rsaPrivateKeyExponent1;
+static P11AttrExponent2 rsaPrivateKeyExponent2;
+static P11AttrCoefficient rsaPrivateKeyCoefficient;
+static P11Attribute* const rsaPrivateKeyAttributes[] =
+{
+	&rsaPrivateKeyModulus,
+	&rsaPrivateKeyPublicExponent,
+	&rsaPrivateKeyPrivateExponent,
+	&rsaPrivateKeyPrime1,
+	&rsaPrivateKeyPrime2,
+	&rsaPrivateKeyExponent1,
+	&rsaPrivateKeyExponent2,
+	&rsaPrivateKeyCoefficient
+};
+static const P11AttributeTable rsaPrivateKeyTable =
+{
+	&privateKeyTable,
+	rsaPrivateKeyAttributes,
+	sizeof(rsaPrivateKeyAttributes) / sizeof(rsaPrivateKeyAttributes[0])
+};
+
 // Constructor
 P11RSAPrivateKeyObj::P11RSAPrivateKeyObj()
 {
 	initialized = false;
+	attributes = &rsaPrivateKeyTable;
 }
 
-// Add attributes
+// Initialize the attributes of the object
 bool P11RSAPrivateKeyObj::init(OSObject *inobject)
 {
 	if (initialized) return true;
@@ -1055,62 +951,37 @@ bool P11RSAPrivateKeyObj::init(OSObject *inobject)
 	// Create parent
 	if (!P11PrivateKeyObj::init(inobject)) return false;
 
-	// Create attributes
-	P11Attribute* attrModulus = new P11AttrModulus(osobject,P11Attribute::ck6);
-	P11Attribute* attrPublicExponent = new P11AttrPublicExponent(osobject,P11Attribute::ck4|P11Attribute::ck6);
-	P11Attribute* attrPrivateExponent = new P11AttrPrivateExponent(osobject);
-	P11Attribute* attrPrime1 = new P11AttrPrime1(osobject);
-	P11Attribute* attrPrime2 = new P11AttrPrime2(osobject);
-	P11Attribute* attrExponent1 = new P11AttrExponent1(osobject);
-	P11Attribute* attrExponent2 = new P11AttrExponent2(osobject);
-	P11Attribute* attrCoefficient = new P11AttrCoefficient(osobject);
-
-	// Initialize the attributes
-	if
-	(
-		!attrModulus->init() ||
-		!attrPublicExponent->init() ||
-		!attrPrivateExponent->init() ||
-		!attrPrime1->init() ||
-		!attrPrime2->init() ||
-		!attrExponent1->init() ||
-		!attrExponent2->init() ||
-		!attrCoefficient->init()
-	)
-	{
-		ERROR_MSG("Could not initialize the attribute");
-		delete attrModulus;
-		delete attrPublicExponent;
-		delete attrPrivateExponent;
-		delete attrPrime1;
-		delete attrPrime2;
-		delete attrExponent1;
-		delete attrExponent2;
-		delete attrCoefficient;
-		return false;
-	}
-
-	// Add them to the map
-	attributes[attrModulus->getType()] = attrModulus;
-	attributes[attrPublicExponent->getType()] = attrPublicExponent;
-	attributes[attrPrivateExponent->getType()] = attrPrivateExponent;
-	attributes[attrPrime1->getType()] = attrPrime1;
-	attributes[attrPrime2->getType()] = attrPrime2;
-	attributes[attrExponent1->getType()] = attrExponent1;
-	attributes[attrExponent2->getType()] = attrExponent2;
-	attributes[attrCoefficient->getType()] = attrCoefficient;
-
 	initialized = true;
 	return true;
 }
 
+// The attributes of P11DSAPrivateKeyObj
+static P11AttrPrime dsaPrivateKeyPrime(P11Attribute::ck4|P11Attribute::ck6);
+static P11AttrSubPrime dsaPrivateKeySubPrime(P11Attribute::ck4|P11Attribute::ck6);
+static P11AttrBase dsaPrivateKeyBase(P11Attribute::ck4|P11Attribute::ck6);
+static P11AttrValue dsaPrivateKeyValue(P11Attribute::ck1|P11Attribute::ck4|P11Attribute::ck6|P11Attribute::ck7);
+static P11Attribute* const dsaPrivateKeyAttributes[] =
+{
+	&dsaPrivateKeyPrime,
+	&dsaPrivateKeySubPrime,
+	&dsaPrivateKeyBase,
+	&dsaPrivateKeyValue
+};
+static const P11AttributeTable dsaPrivateKeyTable =
+{
+	&privateKeyTable,
+	dsaPrivateKeyAttributes,
+	sizeof(dsaPrivateKeyAttributes) / sizeof(dsaPrivateKeyAttributes[0])
+};
+
 // Constructor
 P11DSAPrivateKeyObj::P11DSAPrivateKeyObj()
 {
 	initialized = false;
+	attributes = &dsaPrivateKeyTable;
 }
 
-// Add attributes
+// Initialize the attributes of the object
 bool P11DSAPrivateKeyObj::init(OSObject *inobject)
 {
 	if (initialized) return true;
@@ -1124,46 +995,33 @@ bool P11DSAPrivateKeyObj::init(OSObject *inobject)
 	// Create parent
 	if (!P11PrivateKeyObj::init(inobject)) return false;
 
-	// Create attributes
-	P11Attribute* attrPrime = new P11AttrPrime(osobject,P11Attribute::ck4|P11Attribute::ck6);
-	P11Attribute* attrSubPrime = new P11AttrSubPrime(osobject,P11Attribute::ck4|P11Attribute::ck6);
-	P11Attribute* attrBase = new P11AttrBase(osobject,P11Attribute::ck4|P11Attribute::ck6);
-	P11Attribute* attrValue = new P11AttrValue(osobject,P11Attribute::ck1|P11Attribute::ck4|P11Attribute::ck6|P11Attribute::ck7);
-
-	// Initialize the attributes
-	if
-	(
-		!attrPrime->init() ||
-		!attrSubPrime->init() ||
-		!attrBase->init() ||
-		!attrValue->init()
-	)
-	{
-		ERROR_MSG("Could not initialize the attribute");
-		delete attrPrime;
-		delete attrSubPrime;
-		delete attrBase;
-		delete attrValue;
-		return false;
-	}
-
-	// Add them to the map
-	attributes[attrPrime->getType()] = attrPrime;
-	attributes[attrSubPrime->getType()] = attrSubPrime;
-	attributes[attrBase->getType()] = attrBase;
-	attributes[attrValue->getType()] = attrValue;
-
 	initialized = true;
 	return true;
 }
 
+// The attributes of P11ECPrivateKeyObj
+static P11AttrEcParams ecPrivateKeyEcParams(P11Attribute::ck4|P11Attribute::ck6);
+static P11AttrValue ecPrivateKeyValue(P11Attribute::ck1|P11Attribute::ck4|P11Attribute::ck6|P11Attribute::ck7);
+static P11Attribute* const ecPrivateKeyAttributes[] =
+{
+	&ecPrivateKeyEcParams,
+	&ecPrivateKeyValue
+};
+static const P11AttributeTable ecPrivateKeyTable =
+{
+	&privateKeyTable,
+	ecPrivateKeyAttributes,
+	sizeof(ecPrivateKeyAttributes) / sizeof(ecPrivateKeyAttributes[0])
+};
+
 // Constructor
 P11ECPrivateKeyObj::P11ECPrivateKeyObj()
 {
 	initialized = false;
+	attributes = &ecPrivateKeyTable;
 }
 
-// Add attributes
+// Initialize the attributes of the object
 bool P11ECPrivateKeyObj::init(OSObject *inobject)
 {
 	if (initialized) return true;
@@ -1177,38 +1035,37 @@ bool P11ECPrivateKeyObj::init(OSObject *inobject)
 	// Create parent
 	if (!P11PrivateKeyObj::init(inobject)) return false;
 
-	// Create attributes
-	P11Attribute* attrEcParams = new P11AttrEcParams(osobject,P11Attribute::ck4|P11Attribute::ck6);
-	P11Attribute* attrValue = new P11AttrValue(osobject,P11Attribute::ck1|P11Attribute::ck4|P11Attribute::ck6|P11Attribute::ck7);
-
-	// Initialize the attributes
-	if
-	(
-		!attrEcParams->init() ||
-		!attrValue->init()
-	)
-	{
-		ERROR_MSG("Could not initialize the attribute");
-		delete attrEcParams;
-		delete attrValue;
-		return false;
-	}
-
-	// Add them to the map
-	attributes[attrEcParams->getType()] = attrEcParams;
-	attributes[attrValue->getType()] = attrValue;
-
 	initialized = true;
 	return true;
 }
 
+// The attributes of P11DHPrivateKeyObj
+static P11AttrPrime dhPrivateKeyPrime(P11Attribute::ck4|P11Attribute::ck6);
+static P11AttrBase dhPrivateKeyBase(P11Attribute::ck4|P11Attribute::ck6);
+static P11AttrValue dhPrivateKeyValue(P11Attribute::ck1|P11Attribute::ck4|P11Attribute::ck6|P11Attribute::ck7);
+static P11AttrValueBits dhPrivateKeyValueBits;
+static P11Attribute* const dhPrivateKeyAttributes[] =
+{
+	&dhPrivateKeyPrime,
+	&dhPrivateKeyBase,
+	&dhPrivateKeyValue,
+	&dhPrivateKeyValueBits
+};
+static const P11AttributeTable dhPrivateKeyTable =
+{
+	&privateKeyTable,
+	dhPrivateKeyAttributes,
+	sizeof(dhPrivateKeyAttributes) / sizeof(dhPrivateKeyAttributes[0])
+};
+
 // Constructor
 P11DHPrivateKeyObj::P11DHPrivateKeyObj()
 {
 	initialized = false;
+	attributes = &dhPrivateKeyTable;
 }
 
-// Add attributes
+// Initialize the attributes of the object
 bool P11DHPrivateKeyObj::init(OSObject *inobject)
 {
 	if (initialized) return true;
@@ -1222,46 +1079,37 @@ bool P11DHPrivateKeyObj::init(OSObject *inobject)
 	// Create parent
 	if (!P11PrivateKeyObj::init(inobject)) return false;
 
-	// Create attributes
-	P11Attribute* attrPrime = new P11AttrPrime(osobject,P11Attribute::ck4|P11Attribute::ck6);
-	P11Attribute* attrBase = new P11AttrBase(osobject,P11Attribute::ck4|P11Attribute::ck6);
-	P11Attribute* attrValue = new P11AttrValue(osobject,P11Attribute::ck1|P11Attribute::ck4|P11Attribute::ck6|P11Attribute::ck7);
-	P11Attribute* attrValueBits = new P11AttrValueBits(osobject);
-
-	// Initialize the attributes
-	if
-	(
-		!attrPrime->init() ||
-		!attrBase->init() ||
-		!attrValue->init() ||
-		!attrValueBits->init()
-	)
-	{
-		ERROR_MSG("Could not initialize the attribute");
-		delete attrPrime;
-		delete attrBase;
-		delete attrValue;
-		delete attrValueBits;
-		return false;
-	}
-
-	// Add them to the map
-	attributes[attrPrime->getType()] = attrPrime;
-	attributes[attrBase->getType()] = attrBase;
-	attributes[attrValue->getType()] = attrValue;
-	attributes[attrValueBits->getType()] = attrValueBits;
-
 	initialized = true;
 	return true;
 }
 
+// The attributes of P11GOSTPrivateKeyObj
+static P11AttrValue gostPrivateKeyValue(P11Attribute::ck1|P11Attribute::ck4|P11Attribute::ck6|P11Attribute::ck7);
+static P11AttrGostR3410Params gostPrivateKeyGostR3410Params(P11Attribute::ck4|P11Attribute::ck6);
+static P11AttrGostR3411Params gostPrivateKeyGostR3411Params(P11Attribute::ck4|P11Attribute::ck6);
+static P11AttrGost28147Params gostPrivateKeyGost28147Params(P11Attribute::ck4|P11Attribute::ck6|P11Attribute::ck8);
+static P11Attribute* const gostPrivateKeyAttributes[] =
+{
+	&gostPrivateKeyValue,
+	&gostPrivateKeyGostR3410Params,
+	&gostPrivateKeyGostR3411Params,
+	&gostPrivateKeyGost28147Params
+};
+static const P11AttributeTable gostPrivateKeyTable =
+{
+	&privateKeyTable,
+	gostPrivateKeyAttributes,
+	sizeof(gostPrivateKeyAttributes) / sizeof(gostPrivateKeyAttributes[0])
+};
+
 // Constructor
 P11GOSTPrivateKeyObj::P11GOSTPrivateKeyObj()
 {
 	initialized = false;
+	attributes = &gostPrivateKeyTable;
 }
 
-// Add attributes
+// Initialize the attributes of the object
 bool P11GOSTPrivateKeyObj::init(OSObject *inobject)
 {
 	if (initialized) return true;
@@ -1275,46 +1123,59 @@ bool P11GOSTPrivateKeyObj::init(OSObject *inobject)
 	// Create parent
 	if (!P11PrivateKeyObj::init(inobject)) return false;
 
-	// Create attributes
-	P11Attribute* attrValue = new P11AttrValue(osobject,P11Attribute::ck1|P11Attribute::ck4|P11Attribute::ck6|P11Attribute::ck7);
-	P11Attribute* attrGostR3410Params = new P11AttrGostR3410Params(osobject,P11Attribute::ck4|P11Attribute::ck6);
-	P11Attribute* attrGostR3411Params = new P11AttrGostR3411Params(osobject,P11Attribute::ck4|P11Attribute::ck6);
-	P11Attribute* attrGost28147Params = new P11AttrGost28147Params(osobject,P11Attribute::ck4|P11Attribute::ck6|P11Attribute::ck8);
-
-	// Initialize the attributes
-	if
-	(
-		!attrValue->init() ||
-		!attrGostR3410Params->init() ||
-		!attrGostR3411Params->init() ||
-		!attrGost28147Params->init()
-	)
-	{
-		ERROR_MSG("Could not initialize the attribute");
-		delete attrValue;
-		delete attrGostR3410Params;
-		delete attrGostR3411Params;
-		delete attrGost28147Params;
-		return false;
-	}
-
-	// Add them to the map
-	attributes[attrValue->getType()] = attrValue;
-	attributes[attrGostR3410Params->getType()] = attrGostR3410Params;
-	attributes[attrGostR3411Params->getType()] = attrGostR3411Params;
-	attributes[attrGost28147Params->getType()] = attrGost28147Params;
-
 	initialized = true;
 	return true;
 }
 
+// The attributes of P11SecretKeyObj
+static P11AttrSensitive secretKeySensitive;
+static P11AttrEncrypt secretKeyEncrypt;
+static P11AttrDecrypt secretKeyDecrypt;
+static P11AttrSign secretKeySign;
+static P11AttrVerify secretKeyVerify;
+static P11AttrWrap secretKeyWrap;
+static P11AttrUnwrap secretKeyUnwrap;
+static P11AttrExtractable secretKeyExtractable;
+static P11AttrAlwaysSensitive secretKeyAlwaysSensitive;
+static P11AttrNeverExtractable secretKeyNeverExtractable;
+static P11AttrCheckValue secretKeyCheckValue(P11Attribute::ck8);
+static P11AttrWrapWithTrusted secretKeyWrapWithTrusted;
+static P11AttrTrusted secretKeyTrusted;
+static P11AttrWrapTemplate secretKeyWrapTemplate;
+static P11AttrUnwrapTemplate secretKeyUnwrapTemplate;
+static P11Attribute* const secretKeyAttributes[] =
+{
+	&secretKeySensitive,
+	&secretKeyEncrypt,
+	&secretKeyDecrypt,
+	&secretKeySign,
+	&secretKeyVerify,
+	&secretKeyWrap,
+	&secretKeyUnwrap,
+	&secretKeyExtractable,
+	&secretKeyAlwaysSensitive,
+	&secretKeyNeverExtractable,
+	&secretKeyCheckValue,
+	&secretKeyWrapWithTrusted,
+	&secretKeyTrusted,
+	&secretKeyWrapTemplate,
+	&secretKeyUnwrapTemplate
+};
+static const P11AttributeTable secretKeyTable =
+{
+	&keyTable,
+	secretKeyAttributes,
+	sizeof(secretKeyAttributes) / sizeof(secretKeyAttributes[0])
+};
+
 // Constructor
 P11SecretKeyObj::P11SecretKeyObj()
 {
 	initialized = false;
+	attributes = &secretKeyTable;
 }
 
-// Add attributes
+// Initialize the attributes of the object
 bool P11SecretKeyObj::init(OSObject *inobject)
 {
 	if (initialized) return true;
@@ -1328,91 +1189,34 @@ bool P11SecretKeyObj::init(OSObject *inobject)
 	// Create parent
 	if (!P11KeyObj::init(inobject)) return false;
 
-	// Create attributes
-	P11Attribute* attrSensitive = new P11AttrSensitive(osobject);
-	P11Attribute* attrEncrypt = new P11AttrEncrypt(osobject);
-	P11Attribute* attrDecrypt = new P11AttrDecrypt(osobject);
-	P11Attribute* attrSign = new P11AttrSign(osobject);
-	P11Attribute* attrVerify = new P11AttrVerify(osobject);
-	P11Attribute* attrWrap = new P11AttrWrap(osobject);
-	P11Attribute* attrUnwrap = new P11AttrUnwrap(osobject);
-	P11Attribute* attrExtractable = new P11AttrExtractable(osobject);
-	P11Attribute* attrAlwaysSensitive = new P11AttrAlwaysSensitive(osobject);
-	P11Attribute* attrNeverExtractable = new P11AttrNeverExtractable(osobject);
-	P11Attribute* attrCheckValue = new P11AttrCheckValue(osobject, P11Attribute::ck8);
-	P11Attribute* attrWrapWithTrusted = new P11AttrWrapWithTrusted(osobject);
-	P11Attribute* attrTrusted = new P11AttrTrusted(osobject);
-	P11Attribute* attrWrapTemplate = new P11AttrWrapTemplate(osobject);
-	P11Attribute* attrUnwrapTemplate = new P11AttrUnwrapTemplate(osobject);
-
-	// Initialize the attributes
-	if
-	(
-		!attrSensitive->init() ||
-		!attrEncrypt->init() ||
-		!attrDecrypt->init() ||
-		!attrSign->init() ||
-		!attrVerify->init() ||
-		!attrWrap->init() ||
-		!attrUnwrap->init() ||
-		!attrExtractable->init() ||
-		!attrAlwaysSensitive->init() ||
-		!attrNeverExtractable->init() ||
-		!attrCheckValue->init() ||
-		!attrWrapWithTrusted->init() ||
-		!attrTrusted->init() ||
-		!attrWrapTemplate->init() ||
-		!attrUnwrapTemplate->init()
-	)
-	{
-		ERROR_MSG("Could not initialize the attribute");
-		delete attrSensitive;
-		delete attrEncrypt;
-		delete attrDecrypt;
-		delete attrSign;
-		delete attrVerify;
-		delete attrWrap;
-		delete attrUnwrap;
-		delete attrExtractable;
-		delete attrAlwaysSensitive;
-		delete attrNeverExtractable;
-		delete attrCheckValue;
-		delete attrWrapWithTrusted;
-		delete attrTrusted;
-		delete attrWrapTemplate;
-		delete attrUnwrapTemplate;
-		return false;
-	}
-
-	// Add them to the map
-	attributes[attrSensitive->getType()] = attrSensitive;
-	attributes[attrEncrypt->getType()] = attrEncrypt;
-	attributes[attrDecrypt->getType()] = attrDecrypt;
-	attributes[attrSign->getType()] = attrSign;
-	attributes[attrVerify->getType()] = attrVerify;
-	attributes[attrWrap->getType()] = attrWrap;
-	attributes[attrUnwrap->getType()] = attrUnwrap;
-	attributes[attrExtractable->getType()] = attrExtractable;
-	attributes[attrAlwaysSensitive->getType()] = attrAlwaysSensitive;
-	attributes[attrNeverExtractable->getType()] = attrNeverExtractable;
-	attributes[attrCheckValue->getType()] = attrCheckValue;
-	attributes[attrWrapWithTrusted->getType()] = attrWrapWithTrusted;
-	attributes[attrTrusted->getType()] = attrTrusted;
-	attributes[attrWrapTemplate->getType()] = attrWrapTemplate;
-	attributes[attrUnwrapTemplate->getType()] = attrUnwrapTemplate;
-
 	initialized = true;
 	return true;
 }
 
+// The attributes of P11GenericSecretKeyObj
+static P11AttrValue genericSecretKeyValue(P11Attribute::ck1|P11Attribute::ck4|P11Attribute::ck6|P11Attribute::ck7);
+static P11AttrValueLen genericSecretKeyValueLen;
+static P11Attribute* const genericSecretKeyAttributes[] =
+{
+	&genericSecretKeyValue,
+	&genericSecretKeyValueLen
+};
+static const P11AttributeTable genericSecretKeyTable =
+{
+	&secretKeyTable,
+	genericSecretKeyAttributes,
+	sizeof(genericSecretKeyAttributes) / sizeof(genericSecretKeyAttributes[0])
+};
+
 // Constructor
 P11GenericSecretKeyObj::P11GenericSecretKeyObj()
 {
 	initialized = false;
+	attributes = &genericSecretKeyTable;
 	keytype = CKK_VENDOR_DEFINED;
 }
 
-// Add attributes
+// Initialize the attributes of the object
 bool P11GenericSecretKeyObj::init(OSObject *inobject)
 {
 	if (initialized) return true;
@@ -1426,27 +1230,6 @@ bool P11GenericSecretKeyObj::init(OSObject *inobject)
 	// Create parent
 	if (!P11SecretKeyObj::init(inobject)) return false;
 
-	// Create attributes
-	P11Attribute* attrValue = new P11AttrValue(osobject,P11Attribute::ck1|P11Attribute::ck4|P11Attribute::ck6|P11Attribute::ck7);
-	P11Attribute* attrValueLen = new P11AttrValueLen(osobject);
-
-	// Initialize the attributes
-	if
-	(
-		!attrValue->init() ||
-		!attrValueLen->init()
-	)
-	{
-		ERROR_MSG("Could not initialize the attribute");
-		delete attrValue;
-		delete attrValueLen;
-		return false;
-	}
-
-	// Add them to the map
-	attributes[attrValue->getType()] = attrValue;
-	attributes[attrValueLen->getType()] = attrValueLen;
-
 	initialized = true;
 	return true;
 }
@@ -1469,13 +1252,29 @@ CK_KEY_TYPE P11GenericSecretKeyObj::getKeyType()
 	return keytype;
 }
 
+// The attributes of P11AESSecretKeyObj
+static P11AttrValue aesSecretKeyValue(P11Attribute::ck1|P11Attribute::ck4|P11Attribute::ck6|P11Attribute::ck7);
+static P11AttrValueLen aesSecretKeyValueLen(P11Attribute::ck6);
+static P11Attribute* const aesSecretKeyAttributes[] =
+{
+	&aesSecretKeyValue,
+	&aesSecretKeyValueLen
+};
+static const P11AttributeTable aesSecretKeyTable =
+{
+	&secretKeyTable,
+	aesSecretKeyAttributes,
+	sizeof(aesSecretKeyAttributes) / sizeof(aesSecretKeyAttributes[0])
+};
+
 // Constructor
 P11AESSecretKeyObj::P11AESSecretKeyObj()
 {
 	initialized = false;
+	attributes = &aesSecretKeyTable;
 }
 
-// Add attributes
+// Initialize the attributes of the object
 bool P11AESSecretKeyObj::init(OSObject *inobject)
 {
 	if (initialized) return true;
@@ -1489,39 +1288,32 @@ bool P11AESSecretKeyObj::init(OSObject *inobject)
 	// Create parent
 	if (!P11SecretKeyObj::init(inobject)) return false;
 
-	// Create attributes
-	P11Attribute* attrValue = new P11AttrValue(osobject,P11Attribute::ck1|P11Attribute::ck4|P11Attribute::ck6|P11Attribute::ck7);
-	P11Attribute* attrValueLen = new P11AttrValueLen(osobject,P11Attribute::ck6);
-
-	// Initialize the attributes
-	if
-	(
-		!attrValue->init() ||
-		!attrValueLen->init()
-	)
-	{
-		ERROR_MSG("Could not initialize the attribute");
-		delete attrValue;
-		delete attrValueLen;
-		return false;
-	}
-
-	// Add them to the map
-	attributes[attrValue->getType()] = attrValue;
-	attributes[attrValueLen->getType()] = attrValueLen;
-
 	initialized = true;
 	return true;
 }
 
+// The attributes of P11DESSecretKeyObj
+static P11AttrValue desSecretKeyValue(P11Attribute::ck1|P11Attribute::ck4|P11Attribute::ck6|P11Attribute::ck7);
+static P11Attribute* const desSecretKeyAttributes[] =
+{
+	&desSecretKeyValue
+};
+static const P11AttributeTable desSecretKeyTable =
+{
+	&secretKeyTable,
+	desSecretKeyAttributes,
+	sizeof(desSecretKeyAttributes) / sizeof(desSecretKeyAttributes[0])
+};
+
 // Constructor
 P11DESSecretKeyObj::P11DESSecretKeyObj()
 {
 	initialized = false;
+	attributes = &desSecretKeyTable;
 	keytype = CKK_VENDOR_DEFINED;
 }
 
-// Add attributes
+// Initialize the attributes of the object
 bool P11DESSecretKeyObj::init(OSObject *inobject)
 {
 	if (initialized) return true;
@@ -1535,20 +1327,6 @@ bool P11DESSecretKeyObj::init(OSObject *inobject)
 	// Create parent
 	if (!P11SecretKeyObj::init(inobject)) return false;
 
-	// Create attributes
-	P11Attribute* attrValue = new P11AttrValue(osobject,P11Attribute::ck1|P11Attribute::ck4|P11Attribute::ck6|P11Attribute::ck7);
-
-	// Initialize the attributes
-	if (!attrValue->init())
-	{
-		ERROR_MSG("Could not initialize the attribute");
-		delete attrValue;
-		return false;
-	}
-
-	// Add them to the map
-	attributes[attrValue->getType()] = attrValue;
-
 	initialized = true;
 	return true;
 }
@@ -1571,13 +1349,29 @@ CK_KEY_TYPE P11DESSecretKeyObj::getKeyType()
 	return keytype;
 }
 
+// The attributes of P11GOSTSecretKeyObj
+static P11AttrValue gostSecretKeyValue(P11Attribute::ck1|P11Attribute::ck4|P11Attribute::ck6|P11Attribute::ck7);
+static P11AttrGost28147Params gostSecretKeyGost28147Params(P11Attribute::ck1|P11Attribute::ck3|P11Attribute::ck5);
+static P11Attribute* const gostSecretKeyAttributes[] =
+{
+	&gostSecretKeyValue,
+	&gostSecretKeyGost28147Params
+};
+static const P11AttributeTable gostSecretKeyTable =
+{
+	&secretKeyTable,
+	gostSecretKeyAttributes,
+	sizeof(gostSecretKeyAttributes) / sizeof(gostSecretKeyAttributes[0])
+};
+
 // Constructor
 P11GOSTSecretKeyObj::P11GOSTSecretKeyObj()
 {
 	initialized = false;
+	attributes = &gostSecretKeyTable;
 }
 
-// Add attributes
+// Initialize the attributes of the object
 bool P11GOSTSecretKeyObj::init(OSObject *inobject)
 {
 	if (initialized) return true;
@@ -1591,38 +1385,33 @@ bool P11GOSTSecretKeyObj::init(OSObject *inobject)
 	// Create parent
 	if (!P11SecretKeyObj::init(inobject)) return false;
 
-	// Create attributes
-	P11Attribute* attrValue = new P11AttrValue(osobject,P11Attribute::ck1|P11Attribute::ck4|P11Attribute::ck6|P11Attribute::ck7);
-	P11Attribute* attrGost28147Params = new P11AttrGost28147Params(osobject,P11Attribute::ck1|P11Attribute::ck3|P11Attribute::ck5);
-
-	// Initialize the attributes
-	if
-	(
-		!attrValue->init() ||
-		!attrGost28147Params->init()
-	)
-	{
-		ERROR_MSG("Could not initialize the attribute");
-		delete attrValue;
-		delete attrGost28147Params;
-		return false;
-	}
-
-	// Add them to the map
-	attributes[attrValue->getType()] = attrValue;
-	attributes[attrGost28147Params->getType()] = attrGost28147Params;
-
 	initialized = true;
 	return true;
 }
 
+// The attributes of P11DomainObj
+static P11AttrKeyType domainKeyType;
+static P11AttrLocal domainLocal;
+static P11Attribute* const domainAttributes[] =
+{
+	&domainKeyType,
+	&domainLocal
+};
+static const P11AttributeTable domainTable =
+{
+	&objectTable,
+	domainAttributes,
+	sizeof(domainAttributes) / sizeof(domainAttributes[0])
+};
+
 // Constructor
 P11DomainObj::P11DomainObj()
 {
 	initialized = false;
+	attributes = &domainTable;
 }
 
-// Add attributes
+// Initialize the attributes of the object
 bool P11DomainObj::init(OSObject *inobject)
 {
 	if (initialized) return true;
@@ -1636,38 +1425,37 @@ bool P11DomainObj::init(OSObject *inobject)
 	// Create parent
 	if (!P11Object::init(inobject)) return false;
 
-	// Create attributes
-	P11Attribute* attrKeyType = new P11AttrKeyType(osobject);
-	P11Attribute* attrLocal = new P11AttrLocal(osobject);
-
-	// Initialize the attributes
-	if
-	(
-		!attrKeyType->init() ||
-		!attrLocal->init()
-	)
-	{
-		ERROR_MSG("Could not initialize the attribute");
-		delete attrKeyType;
-		delete attrLocal;
-		return false;
-	}
-
-	// Add them to the map
-	attributes[attrKeyType->getType()] = attrKeyType;
-	attributes[attrLocal->getType()] = attrLocal;
-
 	initialized = true;
 	return true;
 }
 
+// The attributes of P11DSADomainObj
+static P11AttrPrime dsaDomainPrime(P11Attribute::ck4);
+static P11AttrSubPrime dsaDomainSubPrime(P11Attribute::ck4);
+static P11AttrBase dsaDomainBase(P11Attribute::ck4);
+static P11AttrPrimeBits dsaDomainPrimeBits;
+static P11Attribute* const dsaDomainAttributes[] =
+{
+	&dsaDomainPrime,
+	&dsaDomainSubPrime,
+	&dsaDomainBase,
+	&dsaDomainPrimeBits
+};
+static const P11AttributeTable dsaDomainTable =
+{
+	&domainTable,
+	dsaDomainAttributes,
+	sizeof(dsaDomainAttributes) / sizeof(dsaDomainAttributes[0])
+};
+
 // Constructor
 P11DSADomainObj::P11DSADomainObj()
 {
 	initialized = false;
+	attributes = &dsaDomainTable;
 }
 
-// Add attributes
+// Initialize the attributes of the object
 bool P11DSADomainObj::init(OSObject *inobject)
 {
 	if (initialized) return true;
@@ -1681,46 +1469,35 @@ bool P11DSADomainObj::init(OSObject *inobject)
 	// Create parent
 	if (!P11DomainObj::init(inobject)) return false;
 
-	// Create attributes
-	P11Attribute* attrPrime = new P11AttrPrime(osobject,P11Attribute::ck4);
-	P11Attribute* attrSubPrime = new P11AttrSubPrime(osobject,P11Attribute::ck4);
-	P11Attribute* attrBase = new P11AttrBase(osobject,P11Attribute::ck4);
-	P11Attribute* attrPrimeBits = new P11AttrPrimeBits(osobject);
-
-	// Initialize the attributes
-	if
-	(
-		!attrPrime->init() ||
-		!attrSubPrime->init() ||
-		!attrBase->init() ||
-		!attrPrimeBits->init()
-	)
-	{
-		ERROR_MSG("Could not initialize the attribute");
-		delete attrPrime;
-		delete attrSubPrime;
-		delete attrBase;
-		delete attrPrimeBits;
-		return false;
-	}
-
-	// Add them to the map
-	attributes[attrPrime->getType()] = attrPrime;
-	attributes[attrSubPrime->getType()] = attrSubPrime;
-	attributes[attrBase->getType()] = attrBase;
-	attributes[attrPrimeBits->getType()] = attrPrimeBits;
-
 	initialized = true;
 	return true;
 }
 
+// The attributes of P11DHDomainObj
+static P11AttrPrime dhDomainPrime(P11Attribute::ck4);
+static P11AttrBase dhDomainBase(P11Attribute::ck4);
+static P11AttrPrimeBits dhDomainPrimeBits;
+static P11Attribute* const dhDomainAttributes[] =
+{
+	&dhDomainPrime,
+	&dhDomainBase,
+	&dhDomainPrimeBits
+};
+static const P11AttributeTable dhDomainTable =
+{
+	&domainTable,
+	dhDomainAttributes,
+	sizeof(dhDomainAttributes) / sizeof(dhDomainAttributes[0])
+};
+
 // Constructor
 P11DHDomainObj::P11DHDomainObj()
 {
 	initialized = false;
+	attributes = &dhDomainTable;
 }
 
-// Add attributes
+// Initialize the attributes of the object
 bool P11DHDomainObj::init(OSObject *inobject)
 {
 	if (initialized) return true;
@@ -1734,31 +1511,6 @@ bool P11DHDomainObj::init(OSObject *inobject)
 	// Create parent
 	if (!P11DomainObj::init(inobject)) return false;
 
-	// Create attributes
-	P11Attribute* attrPrime = new P11AttrPrime(osobject,P11Attribute::ck4);
-	P11Attribute* attrBase = new P11AttrBase(osobject,P11Attribute::ck4);
-	P11Attribute* attrPrimeBits = new P11AttrPrimeBits(osobject);
-
-	// Initialize the attributes
-	if
-	(
-		!attrPrime->init() ||
-		!attrBase->init() ||
-		!attrPrimeBits->init()
-	)
-	{
-		ERROR_MSG("Could not initialize the attribute");
-		delete attrPrime;
-		delete attrBase;
-		delete attrPrimeBits;
-		return false;
-	}
-
-	// Add them to the map
-	attributes[attrPrime->getType()] = attrPrime;
-	attributes[attrBase->getType()] = attrBase;
-	attributes[attrPrimeBits->getType()] = attrPrimeBits;
-
 	initialized = true;
 	return true;
 }
@@ -37,7 +37,16 @@
 #include "P11Attributes.h"
 #include "Token.h"
 #include "cryptoki.h"
-#include <map>
+
+// The attributes introduced by an object class. The attribute descriptors
+// are shared by all objects of the class; the table is chained to the one
+// of the parent class.
+struct P11AttributeTable
+{
+	const P11AttributeTable* parent;
+	P11Attribute* const* attributes;
+	size_t count;
+};
 
 class P11Object
 {
@@ -52,11 +61,14 @@ protected:
 	// The object
 	OSObject* osobject;
 
-	// The attributes
-	std::map<CK_ATTRIBUTE_TYPE, P11Attribute*> attributes;
+	// The attribute table of the most derived class
+	const P11AttributeTable* attributes;
+
+	// Find the attribute descriptor
+	P11Attribute* getAttribute(CK_ATTRIBUTE_TYPE type);
 
 public:
-	// Add attributes
+	// Initialize the attributes of the object
 	virtual bool init(OSObject *inobject);
 
 protected:
@@ -72,6 +84,10 @@ protected:
 	bool isPrivate();
 	bool isCopyable();
 	bool isModifiable();
+
+private:
+	// Set the default values of the attributes in the table and its parents
+	bool initAttributes(const P11AttributeTable* table);
 };
 
 class P11DataObj : public P11Object
@@ -80,7 +96,7 @@ public:
 	// Constructor
 	P11DataObj();
 
-	// Add attributes
+	// Initialize the attributes of the object
 	virtual bool init(OSObject *inobject);
 
 protected:
@@ -93,7 +109,7 @@ protected:
 	// Constructor
 	P11CertificateObj();
 
-	// Add attributes
+	// Initialize the attributes of the object
 	virtual bool init(OSObject *inobject);
 	bool initialized;
 };
@@ -104,7 +120,7 @@ public:
 	// Constructor
 	P11X509CertificateObj();
 
-	// Add attributes
+	// Initialize the attributes of the object
 	virtual bool init(OSObject *inobject);
 
 protected:
@@ -117,7 +133,7 @@ public:
 	// Constructor
 	P11OpenPGPPublicKeyObj();
 
-	// Add attributes
+	// Initialize the attributes of the object
 	virtual bool init(OSObject *inobject);
 
 protected:
@@ -130,7 +146,7 @@ protected:
 	// Constructor
 	P11KeyObj();
 
-	// Add attributes
+	// Initialize the attributes of the object
 	virtual bool init(OSObject *inobject);
 	bool initialized;
 };
@@ -141,7 +157,7 @@ protected:
 	// Constructor
 	P11PublicKeyObj();
 
-	// Add attributes
+	// Initialize the attributes of the object
 	virtual bool init(OSObject *inobject);
 	bool initialized;
 };
@@ -152,7 +168,7 @@ public:
 	// Constructor
 	P11RSAPublicKeyObj();
 
-	// Add attributes
+	// Initialize the attributes of the object
 	virtual bool init(OSObject *inobject);
 
 protected:
@@ -165,7 +181,7 @@ public:
 	// Constructor
 	P11DSAPublicKeyObj();
 
-	// Add attributes
+	// Initialize the attributes of the object
 	virtual bool init(OSObject *inobject);
 
 protected:
@@ -178,7 +194,7 @@ public:
 	// Constructor
 	P11ECPublicKeyObj();
 
-	// Add attributes
+	// Initialize the attributes of the object
 	virtual bool init(OSObject *inobject);
 
 protected:
@@ -191,7 +207,7 @@ public:
 	// Constructor
 	P11DHPublicKeyObj();
 
-	// Add attributes
+	// Initialize the attributes of the object
 	virtual bool init(OSObject *inobject);
 
 protected:
@@ -204,7 +220,7 @@ public:
 	// Constructor
 	P11GOSTPublicKeyObj();
 
-	// Add attributes
+	// Initialize the attributes of the object
 	virtual bool init(OSObject *inobject);
 
 protected:
@@ -217,7 +233,7 @@ protected:
 	// Constructor
 	P11PrivateKeyObj();
 
-	// Add attributes
+	// Initialize the attributes of the object
 	virtual bool init(OSObject *inobject);
 	bool initialized;
 };
@@ -228,7 +244,7 @@ public:
 	// Constructor
 	P11RSAPrivateKeyObj();
 
-	// Add attributes
+	// Initialize the attributes of the object
 	virtual bool init(OSObject *inobject);
 
 protected:
@@ -241,7 +257,7 @@ public:
 	// Constructor
 	P11DSAPrivateKeyObj();
 
-	// Add attributes
+	// Initialize the attributes of the object
 	virtual bool init(OSObject *inobject);
 
 protected:
@@ -254,7 +270,7 @@ public:
 	// Constructor
 	P11ECPrivateKeyObj();
 
-	// Add attributes
+	// Initialize the attributes of the object
 	virtual bool init(OSObject *inobject);
 
 protected:
@@ -267,7 +283,7 @@ public:
 	// Constructor
 	P11DHPrivateKeyObj();
 
-	// Add attributes
+	// Initialize the attributes of the object
 	virtual bool init(OSObject *inobject);
 
 protected:
@@ -280,7 +296,7 @@ public:
 	// Constructor
 	P11GOSTPrivateKeyObj();
 
-	// Add attributes
+	// Initialize the attributes of the object
 	virtual bool init(OSObject *inobject);
 
 protected:
@@ -293,7 +309,7 @@ protected:
 	// Constructor
 	P11SecretKeyObj();
 
-	// Add attributes
+	// Initialize the attributes of the object
 	virtual bool init(OSObject *inobject);
 	bool initialized;
 };
@@ -304,7 +320,7 @@ public:
 	// Constructor
 	P11GenericSecretKeyObj();
 
-	// Add attributes
+	// Initialize the attributes of the object
 	virtual bool init(OSObject *inobject);
 
 	// Better than multiply subclasses
@@ -322,7 +338,7 @@ public:
 	// Constructor
 	P11AESSecretKeyObj();
 
-	// Add attributes
+	// Initialize the attributes of the object
 	virtual bool init(OSObject *inobject);
 
 protected:
@@ -335,7 +351,7 @@ public:
 	// Constructor
 	P11DESSecretKeyObj();
 
-	// Add attributes
+	// Initialize the attributes of the object
 	virtual bool init(OSObject *inobject);
 
 	// Better than multiply subclasses
@@ -353,7 +369,7 @@ public:
 	// Constructor
 	P11GOSTSecretKeyObj();
 
-	// Add attributes
+	// Initialize the attributes of the object
 	virtual bool init(OSObject *inobject);
 
 protected:
@@ -366,7 +382,7 @@ protected:
 	// Constructor
 	P11DomainObj();
 
-	// Add attributes
+	// Initialize the attributes of the object
 	virtual bool init(OSObject *inobject);
 	bool initialized;
 };
@@ -377,7 +393,7 @@ public:
 	// Constructor
 	P11DSADomainObj();
 
-	// Add attributes
+	// Initialize the attributes of the object
 	virtual bool init(OSObject *inobject);
 protected:
 	bool initialized;
@@ -389,7 +405,7 @@ public:
 	// Constructor
 	P11DHDomainObj();
 
-	// Add attributes
+	// Initialize the attributes of the object
 	virtual bool init(OSObject *inobject);
 protected:
 	bool initialized;
@@ -38,6 +38,7 @@
 #include "SimpleConfigLoader.h"
 #include "MutexFactory.h"
 #include "SecureMemoryRegistry.h"
+#include "LoginCache.h"
 #include "CryptoFactory.h"
 #include "AsymmetricAlgorithm.h"
 #include "SymmetricAlgorithm.h"
@@ -58,9 +59,11 @@
 #include "DHPrivateKey.h"
 #include "GOSTPublicKey.h"
 #include "GOSTPrivateKey.h"
+#include "KeyPairPool.h"
 #include "cryptoki.h"
 #include "SoftHSM.h"
 #include "osmutex.h"
+#include "osthread.h"
 #include "SessionManager.h"
 #include "SessionObjectStore.h"
 #include "HandleManager.h"
@@ -74,6 +77,7 @@
 #endif
 
 #include <stdlib.h>
+#include <vector>
 
 // Initialise the one-and-only instance
 
@@ -327,16 +331,20 @@ SoftHSM::SoftHSM()
 	slotManager = NULL;
 	sessionManager = NULL;
 	handleManager = NULL;
+	keyPairPool = NULL;
+	signBatchThreads = 1;
 }
 
 // Destructor
 SoftHSM::~SoftHSM()
 {
+	if (keyPairPool != NULL) delete keyPairPool;
 	if (handleManager != NULL) delete handleManager;
 	if (sessionManager != NULL) delete sessionManager;
 	if (slotManager != NULL) delete slotManager;
 	if (objectStore != NULL) delete objectStore;
 	if (sessionObjectStore != NULL) delete sessionObjectStore;
+	stopLogSink();
 }
 
 /*****************************************************************************
@@ -347,6 +355,7 @@ SoftHSM::~SoftHSM()
 CK_RV SoftHSM::C_Initialize(CK_VOID_PTR pInitArgs)
 {
 	CK_C_INITIALIZE_ARGS_PTR args;
+	bool canCreateThreads = true;
 
 	// Check if PKCS #11 is already initialised
 	if (isInitialised)
@@ -367,11 +376,11 @@ CK_RV SoftHSM::C_Initialize(CK_VOID_PTR pInitArgs)
 		}
 
 		// Can we spawn our own threads?
-		// if (args->flags & CKF_LIBRARY_CANT_CREATE_OS_THREADS)
-		// {
-		//	DEBUG_MSG("Cannot create threads if CKF_LIBRARY_CANT_CREATE_OS_THREADS is set");
-		//	return CKR_NEED_TO_CREATE_THREADS;
-		// }
+		// Only the optional background work needs them.
+		if (args->flags & CKF_LIBRARY_CANT_CREATE_OS_THREADS)
+		{
+			canCreateThreads = false;
+		}
 
 		// Are we not supplied with mutex functions?
 		if
@@ -462,6 +471,17 @@ CK_RV SoftHSM::C_Initialize(CK_VOID_PTR pInitArgs)
 		return CKR_GENERAL_ERROR;
 	}
 
+	// Configure the log levels of the subsystems that have their own
+	for (int subsystem = LOG_SUBSYSTEM_DEFAULT + 1; subsystem < LOG_SUBSYSTEM_COUNT; subsystem++)
+	{
+		std::string logLevel = Configuration::i()->getString(std::string("log.level.") + getLogSubsystemName(subsystem), "");
+
+		if (!logLevel.empty() && !setLogLevel(subsystem, logLevel))
+		{
+			return CKR_GENERAL_ERROR;
+		}
+	}
+
 	// Configure object store storage backend used by all tokens.
 	if (!ObjectStoreToken::selectBackend(Configuration::i()->getString("objectstore.backend", DEFAULT_OBJECTSTORE_BACKEND)))
 	{
@@ -493,6 +513,65 @@ CK_RV SoftHSM::C_Initialize(CK_VOID_PTR pInitArgs)
 	// Load the handle manager
 	handleManager = new HandleManager();
 
+	// Threads can only be started if the application allows it and does
+	// locking, as they share the secure memory and the crypto factory
+	if (!MutexFactory::i()->isEnabled()) canCreateThreads = false;
+
+	// Start generating key pairs in the background if configured
+	int poolThreads = Configuration::i()->getInt("keygen.pool.threads", 1);
+	keyPairPool = new KeyPairPool();
+	keyPairPool->setLifetime(Configuration::i()->getInt("keygen.pool.lifetime", KEY_PAIR_POOL_LIFETIME));
+	if (!keyPairPool->configureRSA(Configuration::i()->getString("keygen.pool.rsa", "")) ||
+	    !keyPairPool->configureEC(Configuration::i()->getString("keygen.pool.ec", "")))
+	{
+		WARNING_MSG("Not using the key pair pool");
+		delete keyPairPool;
+		keyPairPool = NULL;
+	}
+	else if (keyPairPool->isEmpty())
+	{
+		delete keyPairPool;
+		keyPairPool = NULL;
+	}
+	else if (!canCreateThreads)
+	{
+		WARNING_MSG("Not using the key pair pool; the application does not allow threads");
+		delete keyPairPool;
+		keyPairPool = NULL;
+	}
+	else if (poolThreads < 1 || !keyPairPool->start(poolThreads))
+	{
+		WARNING_MSG("Not using the key pair pool");
+		delete keyPairPool;
+		keyPairPool = NULL;
+	}
+
+	// Spread C_SignBatch over the processors unless configured otherwise
+	int batchThreads = Configuration::i()->getInt("sign.batch.threads", 0);
+	if (!canCreateThreads)
+		signBatchThreads = 1;
+	else if (batchThreads > 0)
+		signBatchThreads = batchThreads;
+	else
+		signBatchThreads = OSGetProcessorCount();
+
+	// Remember logins if configured; the cache is kept across C_Finalize
+	int loginCacheTTL = Configuration::i()->getInt("login.cache.ttl", 0);
+	LoginCache::i()->attach(loginCacheTTL > 0 ? loginCacheTTL : 0);
+
+	// Write the log messages to a file or from a thread if configured
+	std::string logFile = Configuration::i()->getString("log.file", "");
+	bool logAsync = Configuration::i()->getBool("log.async", false);
+	if (logAsync && !canCreateThreads)
+	{
+		WARNING_MSG("Logging synchronously; the application does not allow threads");
+		logAsync = false;
+	}
+	if ((!logFile.empty() || logAsync) && !startLogSink(logFile, logAsync))
+	{
+		WARNING_MSG("Logging synchronously to syslog");
+	}
+
 	// Set the state to initialised
 	isInitialised = true;
 
@@ -507,6 +586,9 @@ CK_RV SoftHSM::C_Finalize(CK_VOID_PTR pReserved)
 	// Must be set to NULL_PTR in this version of PKCS#11
 	if (pReserved != NULL_PTR) return CKR_ARGUMENTS_BAD;
 
+	// Wait for the key pairs that are being generated
+	if (keyPairPool != NULL) delete keyPairPool;
+	keyPairPool = NULL;
 	if (handleManager != NULL) delete handleManager;
 	handleManager = NULL;
 	if (sessionManager != NULL) delete sessionManager;
@@ -517,9 +599,13 @@ CK_RV SoftHSM::C_Finalize(CK_VOID_PTR pReserved)
 	objectStore = NULL;
 	if (sessionObjectStore != NULL) delete sessionObjectStore;
 	sessionObjectStore = NULL;
+	LoginCache::i()->detach();
 	CryptoFactory::reset();
 	SecureMemoryRegistry::reset();
 
+	// Write the queued log messages
+	stopLogSink();
+
 	isInitialised = false;
 
 	SoftHSM::reset();
@@ -1175,6 +1261,10 @@ CK_RV SoftHSM::C_CloseSession(CK_SESSION_HANDLE hSession)
 	// Tell the session object store that the session has closed.
 	sessionObjectStore->sessionClosed(hSession);
 
+	// Drop the prepared keys of the session objects that were removed
+	Token* token = session->getToken();
+	if (token != NULL) token->getPrivateKeyCache()->removeClosedSessionObjects();
+
 	// Tell the session manager the session has been closed.
 	return sessionManager->closeSession(session->getHandle());
 }
@@ -1199,6 +1289,7 @@ CK_RV SoftHSM::C_CloseAllSessions(CK_SLOT_ID slotID)
 	// Tell the session object store that all sessions were closed for the given slotID.
 	// The session object store should then remove all session objects for this slot.
 	sessionObjectStore->allSessionsClosed(slotID);
+	token->getPrivateKeyCache()->removeClosedSessionObjects();
 
 	// Finally tell the session manager tho close all sessions for the given slot.
 	// This will also trigger a logout on the associated token to occur.
@@ -1531,6 +1622,10 @@ CK_RV SoftHSM::C_DestroyObject(CK_SESSION_HANDLE hSession, CK_OBJECT_HANDLE hObj
 	// Tell the handleManager to forget about the object.
 	handleManager->destroyObject(hObject);
 
+	// A prepared private key or digest must not outlive its object
+	token->getPrivateKeyCache()->invalidate(object);
+	token->getAttributeIndex()->invalidate(object);
+
 	// Destroy the object
 	if (!object->destroyObject())
 		return CKR_FUNCTION_FAILED;
@@ -1698,6 +1793,35 @@ CK_RV SoftHSM::C_FindObjectsInit(CK_SESSION_HANDLE hSession, CK_ATTRIBUTE_PTR pT
 	token->getObjects(allObjects);
 	sessionObjectStore->getObjects(slot->getSlotID(),allObjects);
 
+	// Private objects are matched on the digests of their decrypted
+	// attributes, so that they do not need to be decrypted for every find
+	AttributeIndex* attributeIndex = token->getAttributeIndex();
+	std::map<CK_ULONG, ByteString> templateDigests;
+	ByteString digestKey;
+	unsigned long digestGeneration = 0;
+	if (!isPublicSession)
+	{
+		for (CK_ULONG i=0; i<ulCount; ++i)
+		{
+			if (!AttributeIndex::isIndexed(pTemplate[i].type) || pTemplate[i].ulValueLen == 0)
+				continue;
+
+			// All digests of this search are computed with the same key
+			if (digestKey.size() == 0 && !attributeIndex->getKey(digestKey, digestGeneration))
+			{
+				delete findOp;
+				return CKR_GENERAL_ERROR;
+			}
+
+			ByteString bsTemplateValue((const unsigned char*)pTemplate[i].pValue, pTemplate[i].ulValueLen);
+			if (!AttributeIndex::digest(digestKey, bsTemplateValue, templateDigests[i]))
+			{
+				delete findOp;
+				return CKR_GENERAL_ERROR;
+			}
+		}
+	}
+
 	std::set<CK_OBJECT_HANDLE> handles;
 	std::set<OSObject*>::iterator it;
 	for (it=allObjects.begin(); it != allObjects.end(); ++it)
@@ -1743,6 +1867,28 @@ CK_RV SoftHSM::C_FindObjectsInit(CK_SESSION_HANDLE hSession, CK_ATTRIBUTE_PTR pT
 				{
 					if (attr.isByteStringAttribute())
 					{
+						std::map<CK_ULONG, ByteString>::iterator digestIt = templateDigests.find(i);
+						if (isPrivateObject && attr.getByteStringValue().size() != 0 && digestIt != templateDigests.end())
+						{
+							ByteString bsAttrDigest;
+							if (!attributeIndex->lookup(*it, pTemplate[i].type, attr.getByteStringValue(), digestGeneration, bsAttrDigest))
+							{
+								ByteString bsAttrValue;
+								if (!token->decrypt(attr.getByteStringValue(), bsAttrValue) ||
+								    !AttributeIndex::digest(digestKey, bsAttrValue, bsAttrDigest))
+								{
+									delete findOp;
+									return CKR_GENERAL_ERROR;
+								}
+								attributeIndex->update(*it, pTemplate[i].type, attr.getByteStringValue(), digestGeneration, bsAttrDigest);
+							}
+							if (bsAttrDigest != digestIt->second)
+								break;
+							// The attribute matched !
+							bAttrMatch = true;
+							continue;
+						}
+
 						ByteString bsAttrValue;
 						if (isPrivateObject && attr.getByteStringValue().size() != 0)
 						{
@@ -1792,6 +1938,9 @@ CK_RV SoftHSM::C_FindObjectsInit(CK_SESSION_HANDLE hSession, CK_ATTRIBUTE_PTR pT
 		}
 	}
 
+	// Drop the digests of objects that no longer exist
+	attributeIndex->prune(allObjects);
+
 	// Storing the object handles for the find will protect the library
 	// whenever a stale object handle is used to access the library.
 	findOp->setHandles(handles);
@@ -2149,6 +2298,15 @@ CK_RV SoftHSM::C_EncryptInit(CK_SESSION_HANDLE hSession, CK_MECHANISM_PTR pMecha
 		return AsymEncryptInit(hSession, pMechanism, hKey);
 }
 
+// Check if the input and the output buffer share memory without being the same
+// buffer, the ciphers can only work in place when both start at the same address
+static bool isPartiallyOverlapping(const CK_BYTE* in, CK_ULONG inLen, const CK_BYTE* out, CK_ULONG outLen)
+{
+	if (in == out) return false;
+
+	return (in < out + outLen) && (out < in + inLen);
+}
+
 // SymAlgorithm version of C_Encrypt
 static CK_RV SymEncrypt(Session* session, CK_BYTE_PTR pData, CK_ULONG ulDataLen, CK_BYTE_PTR pEncryptedData, CK_ULONG_PTR pulEncryptedDataLen)
 {
@@ -2194,29 +2352,36 @@ static CK_RV SymEncrypt(Session* session, CK_BYTE_PTR pData, CK_ULONG ulDataLen,
 		return CKR_BUFFER_TOO_SMALL;
 	}
 
-	// Get the data
-	ByteString data(pData, ulDataLen);
-	ByteString encryptedData;
+	// The cipher cannot read and write buffers that partially overlap
+	ByteString data;
+	if (isPartiallyOverlapping(pData, ulDataLen, pEncryptedData, maxSize))
+	{
+		data = ByteString(pData, ulDataLen);
+		pData = data.byte_str();
+	}
 
-	// Encrypt the data
-	if (!cipher->encryptUpdate(data, encryptedData))
+	// Encrypt the data directly into the output buffer
+	size_t updateLen = maxSize;
+	if (!cipher->encryptUpdate(pData, ulDataLen, pEncryptedData, updateLen))
 	{
 		session->resetOp();
 		return CKR_GENERAL_ERROR;
 	}
 
 	// Finalize encryption
-	ByteString encryptedFinal;
-	if (!cipher->encryptFinal(encryptedFinal))
+	size_t finalLen = maxSize - updateLen;
+	if (!cipher->encryptFinal(pEncryptedData + updateLen, finalLen))
 	{
 		session->resetOp();
 		return CKR_GENERAL_ERROR;
 	}
-	encryptedData += encryptedFinal;
-	encryptedData.resize(maxSize);
 
-	memcpy(pEncryptedData, encryptedData.byte_str(), encryptedData.size());
-	*pulEncryptedDataLen = encryptedData.size();
+	// Pad the output to the size that was announced
+	if (updateLen + finalLen < maxSize)
+	{
+		memset(pEncryptedData + updateLen + finalLen, 0, maxSize - updateLen - finalLen);
+	}
+	*pulEncryptedDataLen = maxSize;
 
 	session->resetOp();
 	return CKR_OK;
@@ -2339,35 +2504,29 @@ static CK_RV SymEncryptUpdate(Session* session, CK_BYTE_PTR pData, CK_ULONG ulDa
 		return CKR_BUFFER_TOO_SMALL;
 	}
 
-	// Get the data
-	ByteString data(pData, ulDataLen);
-	ByteString encryptedData;
-
-	// Encrypt the data
-	if (!cipher->encryptUpdate(data, encryptedData))
+	// The cipher cannot read and write buffers that partially overlap, and
+	// it writes the buffered bytes first, so it only works in place without them
+	ByteString data;
+	if (isPartiallyOverlapping(pData, ulDataLen, pEncryptedData, *pulEncryptedDataLen) ||
+	    (remainingSize > 0 && pData == pEncryptedData))
 	{
-		session->resetOp();
-		return CKR_GENERAL_ERROR;
+		data = ByteString(pData, ulDataLen);
+		pData = data.byte_str();
 	}
-	DEBUG_MSG(
-			"ulDataLen: %#5x  output buffer size: %#5x  blockSize: %#3x  remainingSize: %#4x  maxSize: %#5x  encryptedData.size(): %#5x",
-			ulDataLen, *pulEncryptedDataLen, blockSize, remainingSize, maxSize, encryptedData.size());
 
-	// Check output size from crypto. Unrecoverable error if to large.
-	if (*pulEncryptedDataLen < encryptedData.size())
+	// Encrypt the data directly into the output buffer; the cipher fails if
+	// it would return more data than fits, which is unrecoverable
+	size_t encryptedLen = *pulEncryptedDataLen;
+	if (!cipher->encryptUpdate(pData, ulDataLen, pEncryptedData, encryptedLen))
 	{
 		session->resetOp();
-		ERROR_MSG(
-				"Cipher encryptUpdate returning too much data. Length of output data buffer is %i but %i bytes was returned by the encrypt.",
-				*pulEncryptedDataLen, encryptedData.size());
 		return CKR_GENERAL_ERROR;
 	}
+	DEBUG_MSG(
+			"ulDataLen: %#5x  output buffer size: %#5x  blockSize: %#3x  remainingSize: %#4x  maxSize: %#5x  encryptedLen: %#5x",
+			ulDataLen, *pulEncryptedDataLen, blockSize, remainingSize, maxSize, encryptedLen);
 
-	if (encryptedData.size() > 0)
-	{
-		memcpy(pEncryptedData, encryptedData.byte_str(), encryptedData.size());
-	}
-	*pulEncryptedDataLen = encryptedData.size();
+	*pulEncryptedDataLen = encryptedLen;
 
 	return CKR_OK;
 }
@@ -2742,18 +2901,11 @@ CK_RV SoftHSM::AsymDecryptInit(CK_SESSION_HANDLE hSession, CK_MECHANISM_PTR pMec
 		asymCrypto = CryptoFactory::i()->getAsymmetricAlgorithm(AsymAlgo::RSA);
 		if (asymCrypto == NULL) return CKR_MECHANISM_INVALID;
 
-		privateKey = asymCrypto->newPrivateKey();
-		if (privateKey == NULL)
-		{
-			CryptoFactory::i()->recycleAsymmetricAlgorithm(asymCrypto);
-			return CKR_HOST_MEMORY;
-		}
-
-		if (getRSAPrivateKey((RSAPrivateKey*)privateKey, token, key) != CKR_OK)
+		CK_RV rv = getCachedPrivateKey(AsymAlgo::RSA, asymCrypto, token, key, &privateKey);
+		if (rv != CKR_OK)
 		{
-			asymCrypto->recyclePrivateKey(privateKey);
 			CryptoFactory::i()->recycleAsymmetricAlgorithm(asymCrypto);
-			return CKR_GENERAL_ERROR;
+			return rv == CKR_HOST_MEMORY ? CKR_HOST_MEMORY : CKR_GENERAL_ERROR;
 		}
 	}
 	else
@@ -2766,7 +2918,7 @@ CK_RV SoftHSM::AsymDecryptInit(CK_SESSION_HANDLE hSession, CK_MECHANISM_PTR pMec
 	session->setMechanism(mechanism);
 	session->setAllowMultiPartOp(false);
 	session->setAllowSinglePartOp(true);
-	session->setPrivateKey(privateKey);
+	session->setPrivateKey(privateKey, true);
 
 	return CKR_OK;
 }
@@ -2810,35 +2962,33 @@ static CK_RV SymDecrypt(Session* session, CK_BYTE_PTR pEncryptedData, CK_ULONG u
 		return CKR_BUFFER_TOO_SMALL;
 	}
 
-	// Get the data
-	ByteString encryptedData(pEncryptedData, ulEncryptedDataLen);
-	ByteString data;
+	// The cipher cannot read and write buffers that partially overlap
+	ByteString encryptedData;
+	if (isPartiallyOverlapping(pEncryptedData, ulEncryptedDataLen, pData, ulEncryptedDataLen))
+	{
+		encryptedData = ByteString(pEncryptedData, ulEncryptedDataLen);
+		pEncryptedData = encryptedData.byte_str();
+	}
 
-	// Decrypt the data
-	if (!cipher->decryptUpdate(encryptedData,data))
+	// Decrypt the data directly into the output buffer
+	size_t updateLen = ulEncryptedDataLen;
+	if (!cipher->decryptUpdate(pEncryptedData, ulEncryptedDataLen, pData, updateLen))
 	{
 		session->resetOp();
 		return CKR_GENERAL_ERROR;
 	}
 
 	// Finalize decryption
-	ByteString dataFinal;
-	if (!cipher->decryptFinal(dataFinal))
+	size_t finalLen = ulEncryptedDataLen - updateLen;
+	if (!cipher->decryptFinal(pData + updateLen, finalLen))
 	{
+		// Do not leave the plaintext of a failed decryption behind
+		memset(pData, 0, updateLen);
+
 		session->resetOp();
 		return CKR_GENERAL_ERROR;
 	}
-	data += dataFinal;
-	if (data.size() > ulEncryptedDataLen)
-	{
-		data.resize(ulEncryptedDataLen);
-	}
-
-	if (data.size() != 0)
-	{
-		memcpy(pData, data.byte_str(), data.size());
-	}
-	*pulDataLen = data.size();
+	*pulDataLen = updateLen + finalLen;
 
 	session->resetOp();
 	return CKR_OK;
@@ -2960,35 +3110,29 @@ static CK_RV SymDecryptUpdate(Session* session, CK_BYTE_PTR pEncryptedData, CK_U
 		return CKR_BUFFER_TOO_SMALL;
 	}
 
-	// Get the data
-	ByteString data(pEncryptedData, ulEncryptedDataLen);
-	ByteString decryptedData;
-
-	// Encrypt the data
-	if (!cipher->decryptUpdate(data, decryptedData))
+	// The cipher cannot read and write buffers that partially overlap, and
+	// it writes the buffered bytes first, so it only works in place without them
+	ByteString encryptedData;
+	if (isPartiallyOverlapping(pEncryptedData, ulEncryptedDataLen, pData, *pDataLen) ||
+	    (remainingSize > 0 && pEncryptedData == pData))
 	{
-		session->resetOp();
-		return CKR_GENERAL_ERROR;
+		encryptedData = ByteString(pEncryptedData, ulEncryptedDataLen);
+		pEncryptedData = encryptedData.byte_str();
 	}
-	DEBUG_MSG(
-			"ulEncryptedDataLen: %#5x  output buffer size: %#5x  blockSize: %#3x  remainingSize: %#4x  maxSize: %#5x  decryptedData.size(): %#5x",
-			ulEncryptedDataLen, *pDataLen, blockSize, remainingSize, maxSize, decryptedData.size());
 
-	// Check output size from crypto. Unrecoverable error if to large.
-	if (*pDataLen < decryptedData.size())
+	// Decrypt the data directly into the output buffer; the cipher fails if
+	// it would return more data than fits, which is unrecoverable
+	size_t decryptedLen = *pDataLen;
+	if (!cipher->decryptUpdate(pEncryptedData, ulEncryptedDataLen, pData, decryptedLen))
 	{
 		session->resetOp();
-		ERROR_MSG(
-				"Cipher decryptUpdate returning too much data. Length of output data buffer is %i but %i bytes was returned by the decrypt.",
-				*pDataLen, decryptedData.size());
 		return CKR_GENERAL_ERROR;
 	}
+	DEBUG_MSG(
+			"ulEncryptedDataLen: %#5x  output buffer size: %#5x  blockSize: %#3x  remainingSize: %#4x  maxSize: %#5x  decryptedLen: %#5x",
+			ulEncryptedDataLen, *pDataLen, blockSize, remainingSize, maxSize, decryptedLen);
 
-	if (decryptedData.size() > 0)
-	{
-		memcpy(pData, decryptedData.byte_str(), decryptedData.size());
-	}
-	*pDataLen = decryptedData.size();
+	*pDataLen = decryptedLen;
 
 	return CKR_OK;
 }
@@ -3196,11 +3340,8 @@ CK_RV SoftHSM::C_Digest(CK_SESSION_HANDLE hSession, CK_BYTE_PTR pData, CK_ULONG
 		return CKR_BUFFER_TOO_SMALL;
 	}
 
-	// Get the data
-	ByteString data(pData, ulDataLen);
-
 	// Digest the data
-	if (session->getDigestOp()->hashUpdate(data) == false)
+	if (session->getDigestOp()->hashUpdate(pData, ulDataLen) == false)
 	{
 		session->resetOp();
 		return CKR_GENERAL_ERROR;
@@ -3243,11 +3384,8 @@ CK_RV SoftHSM::C_DigestUpdate(CK_SESSION_HANDLE hSession, CK_BYTE_PTR pPart, CK_
 	// Check if we are doing the correct operation
 	if (session->getOpType() != SESSION_OP_DIGEST) return CKR_OPERATION_NOT_INITIALIZED;
 
-	// Get the data
-	ByteString data(pPart, ulPartLen);
-
 	// Digest the data
-	if (session->getDigestOp()->hashUpdate(data) == false)
+	if (session->getDigestOp()->hashUpdate(pPart, ulPartLen) == false)
 	{
 		session->resetOp();
 		return CKR_GENERAL_ERROR;
@@ -3732,18 +3870,11 @@ CK_RV SoftHSM::AsymSignInit(CK_SESSION_HANDLE hSession, CK_MECHANISM_PTR pMechan
 		asymCrypto = CryptoFactory::i()->getAsymmetricAlgorithm(AsymAlgo::RSA);
 		if (asymCrypto == NULL) return CKR_MECHANISM_INVALID;
 
-		privateKey = asymCrypto->newPrivateKey();
-		if (privateKey == NULL)
-		{
-			CryptoFactory::i()->recycleAsymmetricAlgorithm(asymCrypto);
-			return CKR_HOST_MEMORY;
-		}
-
-		if (getRSAPrivateKey((RSAPrivateKey*)privateKey, token, key) != CKR_OK)
+		CK_RV rv = getCachedPrivateKey(AsymAlgo::RSA, asymCrypto, token, key, &privateKey);
+		if (rv != CKR_OK)
 		{
-			asymCrypto->recyclePrivateKey(privateKey);
 			CryptoFactory::i()->recycleAsymmetricAlgorithm(asymCrypto);
-			return CKR_GENERAL_ERROR;
+			return rv == CKR_HOST_MEMORY ? CKR_HOST_MEMORY : CKR_GENERAL_ERROR;
 		}
 	}
 	else if (isDSA)
@@ -3751,18 +3882,11 @@ CK_RV SoftHSM::AsymSignInit(CK_SESSION_HANDLE hSession, CK_MECHANISM_PTR pMechan
 		asymCrypto = CryptoFactory::i()->getAsymmetricAlgorithm(AsymAlgo::DSA);
 		if (asymCrypto == NULL) return CKR_MECHANISM_INVALID;
 
-		privateKey = asymCrypto->newPrivateKey();
-		if (privateKey == NULL)
-		{
-			CryptoFactory::i()->recycleAsymmetricAlgorithm(asymCrypto);
-			return CKR_HOST_MEMORY;
-		}
-
-		if (getDSAPrivateKey((DSAPrivateKey*)privateKey, token, key) != CKR_OK)
+		CK_RV rv = getCachedPrivateKey(AsymAlgo::DSA, asymCrypto, token, key, &privateKey);
+		if (rv != CKR_OK)
 		{
-			asymCrypto->recyclePrivateKey(privateKey);
 			CryptoFactory::i()->recycleAsymmetricAlgorithm(asymCrypto);
-			return CKR_GENERAL_ERROR;
+			return rv == CKR_HOST_MEMORY ? CKR_HOST_MEMORY : CKR_GENERAL_ERROR;
 		}
         }
 #ifdef WITH_ECC
@@ -3771,18 +3895,11 @@ CK_RV SoftHSM::AsymSignInit(CK_SESSION_HANDLE hSession, CK_MECHANISM_PTR pMechan
 		asymCrypto = CryptoFactory::i()->getAsymmetricAlgorithm(AsymAlgo::ECDSA);
 		if (asymCrypto == NULL) return CKR_MECHANISM_INVALID;
 
-		privateKey = asymCrypto->newPrivateKey();
-		if (privateKey == NULL)
-		{
-			CryptoFactory::i()->recycleAsymmetricAlgorithm(asymCrypto);
-			return CKR_HOST_MEMORY;
-		}
-
-		if (getECPrivateKey((ECPrivateKey*)privateKey, token, key) != CKR_OK)
+		CK_RV rv = getCachedPrivateKey(AsymAlgo::ECDSA, asymCrypto, token, key, &privateKey);
+		if (rv != CKR_OK)
 		{
-			asymCrypto->recyclePrivateKey(privateKey);
 			CryptoFactory::i()->recycleAsymmetricAlgorithm(asymCrypto);
-			return CKR_GENERAL_ERROR;
+			return rv == CKR_HOST_MEMORY ? CKR_HOST_MEMORY : CKR_GENERAL_ERROR;
 		}
 	}
 #endif
@@ -3792,18 +3909,11 @@ CK_RV SoftHSM::AsymSignInit(CK_SESSION_HANDLE hSession, CK_MECHANISM_PTR pMechan
 		asymCrypto = CryptoFactory::i()->getAsymmetricAlgorithm(AsymAlgo::GOST);
 		if (asymCrypto == NULL) return CKR_MECHANISM_INVALID;
 
-		privateKey = asymCrypto->newPrivateKey();
-		if (privateKey == NULL)
-		{
-			CryptoFactory::i()->recycleAsymmetricAlgorithm(asymCrypto);
-			return CKR_HOST_MEMORY;
-		}
-
-		if (getGOSTPrivateKey((GOSTPrivateKey*)privateKey, token, key) != CKR_OK)
+		CK_RV rv = getCachedPrivateKey(AsymAlgo::GOST, asymCrypto, token, key, &privateKey);
+		if (rv != CKR_OK)
 		{
-			asymCrypto->recyclePrivateKey(privateKey);
 			CryptoFactory::i()->recycleAsymmetricAlgorithm(asymCrypto);
-			return CKR_GENERAL_ERROR;
+			return rv == CKR_HOST_MEMORY ? CKR_HOST_MEMORY : CKR_GENERAL_ERROR;
 		}
 #else
 		return CKR_MECHANISM_INVALID;
@@ -3813,7 +3923,7 @@ CK_RV SoftHSM::AsymSignInit(CK_SESSION_HANDLE hSession, CK_MECHANISM_PTR pMechan
 	// Initialize signing
 	if (bAllowMultiPartOp && !asymCrypto->signInit(privateKey,mechanism,param,paramLen))
 	{
-		asymCrypto->recyclePrivateKey(privateKey);
+		token->getPrivateKeyCache()->release(privateKey);
 		CryptoFactory::i()->recycleAsymmetricAlgorithm(asymCrypto);
 		return CKR_MECHANISM_INVALID;
 	}
@@ -3824,7 +3934,7 @@ CK_RV SoftHSM::AsymSignInit(CK_SESSION_HANDLE hSession, CK_MECHANISM_PTR pMechan
 	session->setParameters(param, paramLen);
 	session->setAllowMultiPartOp(bAllowMultiPartOp);
 	session->setAllowSinglePartOp(true);
-	session->setPrivateKey(privateKey);
+	session->setPrivateKey(privateKey, true);
 
 	return CKR_OK;
 }
@@ -3863,11 +3973,8 @@ static CK_RV MacSign(Session* session, CK_BYTE_PTR pData, CK_ULONG ulDataLen, CK
 		return CKR_BUFFER_TOO_SMALL;
 	}
 
-	// Get the data
-	ByteString data(pData, ulDataLen);
-
 	// Sign the data
-	if (!mac->signUpdate(data))
+	if (!mac->signUpdate(pData, ulDataLen))
 	{
 		session->resetOp();
 		return CKR_GENERAL_ERROR;
@@ -3924,32 +4031,38 @@ static CK_RV AsymSign(Session* session, CK_BYTE_PTR pData, CK_ULONG ulDataLen, C
 		return CKR_BUFFER_TOO_SMALL;
 	}
 
-	// Get the data
-	ByteString data;
-
-	// PKCS #11 Mechanisms v2.30: Cryptoki Draft 7 page 32
-	// We must allow input length <= k and therfore need to prepend the data with zeroes.
-	if (mechanism == AsymMech::RSA) {
-		data.wipe(size-ulDataLen);
-	}
-
-	data += ByteString(pData, ulDataLen);
 	ByteString signature;
 
 	// Sign the data
 	if (session->getAllowMultiPartOp())
 	{
-		if (!asymCrypto->signUpdate(data) ||
+		// The data is hashed by the mechanism, so it is read
+		// directly from the buffer of the caller
+		if (!asymCrypto->signUpdate(pData, ulDataLen) ||
 		    !asymCrypto->signFinal(signature))
 		{
 			session->resetOp();
 			return CKR_GENERAL_ERROR;
 		}
 	}
-	else if (!asymCrypto->sign(privateKey,data,signature,mechanism,param,paramLen))
+	else
 	{
-		session->resetOp();
-		return CKR_GENERAL_ERROR;
+		// Get the data
+		ByteString data;
+
+		// PKCS #11 Mechanisms v2.30: Cryptoki Draft 7 page 32
+		// We must allow input length <= k and therfore need to prepend the data with zeroes.
+		if (mechanism == AsymMech::RSA) {
+			data.wipe(size-ulDataLen);
+		}
+
+		data += ByteString(pData, ulDataLen);
+
+		if (!asymCrypto->sign(privateKey,data,signature,mechanism,param,paramLen))
+		{
+			session->resetOp();
+			return CKR_GENERAL_ERROR;
+		}
 	}
 
 	// Check size
@@ -3990,6 +4103,210 @@ CK_RV SoftHSM::C_Sign(CK_SESSION_HANDLE hSession, CK_BYTE_PTR pData, CK_ULONG ul
 				pSignature, pulSignatureLen);
 }
 
+// The algorithm that implements an asymmetric signing mechanism
+static AsymAlgo::Type getSignAlgorithm(AsymMech::Type mechanism)
+{
+	switch (mechanism)
+	{
+		case AsymMech::DSA:
+		case AsymMech::DSA_SHA1:
+		case AsymMech::DSA_SHA224:
+		case AsymMech::DSA_SHA256:
+		case AsymMech::DSA_SHA384:
+		case AsymMech::DSA_SHA512:
+			return AsymAlgo::DSA;
+		case AsymMech::ECDSA:
+			return AsymAlgo::ECDSA;
+		case AsymMech::GOST:
+		case AsymMech::GOST_GOST:
+			return AsymAlgo::GOST;
+		default:
+			return AsymAlgo::RSA;
+	}
+}
+
+// The signatures of a batch that are made by one thread
+struct SignBatchPart
+{
+	AsymAlgo::Type algorithm;
+	AsymMech::Type mechanism;
+	const void* param;
+	size_t paramLen;
+	bool isMultiPart;
+	PrivateKey* privateKey;
+	size_t size;
+	CK_ULONG first;
+	CK_ULONG step;
+	CK_ULONG count;
+	CK_BYTE_PTR* ppData;
+	CK_ULONG_PTR pulDataLen;
+	CK_BYTE_PTR* ppSignature;
+	CK_ULONG_PTR pulSignatureLen;
+	CK_VOID_PTR thread;
+	CK_RV rv;
+};
+
+// Make every step-th signature of the batch, starting at the first
+static void* signBatchPart(void* arg)
+{
+	SignBatchPart* part = (SignBatchPart*) arg;
+
+	// Each thread needs its own algorithm instance; the prepared private
+	// key is shared, as it is between sessions
+	AsymmetricAlgorithm* asymCrypto = CryptoFactory::i()->getAsymmetricAlgorithm(part->algorithm);
+	if (asymCrypto == NULL)
+	{
+		part->rv = CKR_GENERAL_ERROR;
+		return NULL;
+	}
+
+	part->rv = CKR_OK;
+	for (CK_ULONG i = part->first; i < part->count; i += part->step)
+	{
+		ByteString signature;
+		bool isSigned;
+
+		if (part->isMultiPart)
+		{
+			// The data is hashed by the mechanism, so it is read
+			// directly from the buffer of the caller
+			isSigned = asymCrypto->signInit(part->privateKey, part->mechanism, part->param, part->paramLen) &&
+				   asymCrypto->signUpdate(part->ppData[i], part->pulDataLen[i]) &&
+				   asymCrypto->signFinal(signature);
+		}
+		else
+		{
+			ByteString data;
+
+			// We must allow input length <= k and therfore need to prepend the data with zeroes.
+			if (part->mechanism == AsymMech::RSA) {
+				data.wipe(part->size - part->pulDataLen[i]);
+			}
+
+			data += ByteString(part->ppData[i], part->pulDataLen[i]);
+
+			isSigned = asymCrypto->sign(part->privateKey, data, signature, part->mechanism, part->param, part->paramLen);
+		}
+
+		if (!isSigned || signature.size() != part->size)
+		{
+			ERROR_MSG("Could not make signature %lu of the batch", i);
+			part->rv = CKR_GENERAL_ERROR;
+			break;
+		}
+
+		memcpy(part->ppSignature[i], signature.byte_str(), part->size);
+		part->pulSignatureLen[i] = part->size;
+	}
+
+	CryptoFactory::i()->recycleAsymmetricAlgorithm(asymCrypto);
+
+	return NULL;
+}
+
+// Sign a batch of messages with the same key and mechanism
+CK_RV SoftHSM::C_SignBatch(CK_SESSION_HANDLE hSession, CK_MECHANISM_PTR pMechanism, CK_OBJECT_HANDLE hKey, CK_ULONG ulCount, CK_BYTE_PTR* ppData, CK_ULONG_PTR pulDataLen, CK_BYTE_PTR* ppSignature, CK_ULONG_PTR pulSignatureLen)
+{
+	if (!isInitialised) return CKR_CRYPTOKI_NOT_INITIALIZED;
+
+	if (ulCount > 0 && (ppData == NULL_PTR || pulDataLen == NULL_PTR || pulSignatureLen == NULL_PTR))
+		return CKR_ARGUMENTS_BAD;
+	for (CK_ULONG i = 0; i < ulCount; i++)
+	{
+		if (ppData[i] == NULL_PTR && pulDataLen[i] != 0) return CKR_ARGUMENTS_BAD;
+		if (ppSignature != NULL_PTR && ppSignature[i] == NULL_PTR) return CKR_ARGUMENTS_BAD;
+	}
+
+	// Check the key and mechanism and prepare the key as for C_SignInit
+	CK_RV rv = AsymSignInit(hSession, pMechanism, hKey);
+	if (rv != CKR_OK) return rv;
+
+	Session* session = (Session*)handleManager->getSession(hSession);
+	if (session == NULL) return CKR_SESSION_HANDLE_INVALID;
+
+	SignBatchPart batch;
+	batch.mechanism = session->getMechanism();
+	batch.algorithm = getSignAlgorithm(batch.mechanism);
+	batch.param = session->getParameters(batch.paramLen);
+	batch.isMultiPart = session->getAllowMultiPartOp();
+	batch.privateKey = session->getPrivateKey();
+	batch.size = batch.privateKey->getOutputLength();
+	batch.first = 0;
+	batch.step = 1;
+	batch.count = ulCount;
+	batch.ppData = ppData;
+	batch.pulDataLen = pulDataLen;
+	batch.ppSignature = ppSignature;
+	batch.pulSignatureLen = pulSignatureLen;
+	batch.thread = NULL_PTR;
+	batch.rv = CKR_OK;
+
+	// Size of the signatures
+	bool isTooSmall = false;
+	for (CK_ULONG i = 0; i < ulCount; i++)
+	{
+		if (batch.mechanism == AsymMech::RSA && pulDataLen[i] > batch.size)
+		{
+			session->resetOp();
+			return CKR_DATA_LEN_RANGE;
+		}
+
+		if (ppSignature != NULL_PTR && pulSignatureLen[i] < batch.size)
+		{
+			isTooSmall = true;
+		}
+	}
+	if (ppSignature == NULL_PTR || isTooSmall)
+	{
+		for (CK_ULONG i = 0; i < ulCount; i++)
+		{
+			pulSignatureLen[i] = batch.size;
+		}
+
+		session->resetOp();
+		return isTooSmall ? CKR_BUFFER_TOO_SMALL : CKR_OK;
+	}
+
+	// Interleave the signatures over the threads; the calling thread
+	// makes the first part
+	CK_ULONG threads = signBatchThreads < ulCount ? signBatchThreads : ulCount;
+	std::vector<SignBatchPart> parts(threads > 0 ? threads : 1, batch);
+	for (CK_ULONG i = 0; i < parts.size(); i++)
+	{
+		parts[i].first = i;
+		parts[i].step = parts.size();
+
+		if (i > 0 && OSCreateThread(&parts[i].thread, signBatchPart, &parts[i]) != CKR_OK)
+		{
+			parts[i].thread = NULL_PTR;
+		}
+	}
+
+	signBatchPart(&parts[0]);
+
+	for (CK_ULONG i = 1; i < parts.size(); i++)
+	{
+		// Make the part here if its thread could not be started
+		if (parts[i].thread == NULL_PTR)
+		{
+			signBatchPart(&parts[i]);
+		}
+		else
+		{
+			OSJoinThread(parts[i].thread);
+		}
+	}
+
+	session->resetOp();
+
+	for (CK_ULONG i = 0; i < parts.size(); i++)
+	{
+		if (parts[i].rv != CKR_OK) return parts[i].rv;
+	}
+
+	return CKR_OK;
+}
+
 // MacAlgorithm version of C_SignUpdate
 static CK_RV MacSignUpdate(Session* session, CK_BYTE_PTR pPart, CK_ULONG ulPartLen)
 {
@@ -4000,11 +4317,8 @@ static CK_RV MacSignUpdate(Session* session, CK_BYTE_PTR pPart, CK_ULONG ulPartL
 		return CKR_OPERATION_NOT_INITIALIZED;
 	}
 
-	// Get the part
-	ByteString part(pPart, ulPartLen);
-
 	// Sign the data
-	if (!mac->signUpdate(part))
+	if (!mac->signUpdate(pPart, ulPartLen))
 	{
 		session->resetOp();
 		return CKR_GENERAL_ERROR;
@@ -4024,11 +4338,8 @@ static CK_RV AsymSignUpdate(Session* session, CK_BYTE_PTR pPart, CK_ULONG ulPart
 		return CKR_OPERATION_NOT_INITIALIZED;
 	}
 
-	// Get the part
-	ByteString part(pPart, ulPartLen);
-
 	// Sign the data
-	if (!asymCrypto->signUpdate(part))
+	if (!asymCrypto->signUpdate(pPart, ulPartLen))
 	{
 		session->resetOp();
 		return CKR_GENERAL_ERROR;
@@ -4667,11 +4978,8 @@ static CK_RV MacVerify(Session* session, CK_BYTE_PTR pData, CK_ULONG ulDataLen,
 		return CKR_SIGNATURE_LEN_RANGE;
 	}
 
-	// Get the data
-	ByteString data(pData, ulDataLen);
-
 	// Verify the data
-	if (!mac->verifyUpdate(data))
+	if (!mac->verifyUpdate(pData, ulDataLen))
 	{
 		session->resetOp();
 		return CKR_GENERAL_ERROR;
@@ -4716,32 +5024,38 @@ static CK_RV AsymVerify(Session* session, CK_BYTE_PTR pData, CK_ULONG ulDataLen,
 		return CKR_SIGNATURE_LEN_RANGE;
 	}
 
-	// Get the data
-	ByteString data;
-
-	// PKCS #11 Mechanisms v2.30: Cryptoki Draft 7 page 32
-	// We must allow input length <= k and therfore need to prepend the data with zeroes.
-	if (mechanism == AsymMech::RSA) {
-		data.wipe(size-ulDataLen);
-	}
-
-	data += ByteString(pData, ulDataLen);
 	ByteString signature(pSignature, ulSignatureLen);
 
 	// Verify the data
 	if (session->getAllowMultiPartOp())
 	{
-		if (!asymCrypto->verifyUpdate(data) ||
+		// The data is hashed by the mechanism, so it is read
+		// directly from the buffer of the caller
+		if (!asymCrypto->verifyUpdate(pData, ulDataLen) ||
 		    !asymCrypto->verifyFinal(signature))
 		{
 			session->resetOp();
 			return CKR_SIGNATURE_INVALID;
 		}
 	}
-	else if (!asymCrypto->verify(publicKey,data,signature,mechanism,param,paramLen))
+	else
 	{
-		session->resetOp();
-		return CKR_SIGNATURE_INVALID;
+		// Get the data
+		ByteString data;
+
+		// PKCS #11 Mechanisms v2.30: Cryptoki Draft 7 page 32
+		// We must allow input length <= k and therfore need to prepend the data with zeroes.
+		if (mechanism == AsymMech::RSA) {
+			data.wipe(size-ulDataLen);
+		}
+
+		data += ByteString(pData, ulDataLen);
+
+		if (!asymCrypto->verify(publicKey,data,signature,mechanism,param,paramLen))
+		{
+			session->resetOp();
+			return CKR_SIGNATURE_INVALID;
+		}
 	}
 
 	session->resetOp();
@@ -4782,11 +5096,8 @@ static CK_RV MacVerifyUpdate(Session* session, CK_BYTE_PTR pPart, CK_ULONG ulPar
 		return CKR_OPERATION_NOT_INITIALIZED;
 	}
 
-	// Get the part
-	ByteString part(pPart, ulPartLen);
-
 	// Verify the data
-	if (!mac->verifyUpdate(part))
+	if (!mac->verifyUpdate(pPart, ulPartLen))
 	{
 		// verifyUpdate can't fail for a logical reason, so we assume total breakdown.
 		session->resetOp();
@@ -4807,11 +5118,8 @@ static CK_RV AsymVerifyUpdate(Session* session, CK_BYTE_PTR pPart, CK_ULONG ulPa
 		return CKR_OPERATION_NOT_INITIALIZED;
 	}
 
-	// Get the part
-	ByteString part(pPart, ulPartLen);
-
 	// Verify the data
-	if (!asymCrypto->verifyUpdate(part))
+	if (!asymCrypto->verifyUpdate(pPart, ulPartLen))
 	{
 		// verifyUpdate can't fail for a logical reason, so we assume total breakdown.
 		session->resetOp();
@@ -5771,33 +6079,30 @@ CK_RV SoftHSM::UnwrapKeyAsym
 	AsymmetricAlgorithm* cipher = CryptoFactory::i()->getAsymmetricAlgorithm(algo);
 	if (cipher == NULL) return CKR_MECHANISM_INVALID;
 
-	PrivateKey* unwrappingkey = cipher->newPrivateKey();
-	if (unwrappingkey == NULL)
-	{
-		CryptoFactory::i()->recycleAsymmetricAlgorithm(cipher);
-		return CKR_HOST_MEMORY;
-	}
+	PrivateKey* unwrappingkey = NULL;
+	CK_RV rv;
 
 	switch(pMechanism->mechanism) {
 		case CKM_RSA_PKCS:
 		case CKM_RSA_PKCS_OAEP:
-			if (getRSAPrivateKey((RSAPrivateKey*)unwrappingkey, token, unwrapKey) != CKR_OK)
+			rv = getCachedPrivateKey(algo, cipher, token, unwrapKey, &unwrappingkey);
+			if (rv != CKR_OK)
 			{
-				cipher->recyclePrivateKey(unwrappingkey);
 				CryptoFactory::i()->recycleAsymmetricAlgorithm(cipher);
-				return CKR_GENERAL_ERROR;
+				return rv == CKR_HOST_MEMORY ? CKR_HOST_MEMORY : CKR_GENERAL_ERROR;
 			}
 			break;
 
 		default:
+			CryptoFactory::i()->recycleAsymmetricAlgorithm(cipher);
 			return CKR_MECHANISM_INVALID;
 	}
 
 	// Unwrap the key
-	CK_RV rv = CKR_OK;
+	rv = CKR_OK;
 	if (!cipher->unwrapKey(unwrappingkey, wrapped, keydata, mode))
 		rv = CKR_GENERAL_ERROR;
-	cipher->recyclePrivateKey(unwrappingkey);
+	token->getPrivateKeyCache()->release(unwrappingkey);
 	CryptoFactory::i()->recycleAsymmetricAlgorithm(cipher);
 	return rv;
 }
@@ -6295,15 +6600,8 @@ CK_RV SoftHSM::C_GenerateRandom(CK_SESSION_HANDLE hSession, CK_BYTE_PTR pRandomD
 	RNG* rng = CryptoFactory::i()->getRNG();
 	if (rng == NULL) return CKR_GENERAL_ERROR;
 
-	// Generate random data
-	ByteString randomData;
-	if (!rng->generateRandom(randomData, ulRandomLen)) return CKR_GENERAL_ERROR;
-
-	// Return random data
-	if (ulRandomLen != 0)
-	{
-		memcpy(pRandomData, randomData.byte_str(), ulRandomLen);
-	}
+	// Generate random data straight into the buffer of the caller
+	if (!rng->generateRandom(pRandomData, ulRandomLen)) return CKR_GENERAL_ERROR;
 
 	return CKR_OK;
 }
@@ -7096,7 +7394,9 @@ CK_RV SoftHSM::generateRSA
 	AsymmetricAlgorithm* rsa = CryptoFactory::i()->getAsymmetricAlgorithm(AsymAlgo::RSA);
 	if (rsa == NULL)
 		return CKR_GENERAL_ERROR;
-	if (!rsa->generateKeyPair(&kp, &p))
+	if (keyPairPool != NULL)
+		kp = keyPairPool->takeRSA(p);
+	if (kp == NULL && !rsa->generateKeyPair(&kp, &p))
 	{
 		ERROR_MSG("Could not generate key pair");
 		CryptoFactory::i()->recycleAsymmetricAlgorithm(rsa);
@@ -7809,7 +8109,9 @@ CK_RV SoftHSM::generateEC
 	AsymmetricKeyPair* kp = NULL;
 	AsymmetricAlgorithm* ec = CryptoFactory::i()->getAsymmetricAlgorithm(AsymAlgo::ECDSA);
 	if (ec == NULL) return CKR_GENERAL_ERROR;
-	if (!ec->generateKeyPair(&kp, &p))
+	if (keyPairPool != NULL)
+		kp = keyPairPool->takeEC(p);
+	if (kp == NULL && !ec->generateKeyPair(&kp, &p))
 	{
 		ERROR_MSG("Could not generate key pair");
 		CryptoFactory::i()->recycleAsymmetricAlgorithm(ec);
@@ -9953,17 +10255,27 @@ CK_RV SoftHSM::getRSAPrivateKey(RSAPrivateKey* privateKey, Token* token, OSObjec
 	ByteString coefficient;
 	if (isKeyPrivate)
 	{
-		bool bOK = true;
-		bOK = bOK && token->decrypt(key->getByteStringValue(CKA_MODULUS), modulus);
-		bOK = bOK && token->decrypt(key->getByteStringValue(CKA_PUBLIC_EXPONENT), publicExponent);
-		bOK = bOK && token->decrypt(key->getByteStringValue(CKA_PRIVATE_EXPONENT), privateExponent);
-		bOK = bOK && token->decrypt(key->getByteStringValue(CKA_PRIME_1), prime1);
-		bOK = bOK && token->decrypt(key->getByteStringValue(CKA_PRIME_2), prime2);
-		bOK = bOK && token->decrypt(key->getByteStringValue(CKA_EXPONENT_1), exponent1);
-		bOK = bOK && token->decrypt(key->getByteStringValue(CKA_EXPONENT_2), exponent2);
-		bOK = bOK && token->decrypt(key->getByteStringValue(CKA_COEFFICIENT), coefficient);
-		if (!bOK)
+		// Decrypt all components in one go
+		std::vector<ByteString> encrypted;
+		std::vector<ByteString> decrypted;
+		encrypted.push_back(key->getByteStringValue(CKA_MODULUS));
+		encrypted.push_back(key->getByteStringValue(CKA_PUBLIC_EXPONENT));
+		encrypted.push_back(key->getByteStringValue(CKA_PRIVATE_EXPONENT));
+		encrypted.push_back(key->getByteStringValue(CKA_PRIME_1));
+		encrypted.push_back(key->getByteStringValue(CKA_PRIME_2));
+		encrypted.push_back(key->getByteStringValue(CKA_EXPONENT_1));
+		encrypted.push_back(key->getByteStringValue(CKA_EXPONENT_2));
+		encrypted.push_back(key->getByteStringValue(CKA_COEFFICIENT));
+		if (!token->decrypt(encrypted, decrypted))
 			return CKR_GENERAL_ERROR;
+		modulus = decrypted[0];
+		publicExponent = decrypted[1];
+		privateExponent = decrypted[2];
+		prime1 = decrypted[3];
+		prime2 = decrypted[4];
+		exponent1 = decrypted[5];
+		exponent2 = decrypted[6];
+		coefficient = decrypted[7];
 	}
 	else
 	{
@@ -10294,6 +10606,116 @@ CK_RV SoftHSM::getGOSTPublicKey(GOSTPublicKey* publicKey, Token* token, OSObject
 	return CKR_OK;
 }
 
+// Get the prepared private key for the object from the token's private key
+// cache; the key is constructed and added to the cache when it is not there
+CK_RV SoftHSM::getCachedPrivateKey(AsymAlgo::Type algorithm, AsymmetricAlgorithm* asymCrypto, Token* token, OSObject* key, PrivateKey** privateKey)
+{
+	if (asymCrypto == NULL) return CKR_ARGUMENTS_BAD;
+	if (token == NULL) return CKR_ARGUMENTS_BAD;
+	if (key == NULL) return CKR_ARGUMENTS_BAD;
+	if (privateKey == NULL) return CKR_ARGUMENTS_BAD;
+
+	// The stored (possibly encrypted) key material identifies the key
+	ByteString checkValue;
+	if (!getPrivateKeyCheckValue(algorithm, key, checkValue))
+		return CKR_GENERAL_ERROR;
+
+	PrivateKeyCache* cache = token->getPrivateKeyCache();
+	*privateKey = cache->get(key, algorithm, checkValue);
+	if (*privateKey != NULL) return CKR_OK;
+
+	PrivateKey* newKey = asymCrypto->newPrivateKey();
+	if (newKey == NULL) return CKR_HOST_MEMORY;
+
+	CK_RV rv;
+	switch (algorithm)
+	{
+		case AsymAlgo::RSA:
+			rv = getRSAPrivateKey((RSAPrivateKey*)newKey, token, key);
+			break;
+		case AsymAlgo::DSA:
+			rv = getDSAPrivateKey((DSAPrivateKey*)newKey, token, key);
+			break;
+		case AsymAlgo::ECDSA:
+			rv = getECPrivateKey((ECPrivateKey*)newKey, token, key);
+			break;
+		case AsymAlgo::GOST:
+			rv = getGOSTPrivateKey((GOSTPrivateKey*)newKey, token, key);
+			break;
+		default:
+			rv = CKR_MECHANISM_INVALID;
+			break;
+	}
+
+	if (rv == CKR_OK && !newKey->prepare())
+	{
+		ERROR_MSG("Could not prepare the private key");
+		rv = CKR_GENERAL_ERROR;
+	}
+
+	if (rv != CKR_OK)
+	{
+		asymCrypto->recyclePrivateKey(newKey);
+		return rv;
+	}
+
+	*privateKey = cache->add(key, algorithm, checkValue, newKey);
+
+	return CKR_OK;
+}
+
+// Compute the value that is used to detect changes to a cached private key
+bool SoftHSM::getPrivateKeyCheckValue(AsymAlgo::Type algorithm, OSObject* key, ByteString& checkValue)
+{
+	static const CK_ATTRIBUTE_TYPE rsaAttributes[] = {
+		CKA_MODULUS, CKA_PUBLIC_EXPONENT, CKA_PRIVATE_EXPONENT,
+		CKA_PRIME_1, CKA_PRIME_2, CKA_EXPONENT_1, CKA_EXPONENT_2,
+		CKA_COEFFICIENT
+	};
+	static const CK_ATTRIBUTE_TYPE dsaAttributes[] = {
+		CKA_PRIME, CKA_SUBPRIME, CKA_BASE, CKA_VALUE
+	};
+	static const CK_ATTRIBUTE_TYPE ecAttributes[] = {
+		CKA_EC_PARAMS, CKA_VALUE
+	};
+	static const CK_ATTRIBUTE_TYPE gostAttributes[] = {
+		CKA_VALUE, CKA_GOSTR3410_PARAMS
+	};
+
+	const CK_ATTRIBUTE_TYPE* attributes;
+	size_t count;
+	switch (algorithm)
+	{
+		case AsymAlgo::RSA:
+			attributes = rsaAttributes;
+			count = sizeof(rsaAttributes) / sizeof(rsaAttributes[0]);
+			break;
+		case AsymAlgo::DSA:
+			attributes = dsaAttributes;
+			count = sizeof(dsaAttributes) / sizeof(dsaAttributes[0]);
+			break;
+		case AsymAlgo::ECDSA:
+			attributes = ecAttributes;
+			count = sizeof(ecAttributes) / sizeof(ecAttributes[0]);
+			break;
+		case AsymAlgo::GOST:
+			attributes = gostAttributes;
+			count = sizeof(gostAttributes) / sizeof(gostAttributes[0]);
+			break;
+		default:
+			return false;
+	}
+
+	checkValue.wipe();
+	checkValue += (unsigned char)(key->getBooleanValue(CKA_PRIVATE, false) ? 1 : 0);
+	for (size_t i = 0; i < count; i++)
+	{
+		checkValue += key->getByteStringValue(attributes[i]).serialise();
+	}
+
+	return true;
+}
+
 CK_RV SoftHSM::getSymmetricKey(SymmetricKey* skey, Token* token, OSObject* key)
 {
 	if (skey == NULL) return CKR_ARGUMENTS_BAD;
@@ -50,6 +50,7 @@
 #include "DHPrivateKey.h"
 #include "GOSTPublicKey.h"
 #include "GOSTPrivateKey.h"
+#include "KeyPairPool.h"
 
 #include <memory>
 
@@ -170,6 +171,9 @@ public:
 	CK_RV C_CancelFunction(CK_SESSION_HANDLE hSession);
 	CK_RV C_WaitForSlotEvent(CK_FLAGS flags, CK_SLOT_ID_PTR pSlot, CK_VOID_PTR pReserved);
 
+	// SoftHSM vendor extensions
+	CK_RV C_SignBatch(CK_SESSION_HANDLE hSession, CK_MECHANISM_PTR pMechanism, CK_OBJECT_HANDLE hKey, CK_ULONG ulCount, CK_BYTE_PTR* ppData, CK_ULONG_PTR pulDataLen, CK_BYTE_PTR* ppSignature, CK_ULONG_PTR pulSignatureLen);
+
 private:
 	// Constructor
 	SoftHSM();
@@ -190,6 +194,10 @@ private:
 	SlotManager* slotManager;
 	SessionManager* sessionManager;
 	HandleManager* handleManager;
+	KeyPairPool* keyPairPool;
+
+	// The number of threads that C_SignBatch uses
+	unsigned long signBatchThreads;
 
 	// Encrypt/Decrypt variants
 	CK_RV SymEncryptInit(CK_SESSION_HANDLE hSession, CK_MECHANISM_PTR pMechanism, CK_OBJECT_HANDLE hKey);
@@ -384,6 +392,8 @@ private:
 	CK_RV getGOSTPrivateKey(GOSTPrivateKey* privateKey, Token* token, OSObject* key);
 	CK_RV getGOSTPublicKey(GOSTPublicKey* publicKey, Token* token, OSObject* key);
 	CK_RV getSymmetricKey(SymmetricKey* skey, Token* token, OSObject* key);
+	CK_RV getCachedPrivateKey(AsymAlgo::Type algorithm, AsymmetricAlgorithm* asymCrypto, Token* token, OSObject* key, PrivateKey** privateKey);
+	bool getPrivateKeyCheckValue(AsymAlgo::Type algorithm, OSObject* key, ByteString& checkValue);
 
 	bool setRSAPrivateKey(OSObject* key, const ByteString &ber, Token* token, bool isPrivate) const;
 	bool setDSAPrivateKey(OSObject* key, const ByteString &ber, Token* token, bool isPrivate) const;
@@ -46,8 +46,26 @@ std::auto_ptr<Configuration> Configuration::instance(NULL);
 const struct config Configuration::valid_config[] = {
 	{ "directories.tokendir",	CONFIG_TYPE_STRING },
 	{ "objectstore.backend",	CONFIG_TYPE_STRING },
+	{ "objectstore.monitor",	CONFIG_TYPE_BOOL },
+	{ "objectstore.genpage",	CONFIG_TYPE_BOOL },
+	{ "objectstore.db.wal",		CONFIG_TYPE_BOOL },
+	{ "objectstore.db.synchronous",	CONFIG_TYPE_STRING },
+	{ "objectstore.db.checkpoint",	CONFIG_TYPE_INT },
+	{ "objectstore.db.readers",	CONFIG_TYPE_INT },
 	{ "log.level",			CONFIG_TYPE_STRING },
+	{ "log.level.object_store",	CONFIG_TYPE_STRING },
+	{ "log.level.crypto",		CONFIG_TYPE_STRING },
+	{ "log.level.session",		CONFIG_TYPE_STRING },
+	{ "log.level.handle",		CONFIG_TYPE_STRING },
+	{ "log.file",			CONFIG_TYPE_STRING },
+	{ "log.async",			CONFIG_TYPE_BOOL },
 	{ "slots.removable",		CONFIG_TYPE_BOOL },
+	{ "keygen.pool.rsa",		CONFIG_TYPE_STRING },
+	{ "keygen.pool.ec",		CONFIG_TYPE_STRING },
+	{ "keygen.pool.threads",	CONFIG_TYPE_INT },
+	{ "keygen.pool.lifetime",	CONFIG_TYPE_INT },
+	{ "sign.batch.threads",		CONFIG_TYPE_INT },
+	{ "login.cache.ttl",		CONFIG_TYPE_INT },
 	{ "",				CONFIG_TYPE_UNSUPPORTED }
 };
 
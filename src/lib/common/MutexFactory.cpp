@@ -161,6 +161,11 @@ void MutexFactory::disable()
 	enabled = false;
 }
 
+bool MutexFactory::isEnabled()
+{
+	return enabled;
+}
+
 CK_RV MutexFactory::CreateMutex(CK_VOID_PTR_PTR newMutex)
 {
 	if (!enabled) return CKR_OK;
@@ -100,6 +100,9 @@ public:
 	void enable();
 	void disable();
 
+	// Is mutex handling enabled?
+	bool isEnabled();
+
 private:
 	// Constructor
 	MutexFactory();
@@ -36,74 +36,518 @@
 #include <stdarg.h>
 #include <syslog.h>
 #include <stdio.h>
-#include <sstream>
-#include <vector>
+#include <time.h>
+#ifdef HAVE_PTHREAD_H
+#include <pthread.h>
+#include <unistd.h>
+#elif _WIN32
+#include <windows.h>
+#endif
 #include "log.h"
+#include "osthread.h"
 
-int softLogLevel = LOG_DEBUG;
+// Messages that are written by the caller are formatted into a buffer of this size
+#define LOG_MESSAGE_SIZE 4096
 
-bool setLogLevel(const std::string &loglevel)
+int softLogLevels[LOG_SUBSYSTEM_COUNT] = { LOG_DEBUG, LOG_DEBUG, LOG_DEBUG, LOG_DEBUG, LOG_DEBUG };
+
+// The names of the subsystems in the configuration, as in log.level.crypto
+static const char* const logSubsystemNames[LOG_SUBSYSTEM_COUNT] = { NULL, "object_store", "crypto", "session", "handle" };
+
+// The log file; messages are sent to syslog if it is not open
+static FILE* logFile = NULL;
+
+// The queued messages are written by a thread if the compiler has atomic operations
+#ifdef __GNUC__
+#define SOFTHSM_LOG_RING
+
+// The number of messages that can be queued (a power of two)
+#define LOG_RING_SIZE 512
+
+// Longer queued messages are truncated
+#define LOG_SLOT_SIZE 1024
+
+struct LogSlot
+{
+	// The position of the slot in the ring when it is free, and one more when it holds a message
+	volatile unsigned long sequence;
+	int loglevel;
+	time_t timestamp;
+	char message[LOG_SLOT_SIZE];
+};
+
+// The slots are reserved by the callers without a lock, and freed by the thread
+static LogSlot logRing[LOG_RING_SIZE];
+static volatile unsigned long logEnqueuePos = 0;
+static unsigned long logDequeuePos = 0;
+
+// The messages that did not fit in the ring
+static volatile unsigned long logDropped = 0;
+
+// Set while the thread runs
+static volatile bool logAsync = false;
+static volatile bool logSinkStopping = false;
+static CK_VOID_PTR logSinkThread = NULL;
+#ifdef HAVE_PTHREAD_H
+static bool logAtForkRegistered = false;
+#endif
+
+// The number of callers that are queueing a message
+static volatile unsigned long logWriters = 0;
+
+// The thread sleeps on a condition variable while the ring is empty, and
+// the callers only take the mutex to wake it up when it waits
+static volatile bool logSinkWaiting = false;
+static CK_VOID_PTR logSinkCondition = NULL;
+#endif // __GNUC__
+
+static bool parseLogLevel(const std::string &loglevel, int &level)
 {
 	if (loglevel == "ERROR")
 	{
-		softLogLevel = LOG_ERR;
+		level = LOG_ERR;
 	}
 	else if (loglevel == "WARNING")
 	{
-		softLogLevel = LOG_WARNING;
+		level = LOG_WARNING;
 	}
 	else if (loglevel == "INFO")
 	{
-		softLogLevel = LOG_INFO;
+		level = LOG_INFO;
 	}
 	else if (loglevel == "DEBUG")
 	{
-		softLogLevel = LOG_DEBUG;
+		level = LOG_DEBUG;
 	}
 	else
+	{
+		return false;
+	}
+
+	return true;
+}
+
+// Set the log level of all subsystems
+bool setLogLevel(const std::string &loglevel)
+{
+	int level;
+
+	if (!parseLogLevel(loglevel, level))
 	{
 		ERROR_MSG("Unknown value (%s) for log.level in configuration", loglevel.c_str());
 		return false;
 	}
 
+	for (int i = 0; i < LOG_SUBSYSTEM_COUNT; i++)
+	{
+		softLogLevels[i] = level;
+	}
+
 	return true;
 }
 
-void softHSMLog(const int loglevel, const char* functionName, const char* fileName, const int lineNo, const char* format, ...)
+// Set the log level of one subsystem
+bool setLogLevel(const int subsystem, const std::string &loglevel)
 {
-	if (loglevel > softLogLevel) return;
+	int level;
+
+	if (subsystem < 0 || subsystem >= LOG_SUBSYSTEM_COUNT)
+	{
+		ERROR_MSG("Unknown log subsystem (%i)", subsystem);
+		return false;
+	}
 
-	std::stringstream prepend;
+	if (!parseLogLevel(loglevel, level))
+	{
+		if (subsystem == LOG_SUBSYSTEM_DEFAULT)
+		{
+			ERROR_MSG("Unknown value (%s) for log.level in configuration", loglevel.c_str());
+		}
+		else
+		{
+			ERROR_MSG("Unknown value (%s) for log.level.%s in configuration", loglevel.c_str(), logSubsystemNames[subsystem]);
+		}
+		return false;
+	}
+
+	softLogLevels[subsystem] = level;
+
+	return true;
+}
+
+// Return the name of a subsystem, or NULL for the default one
+const char* getLogSubsystemName(const int subsystem)
+{
+	if (subsystem < 0 || subsystem >= LOG_SUBSYSTEM_COUNT) return NULL;
+
+	return logSubsystemNames[subsystem];
+}
+
+static const char* getLogLevelName(const int loglevel)
+{
+	switch (loglevel)
+	{
+		case LOG_ERR:
+			return "ERROR";
+		case LOG_WARNING:
+			return "WARNING";
+		case LOG_INFO:
+			return "INFO";
+		default:
+			return "DEBUG";
+	}
+}
+
+// Print the location and the format to a log message
+static void formatLogMessage(char* buffer, const size_t size, const char* functionName, const char* fileName, const int lineNo, const char* format, va_list args)
+{
+	int len = 0;
 
 #ifdef SOFTHSM_LOG_FILE_AND_LINE
-	prepend << fileName << "(" << lineNo << ")";
-#ifndef SOFTHSM_LOG_FUNCTION_NAME
+#ifdef SOFTHSM_LOG_FUNCTION_NAME
+	len = snprintf(buffer, size, "%s(%i) %s: ", fileName, lineNo, functionName);
+#else
 	(void) functionName;
-	prepend << ":";
-#endif // !SOFTHSM_LOG_FUNCTION_NAME
-	prepend << " ";
-#endif // SOFTHSM_LOG_FILE_AND_LINE
-
+	len = snprintf(buffer, size, "%s(%i): ", fileName, lineNo);
+#endif // SOFTHSM_LOG_FUNCTION_NAME
+#else
+	(void) fileName;
+	(void) lineNo;
 #ifdef SOFTHSM_LOG_FUNCTION_NAME
-	prepend << functionName << ": ";
+	len = snprintf(buffer, size, "%s: ", functionName);
+#else
+	(void) functionName;
 #endif // SOFTHSM_LOG_FUNCTION_NAME
+#endif // SOFTHSM_LOG_FILE_AND_LINE
 
-	// Print the format to a log message
-	std::vector<char> logMessage;
-	va_list args;
+	if (len < 0) len = 0;
+	if ((size_t) len >= size) len = size - 1;
+	buffer[len] = '\0';
 
-	logMessage.resize(4096);
+	vsnprintf(buffer + len, size - len, format, args);
+}
 
-	va_start(args, format);
-	vsnprintf(&logMessage[0], 4096, format, args);
-	va_end(args);
+// Write a formatted message to the log file or to syslog; the time is the
+// one at which the message was logged
+static void writeLogMessage(const int loglevel, const time_t when, const char* message)
+{
+	if (logFile == NULL)
+	{
+		syslog(loglevel, "%s", message);
+	}
+	else
+	{
+		char timestamp[32];
+		struct tm local;
 
-	// And log it
-	syslog(loglevel, "%s%s", prepend.str().c_str(), &logMessage[0]);
+#ifdef _WIN32
+		localtime_s(&local, &when);
+#else
+		localtime_r(&when, &local);
+#endif
+		strftime(timestamp, sizeof(timestamp), "%Y-%m-%d %H:%M:%S", &local);
+
+		fprintf(logFile, "%s %s: %s\n", timestamp, getLogLevelName(loglevel), message);
+	}
 
 #ifdef DEBUG_LOG_STDERR
-	fprintf(stderr, "%s%s\n", prepend.str().c_str(), &logMessage[0]);
+	fprintf(stderr, "%s\n", message);
 	fflush(stderr);
 #endif // DEBUG_LOG_STDERR
 }
 
+#ifdef SOFTHSM_LOG_RING
+// Reserve a slot for a message; returns NULL if the ring is full
+static LogSlot* reserveLogSlot(unsigned long &pos)
+{
+	pos = logEnqueuePos;
+
+	for (;;)
+	{
+		LogSlot* slot = &logRing[pos & (LOG_RING_SIZE - 1)];
+		long diff = (long) (slot->sequence - pos);
+
+		if (diff == 0)
+		{
+			if (__sync_bool_compare_and_swap(&logEnqueuePos, pos, pos + 1))
+			{
+				return slot;
+			}
+		}
+		else if (diff < 0)
+		{
+			__sync_fetch_and_add(&logDropped, 1);
+
+			return NULL;
+		}
+
+		pos = logEnqueuePos;
+	}
+}
+
+// Are there queued messages or dropped messages to report?
+static bool isLogRingPending()
+{
+	LogSlot* slot = &logRing[logDequeuePos & (LOG_RING_SIZE - 1)];
+
+	return (slot->sequence == logDequeuePos + 1) || (logDropped != 0);
+}
+
+// Write the queued messages, in the order in which their slots were reserved
+static void drainLogRing()
+{
+	bool written = false;
+
+	for (;;)
+	{
+		LogSlot* slot = &logRing[logDequeuePos & (LOG_RING_SIZE - 1)];
+
+		if (slot->sequence != logDequeuePos + 1) break;
+		__sync_synchronize();
+
+		writeLogMessage(slot->loglevel, slot->timestamp, slot->message);
+		written = true;
+
+		__sync_synchronize();
+		slot->sequence = logDequeuePos + LOG_RING_SIZE;
+		logDequeuePos++;
+	}
+
+	unsigned long dropped = __sync_fetch_and_and(&logDropped, 0);
+	if (dropped > 0)
+	{
+		char message[128];
+
+		snprintf(message, sizeof(message), "%lu log messages were dropped because the log queue was full", dropped);
+		writeLogMessage(LOG_WARNING, time(NULL), message);
+		written = true;
+	}
+
+	if (written && logFile != NULL) fflush(logFile);
+}
+
+// Wake up the thread if it waits for messages
+static void wakeLogSink()
+{
+	OSLockCondition(logSinkCondition);
+	OSSignalCondition(logSinkCondition);
+	OSUnlockCondition(logSinkCondition);
+}
+
+// Wait until a message is published or the thread is stopped; the ring is
+// checked again after the flag is set, so that no wake up is missed
+static void waitLogSink()
+{
+	OSLockCondition(logSinkCondition);
+
+	logSinkWaiting = true;
+	__sync_synchronize();
+
+	if (!logSinkStopping && !isLogRingPending())
+	{
+		OSWaitCondition(logSinkCondition, 0);
+	}
+
+	logSinkWaiting = false;
+
+	OSUnlockCondition(logSinkCondition);
+}
+
+static void* logSinkMain(void* /*arg*/)
+{
+	for (;;)
+	{
+		// The messages that were queued before the thread was stopped are still written
+		bool stopping = logSinkStopping;
+		__sync_synchronize();
+
+		drainLogRing();
+
+		if (stopping) break;
+
+		waitLogSink();
+	}
+
+	return NULL;
+}
+
+#ifdef HAVE_PTHREAD_H
+// The thread does not exist in a child process, and it or a caller may
+// have held the mutex or been counted as a writer during the fork, so the
+// condition is left behind and a new one is created by the next start
+static void logAtForkChild()
+{
+	logAsync = false;
+	logSinkThread = NULL;
+	logWriters = 0;
+	logSinkWaiting = false;
+	logSinkCondition = NULL;
+}
+#endif
+#endif // SOFTHSM_LOG_RING
+
+// Write the messages to the given file instead of syslog if the name is not
+// empty, and from a thread instead of from the caller if async is set; on
+// failure the messages are written to syslog by the caller
+bool startLogSink(const std::string &logFileName, const bool async)
+{
+	stopLogSink();
+
+	if (!logFileName.empty())
+	{
+		logFile = fopen(logFileName.c_str(), "a");
+
+		if (logFile == NULL)
+		{
+			ERROR_MSG("Could not open the log file %s", logFileName.c_str());
+
+			return false;
+		}
+	}
+
+	if (!async) return true;
+
+#ifdef SOFTHSM_LOG_RING
+	// Messages of threads that were interrupted by a fork are never completed
+	for (unsigned long i = 0; i < LOG_RING_SIZE; i++)
+	{
+		logRing[i].sequence = i;
+	}
+	logEnqueuePos = 0;
+	logDequeuePos = 0;
+	logDropped = 0;
+
+#ifdef HAVE_PTHREAD_H
+	if (!logAtForkRegistered)
+	{
+		if (pthread_atfork(NULL, NULL, logAtForkChild) != 0)
+		{
+			ERROR_MSG("Could not register the log fork handler");
+			stopLogSink();
+
+			return false;
+		}
+
+		logAtForkRegistered = true;
+	}
+#endif
+
+	if (logSinkCondition == NULL && OSCreateCondition(&logSinkCondition) != CKR_OK)
+	{
+		ERROR_MSG("Could not create the log condition");
+		logSinkCondition = NULL;
+		stopLogSink();
+
+		return false;
+	}
+
+	logSinkStopping = false;
+	__sync_synchronize();
+
+	if (OSCreateThread(&logSinkThread, logSinkMain, NULL) != CKR_OK)
+	{
+		ERROR_MSG("Could not start the log thread");
+		logSinkThread = NULL;
+		stopLogSink();
+
+		return false;
+	}
+
+	logAsync = true;
+#else
+	WARNING_MSG("Messages are logged by the caller; the compiler has no atomic operations");
+#endif // SOFTHSM_LOG_RING
+
+	return true;
+}
+
+// Stop the thread after it wrote the queued messages, and close the log file
+void stopLogSink()
+{
+#ifdef SOFTHSM_LOG_RING
+	if (logSinkThread != NULL)
+	{
+		logAsync = false;
+		__sync_synchronize();
+
+		// The callers that saw the flag still publish their messages,
+		// which must be written before the thread stops and the ring
+		// is reset by the next start
+		while (logWriters != 0)
+		{
+#ifdef HAVE_PTHREAD_H
+			usleep(100);
+#else
+			Sleep(1);
+#endif
+		}
+
+		logSinkStopping = true;
+		__sync_synchronize();
+		wakeLogSink();
+
+		OSJoinThread(logSinkThread);
+		logSinkThread = NULL;
+	}
+#endif // SOFTHSM_LOG_RING
+
+	if (logFile != NULL)
+	{
+		fclose(logFile);
+		logFile = NULL;
+	}
+}
+
+// The level is checked by the log macros
+void softHSMLog(const int loglevel, const char* functionName, const char* fileName, const int lineNo, const char* format, ...)
+{
+	va_list args;
+
+#ifdef SOFTHSM_LOG_RING
+	// Format the message into a slot and leave the writing to the thread;
+	// the flag is checked again once the caller is counted, so that
+	// stopLogSink waits for the message
+	if (logAsync)
+	{
+		__sync_fetch_and_add(&logWriters, 1);
+
+		if (logAsync)
+		{
+			unsigned long pos;
+			LogSlot* slot = reserveLogSlot(pos);
+
+			if (slot != NULL)
+			{
+				va_start(args, format);
+				formatLogMessage(slot->message, LOG_SLOT_SIZE, functionName, fileName, lineNo, format, args);
+				va_end(args);
+				slot->loglevel = loglevel;
+				slot->timestamp = time(NULL);
+
+				__sync_synchronize();
+				slot->sequence = pos + 1;
+
+				__sync_synchronize();
+				if (logSinkWaiting) wakeLogSink();
+			}
+
+			__sync_fetch_and_sub(&logWriters, 1);
+
+			return;
+		}
+
+		__sync_fetch_and_sub(&logWriters, 1);
+	}
+#endif // SOFTHSM_LOG_RING
+
+	char message[LOG_MESSAGE_SIZE];
+
+	va_start(args, format);
+	formatLogMessage(message, LOG_MESSAGE_SIZE, functionName, fileName, lineNo, format, args);
+	va_end(args);
+
+	// And log it
+	writeLogMessage(loglevel, time(NULL), message);
+
+	if (logFile != NULL) fflush(logFile);
+}
@@ -49,36 +49,58 @@
 /* Define this symbol (either here or in the build setup) to log to stderr */
 /* #define DEBUG_LOG_STDERR */
 
-/* Logging errors */
-#ifndef _WIN32
-#define ERROR_MSG(...) softHSMLog(LOG_ERR, __func__, __FILE__, __LINE__, __VA_ARGS__);
-#else
-#define ERROR_MSG(...) softHSMLog(LOG_ERR, __FUNCTION__, __FILE__, __LINE__, __VA_ARGS__);
+/* The subsystems that can have their own log level */
+enum
+{
+	LOG_SUBSYSTEM_DEFAULT,
+	LOG_SUBSYSTEM_OBJECT_STORE,
+	LOG_SUBSYSTEM_CRYPTO,
+	LOG_SUBSYSTEM_SESSION,
+	LOG_SUBSYSTEM_HANDLE,
+	LOG_SUBSYSTEM_COUNT
+};
+
+/* The build setup of a subsystem defines the subsystem of its log messages */
+#ifndef SOFTHSM_LOG_SUBSYSTEM
+#define SOFTHSM_LOG_SUBSYSTEM LOG_SUBSYSTEM_DEFAULT
 #endif
 
-/* Logging warnings */
 #ifndef _WIN32
-#define WARNING_MSG(...) softHSMLog(LOG_WARNING, __func__, __FILE__, __LINE__, __VA_ARGS__);
+#define SOFTHSM_LOG_FUNCTION __func__
 #else
-#define WARNING_MSG(...) softHSMLog(LOG_WARNING, __FUNCTION__, __FILE__, __LINE__, __VA_ARGS__);
+#define SOFTHSM_LOG_FUNCTION __FUNCTION__
 #endif
 
+/* The arguments of a message are only evaluated if its level is enabled */
+#define SOFTHSM_LOG_MSG(level, ...) \
+	do \
+	{ \
+		if ((level) <= softLogLevels[SOFTHSM_LOG_SUBSYSTEM]) \
+			softHSMLog((level), SOFTHSM_LOG_FUNCTION, __FILE__, __LINE__, __VA_ARGS__); \
+	} \
+	while (0)
+
+/* Logging errors */
+#define ERROR_MSG(...) SOFTHSM_LOG_MSG(LOG_ERR, __VA_ARGS__);
+
+/* Logging warnings */
+#define WARNING_MSG(...) SOFTHSM_LOG_MSG(LOG_WARNING, __VA_ARGS__);
+
 /* Logging information */
-#ifndef _WIN32
-#define INFO_MSG(...) softHSMLog(LOG_INFO, __func__, __FILE__, __LINE__, __VA_ARGS__);
-#else
-#define INFO_MSG(...) softHSMLog(LOG_INFO, __FUNCTION__, __FILE__, __LINE__, __VA_ARGS__);
-#endif
+#define INFO_MSG(...) SOFTHSM_LOG_MSG(LOG_INFO, __VA_ARGS__);
 
 /* Logging debug information */
-#ifndef _WIN32
-#define DEBUG_MSG(...) softHSMLog(LOG_DEBUG, __func__, __FILE__, __LINE__, __VA_ARGS__);
-#else
-#define DEBUG_MSG(...) softHSMLog(LOG_DEBUG, __FUNCTION__, __FILE__, __LINE__, __VA_ARGS__);
-#endif
+#define DEBUG_MSG(...) SOFTHSM_LOG_MSG(LOG_DEBUG, __VA_ARGS__);
+
+/* The log level of each subsystem */
+extern int softLogLevels[LOG_SUBSYSTEM_COUNT];
 
 /* Function definitions */
 bool setLogLevel(const std::string &loglevel);
+bool setLogLevel(const int subsystem, const std::string &loglevel);
+const char* getLogSubsystemName(const int subsystem);
+bool startLogSink(const std::string &logFile, const bool async);
+void stopLogSink();
 void softHSMLog(const int loglevel, const char* functionName, const char* fileName, const int lineNo, const char* format, ...);
 
 #endif /* !_SOFTHSM_V2_LOG_H */
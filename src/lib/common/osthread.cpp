@@ -0,0 +1,614 @@
+/*
+ * Copyright (c) 2016 SURFnet bv
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+/*****************************************************************************
+ osthread.cpp
+
+ Contains OS-specific implementations of the threads that SoftHSM starts
+ itself, for the optional background work, of the condition variables
+ that they wait on and of thread-specific values
+ *****************************************************************************/
+
+#include "config.h"
+#include "log.h"
+#include "osthread.h"
+
+#ifdef HAVE_PTHREAD_H
+
+#include <stdlib.h>
+#include <pthread.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+CK_RV OSCreateThread(CK_VOID_PTR_PTR newThread, OSThreadFunction function, void* arg)
+{
+	int rv;
+
+	/* Allocate memory */
+	pthread_t* pthreadThread = (pthread_t*) malloc(sizeof(pthread_t));
+
+	if (pthreadThread == NULL)
+	{
+		ERROR_MSG("Failed to allocate memory for a new thread");
+
+		return CKR_HOST_MEMORY;
+	}
+
+	/* Start the thread */
+	if ((rv = pthread_create(pthreadThread, NULL, function, arg)) != 0)
+	{
+		free(pthreadThread);
+
+		ERROR_MSG("Failed to start POSIX thread (0x%08X)", rv);
+
+		return CKR_GENERAL_ERROR;
+	}
+
+	*newThread = pthreadThread;
+
+	return CKR_OK;
+}
+
+CK_RV OSJoinThread(CK_VOID_PTR thread)
+{
+	int rv;
+	pthread_t* pthreadThread = (pthread_t*) thread;
+
+	if (pthreadThread == NULL)
+	{
+		ERROR_MSG("Cannot join NULL thread");
+
+		return CKR_ARGUMENTS_BAD;
+	}
+
+	if ((rv = pthread_join(*pthreadThread, NULL)) != 0)
+	{
+		ERROR_MSG("Failed to join POSIX thread (0x%08X)", rv);
+
+		return CKR_GENERAL_ERROR;
+	}
+
+	free(pthreadThread);
+
+	return CKR_OK;
+}
+
+unsigned long OSGetProcessorCount()
+{
+	long count = sysconf(_SC_NPROCESSORS_ONLN);
+
+	return count > 0 ? (unsigned long) count : 1;
+}
+
+struct OSCondition
+{
+	pthread_mutex_t mutex;
+	pthread_cond_t cond;
+};
+
+CK_RV OSCreateCondition(CK_VOID_PTR_PTR newCondition)
+{
+	int rv;
+
+	/* Allocate memory */
+	OSCondition* condition = (OSCondition*) malloc(sizeof(OSCondition));
+
+	if (condition == NULL)
+	{
+		ERROR_MSG("Failed to allocate memory for a new condition");
+
+		return CKR_HOST_MEMORY;
+	}
+
+	/* Initialize the mutex and the condition variable */
+	if ((rv = pthread_mutex_init(&condition->mutex, NULL)) != 0)
+	{
+		free(condition);
+
+		ERROR_MSG("Failed to initialize POSIX mutex (0x%08X)", rv);
+
+		return CKR_GENERAL_ERROR;
+	}
+
+	if ((rv = pthread_cond_init(&condition->cond, NULL)) != 0)
+	{
+		pthread_mutex_destroy(&condition->mutex);
+		free(condition);
+
+		ERROR_MSG("Failed to initialize POSIX condition variable (0x%08X)", rv);
+
+		return CKR_GENERAL_ERROR;
+	}
+
+	*newCondition = condition;
+
+	return CKR_OK;
+}
+
+CK_RV OSDestroyCondition(CK_VOID_PTR condition)
+{
+	OSCondition* osCondition = (OSCondition*) condition;
+
+	if (osCondition == NULL)
+	{
+		ERROR_MSG("Cannot destroy NULL condition");
+
+		return CKR_ARGUMENTS_BAD;
+	}
+
+	pthread_cond_destroy(&osCondition->cond);
+	pthread_mutex_destroy(&osCondition->mutex);
+	free(osCondition);
+
+	return CKR_OK;
+}
+
+void OSLockCondition(CK_VOID_PTR condition)
+{
+	pthread_mutex_lock(&((OSCondition*) condition)->mutex);
+}
+
+void OSUnlockCondition(CK_VOID_PTR condition)
+{
+	pthread_mutex_unlock(&((OSCondition*) condition)->mutex);
+}
+
+void OSWaitCondition(CK_VOID_PTR condition, unsigned long milliseconds)
+{
+	OSCondition* osCondition = (OSCondition*) condition;
+
+	if (milliseconds == 0)
+	{
+		pthread_cond_wait(&osCondition->cond, &osCondition->mutex);
+
+		return;
+	}
+
+	struct timeval now;
+	struct timespec until;
+
+	gettimeofday(&now, NULL);
+	until.tv_sec = now.tv_sec + milliseconds / 1000;
+	until.tv_nsec = now.tv_usec * 1000 + (milliseconds % 1000) * 1000000;
+	if (until.tv_nsec >= 1000000000)
+	{
+		until.tv_sec++;
+		until.tv_nsec -= 1000000000;
+	}
+
+	pthread_cond_timedwait(&osCondition->cond, &osCondition->mutex, &until);
+}
+
+void OSSignalCondition(CK_VOID_PTR condition)
+{
+	pthread_cond_signal(&((OSCondition*) condition)->cond);
+}
+
+void OSBroadcastCondition(CK_VOID_PTR condition)
+{
+	pthread_cond_broadcast(&((OSCondition*) condition)->cond);
+}
+
+// A POSIX key is never deleted, since pthread_key_delete() does not wait
+// for the destructors that are already running. A destroyed key is kept
+// for reuse instead; the values are stored in a cell that records the
+// incarnation of the key that they were set for.
+struct OSThreadKey
+{
+	pthread_key_t key;
+	pthread_mutex_t mutex;
+	OSThreadKeyDestructor destructor;
+	unsigned long incarnation;
+	OSThreadKey* next;
+};
+
+struct OSThreadValue
+{
+	OSThreadKey* key;
+	unsigned long incarnation;
+	void* value;
+};
+
+static pthread_mutex_t freeThreadKeysMutex = PTHREAD_MUTEX_INITIALIZER;
+static OSThreadKey* freeThreadKeys = NULL;
+
+static void OSThreadValueDestructor(void* cell)
+{
+	OSThreadValue* threadValue = (OSThreadValue*) cell;
+	OSThreadKey* threadKey = threadValue->key;
+
+	// The destructor is called with the mutex held, so that the key
+	// cannot be destroyed while it is running
+	pthread_mutex_lock(&threadKey->mutex);
+	if (threadValue->incarnation == threadKey->incarnation &&
+	    threadKey->destructor != NULL &&
+	    threadValue->value != NULL)
+	{
+		threadKey->destructor(threadValue->value);
+	}
+	pthread_mutex_unlock(&threadKey->mutex);
+
+	free(threadValue);
+}
+
+CK_RV OSCreateThreadKey(CK_VOID_PTR_PTR newKey, OSThreadKeyDestructor destructor)
+{
+	int rv;
+
+	/* Reuse a destroyed key */
+	pthread_mutex_lock(&freeThreadKeysMutex);
+	OSThreadKey* threadKey = freeThreadKeys;
+	if (threadKey != NULL)
+	{
+		freeThreadKeys = threadKey->next;
+	}
+	pthread_mutex_unlock(&freeThreadKeysMutex);
+
+	if (threadKey == NULL)
+	{
+		/* Allocate memory */
+		threadKey = (OSThreadKey*) malloc(sizeof(OSThreadKey));
+
+		if (threadKey == NULL)
+		{
+			ERROR_MSG("Failed to allocate memory for a new thread key");
+
+			return CKR_HOST_MEMORY;
+		}
+
+		/* Create the key */
+		if ((rv = pthread_key_create(&threadKey->key, OSThreadValueDestructor)) != 0)
+		{
+			free(threadKey);
+
+			ERROR_MSG("Failed to create POSIX thread key (0x%08X)", rv);
+
+			return CKR_GENERAL_ERROR;
+		}
+
+		pthread_mutex_init(&threadKey->mutex, NULL);
+		threadKey->destructor = NULL;
+		threadKey->incarnation = 0;
+	}
+
+	pthread_mutex_lock(&threadKey->mutex);
+	threadKey->destructor = destructor;
+	pthread_mutex_unlock(&threadKey->mutex);
+
+	*newKey = threadKey;
+
+	return CKR_OK;
+}
+
+CK_RV OSDestroyThreadKey(CK_VOID_PTR key)
+{
+	OSThreadKey* threadKey = (OSThreadKey*) key;
+
+	if (threadKey == NULL)
+	{
+		ERROR_MSG("Cannot destroy NULL thread key");
+
+		return CKR_ARGUMENTS_BAD;
+	}
+
+	// Wait for the destructors that are running; the values that are
+	// still set belong to an old incarnation from here on
+	pthread_mutex_lock(&threadKey->mutex);
+	threadKey->incarnation++;
+	threadKey->destructor = NULL;
+	pthread_mutex_unlock(&threadKey->mutex);
+
+	pthread_mutex_lock(&freeThreadKeysMutex);
+	threadKey->next = freeThreadKeys;
+	freeThreadKeys = threadKey;
+	pthread_mutex_unlock(&freeThreadKeysMutex);
+
+	return CKR_OK;
+}
+
+void* OSGetThreadValue(CK_VOID_PTR key)
+{
+	OSThreadKey* threadKey = (OSThreadKey*) key;
+	OSThreadValue* threadValue = (OSThreadValue*) pthread_getspecific(threadKey->key);
+
+	if (threadValue == NULL || threadValue->incarnation != threadKey->incarnation)
+	{
+		return NULL;
+	}
+
+	return threadValue->value;
+}
+
+CK_RV OSSetThreadValue(CK_VOID_PTR key, void* value)
+{
+	int rv;
+	OSThreadKey* threadKey = (OSThreadKey*) key;
+	OSThreadValue* threadValue = (OSThreadValue*) pthread_getspecific(threadKey->key);
+
+	if (threadValue == NULL)
+	{
+		threadValue = (OSThreadValue*) malloc(sizeof(OSThreadValue));
+
+		if (threadValue == NULL)
+		{
+			ERROR_MSG("Failed to allocate memory for a thread value");
+
+			return CKR_HOST_MEMORY;
+		}
+
+		if ((rv = pthread_setspecific(threadKey->key, threadValue)) != 0)
+		{
+			free(threadValue);
+
+			ERROR_MSG("Failed to set POSIX thread value (0x%08X)", rv);
+
+			return CKR_GENERAL_ERROR;
+		}
+	}
+
+	threadValue->key = threadKey;
+	threadValue->incarnation = threadKey->incarnation;
+	threadValue->value = value;
+
+	return CKR_OK;
+}
+
+#elif _WIN32
+
+#include <stdlib.h>
+
+struct OSThreadStart
+{
+	OSThreadFunction function;
+	void* arg;
+};
+
+static DWORD WINAPI OSThreadMain(LPVOID start)
+{
+	OSThreadStart threadStart = *(OSThreadStart*) start;
+
+	free(start);
+	threadStart.function(threadStart.arg);
+
+	return 0;
+}
+
+CK_RV OSCreateThread(CK_VOID_PTR_PTR newThread, OSThreadFunction function, void* arg)
+{
+	HANDLE hThread;
+
+	/* Allocate memory */
+	OSThreadStart* start = (OSThreadStart*) malloc(sizeof(OSThreadStart));
+
+	if (start == NULL)
+	{
+		ERROR_MSG("Failed to allocate memory for a new thread");
+
+		return CKR_HOST_MEMORY;
+	}
+
+	start->function = function;
+	start->arg = arg;
+
+	hThread = CreateThread(NULL, 0, OSThreadMain, start, 0, NULL);
+	if (hThread == NULL)
+	{
+		DWORD rv = GetLastError();
+
+		free(start);
+
+		ERROR_MSG("Failed to start WIN32 thread (0x%08X)", rv);
+
+		return CKR_GENERAL_ERROR;
+	}
+
+	*newThread = hThread;
+
+	return CKR_OK;
+}
+
+CK_RV OSJoinThread(CK_VOID_PTR thread)
+{
+	DWORD rv;
+	HANDLE hThread = (HANDLE) thread;
+
+	if (hThread == NULL)
+	{
+		ERROR_MSG("Cannot join NULL thread");
+
+		return CKR_ARGUMENTS_BAD;
+	}
+
+	rv = WaitForSingleObject(hThread, INFINITE);
+	if (rv != WAIT_OBJECT_0)
+	{
+		if (rv == WAIT_FAILED)
+			rv = GetLastError();
+
+		ERROR_MSG("Failed to join WIN32 thread 0x%08X (0x%08X)", hThread, rv);
+
+		return CKR_GENERAL_ERROR;
+	}
+
+	CloseHandle(hThread);
+
+	return CKR_OK;
+}
+
+unsigned long OSGetProcessorCount()
+{
+	SYSTEM_INFO info;
+
+	GetSystemInfo(&info);
+
+	return info.dwNumberOfProcessors > 0 ? info.dwNumberOfProcessors : 1;
+}
+
+struct OSCondition
+{
+	CRITICAL_SECTION mutex;
+	CONDITION_VARIABLE cond;
+};
+
+CK_RV OSCreateCondition(CK_VOID_PTR_PTR newCondition)
+{
+	/* Allocate memory */
+	OSCondition* condition = (OSCondition*) malloc(sizeof(OSCondition));
+
+	if (condition == NULL)
+	{
+		ERROR_MSG("Failed to allocate memory for a new condition");
+
+		return CKR_HOST_MEMORY;
+	}
+
+	InitializeCriticalSection(&condition->mutex);
+	InitializeConditionVariable(&condition->cond);
+
+	*newCondition = condition;
+
+	return CKR_OK;
+}
+
+CK_RV OSDestroyCondition(CK_VOID_PTR condition)
+{
+	OSCondition* osCondition = (OSCondition*) condition;
+
+	if (osCondition == NULL)
+	{
+		ERROR_MSG("Cannot destroy NULL condition");
+
+		return CKR_ARGUMENTS_BAD;
+	}
+
+	DeleteCriticalSection(&osCondition->mutex);
+	free(osCondition);
+
+	return CKR_OK;
+}
+
+void OSLockCondition(CK_VOID_PTR condition)
+{
+	EnterCriticalSection(&((OSCondition*) condition)->mutex);
+}
+
+void OSUnlockCondition(CK_VOID_PTR condition)
+{
+	LeaveCriticalSection(&((OSCondition*) condition)->mutex);
+}
+
+void OSWaitCondition(CK_VOID_PTR condition, unsigned long milliseconds)
+{
+	OSCondition* osCondition = (OSCondition*) condition;
+
+	SleepConditionVariableCS(&osCondition->cond, &osCondition->mutex, milliseconds == 0 ? INFINITE : (DWORD) milliseconds);
+}
+
+void OSSignalCondition(CK_VOID_PTR condition)
+{
+	WakeConditionVariable(&((OSCondition*) condition)->cond);
+}
+
+void OSBroadcastCondition(CK_VOID_PTR condition)
+{
+	WakeAllConditionVariable(&((OSCondition*) condition)->cond);
+}
+
+CK_RV OSCreateThreadKey(CK_VOID_PTR_PTR newKey, OSThreadKeyDestructor destructor)
+{
+	(void) destructor;
+
+	/* Allocate memory */
+	DWORD* index = (DWORD*) malloc(sizeof(DWORD));
+
+	if (index == NULL)
+	{
+		ERROR_MSG("Failed to allocate memory for a new thread key");
+
+		return CKR_HOST_MEMORY;
+	}
+
+	*index = TlsAlloc();
+	if (*index == TLS_OUT_OF_INDEXES)
+	{
+		DWORD rv = GetLastError();
+
+		free(index);
+
+		ERROR_MSG("Failed to create WIN32 thread key (0x%08X)", rv);
+
+		return CKR_GENERAL_ERROR;
+	}
+
+	*newKey = index;
+
+	return CKR_OK;
+}
+
+CK_RV OSDestroyThreadKey(CK_VOID_PTR key)
+{
+	DWORD* index = (DWORD*) key;
+
+	if (index == NULL)
+	{
+		ERROR_MSG("Cannot destroy NULL thread key");
+
+		return CKR_ARGUMENTS_BAD;
+	}
+
+	if (!TlsFree(*index))
+	{
+		ERROR_MSG("Failed to destroy WIN32 thread key (0x%08X)", GetLastError());
+
+		return CKR_GENERAL_ERROR;
+	}
+
+	free(index);
+
+	return CKR_OK;
+}
+
+void* OSGetThreadValue(CK_VOID_PTR key)
+{
+	return TlsGetValue(*(DWORD*) key);
+}
+
+CK_RV OSSetThreadValue(CK_VOID_PTR key, void* value)
+{
+	if (!TlsSetValue(*(DWORD*) key, value))
+	{
+		ERROR_MSG("Failed to set WIN32 thread value (0x%08X)", GetLastError());
+
+		return CKR_GENERAL_ERROR;
+	}
+
+	return CKR_OK;
+}
+
+#else
+#error "There are no thread implementations for your operating system yet"
+#endif
@@ -0,0 +1,73 @@
+/*
+ * Copyright (c) 2016 SURFnet bv
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+/*****************************************************************************
+ osthread.h
+
+ Contains OS-specific implementations of the threads that SoftHSM starts
+ itself, for the optional background work, of the condition variables
+ that they wait on and of thread-specific values
+ *****************************************************************************/
+
+#ifndef _SOFTHSM_V2_OSTHREAD_H
+#define _SOFTHSM_V2_OSTHREAD_H
+
+#include "config.h"
+#include "cryptoki.h"
+
+typedef void* (*OSThreadFunction)(void* arg);
+
+CK_RV OSCreateThread(CK_VOID_PTR_PTR newThread, OSThreadFunction function, void* arg);
+CK_RV OSJoinThread(CK_VOID_PTR thread);
+unsigned long OSGetProcessorCount();
+
+// Condition variables, each with the mutex that guards its condition; the
+// mutex must be locked to wait or signal. Only creating and destroying can
+// fail, and nothing else logs, so that the log code can use them. A wait
+// of 0 milliseconds lasts until the condition is signalled.
+CK_RV OSCreateCondition(CK_VOID_PTR_PTR newCondition);
+CK_RV OSDestroyCondition(CK_VOID_PTR condition);
+void OSLockCondition(CK_VOID_PTR condition);
+void OSUnlockCondition(CK_VOID_PTR condition);
+void OSWaitCondition(CK_VOID_PTR condition, unsigned long milliseconds);
+void OSSignalCondition(CK_VOID_PTR condition);
+void OSBroadcastCondition(CK_VOID_PTR condition);
+
+// Thread-specific values; the destructor is called for the value of a
+// thread that exits (not on Windows, where the values are left to the
+// owner of the key). OSDestroyThreadKey waits for the destructors that
+// are running and no destructor is called once it returns, so it must not
+// be called while holding a lock that the destructor takes; the values of
+// the threads that are still alive are left to the owner of the key.
+typedef void (*OSThreadKeyDestructor)(void* value);
+
+CK_RV OSCreateThreadKey(CK_VOID_PTR_PTR newKey, OSThreadKeyDestructor destructor);
+CK_RV OSDestroyThreadKey(CK_VOID_PTR key);
+void* OSGetThreadValue(CK_VOID_PTR key);
+CK_RV OSSetThreadValue(CK_VOID_PTR key, void* value);
+
+#endif /* !_SOFTHSM_V2_OSTHREAD_H */
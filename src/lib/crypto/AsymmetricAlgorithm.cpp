@@ -78,6 +78,16 @@ bool AsymmetricAlgorithm::signUpdate(const ByteString& /*dataToSign*/)
 	return true;
 }
 
+bool AsymmetricAlgorithm::signUpdate(const unsigned char* /*dataToSign*/, size_t /*dataToSignLen*/)
+{
+	if (currentOperation != SIGN)
+	{
+		return false;
+	}
+
+	return true;
+}
+
 bool AsymmetricAlgorithm::signFinal(ByteString& /*signature*/)
 {
 	if (currentOperation != SIGN)
@@ -126,6 +136,16 @@ bool AsymmetricAlgorithm::verifyUpdate(const ByteString& /*originalData*/)
 	return true;
 }
 
+bool AsymmetricAlgorithm::verifyUpdate(const unsigned char* /*originalData*/, size_t /*originalDataLen*/)
+{
+	if (currentOperation != VERIFY)
+	{
+		return false;
+	}
+
+	return true;
+}
+
 bool AsymmetricAlgorithm::verifyFinal(const ByteString& /*signature*/)
 {
 	if (currentOperation != VERIFY)
@@ -53,6 +53,9 @@
 #include "BotanGOSTR3411.h"
 #endif
 #include "BotanHMAC.h"
+#if defined(WITH_ECC) || defined(WITH_GOST)
+#include "BotanUtil.h"
+#endif
 
 #include <botan/init.h>
 
@@ -83,6 +86,9 @@ BotanCryptoFactory::BotanCryptoFactory()
 
 	// Create mutex
 	rngsMutex = MutexFactory::i()->getMutex();
+#if defined(WITH_ECC) || defined(WITH_GOST)
+	ecGroupsMutex = MutexFactory::i()->getMutex();
+#endif
 }
 
 // Destructor
@@ -106,6 +112,15 @@ BotanCryptoFactory::~BotanCryptoFactory()
 	// Delete the mutex
 	MutexFactory::i()->recycleMutex(rngsMutex);
 
+#if defined(WITH_ECC) || defined(WITH_GOST)
+	// Delete the cached EC groups
+	for (std::map<std::string, Botan::EC_Group*>::iterator i = ecGroups.begin(); i != ecGroups.end(); i++)
+	{
+		delete i->second;
+	}
+	MutexFactory::i()->recycleMutex(ecGroupsMutex);
+#endif
+
 	// Deinitialize the Botan crypto lib
 #if BOTAN_VERSION_CODE < BOTAN_VERSION_CODE_FOR(1,11,14)
 	if (!wasInitialized)
@@ -302,3 +317,35 @@ RNG* BotanCryptoFactory::getRNG(RNGImpl::Type name /* = RNGImpl::Default */)
 		return NULL;
 	}
 }
+
+#if defined(WITH_ECC) || defined(WITH_GOST)
+// Return the EC group for the given DER encoded parameters. Decoding the
+// parameters and setting up the curve is expensive, so the groups of the
+// curves in use are kept and copies of them are handed out.
+Botan::EC_Group BotanCryptoFactory::getECGroup(const ByteString& params)
+{
+	std::string key((const char*) params.const_byte_str(), params.size());
+
+	{
+		MutexLocker lock(ecGroupsMutex);
+
+		std::map<std::string, Botan::EC_Group*>::iterator i = ecGroups.find(key);
+		if (i != ecGroups.end())
+		{
+			return *i->second;
+		}
+	}
+
+	// Decode outside the lock; this throws on invalid parameters
+	Botan::EC_Group group = BotanUtil::byteString2ECGroup(params);
+
+	MutexLocker lock(ecGroupsMutex);
+
+	if (ecGroups.find(key) == ecGroups.end() && ecGroups.size() < BOTAN_EC_GROUP_CACHE_SIZE)
+	{
+		ecGroups[key] = new Botan::EC_Group(group);
+	}
+
+	return group;
+}
+#endif
@@ -48,7 +48,14 @@
 #include "MutexFactory.h"
 #include <memory>
 #include <map>
+#include <string>
 #include <botan/version.h>
+#if defined(WITH_ECC) || defined(WITH_GOST)
+#include <botan/ec_group.h>
+#endif
+
+// The maximum number of EC groups kept for reuse
+#define BOTAN_EC_GROUP_CACHE_SIZE 16
 
 class BotanCryptoFactory : public CryptoFactory
 {
@@ -74,6 +81,11 @@ public:
 	// Get the global RNG (may be an unique RNG per thread)
 	RNG* getRNG(RNGImpl::Type name = RNGImpl::Default);
 
+#if defined(WITH_ECC) || defined(WITH_GOST)
+	// Return the EC group for the given DER encoded parameters
+	Botan::EC_Group getECGroup(const ByteString& params);
+#endif
+
 	// Destructor
 	~BotanCryptoFactory();
 
@@ -96,6 +108,12 @@ private:
 #endif
         Mutex* rngsMutex;
 
+#if defined(WITH_ECC) || defined(WITH_GOST)
+	// Decoded EC groups by their DER encoded parameters
+	std::map<std::string, Botan::EC_Group*> ecGroups;
+	Mutex* ecGroupsMutex;
+#endif
+
 #if BOTAN_VERSION_CODE < BOTAN_VERSION_CODE_FOR(1,11,14)
 	bool wasInitialized;
 #endif
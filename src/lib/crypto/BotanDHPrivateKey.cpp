@@ -269,6 +269,12 @@ BotanDH_PrivateKey* BotanDHPrivateKey::getBotanKey()
 	return dh;
 }
 
+// Create the Botan representation of the key up front
+bool BotanDHPrivateKey::prepare()
+{
+	return getBotanKey() != NULL;
+}
+
 // Create the Botan representation of the key
 void BotanDHPrivateKey::createBotanKey()
 {
@@ -220,17 +220,21 @@ bool BotanDSA::signInit(PrivateKey* privateKey, const AsymMech::Type mechanism,
 
 bool BotanDSA::signUpdate(const ByteString& dataToSign)
 {
-	if (!AsymmetricAlgorithm::signUpdate(dataToSign))
+	return signUpdate(dataToSign.const_byte_str(), dataToSign.size());
+}
+
+bool BotanDSA::signUpdate(const unsigned char* dataToSign, size_t dataToSignLen)
+{
+	if (!AsymmetricAlgorithm::signUpdate(dataToSign, dataToSignLen))
 	{
 		return false;
 	}
 
 	try
 	{
-		if (dataToSign.size() != 0)
+		if (dataToSignLen != 0)
 		{
-			signer->update(dataToSign.const_byte_str(),
-				       dataToSign.size());
+			signer->update(dataToSign, dataToSignLen);
 		}
 	}
 	catch (...)
@@ -441,17 +445,21 @@ bool BotanDSA::verifyInit(PublicKey* publicKey, const AsymMech::Type mechanism,
 
 bool BotanDSA::verifyUpdate(const ByteString& originalData)
 {
-	if (!AsymmetricAlgorithm::verifyUpdate(originalData))
+	return verifyUpdate(originalData.const_byte_str(), originalData.size());
+}
+
+bool BotanDSA::verifyUpdate(const unsigned char* originalData, size_t originalDataLen)
+{
+	if (!AsymmetricAlgorithm::verifyUpdate(originalData, originalDataLen))
 	{
 		return false;
 	}
 
 	try
 	{
-		if (originalData.size() != 0)
+		if (originalDataLen != 0)
 		{
-			verifier->update(originalData.const_byte_str(),
-					 originalData.size());
+			verifier->update(originalData, originalDataLen);
 		}
 	}
 	catch (...)
@@ -50,12 +50,14 @@ public:
 	virtual bool sign(PrivateKey* privateKey, const ByteString& dataToSign, ByteString& signature, const AsymMech::Type mechanism, const void* param = NULL, const size_t paramLen = 0);
 	virtual bool signInit(PrivateKey* privateKey, const AsymMech::Type mechanism, const void* param = NULL, const size_t paramLen = 0);
 	virtual bool signUpdate(const ByteString& dataToSign);
+	virtual bool signUpdate(const unsigned char* dataToSign, size_t dataToSignLen);
 	virtual bool signFinal(ByteString& signature);
 
 	// Verification functions
 	virtual bool verify(PublicKey* publicKey, const ByteString& originalData, const ByteString& signature, const AsymMech::Type mechanism, const void* param = NULL, const size_t paramLen = 0);
 	virtual bool verifyInit(PublicKey* publicKey, const AsymMech::Type mechanism, const void* param = NULL, const size_t paramLen = 0);
 	virtual bool verifyUpdate(const ByteString& originalData);
+	virtual bool verifyUpdate(const unsigned char* originalData, size_t originalDataLen);
 	virtual bool verifyFinal(const ByteString& signature);
 
 	// Encryption functions
@@ -205,6 +205,12 @@ Botan::DSA_PrivateKey* BotanDSAPrivateKey::getBotanKey()
 	return dsa;
 }
 
+// Create the Botan representation of the key up front
+bool BotanDSAPrivateKey::prepare()
+{
+	return getBotanKey() != NULL;
+}
+
 // Create the Botan representation of the key
 void BotanDSAPrivateKey::createBotanKey()
 {
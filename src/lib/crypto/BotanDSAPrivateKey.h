@@ -68,6 +68,9 @@ public:
 	// Decode from PKCS#8 BER
 	virtual bool PKCS8Decode(const ByteString& ber);
 
+	// Create the Botan representation of the key up front
+	virtual bool prepare();
+
 	// Set from Botan representation
 	virtual void setFromBotan(const Botan::DSA_PrivateKey* inDSA);
 
@@ -133,7 +133,7 @@ bool BotanECDH::generateKeyPair(AsymmetricKeyPair** ppKeyPair, AsymmetricParamet
 	try
 	{
 		BotanRNG* rng = (BotanRNG*)BotanCryptoFactory::i()->getRNG();
-		eckp = new Botan::ECDH_PrivateKey(*rng->getRNG(), BotanUtil::byteString2ECGroup(params->getEC()));
+		eckp = new Botan::ECDH_PrivateKey(*rng->getRNG(), BotanCryptoFactory::i()->getECGroup(params->getEC()));
 	}
 	catch (...)
 	{
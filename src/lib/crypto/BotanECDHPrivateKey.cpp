@@ -71,7 +71,7 @@ unsigned long BotanECDHPrivateKey::getOrderLength() const
 {
 	try
 	{
-		Botan::EC_Group group = BotanUtil::byteString2ECGroup(ec);
+		Botan::EC_Group group = BotanCryptoFactory::i()->getECGroup(ec);
 		return group.get_order().bytes();
 	}
 	catch (...)
@@ -218,6 +218,12 @@ Botan::ECDH_PrivateKey* BotanECDHPrivateKey::getBotanKey()
 	return eckey;
 }
 
+// Create the Botan representation of the key up front
+bool BotanECDHPrivateKey::prepare()
+{
+	return getBotanKey() != NULL;
+}
+
 // Create the Botan representation of the key
 void BotanECDHPrivateKey::createBotanKey()
 {
@@ -233,7 +239,7 @@ void BotanECDHPrivateKey::createBotanKey()
 		try
 		{
 			BotanRNG* rng = (BotanRNG*)BotanCryptoFactory::i()->getRNG();
-			Botan::EC_Group group = BotanUtil::byteString2ECGroup(ec);
+			Botan::EC_Group group = BotanCryptoFactory::i()->getECGroup(ec);
 			eckey = new Botan::ECDH_PrivateKey(*rng->getRNG(),
 							group,
 							BotanUtil::byteString2bigInt(d));
@@ -301,7 +301,7 @@ bool BotanECDSA::generateKeyPair(AsymmetricKeyPair** ppKeyPair, AsymmetricParame
 	try
 	{
 		BotanRNG* rng = (BotanRNG*)BotanCryptoFactory::i()->getRNG();
-		eckp = new Botan::ECDSA_PrivateKey(*rng->getRNG(), BotanUtil::byteString2ECGroup(params->getEC()));
+		eckp = new Botan::ECDSA_PrivateKey(*rng->getRNG(), BotanCryptoFactory::i()->getECGroup(params->getEC()));
 	}
 	catch (...)
 	{
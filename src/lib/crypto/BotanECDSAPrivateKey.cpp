@@ -71,7 +71,7 @@ unsigned long BotanECDSAPrivateKey::getOrderLength() const
 {
 	try
 	{
-		Botan::EC_Group group = BotanUtil::byteString2ECGroup(ec);
+		Botan::EC_Group group = BotanCryptoFactory::i()->getECGroup(ec);
 		return group.get_order().bytes();
 	}
 	catch (...)
@@ -214,6 +214,12 @@ Botan::ECDSA_PrivateKey* BotanECDSAPrivateKey::getBotanKey()
 	return eckey;
 }
 
+// Create the Botan representation of the key up front
+bool BotanECDSAPrivateKey::prepare()
+{
+	return getBotanKey() != NULL;
+}
+
 // Create the Botan representation of the key
 void BotanECDSAPrivateKey::createBotanKey()
 {
@@ -229,7 +235,7 @@ void BotanECDSAPrivateKey::createBotanKey()
 		try
 		{
 			BotanRNG* rng = (BotanRNG*)BotanCryptoFactory::i()->getRNG();
-			Botan::EC_Group group = BotanUtil::byteString2ECGroup(ec);
+			Botan::EC_Group group = BotanCryptoFactory::i()->getECGroup(ec);
 			eckey = new Botan::ECDSA_PrivateKey(*rng->getRNG(),
 							group,
 							BotanUtil::byteString2bigInt(d));
@@ -34,6 +34,7 @@
 #ifdef WITH_ECC
 #include "log.h"
 #include "BotanECDSAPublicKey.h"
+#include "BotanCryptoFactory.h"
 #include "BotanUtil.h"
 #include <string.h>
 
@@ -64,7 +65,7 @@ unsigned long BotanECDSAPublicKey::getOrderLength() const
 {
 	try
 	{
-		Botan::EC_Group group = BotanUtil::byteString2ECGroup(ec);
+		Botan::EC_Group group = BotanCryptoFactory::i()->getECGroup(ec);
 		return group.get_order().bytes();
 	}
 	catch (...)
@@ -138,7 +139,7 @@ void BotanECDSAPublicKey::createBotanKey()
 
 		try
 		{
-			Botan::EC_Group group = BotanUtil::byteString2ECGroup(ec);
+			Botan::EC_Group group = BotanCryptoFactory::i()->getECGroup(ec);
 			Botan::PointGFp point = BotanUtil::byteString2ECPoint(q, group);
 			eckey = new Botan::ECDSA_PublicKey(group, point);
 		}
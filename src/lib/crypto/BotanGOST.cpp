@@ -131,17 +131,21 @@ bool BotanGOST::signInit(PrivateKey* privateKey, const AsymMech::Type mechanism,
 
 bool BotanGOST::signUpdate(const ByteString& dataToSign)
 {
-	if (!AsymmetricAlgorithm::signUpdate(dataToSign))
+	return signUpdate(dataToSign.const_byte_str(), dataToSign.size());
+}
+
+bool BotanGOST::signUpdate(const unsigned char* dataToSign, size_t dataToSignLen)
+{
+	if (!AsymmetricAlgorithm::signUpdate(dataToSign, dataToSignLen))
 	{
 		return false;
 	}
 
 	try
 	{
-		if (dataToSign.size() != 0)
+		if (dataToSignLen != 0)
 		{
-			signer->update(dataToSign.const_byte_str(),
-				       dataToSign.size());
+			signer->update(dataToSign, dataToSignLen);
 		}
 	}
 	catch (...)
@@ -273,17 +277,21 @@ bool BotanGOST::verifyInit(PublicKey* publicKey, const AsymMech::Type mechanism,
 
 bool BotanGOST::verifyUpdate(const ByteString& originalData)
 {
-	if (!AsymmetricAlgorithm::verifyUpdate(originalData))
+	return verifyUpdate(originalData.const_byte_str(), originalData.size());
+}
+
+bool BotanGOST::verifyUpdate(const unsigned char* originalData, size_t originalDataLen)
+{
+	if (!AsymmetricAlgorithm::verifyUpdate(originalData, originalDataLen))
 	{
 		return false;
 	}
 
 	try
 	{
-		if (originalData.size() != 0)
+		if (originalDataLen != 0)
 		{
-			verifier->update(originalData.const_byte_str(),
-					 originalData.size());
+			verifier->update(originalData, originalDataLen);
 		}
 	}
 	catch (...)
@@ -373,7 +381,7 @@ bool BotanGOST::generateKeyPair(AsymmetricKeyPair** ppKeyPair, AsymmetricParamet
 	try
 	{
 		BotanRNG* rng = (BotanRNG*)BotanCryptoFactory::i()->getRNG();
-		eckp = new Botan::GOST_3410_PrivateKey(*rng->getRNG(), BotanUtil::byteString2ECGroup(params->getEC()));
+		eckp = new Botan::GOST_3410_PrivateKey(*rng->getRNG(), BotanCryptoFactory::i()->getECGroup(params->getEC()));
 	}
 	catch (...)
 	{
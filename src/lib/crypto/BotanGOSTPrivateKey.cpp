@@ -66,7 +66,7 @@ unsigned long BotanGOSTPrivateKey::getOrderLength() const
 {
 	try
 	{
-		Botan::EC_Group group = BotanUtil::byteString2ECGroup(ec);
+		Botan::EC_Group group = BotanCryptoFactory::i()->getECGroup(ec);
 		return group.get_order().bytes();
 	}
 	catch (...)
@@ -172,6 +172,12 @@ Botan::GOST_3410_PrivateKey* BotanGOSTPrivateKey::getBotanKey()
 	return eckey;
 }
 
+// Create the Botan representation of the key up front
+bool BotanGOSTPrivateKey::prepare()
+{
+	return getBotanKey() != NULL;
+}
+
 // Create the Botan representation of the key
 void BotanGOSTPrivateKey::createBotanKey()
 {
@@ -187,7 +193,7 @@ void BotanGOSTPrivateKey::createBotanKey()
 		try
 		{
 			BotanRNG* rng = (BotanRNG*)BotanCryptoFactory::i()->getRNG();
-			Botan::EC_Group group = BotanUtil::byteString2ECGroup(ec);
+			Botan::EC_Group group = BotanCryptoFactory::i()->getECGroup(ec);
 			eckey = new Botan::GOST_3410_PrivateKey(*rng->getRNG(),
 							group,
 							BotanUtil::byteString2bigInt(d));
@@ -34,6 +34,7 @@
 #ifdef WITH_GOST
 #include "log.h"
 #include "BotanGOSTPublicKey.h"
+#include "BotanCryptoFactory.h"
 #include "BotanUtil.h"
 #include <string.h>
 
@@ -64,7 +65,7 @@ unsigned long BotanGOSTPublicKey::getOrderLength() const
 {
 	try
 	{
-		Botan::EC_Group group = BotanUtil::byteString2ECGroup(ec);
+		Botan::EC_Group group = BotanCryptoFactory::i()->getECGroup(ec);
 		return group.get_order().bytes();
 	}
 	catch (...)
@@ -188,7 +189,7 @@ void BotanGOSTPublicKey::createBotanKey()
 			}
 			ByteString p = "044104" + bPoint;
 
-			Botan::EC_Group group = BotanUtil::byteString2ECGroup(ec);
+			Botan::EC_Group group = BotanCryptoFactory::i()->getECGroup(ec);
 			Botan::PointGFp point = BotanUtil::byteString2ECPoint(p, group);
 			eckey = new Botan::GOST_3410_PublicKey(group, point);
 		}
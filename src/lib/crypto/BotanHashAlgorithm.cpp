@@ -81,7 +81,12 @@ bool BotanHashAlgorithm::hashInit()
 
 bool BotanHashAlgorithm::hashUpdate(const ByteString& data)
 {
-	if (!HashAlgorithm::hashUpdate(data))
+	return hashUpdate(data.const_byte_str(), data.size());
+}
+
+bool BotanHashAlgorithm::hashUpdate(const unsigned char* data, size_t dataLen)
+{
+	if (!HashAlgorithm::hashUpdate(data, dataLen))
 	{
 		return false;
 	}
@@ -89,9 +94,9 @@ bool BotanHashAlgorithm::hashUpdate(const ByteString& data)
 	// Continue digesting
 	try
 	{
-		if (data.size() != 0)
+		if (dataLen != 0)
 		{
-			hash->update(data.const_byte_str(), data.size());
+			hash->update(data, dataLen);
 		}
 	}
 	catch (...)
@@ -131,3 +136,48 @@ bool BotanHashAlgorithm::hashFinal(ByteString& hashedData)
 
 	return true;
 }
+
+// The chain runs in the buffer of the result; final() resets the hash for
+// the next iteration
+bool BotanHashAlgorithm::hashIterated(const ByteString& data, unsigned long iterations, ByteString& hashedData)
+{
+	if ((iterations == 0) || !HashAlgorithm::hashInit())
+	{
+		return false;
+	}
+
+	ByteString dummy;
+
+	try
+	{
+		if (hash == NULL)
+		{
+			hash = getHash();
+		}
+		else
+		{
+			hash->clear();
+		}
+
+		hash->update(data.const_byte_str(), data.size());
+
+		hashedData.resize(hash->output_length());
+		hash->final(&hashedData[0]);
+
+		while (--iterations > 0)
+		{
+			hash->update(hashedData.const_byte_str(), hashedData.size());
+			hash->final(&hashedData[0]);
+		}
+	}
+	catch (...)
+	{
+		ERROR_MSG("Failed to digest the data");
+
+		HashAlgorithm::hashFinal(dummy);
+
+		return false;
+	}
+
+	return HashAlgorithm::hashFinal(dummy);
+}
@@ -49,7 +49,9 @@ public:
 	// Hashing functions
 	virtual bool hashInit();
 	virtual bool hashUpdate(const ByteString& data);
+	virtual bool hashUpdate(const unsigned char* data, size_t dataLen);
 	virtual bool hashFinal(ByteString& hashedData);
+	virtual bool hashIterated(const ByteString& data, unsigned long iterations, ByteString& hashedData);
 
 	virtual int getHashSize() = 0;
 protected:
@@ -98,7 +98,12 @@ bool BotanMacAlgorithm::signInit(const SymmetricKey* key)
 
 bool BotanMacAlgorithm::signUpdate(const ByteString& dataToSign)
 {
-	if (!MacAlgorithm::signUpdate(dataToSign))
+	return signUpdate(dataToSign.const_byte_str(), dataToSign.size());
+}
+
+bool BotanMacAlgorithm::signUpdate(const unsigned char* dataToSign, size_t dataToSignLen)
+{
+	if (!MacAlgorithm::signUpdate(dataToSign, dataToSignLen))
 	{
 		delete hmac;
 		hmac = NULL;
@@ -108,10 +113,9 @@ bool BotanMacAlgorithm::signUpdate(const ByteString& dataToSign)
 
 	try
 	{
-		if (dataToSign.size() != 0)
+		if (dataToSignLen != 0)
 		{
-			hmac->update(dataToSign.const_byte_str(),
-				     dataToSign.size());
+			hmac->update(dataToSign, dataToSignLen);
 		}
 	}
 	catch (...)
@@ -217,7 +221,12 @@ bool BotanMacAlgorithm::verifyInit(const SymmetricKey* key)
 
 bool BotanMacAlgorithm::verifyUpdate(const ByteString& originalData)
 {
-	if (!MacAlgorithm::verifyUpdate(originalData))
+	return verifyUpdate(originalData.const_byte_str(), originalData.size());
+}
+
+bool BotanMacAlgorithm::verifyUpdate(const unsigned char* originalData, size_t originalDataLen)
+{
+	if (!MacAlgorithm::verifyUpdate(originalData, originalDataLen))
 	{
 		delete hmac;
 		hmac = NULL;
@@ -227,10 +236,9 @@ bool BotanMacAlgorithm::verifyUpdate(const ByteString& originalData)
 
 	try
 	{
-		if (originalData.size() != 0)
+		if (originalDataLen != 0)
 		{
-			hmac->update(originalData.const_byte_str(),
-				     originalData.size());
+			hmac->update(originalData, originalDataLen);
 		}
 	}
 	catch (...)
@@ -51,11 +51,13 @@ public:
 	// Signing functions
 	virtual bool signInit(const SymmetricKey* key);
 	virtual bool signUpdate(const ByteString& dataToSign);
+	virtual bool signUpdate(const unsigned char* dataToSign, size_t dataToSignLen);
 	virtual bool signFinal(ByteString& signature);
 
 	// Verification functions
 	virtual bool verifyInit(const SymmetricKey* key);
 	virtual bool verifyUpdate(const ByteString& originalData);
+	virtual bool verifyUpdate(const unsigned char* originalData, size_t originalDataLen);
 	virtual bool verifyFinal(ByteString& signature);
 
 	// Return the MAC size
@@ -60,12 +60,10 @@ BotanRNG::~BotanRNG()
 }
 
 // Generate random data
-bool BotanRNG::generateRandom(ByteString& data, const size_t len)
+bool BotanRNG::generateRandom(unsigned char* data, const size_t len)
 {
-	data.wipe(len);
-
 	if (len > 0)
-		rng->randomize(&data[0], len);
+		rng->randomize(data, len);
 
 	return true;
 }
@@ -49,7 +49,8 @@ public:
 	virtual ~BotanRNG();
 
 	// Generate random data
-	virtual bool generateRandom(ByteString& data, const size_t len);
+	using RNG::generateRandom;
+	virtual bool generateRandom(unsigned char* data, const size_t len);
 
 	// Seed the random pool
 	virtual void seed(ByteString& seedData);
@@ -258,6 +258,12 @@ Botan::RSA_PrivateKey* BotanRSAPrivateKey::getBotanKey()
 	return rsa;
 }
 
+// Create the Botan representation of the key up front
+bool BotanRSAPrivateKey::prepare()
+{
+	return getBotanKey() != NULL;
+}
+
 // Create the Botan representation of the key
 void BotanRSAPrivateKey::createBotanKey()
 {
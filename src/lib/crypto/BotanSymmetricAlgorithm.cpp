@@ -231,6 +231,121 @@ bool BotanSymmetricAlgorithm::encryptFinal(ByteString& encryptedData)
 	return true;
 }
 
+bool BotanSymmetricAlgorithm::encryptUpdate(const unsigned char* data, size_t dataLen, unsigned char* encryptedData, size_t& encryptedDataLen)
+{
+	if (!SymmetricAlgorithm::encryptUpdate(data, dataLen, encryptedData, encryptedDataLen))
+	{
+		delete cryption;
+		cryption = NULL;
+
+		return false;
+	}
+
+	// Write data
+	try
+	{
+		if (dataLen > 0)
+			cryption->write(data, dataLen);
+	}
+	catch (...)
+	{
+		ERROR_MSG("Failed to write to the encryption token");
+
+		ByteString dummy;
+		SymmetricAlgorithm::encryptFinal(dummy);
+
+		delete cryption;
+		cryption = NULL;
+
+		return false;
+	}
+
+	// Read data directly into the output buffer
+	size_t bytesRead = 0;
+	try
+	{
+		size_t outLen = cryption->remaining();
+		if (outLen > encryptedDataLen)
+		{
+			ERROR_MSG("The output buffer is too small");
+
+			ByteString dummy;
+			SymmetricAlgorithm::encryptFinal(dummy);
+
+			delete cryption;
+			cryption = NULL;
+
+			return false;
+		}
+		if (outLen > 0)
+			bytesRead = cryption->read(encryptedData, outLen);
+	}
+	catch (...)
+	{
+		ERROR_MSG("Failed to encrypt the data");
+
+		ByteString dummy;
+		SymmetricAlgorithm::encryptFinal(dummy);
+
+		delete cryption;
+		cryption = NULL;
+
+		return false;
+	}
+
+	encryptedDataLen = bytesRead;
+	currentBufferSize -= bytesRead;
+
+	return true;
+}
+
+bool BotanSymmetricAlgorithm::encryptFinal(unsigned char* encryptedData, size_t& encryptedDataLen)
+{
+	if (!SymmetricAlgorithm::encryptFinal(encryptedData, encryptedDataLen))
+	{
+		delete cryption;
+		cryption = NULL;
+
+		return false;
+	}
+
+	// Read data directly into the output buffer
+	size_t bytesRead = 0;
+	try
+	{
+		cryption->end_msg();
+		size_t outLen = cryption->remaining();
+		if (outLen > encryptedDataLen)
+		{
+			ERROR_MSG("The output buffer is too small");
+
+			delete cryption;
+			cryption = NULL;
+
+			return false;
+		}
+		if (outLen > 0)
+			bytesRead = cryption->read(encryptedData, outLen);
+	}
+	catch (...)
+	{
+		ERROR_MSG("Failed to encrypt the data");
+
+		delete cryption;
+		cryption = NULL;
+
+		return false;
+	}
+
+	// Clean up
+	delete cryption;
+	cryption = NULL;
+
+	encryptedDataLen = bytesRead;
+
+	return true;
+}
+
 // Decryption functions
 bool BotanSymmetricAlgorithm::decryptInit(const SymmetricKey* key, const SymMode::Type mode /* = SymMode::CBC */, const ByteString& IV /* = ByteString() */, bool padding /* = true */)
 {
@@ -404,3 +519,118 @@ bool BotanSymmetricAlgorithm::decryptFinal(ByteString& data)
 	return true;
 }
 
+bool BotanSymmetricAlgorithm::decryptUpdate(const unsigned char* encryptedData, size_t encryptedDataLen, unsigned char* data, size_t& dataLen)
+{
+	if (!SymmetricAlgorithm::decryptUpdate(encryptedData, encryptedDataLen, data, dataLen))
+	{
+		delete cryption;
+		cryption = NULL;
+
+		return false;
+	}
+
+	// Write data
+	try
+	{
+		if (encryptedDataLen > 0)
+			cryption->write(encryptedData, encryptedDataLen);
+	}
+	catch (...)
+	{
+		ERROR_MSG("Failed to write to the decryption token");
+
+		ByteString dummy;
+		SymmetricAlgorithm::decryptFinal(dummy);
+
+		delete cryption;
+		cryption = NULL;
+
+		return false;
+	}
+
+	// Read data directly into the output buffer
+	size_t bytesRead = 0;
+	try
+	{
+		size_t outLen = cryption->remaining();
+		if (outLen > dataLen)
+		{
+			ERROR_MSG("The output buffer is too small");
+
+			ByteString dummy;
+			SymmetricAlgorithm::decryptFinal(dummy);
+
+			delete cryption;
+			cryption = NULL;
+
+			return false;
+		}
+		if (outLen > 0)
+			bytesRead = cryption->read(data, outLen);
+	}
+	catch (...)
+	{
+		ERROR_MSG("Failed to decrypt the data");
+
+		ByteString dummy;
+		SymmetricAlgorithm::decryptFinal(dummy);
+
+		delete cryption;
+		cryption = NULL;
+
+		return false;
+	}
+
+	dataLen = bytesRead;
+	currentBufferSize -= bytesRead;
+
+	return true;
+}
+
+bool BotanSymmetricAlgorithm::decryptFinal(unsigned char* data, size_t& dataLen)
+{
+	if (!SymmetricAlgorithm::decryptFinal(data, dataLen))
+	{
+		delete cryption;
+		cryption = NULL;
+
+		return false;
+	}
+
+	// Read data directly into the output buffer
+	size_t bytesRead = 0;
+	try
+	{
+		cryption->end_msg();
+		size_t outLen = cryption->remaining();
+		if (outLen > dataLen)
+		{
+			ERROR_MSG("The output buffer is too small");
+
+			delete cryption;
+			cryption = NULL;
+
+			return false;
+		}
+		if (outLen > 0)
+			bytesRead = cryption->read(data, outLen);
+	}
+	catch (...)
+	{
+		ERROR_MSG("Failed to decrypt the data");
+
+		delete cryption;
+		cryption = NULL;
+
+		return false;
+	}
+
+	// Clean up
+	delete cryption;
+	cryption = NULL;
+
+	dataLen = bytesRead;
+
+	return true;
+}
+
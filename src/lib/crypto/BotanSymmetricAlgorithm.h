@@ -53,11 +53,15 @@ public:
 	virtual bool encryptInit(const SymmetricKey* key, const SymMode::Type mode = SymMode::CBC, const ByteString& IV = ByteString(), bool padding = true);
 	virtual bool encryptUpdate(const ByteString& data, ByteString& encryptedData);
 	virtual bool encryptFinal(ByteString& encryptedData);
+	virtual bool encryptUpdate(const unsigned char* data, size_t dataLen, unsigned char* encryptedData, size_t& encryptedDataLen);
+	virtual bool encryptFinal(unsigned char* encryptedData, size_t& encryptedDataLen);
 
 	// Decryption functions
 	virtual bool decryptInit(const SymmetricKey* key, const SymMode::Type mode = SymMode::CBC, const ByteString& IV = ByteString(), bool padding = true);
 	virtual bool decryptUpdate(const ByteString& encryptedData, ByteString& data);
 	virtual bool decryptFinal(ByteString& data);
+	virtual bool decryptUpdate(const unsigned char* encryptedData, size_t encryptedDataLen, unsigned char* data, size_t& dataLen);
+	virtual bool decryptFinal(unsigned char* data, size_t& dataLen);
 
 	// Return the block size
 	virtual size_t getBlockSize() const = 0;
@@ -62,6 +62,16 @@ bool HashAlgorithm::hashUpdate(const ByteString& /*data*/)
 	return true;
 }
 
+bool HashAlgorithm::hashUpdate(const unsigned char* /*data*/, size_t /*dataLen*/)
+{
+	if (currentOperation != HASHING)
+	{
+		return false;
+	}
+
+	return true;
+}
+
 bool HashAlgorithm::hashFinal(ByteString& /*hashedData*/)
 {
 	if (currentOperation != HASHING)
@@ -74,3 +84,31 @@ bool HashAlgorithm::hashFinal(ByteString& /*hashedData*/)
 	return true;
 }
 
+// Generic iterated hashing; backends override this to run the chain without
+// starting a new hashing operation for every iteration
+bool HashAlgorithm::hashIterated(const ByteString& data, unsigned long iterations, ByteString& hashedData)
+{
+	if (iterations == 0)
+	{
+		return false;
+	}
+
+	if (!hashInit() ||
+	    !hashUpdate(data) ||
+	    !hashFinal(hashedData))
+	{
+		return false;
+	}
+
+	while (--iterations > 0)
+	{
+		if (!hashInit() ||
+		    !hashUpdate(hashedData) ||
+		    !hashFinal(hashedData))
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
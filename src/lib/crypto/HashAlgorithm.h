@@ -63,8 +63,12 @@ public:
 	// Hashing functions
 	virtual bool hashInit();
 	virtual bool hashUpdate(const ByteString& data);
+	virtual bool hashUpdate(const unsigned char* data, size_t dataLen);
 	virtual bool hashFinal(ByteString& hashedData);
 
+	// Hash the data and then the digest again, iterations times in total
+	virtual bool hashIterated(const ByteString& data, unsigned long iterations, ByteString& hashedData);
+
 	virtual int getHashSize() = 0;
 protected:
 	// The current operation
@@ -0,0 +1,533 @@
+/*
+ * Copyright (c) 2016 SURFnet bv
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+/*****************************************************************************
+ KeyPairPool.cpp
+
+ Keeps a configured number of RSA and EC key pairs ready, generated ahead of
+ time by background threads, so that C_GenerateKeyPair only has to store the
+ key objects. The private keys of ready key pairs are held in the structures
+ of the crypto library, outside the secure memory registry, so they are
+ replaced once they reach a configurable age.
+ *****************************************************************************/
+
+#include "config.h"
+#include "log.h"
+#include "CryptoFactory.h"
+#include "KeyPairPool.h"
+#include "osthread.h"
+#include <stdlib.h>
+#include <sstream>
+#ifdef HAVE_PTHREAD_H
+#include <unistd.h>
+#endif
+
+// Split a string at the given separator and trim the parts
+static std::vector<std::string> split(const std::string& str, char separator)
+{
+	std::vector<std::string> parts;
+	std::istringstream stream(str);
+	std::string part;
+
+	while (std::getline(stream, part, separator))
+	{
+		size_t begin = part.find_first_not_of(" \t");
+		size_t end = part.find_last_not_of(" \t");
+
+		if (begin == std::string::npos)
+		{
+			parts.push_back("");
+		}
+		else
+		{
+			parts.push_back(part.substr(begin, end - begin + 1));
+		}
+	}
+
+	return parts;
+}
+
+// Parse a positive decimal number
+static bool toSize(const std::string& str, size_t& value)
+{
+	char* end = NULL;
+
+	if (str.empty() || str.find_first_not_of("0123456789") != std::string::npos) return false;
+
+	value = strtoul(str.c_str(), &end, 10);
+
+	return *end == '\0' && value > 0;
+}
+
+// The named curves that can be used in keygen.pool.ec
+static const struct
+{
+	const char* name;
+	const char* der;
+} curves[] = {
+	{ "P-256",	"06082A8648CE3D030107" },
+	{ "prime256v1",	"06082A8648CE3D030107" },
+	{ "secp256r1",	"06082A8648CE3D030107" },
+	{ "P-384",	"06052B81040022" },
+	{ "secp384r1",	"06052B81040022" },
+	{ "P-521",	"06052B81040023" },
+	{ "secp521r1",	"06052B81040023" },
+	{ NULL,		NULL }
+};
+
+// Constructor
+KeyPairPool::KeyPairPool()
+{
+	stopping = false;
+	lifetime = KEY_PAIR_POOL_LIFETIME;
+
+	// Without a condition the pool is never started
+	if (OSCreateCondition(&condition) != CKR_OK)
+	{
+		condition = NULL;
+	}
+
+#ifdef HAVE_PTHREAD_H
+	pid = getpid();
+#endif
+}
+
+// Destructor
+KeyPairPool::~KeyPairPool()
+{
+	stop();
+
+	for (std::map<std::string, Entry*>::iterator i = entries.begin(); i != entries.end(); i++)
+	{
+		Entry* entry = i->second;
+
+		for (std::list<ReadyPair>::iterator j = entry->ready.begin(); j != entry->ready.end(); j++)
+		{
+			delete j->kp;
+		}
+
+		delete entry->parameters;
+		delete entry;
+	}
+
+	// The threads of the parent do not exist in a child process and may
+	// have left the mutex locked, so it is left alone there
+	if (isForked() || condition == NULL) return;
+
+	OSDestroyCondition(condition);
+}
+
+// Add the RSA entries of a "bits[:exponent]:count, ..." specification
+bool KeyPairPool::configureRSA(const std::string& spec)
+{
+	std::vector<std::string> items = split(spec, ',');
+
+	for (size_t i = 0; i < items.size(); i++)
+	{
+		std::vector<std::string> fields = split(items[i], ':');
+		size_t bitLen, exponent, count;
+
+		if (fields.size() == 2)
+		{
+			fields.insert(fields.begin() + 1, "65537");
+		}
+
+		if (fields.size() != 3 ||
+		    !toSize(fields[0], bitLen) ||
+		    !toSize(fields[1], exponent) ||
+		    !toSize(fields[2], count))
+		{
+			ERROR_MSG("Invalid RSA key pair pool entry \"%s\"", items[i].c_str());
+
+			return false;
+		}
+
+		if (!addRSA(bitLen, ByteString((unsigned long) exponent), count)) return false;
+	}
+
+	return true;
+}
+
+// Add the EC entries of a "curve:count, ..." specification
+bool KeyPairPool::configureEC(const std::string& spec)
+{
+	std::vector<std::string> items = split(spec, ',');
+
+	for (size_t i = 0; i < items.size(); i++)
+	{
+		std::vector<std::string> fields = split(items[i], ':');
+		ByteString ec;
+		size_t count;
+
+		if (fields.size() == 2)
+		{
+			for (size_t j = 0; curves[j].name != NULL; j++)
+			{
+				if (fields[0] == curves[j].name)
+				{
+					ec = ByteString(curves[j].der);
+					break;
+				}
+			}
+
+			if (ec.size() == 0 &&
+			    fields[0].size() % 2 == 0 &&
+			    fields[0].find_first_not_of("0123456789abcdefABCDEF") == std::string::npos)
+			{
+				ec = ByteString(fields[0].c_str());
+			}
+		}
+
+		if (ec.size() == 0 || !toSize(fields[1], count))
+		{
+			ERROR_MSG("Invalid EC key pair pool entry \"%s\"", items[i].c_str());
+
+			return false;
+		}
+
+		if (!addEC(ec, count)) return false;
+	}
+
+	return true;
+}
+
+// Keep count RSA key pairs with the given parameters ready
+bool KeyPairPool::addRSA(const size_t bitLen, const ByteString& e, const size_t count)
+{
+	RSAParameters* params = new RSAParameters();
+	params->setE(e);
+	params->setBitLength(bitLen);
+
+	return add(rsaID(bitLen, e), AsymAlgo::RSA, params, count);
+}
+
+// Keep count EC key pairs with the given parameters ready
+bool KeyPairPool::addEC(const ByteString& ec, const size_t count)
+{
+	ECParameters* params = new ECParameters();
+	params->setEC(ec);
+
+	return add(ecID(ec), AsymAlgo::ECDSA, params, count);
+}
+
+bool KeyPairPool::add(const std::string& id, AsymAlgo::Type algorithm, AsymmetricParameters* parameters, const size_t count)
+{
+	lock();
+
+	if (!threads.empty() || entries.find(id) != entries.end())
+	{
+		unlock();
+
+		ERROR_MSG("Key pair pool entry %s can only be configured once, before the pool is started", id.c_str());
+		delete parameters;
+
+		return false;
+	}
+
+	Entry* entry = new Entry();
+	entry->algorithm = algorithm;
+	entry->parameters = parameters;
+	entry->count = count;
+	entry->pending = 0;
+	entry->failed = false;
+	entries[id] = entry;
+
+	unlock();
+
+	return true;
+}
+
+// Set the number of seconds that a ready key pair is kept
+void KeyPairPool::setLifetime(const time_t seconds)
+{
+	lock();
+	lifetime = seconds > 0 ? seconds : KEY_PAIR_POOL_LIFETIME;
+	unlock();
+}
+
+// Is there anything to generate?
+bool KeyPairPool::isEmpty() const
+{
+	return entries.empty();
+}
+
+// Start the worker threads
+bool KeyPairPool::start(const size_t count)
+{
+	if (count == 0 || entries.empty()) return true;
+
+	// The workers share the crypto factory, which must exist before they do
+	if (condition == NULL || CryptoFactory::i() == NULL) return false;
+
+	for (size_t i = 0; i < count; i++)
+	{
+		CK_VOID_PTR thread;
+
+		if (OSCreateThread(&thread, run, this) != CKR_OK)
+		{
+			stop();
+
+			return false;
+		}
+
+		lock();
+		threads.push_back(thread);
+		unlock();
+	}
+
+	DEBUG_MSG("Started %u key pair pool thread(s) for %u entries", (unsigned) count, (unsigned) entries.size());
+
+	return true;
+}
+
+// Stop the worker threads
+void KeyPairPool::stop()
+{
+	if (isForked())
+	{
+		threads.clear();
+		return;
+	}
+
+	lock();
+	stopping = true;
+	wakeAll();
+	unlock();
+
+	// No new threads can be added while stopping
+	for (size_t i = 0; i < threads.size(); i++)
+	{
+		OSJoinThread(threads[i]);
+	}
+
+	threads.clear();
+}
+
+// Take a ready RSA key pair
+AsymmetricKeyPair* KeyPairPool::takeRSA(const RSAParameters& params)
+{
+	return take(rsaID(params.getBitLength(), params.getE()));
+}
+
+// Take a ready EC key pair
+AsymmetricKeyPair* KeyPairPool::takeEC(const ECParameters& params)
+{
+	return take(ecID(params.getEC()));
+}
+
+AsymmetricKeyPair* KeyPairPool::take(const std::string& id)
+{
+	// Key pairs generated for the parent must never be handed out twice
+	if (isForked()) return NULL;
+
+	lock();
+
+	expire();
+
+	std::map<std::string, Entry*>::iterator i = entries.find(id);
+	if (i == entries.end() || i->second->ready.empty())
+	{
+		unlock();
+
+		return NULL;
+	}
+
+	AsymmetricKeyPair* kp = i->second->ready.front().kp;
+	i->second->ready.pop_front();
+
+	// Have the taken key pair replaced
+	wakeAll();
+	unlock();
+
+	return kp;
+}
+
+// The exponent is compared without leading zeroes
+/*static*/ std::string KeyPairPool::rsaID(const size_t bitLen, const ByteString& e)
+{
+	std::ostringstream id;
+	size_t offset = 0;
+
+	while (offset < e.size() && e.const_byte_str()[offset] == 0) offset++;
+
+	id << "RSA-" << bitLen << ":" << e.substr(offset).hex_str();
+
+	return id.str();
+}
+
+/*static*/ std::string KeyPairPool::ecID(const ByteString& ec)
+{
+	return "EC:" + ec.hex_str();
+}
+
+/*static*/ void* KeyPairPool::run(void* pool)
+{
+	((KeyPairPool*) pool)->work();
+
+	return NULL;
+}
+
+// Generate key pairs until the pool is stopped
+void KeyPairPool::work()
+{
+	lock();
+
+	while (!stopping)
+	{
+		time_t next = expire();
+		Entry* entry = nextEntry();
+
+		if (entry == NULL)
+		{
+			wait(next);
+			continue;
+		}
+
+		entry->pending++;
+		unlock();
+
+		// Generate without holding the lock
+		AsymmetricKeyPair* kp = NULL;
+		AsymmetricAlgorithm* algorithm = CryptoFactory::i()->getAsymmetricAlgorithm(entry->algorithm);
+		if (algorithm != NULL)
+		{
+			if (!algorithm->generateKeyPair(&kp, entry->parameters))
+			{
+				kp = NULL;
+			}
+
+			CryptoFactory::i()->recycleAsymmetricAlgorithm(algorithm);
+		}
+
+		lock();
+		entry->pending--;
+
+		if (kp == NULL)
+		{
+			ERROR_MSG("Could not generate a key pair for the pool; the entry is disabled");
+
+			entry->failed = true;
+		}
+		else if (stopping)
+		{
+			delete kp;
+		}
+		else
+		{
+			ReadyPair ready;
+			ready.kp = kp;
+			ready.generated = time(NULL);
+
+			entry->ready.push_back(ready);
+		}
+	}
+
+	unlock();
+}
+
+// Find the entry that is least filled relative to its size
+// Calling function must lock the mutex
+KeyPairPool::Entry* KeyPairPool::nextEntry()
+{
+	Entry* next = NULL;
+
+	for (std::map<std::string, Entry*>::iterator i = entries.begin(); i != entries.end(); i++)
+	{
+		Entry* entry = i->second;
+		size_t filled = entry->ready.size() + entry->pending;
+
+		if (entry->failed || filled >= entry->count) continue;
+
+		if (next == NULL ||
+		    filled * next->count < (next->ready.size() + next->pending) * entry->count)
+		{
+			next = entry;
+		}
+	}
+
+	return next;
+}
+
+// Wipe the key pairs that have reached their lifetime
+// Calling function must lock the mutex
+time_t KeyPairPool::expire()
+{
+	time_t now = time(NULL);
+	time_t next = 0;
+
+	for (std::map<std::string, Entry*>::iterator i = entries.begin(); i != entries.end(); i++)
+	{
+		std::list<ReadyPair>& ready = i->second->ready;
+
+		while (!ready.empty() && now - ready.front().generated >= lifetime)
+		{
+			delete ready.front().kp;
+			ready.pop_front();
+		}
+
+		if (!ready.empty())
+		{
+			time_t left = ready.front().generated + lifetime - now;
+
+			if (next == 0 || left < next) next = left;
+		}
+	}
+
+	return next;
+}
+
+bool KeyPairPool::isForked() const
+{
+#ifdef HAVE_PTHREAD_H
+	return getpid() != pid;
+#else
+	return false;
+#endif
+}
+
+void KeyPairPool::lock()
+{
+	if (condition != NULL) OSLockCondition(condition);
+}
+
+void KeyPairPool::unlock()
+{
+	if (condition != NULL) OSUnlockCondition(condition);
+}
+
+// Wait to be woken up or for the given number of seconds, if not 0
+// Calling function must lock the mutex
+void KeyPairPool::wait(const time_t seconds)
+{
+	OSWaitCondition(condition, (unsigned long) seconds * 1000);
+}
+
+// Calling function must lock the mutex
+void KeyPairPool::wakeAll()
+{
+	if (condition != NULL) OSBroadcastCondition(condition);
+}
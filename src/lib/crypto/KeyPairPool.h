@@ -0,0 +1,157 @@
+/*
+ * Copyright (c) 2016 SURFnet bv
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+/*****************************************************************************
+ KeyPairPool.h
+
+ Keeps a configured number of RSA and EC key pairs ready, generated ahead of
+ time by background threads, so that C_GenerateKeyPair only has to store the
+ key objects. The private keys of ready key pairs are held in the structures
+ of the crypto library, outside the secure memory registry, so they are
+ replaced once they reach a configurable age.
+ *****************************************************************************/
+
+#ifndef _SOFTHSM_V2_KEYPAIRPOOL_H
+#define _SOFTHSM_V2_KEYPAIRPOOL_H
+
+#include "config.h"
+#include "cryptoki.h"
+
+#ifdef HAVE_PTHREAD_H
+#include <sys/types.h>
+#endif
+
+#include <string>
+#include <time.h>
+#include <map>
+#include <list>
+#include <vector>
+#include "ByteString.h"
+#include "AsymmetricAlgorithm.h"
+#include "AsymmetricKeyPair.h"
+#include "RSAParameters.h"
+#include "ECParameters.h"
+
+// The default number of seconds that a ready key pair is kept
+#define KEY_PAIR_POOL_LIFETIME 600
+
+class KeyPairPool
+{
+public:
+	// Constructor
+	KeyPairPool();
+
+	// Destructor; stops the worker threads and wipes the unused key pairs
+	virtual ~KeyPairPool();
+
+	// Add the RSA entries of a "bits[:exponent]:count, ..." specification
+	bool configureRSA(const std::string& spec);
+
+	// Add the EC entries of a "curve:count, ..." specification; the curve is
+	// a name like P-256 or the DER encoded parameters in hex
+	bool configureEC(const std::string& spec);
+
+	// Keep count key pairs with the given parameters ready
+	bool addRSA(const size_t bitLen, const ByteString& e, const size_t count);
+	bool addEC(const ByteString& ec, const size_t count);
+
+	// Set the number of seconds that a ready key pair is kept; older key
+	// pairs are wiped and generated again
+	void setLifetime(const time_t seconds);
+
+	// Is there anything to generate?
+	bool isEmpty() const;
+
+	// Start the worker threads
+	bool start(const size_t threads);
+
+	// Stop the worker threads, waiting for the key pairs they are generating
+	void stop();
+
+	// Take a ready key pair; returns NULL if there is none, in which case the
+	// caller must generate the key pair itself. The key pair can be recycled
+	// by an asymmetric algorithm of the matching type.
+	AsymmetricKeyPair* takeRSA(const RSAParameters& params);
+	AsymmetricKeyPair* takeEC(const ECParameters& params);
+
+private:
+	// A ready key pair and the time at which it was generated
+	struct ReadyPair
+	{
+		AsymmetricKeyPair* kp;
+		time_t generated;
+	};
+
+	// The key pairs for one set of parameters; the ready ones oldest first
+	struct Entry
+	{
+		AsymAlgo::Type algorithm;
+		AsymmetricParameters* parameters;
+		size_t count;
+		size_t pending;
+		bool failed;
+		std::list<ReadyPair> ready;
+	};
+
+	// Identify the entries
+	static std::string rsaID(const size_t bitLen, const ByteString& e);
+	static std::string ecID(const ByteString& ec);
+
+	bool add(const std::string& id, AsymAlgo::Type algorithm, AsymmetricParameters* parameters, const size_t count);
+	AsymmetricKeyPair* take(const std::string& id);
+
+	// Worker threads
+	static void* run(void* pool);
+	void work();
+	Entry* nextEntry();
+
+	// Wipe the key pairs that are too old; returns the number of seconds
+	// until the next one is, or 0 if there are none
+	time_t expire();
+
+	// Were we inherited by a child process?
+	bool isForked() const;
+
+	void lock();
+	void unlock();
+	void wait(const time_t seconds);
+	void wakeAll();
+
+	std::map<std::string, Entry*> entries;
+	std::vector<CK_VOID_PTR> threads;
+	bool stopping;
+	time_t lifetime;
+
+	// Guards the entries and wakes up the worker threads
+	CK_VOID_PTR condition;
+
+#ifdef HAVE_PTHREAD_H
+	pid_t pid;
+#endif
+};
+
+#endif // !_SOFTHSM_V2_KEYPAIRPOOL_H
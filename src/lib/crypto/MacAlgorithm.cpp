@@ -63,6 +63,16 @@ bool MacAlgorithm::signUpdate(const ByteString& /*dataToSign*/)
 	return true;
 }
 
+bool MacAlgorithm::signUpdate(const unsigned char* /*dataToSign*/, size_t /*dataToSignLen*/)
+{
+	if (currentOperation != SIGN)
+	{
+		return false;
+	}
+
+	return true;
+}
+
 bool MacAlgorithm::signFinal(ByteString& /*signature*/)
 {
 	if (currentOperation != SIGN)
@@ -99,6 +109,16 @@ bool MacAlgorithm::verifyUpdate(const ByteString& /*originalData*/)
 	return true;
 }
 
+bool MacAlgorithm::verifyUpdate(const unsigned char* /*originalData*/, size_t /*originalDataLen*/)
+{
+	if (currentOperation != VERIFY)
+	{
+		return false;
+	}
+
+	return true;
+}
+
 bool MacAlgorithm::verifyFinal(ByteString& /*signature*/)
 {
 	if (currentOperation != VERIFY)
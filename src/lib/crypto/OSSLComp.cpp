@@ -57,6 +57,12 @@
 
 #include <string.h>
 
+// EVP cipher routines
+int EVP_CIPHER_CTX_reset(EVP_CIPHER_CTX *ctx)
+{
+	return EVP_CIPHER_CTX_cleanup(ctx);
+}
+
 // EVP digest routines
 EVP_MD_CTX *EVP_MD_CTX_new(void)
 {
@@ -88,6 +94,14 @@ HMAC_CTX *HMAC_CTX_new(void)
 	return ctx;
 }
 
+int HMAC_CTX_reset(HMAC_CTX *ctx)
+{
+	HMAC_CTX_cleanup(ctx);
+	HMAC_CTX_init(ctx);
+
+	return 1;
+}
+
 void HMAC_CTX_free(HMAC_CTX *ctx)
 {
 	if (ctx == NULL) return;
@@ -47,12 +47,16 @@
 #endif
 #include <openssl/rsa.h>
 
+// EVP cipher routines
+int EVP_CIPHER_CTX_reset(EVP_CIPHER_CTX *ctx);
+
 // EVP digest routines
 EVP_MD_CTX *EVP_MD_CTX_new(void);
 void EVP_MD_CTX_free(EVP_MD_CTX *ctx);
 
 // HMAC routines
 HMAC_CTX *HMAC_CTX_new(void);
+int HMAC_CTX_reset(HMAC_CTX *ctx);
 void HMAC_CTX_free(HMAC_CTX *ctx);
 
 // DH routines
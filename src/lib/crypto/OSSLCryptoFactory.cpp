@@ -47,6 +47,7 @@
 #include "OSSLDSA.h"
 #include "OSSLDH.h"
 #ifdef WITH_ECC
+#include "OSSLUtil.h"
 #include "OSSLECDH.h"
 #include "OSSLECDSA.h"
 #endif
@@ -100,6 +101,11 @@ void lock_callback(int mode, int n, const char* file, int line)
 // Constructor
 OSSLCryptoFactory::OSSLCryptoFactory()
 {
+	poolMutex = MutexFactory::i()->getMutex();
+#ifdef WITH_ECC
+	ecGroupsMutex = MutexFactory::i()->getMutex();
+#endif
+
 	// Multi-thread support
 	nlocks = CRYPTO_num_locks();
 	locks = new Mutex*[nlocks];
@@ -202,6 +208,39 @@ OSSLCryptoFactory::~OSSLCryptoFactory()
 	// Destroy the one-and-only RNG
 	delete rng;
 
+	// Destroy the idle algorithm instances
+	for (std::map<SymAlgo::Type, std::vector<OSSLEVPSymmetricAlgorithm*> >::iterator i = symmetricPool.begin(); i != symmetricPool.end(); i++)
+	{
+		for (size_t j = 0; j < i->second.size(); j++)
+		{
+			delete i->second[j];
+		}
+	}
+	for (std::map<HashAlgo::Type, std::vector<OSSLEVPHashAlgorithm*> >::iterator i = hashPool.begin(); i != hashPool.end(); i++)
+	{
+		for (size_t j = 0; j < i->second.size(); j++)
+		{
+			delete i->second[j];
+		}
+	}
+	for (std::map<MacAlgo::Type, std::vector<OSSLEVPMacAlgorithm*> >::iterator i = macPool.begin(); i != macPool.end(); i++)
+	{
+		for (size_t j = 0; j < i->second.size(); j++)
+		{
+			delete i->second[j];
+		}
+	}
+	MutexFactory::i()->recycleMutex(poolMutex);
+
+#ifdef WITH_ECC
+	// Free the cached EC groups
+	for (std::map<std::string, EC_GROUP*>::iterator i = ecGroups.begin(); i != ecGroups.end(); i++)
+	{
+		EC_GROUP_free(i->second);
+	}
+	MutexFactory::i()->recycleMutex(ecGroupsMutex);
+#endif
+
 	// Recycle locks
 	CRYPTO_set_locking_callback(NULL);
 	for (unsigned i = 0; i < nlocks; i++)
@@ -238,13 +277,32 @@ bool OSSLCryptoFactory::getFipsSelfTestStatus() const
 // Create a concrete instance of a symmetric algorithm
 SymmetricAlgorithm* OSSLCryptoFactory::getSymmetricAlgorithm(SymAlgo::Type algorithm)
 {
+	// Hand out an idle instance if there is one
+	{
+		MutexLocker lock(poolMutex);
+
+		std::vector<OSSLEVPSymmetricAlgorithm*>& pool = symmetricPool[algorithm];
+
+		if (!pool.empty())
+		{
+			OSSLEVPSymmetricAlgorithm* reused = pool.back();
+			pool.pop_back();
+
+			return reused;
+		}
+	}
+
+	OSSLEVPSymmetricAlgorithm* created = NULL;
+
 	switch (algorithm)
 	{
 		case SymAlgo::AES:
-			return new OSSLAES();
+			created = new OSSLAES();
+			break;
 		case SymAlgo::DES:
 		case SymAlgo::DES3:
-			return new OSSLDES();
+			created = new OSSLDES();
+			break;
 		default:
 			// No algorithm implementation is available
 			ERROR_MSG("Unknown algorithm '%i'", algorithm);
@@ -252,8 +310,36 @@ SymmetricAlgorithm* OSSLCryptoFactory::getSymmetricAlgorithm(SymAlgo::Type algor
 			return NULL;
 	}
 
-	// No algorithm implementation is available
-	return NULL;
+	created->poolType = algorithm;
+
+	return created;
+}
+
+// Recycle a symmetric algorithm instance; idle instances are kept for reuse
+void OSSLCryptoFactory::recycleSymmetricAlgorithm(SymmetricAlgorithm* toRecycle)
+{
+	if (toRecycle == NULL) return;
+
+	OSSLEVPSymmetricAlgorithm* algorithm = (OSSLEVPSymmetricAlgorithm*) toRecycle;
+
+	if (algorithm->isIdle())
+	{
+		// Idle instances do not keep key material
+		algorithm->clearCTX();
+
+		MutexLocker lock(poolMutex);
+
+		std::vector<OSSLEVPSymmetricAlgorithm*>& pool = symmetricPool[algorithm->poolType];
+
+		if (pool.size() < OSSL_ALGORITHM_POOL_SIZE)
+		{
+			pool.push_back(algorithm);
+
+			return;
+		}
+	}
+
+	delete algorithm;
 }
 
 // Create a concrete instance of an asymmetric algorithm
@@ -291,23 +377,47 @@ AsymmetricAlgorithm* OSSLCryptoFactory::getAsymmetricAlgorithm(AsymAlgo::Type al
 // Create a concrete instance of a hash algorithm
 HashAlgorithm* OSSLCryptoFactory::getHashAlgorithm(HashAlgo::Type algorithm)
 {
+	// Hand out an idle instance if there is one
+	{
+		MutexLocker lock(poolMutex);
+
+		std::vector<OSSLEVPHashAlgorithm*>& pool = hashPool[algorithm];
+
+		if (!pool.empty())
+		{
+			OSSLEVPHashAlgorithm* reused = pool.back();
+			pool.pop_back();
+
+			return reused;
+		}
+	}
+
+	OSSLEVPHashAlgorithm* created = NULL;
+
 	switch (algorithm)
 	{
 		case HashAlgo::MD5:
-			return new OSSLMD5();
+			created = new OSSLMD5();
+			break;
 		case HashAlgo::SHA1:
-			return new OSSLSHA1();
+			created = new OSSLSHA1();
+			break;
 		case HashAlgo::SHA224:
-			return new OSSLSHA224();
+			created = new OSSLSHA224();
+			break;
 		case HashAlgo::SHA256:
-			return new OSSLSHA256();
+			created = new OSSLSHA256();
+			break;
 		case HashAlgo::SHA384:
-			return new OSSLSHA384();
+			created = new OSSLSHA384();
+			break;
 		case HashAlgo::SHA512:
-			return new OSSLSHA512();
+			created = new OSSLSHA512();
+			break;
 #ifdef WITH_GOST
 		case HashAlgo::GOST:
-			return new OSSLGOSTR3411();
+			created = new OSSLGOSTR3411();
+			break;
 #endif
 		default:
 			// No algorithm implementation is available
@@ -316,30 +426,79 @@ HashAlgorithm* OSSLCryptoFactory::getHashAlgorithm(HashAlgo::Type algorithm)
 			return NULL;
 	}
 
-	// No algorithm implementation is available
-	return NULL;
+	created->poolType = algorithm;
+
+	return created;
+}
+
+// Recycle a hash algorithm instance; idle instances are kept for reuse
+void OSSLCryptoFactory::recycleHashAlgorithm(HashAlgorithm* toRecycle)
+{
+	if (toRecycle == NULL) return;
+
+	OSSLEVPHashAlgorithm* algorithm = (OSSLEVPHashAlgorithm*) toRecycle;
+
+	if (algorithm->isIdle())
+	{
+		MutexLocker lock(poolMutex);
+
+		std::vector<OSSLEVPHashAlgorithm*>& pool = hashPool[algorithm->poolType];
+
+		if (pool.size() < OSSL_ALGORITHM_POOL_SIZE)
+		{
+			pool.push_back(algorithm);
+
+			return;
+		}
+	}
+
+	delete algorithm;
 }
 
 // Create a concrete instance of a MAC algorithm
 MacAlgorithm* OSSLCryptoFactory::getMacAlgorithm(MacAlgo::Type algorithm)
 {
+	// Hand out an idle instance if there is one
+	{
+		MutexLocker lock(poolMutex);
+
+		std::vector<OSSLEVPMacAlgorithm*>& pool = macPool[algorithm];
+
+		if (!pool.empty())
+		{
+			OSSLEVPMacAlgorithm* reused = pool.back();
+			pool.pop_back();
+
+			return reused;
+		}
+	}
+
+	OSSLEVPMacAlgorithm* created = NULL;
+
 	switch (algorithm)
 	{
 		case MacAlgo::HMAC_MD5:
-			return new OSSLHMACMD5();
+			created = new OSSLHMACMD5();
+			break;
 		case MacAlgo::HMAC_SHA1:
-			return new OSSLHMACSHA1();
+			created = new OSSLHMACSHA1();
+			break;
 		case MacAlgo::HMAC_SHA224:
-			return new OSSLHMACSHA224();
+			created = new OSSLHMACSHA224();
+			break;
 		case MacAlgo::HMAC_SHA256:
-			return new OSSLHMACSHA256();
+			created = new OSSLHMACSHA256();
+			break;
 		case MacAlgo::HMAC_SHA384:
-			return new OSSLHMACSHA384();
+			created = new OSSLHMACSHA384();
+			break;
 		case MacAlgo::HMAC_SHA512:
-			return new OSSLHMACSHA512();
+			created = new OSSLHMACSHA512();
+			break;
 #ifdef WITH_GOST
 		case MacAlgo::HMAC_GOST:
-			return new OSSLHMACGOSTR3411();
+			created = new OSSLHMACGOSTR3411();
+			break;
 #endif
 		default:
 			// No algorithm implementation is available
@@ -348,8 +507,36 @@ MacAlgorithm* OSSLCryptoFactory::getMacAlgorithm(MacAlgo::Type algorithm)
 			return NULL;
 	}
 
-	// No algorithm implementation is available
-	return NULL;
+	created->poolType = algorithm;
+
+	return created;
+}
+
+// Recycle a MAC algorithm instance; idle instances are kept for reuse
+void OSSLCryptoFactory::recycleMacAlgorithm(MacAlgorithm* toRecycle)
+{
+	if (toRecycle == NULL) return;
+
+	OSSLEVPMacAlgorithm* algorithm = (OSSLEVPMacAlgorithm*) toRecycle;
+
+	if (algorithm->isIdle())
+	{
+		// Idle instances do not keep key material
+		algorithm->clearCTX();
+
+		MutexLocker lock(poolMutex);
+
+		std::vector<OSSLEVPMacAlgorithm*>& pool = macPool[algorithm->poolType];
+
+		if (pool.size() < OSSL_ALGORITHM_POOL_SIZE)
+		{
+			pool.push_back(algorithm);
+
+			return;
+		}
+	}
+
+	delete algorithm;
 }
 
 // Get the global RNG (may be an unique RNG per thread)
@@ -368,3 +555,75 @@ RNG* OSSLCryptoFactory::getRNG(RNGImpl::Type name /* = RNGImpl::Default */)
 	}
 }
 
+#ifdef WITH_ECC
+// Set the EC group for the given DER encoded parameters on the key. Decoding
+// the parameters and setting up the curve is expensive, so the groups of
+// the curves in use are kept, with the multiples of their generator
+// precomputed. OpenSSL gives the key its own copy of the group.
+bool OSSLCryptoFactory::setECGroup(EC_KEY* eckey, const ByteString& params)
+{
+	if (eckey == NULL) return false;
+
+	std::string key((const char*) params.const_byte_str(), params.size());
+
+	// Cached groups stay valid until the factory is destroyed
+	EC_GROUP* grp = NULL;
+	{
+		MutexLocker lock(ecGroupsMutex);
+
+		std::map<std::string, EC_GROUP*>::iterator i = ecGroups.find(key);
+		if (i != ecGroups.end())
+		{
+			grp = i->second;
+		}
+	}
+
+	if (grp != NULL)
+	{
+		return EC_KEY_set_group(eckey, grp) == 1;
+	}
+
+	grp = OSSL::byteString2grp(params);
+	if (grp == NULL)
+	{
+		ERROR_MSG("Could not decode the EC parameters");
+
+		return false;
+	}
+
+	// Only a group that goes into the cache is worth the precomputation
+	bool cache;
+	{
+		MutexLocker lock(ecGroupsMutex);
+
+		cache = ecGroups.find(key) == ecGroups.end() && ecGroups.size() < OSSL_EC_GROUP_CACHE_SIZE;
+	}
+
+	// Fill in the generator table before the group is shared
+	if (cache && !EC_GROUP_precompute_mult(grp, NULL))
+	{
+		WARNING_MSG("Could not precompute the generator multiples of the EC group");
+	}
+
+	bool rv = EC_KEY_set_group(eckey, grp) == 1;
+
+	if (cache)
+	{
+		MutexLocker lock(ecGroupsMutex);
+
+		if (ecGroups.find(key) == ecGroups.end() && ecGroups.size() < OSSL_EC_GROUP_CACHE_SIZE)
+		{
+			ecGroups[key] = grp;
+			grp = NULL;
+		}
+	}
+
+	// Another thread got there first or the cache is full
+	if (grp != NULL)
+	{
+		EC_GROUP_free(grp);
+	}
+
+	return rv;
+}
+#endif
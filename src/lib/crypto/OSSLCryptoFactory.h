@@ -40,12 +40,28 @@
 #include "HashAlgorithm.h"
 #include "MacAlgorithm.h"
 #include "RNG.h"
+#include "OSSLEVPSymmetricAlgorithm.h"
+#include "OSSLEVPHashAlgorithm.h"
+#include "OSSLEVPMacAlgorithm.h"
+#include "MutexFactory.h"
+#include <map>
 #include <memory>
+#include <string>
+#include <vector>
+#ifdef WITH_ECC
+#include <openssl/ec.h>
+#endif
 #ifdef WITH_GOST
 #include <openssl/conf.h>
 #include <openssl/engine.h>
 #endif
 
+// The maximum number of idle instances kept per algorithm type
+#define OSSL_ALGORITHM_POOL_SIZE 16
+
+// The maximum number of EC groups kept for reuse
+#define OSSL_EC_GROUP_CACHE_SIZE 16
+
 class OSSLCryptoFactory : public CryptoFactory
 {
 public:
@@ -63,18 +79,32 @@ public:
 	// Create a concrete instance of a symmetric algorithm
 	virtual SymmetricAlgorithm* getSymmetricAlgorithm(SymAlgo::Type algorithm);
 
+	// Recycle a symmetric algorithm instance
+	virtual void recycleSymmetricAlgorithm(SymmetricAlgorithm* toRecycle);
+
 	// Create a concrete instance of an asymmetric algorithm
 	virtual AsymmetricAlgorithm* getAsymmetricAlgorithm(AsymAlgo::Type algorithm);
 
 	// Create a concrete instance of a hash algorithm
 	virtual HashAlgorithm* getHashAlgorithm(HashAlgo::Type algorithm);
 
+	// Recycle a hash algorithm instance
+	virtual void recycleHashAlgorithm(HashAlgorithm* toRecycle);
+
 	// Create a concrete instance of a MAC algorithm
 	virtual MacAlgorithm* getMacAlgorithm(MacAlgo::Type algorithm);
 
+	// Recycle a MAC algorithm instance
+	virtual void recycleMacAlgorithm(MacAlgorithm* toRecycle);
+
 	// Get the global RNG (may be an unique RNG per thread)
 	virtual RNG* getRNG(RNGImpl::Type name = RNGImpl::Default);
 
+#ifdef WITH_ECC
+	// Set the EC group for the given DER encoded parameters on the key
+	bool setECGroup(EC_KEY* eckey, const ByteString& params);
+#endif
+
 	// Destructor
 	virtual ~OSSLCryptoFactory();
 
@@ -102,6 +132,21 @@ private:
 	// The one-and-only RNG instance
 	RNG* rng;
 
+	// Idle symmetric, hash and MAC algorithm instances; these keep their
+	// OpenSSL contexts so that the next operation does not need to
+	// allocate new ones
+	std::map<SymAlgo::Type, std::vector<OSSLEVPSymmetricAlgorithm*> > symmetricPool;
+	std::map<HashAlgo::Type, std::vector<OSSLEVPHashAlgorithm*> > hashPool;
+	std::map<MacAlgo::Type, std::vector<OSSLEVPMacAlgorithm*> > macPool;
+	Mutex* poolMutex;
+
+#ifdef WITH_ECC
+	// Decoded EC groups by their DER encoded parameters; the groups are
+	// shared and never modified or freed while the factory exists
+	std::map<std::string, EC_GROUP*> ecGroups;
+	Mutex* ecGroupsMutex;
+#endif
+
 #ifdef WITH_GOST
 	// The GOST engine
 	ENGINE *eg;
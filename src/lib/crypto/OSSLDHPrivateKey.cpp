@@ -190,6 +190,12 @@ DH* OSSLDHPrivateKey::getOSSLKey()
 	return dh;
 }
 
+// Create the OpenSSL representation of the key up front
+bool OSSLDHPrivateKey::prepare()
+{
+	return getOSSLKey() != NULL;
+}
+
 // Create the OpenSSL representation of the key
 void OSSLDHPrivateKey::createOSSLKey()
 {
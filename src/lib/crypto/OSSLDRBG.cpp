@@ -0,0 +1,247 @@
+/*
+ * Copyright (c) 2016 SURFnet bv
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+/*****************************************************************************
+ OSSLDRBG.cpp
+
+ A CTR_DRBG with AES-256 and without derivation function (NIST SP 800-90A)
+ *****************************************************************************/
+
+#include "config.h"
+#include "log.h"
+#include "OSSLDRBG.h"
+#include "OSSLComp.h"
+#include <string.h>
+#include <openssl/crypto.h>
+
+// Constructor
+OSSLDRBG::OSSLDRBG()
+{
+	requests = 0;
+	instantiated = false;
+
+	memset(key, 0, sizeof(key));
+	memset(v, 0, sizeof(v));
+
+	// The cipher is looked up once; later requests only change the key
+	ctx = EVP_CIPHER_CTX_new();
+
+	if ((ctx != NULL) && !EVP_EncryptInit_ex(ctx, EVP_aes_256_ctr(), NULL, NULL, NULL))
+	{
+		EVP_CIPHER_CTX_free(ctx);
+		ctx = NULL;
+	}
+
+	if (ctx == NULL)
+	{
+		ERROR_MSG("Failed to set up the AES-256 CTR context of the DRBG");
+	}
+}
+
+// Destructor
+OSSLDRBG::~OSSLDRBG()
+{
+	OPENSSL_cleanse(key, sizeof(key));
+	OPENSSL_cleanse(v, sizeof(v));
+
+	if (ctx != NULL) EVP_CIPHER_CTX_free(ctx);
+}
+
+// Start over from the given entropy input
+bool OSSLDRBG::instantiate(const unsigned char* entropy)
+{
+	memset(key, 0, sizeof(key));
+	memset(v, 0, sizeof(v));
+
+	instantiated = update(entropy);
+	requests = 0;
+
+	return instantiated;
+}
+
+// Mix in fresh entropy input
+bool OSSLDRBG::reseed(const unsigned char* entropy)
+{
+	if (!instantiated) return instantiate(entropy);
+
+	instantiated = update(entropy);
+	requests = 0;
+
+	return instantiated;
+}
+
+// Does the DRBG need fresh entropy before it can generate data?
+bool OSSLDRBG::needsReseed() const
+{
+	return !instantiated || (requests >= OSSL_DRBG_RESEED_INTERVAL);
+}
+
+// Generate random data straight into the buffer of the caller
+bool OSSLDRBG::generate(unsigned char* data, size_t len)
+{
+	if (needsReseed()) return false;
+
+	while (len > 0)
+	{
+		size_t chunk = len < OSSL_DRBG_MAX_REQUEST ? len : OSSL_DRBG_MAX_REQUEST;
+		int outLen;
+
+		// The output is the key stream from the counter block after V;
+		// the context already holds the key
+		increment();
+
+		memset(data, 0, chunk);
+
+		if (!EVP_EncryptInit_ex(ctx, NULL, NULL, NULL, v) ||
+		    !EVP_EncryptUpdate(ctx, data, &outLen, data, (int) chunk))
+		{
+			ERROR_MSG("DRBG generation failed");
+
+			clearCTX();
+			instantiated = false;
+
+			return false;
+		}
+
+		// The rest of the last block is discarded and the next three
+		// blocks of the same key stream are the new key and V
+		unsigned char next[OSSL_DRBG_BLOCK_SIZE + OSSL_DRBG_SEED_SIZE];
+		size_t skip = (OSSL_DRBG_BLOCK_SIZE - (chunk % OSSL_DRBG_BLOCK_SIZE)) % OSSL_DRBG_BLOCK_SIZE;
+
+		memset(next, 0, sizeof(next));
+
+		if (!EVP_EncryptUpdate(ctx, next, &outLen, next, (int) (skip + OSSL_DRBG_SEED_SIZE)))
+		{
+			ERROR_MSG("DRBG generation failed");
+
+			OPENSSL_cleanse(next, sizeof(next));
+			clearCTX();
+			instantiated = false;
+
+			return false;
+		}
+
+		memcpy(key, next + skip, OSSL_DRBG_KEY_SIZE);
+		memcpy(v, next + skip + OSSL_DRBG_KEY_SIZE, OSSL_DRBG_BLOCK_SIZE);
+		OPENSSL_cleanse(next, sizeof(next));
+
+		// The context must not keep the key that produced this output
+		if (!rekey())
+		{
+			ERROR_MSG("DRBG generation failed");
+
+			instantiated = false;
+
+			return false;
+		}
+
+		data += chunk;
+		len -= chunk;
+		requests++;
+	}
+
+	return true;
+}
+
+// Replace the key and the counter block with the next three blocks of
+// output, mixed with the provided data
+bool OSSLDRBG::update(const unsigned char* provided)
+{
+	if (ctx == NULL) return false;
+
+	unsigned char temp[OSSL_DRBG_SEED_SIZE];
+	int outLen;
+
+	increment();
+
+	memset(temp, 0, sizeof(temp));
+
+	if (!EVP_EncryptInit_ex(ctx, NULL, NULL, key, v) ||
+	    !EVP_EncryptUpdate(ctx, temp, &outLen, temp, sizeof(temp)))
+	{
+		ERROR_MSG("DRBG update failed");
+
+		OPENSSL_cleanse(temp, sizeof(temp));
+		clearCTX();
+
+		return false;
+	}
+
+	if (provided != NULL)
+	{
+		for (size_t i = 0; i < sizeof(temp); i++)
+		{
+			temp[i] ^= provided[i];
+		}
+	}
+
+	memcpy(key, temp, OSSL_DRBG_KEY_SIZE);
+	memcpy(v, temp + OSSL_DRBG_KEY_SIZE, OSSL_DRBG_BLOCK_SIZE);
+	OPENSSL_cleanse(temp, sizeof(temp));
+
+	if (!rekey())
+	{
+		ERROR_MSG("DRBG update failed");
+
+		return false;
+	}
+
+	return true;
+}
+
+// Load the new key and counter block into the cipher context; the key
+// schedule of the previous key is overwritten, so that it cannot be
+// recovered from the context (backtracking resistance)
+bool OSSLDRBG::rekey()
+{
+	if (EVP_EncryptInit_ex(ctx, NULL, NULL, key, v)) return true;
+
+	clearCTX();
+
+	return false;
+}
+
+// Wipe the key schedule in the cipher context and set up the cipher again,
+// so that the DRBG can be instantiated anew
+void OSSLDRBG::clearCTX()
+{
+	EVP_CIPHER_CTX_reset(ctx);
+
+	if (!EVP_EncryptInit_ex(ctx, EVP_aes_256_ctr(), NULL, NULL, NULL))
+	{
+		ERROR_MSG("Failed to set up the AES-256 CTR context of the DRBG");
+	}
+}
+
+// Add one to the counter block, which is a big-endian number
+void OSSLDRBG::increment()
+{
+	for (int i = OSSL_DRBG_BLOCK_SIZE - 1; i >= 0; i--)
+	{
+		if (++v[i] != 0) break;
+	}
+}
@@ -0,0 +1,105 @@
+/*
+ * Copyright (c) 2016 SURFnet bv
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+/*****************************************************************************
+ OSSLDRBG.h
+
+ A CTR_DRBG with AES-256 and without derivation function (NIST SP 800-90A).
+ OSSLRNG keeps one instance per thread in front of the OpenSSL RNG, which
+ provides the entropy, so that threads do not contend for the OpenSSL RNG
+ locks. An instance must only be used by one thread at a time.
+ *****************************************************************************/
+
+#ifndef _SOFTHSM_V2_OSSLDRBG_H
+#define _SOFTHSM_V2_OSSLDRBG_H
+
+#include "config.h"
+#include <stddef.h>
+#include <openssl/evp.h>
+
+// The sizes of the entropy input, the key and the counter block
+#define OSSL_DRBG_SEED_SIZE 48
+#define OSSL_DRBG_KEY_SIZE 32
+#define OSSL_DRBG_BLOCK_SIZE 16
+
+// The largest number of bytes that is generated with one key; the
+// standard allows up to 2^19 bits
+#define OSSL_DRBG_MAX_REQUEST 65536
+
+// The number of requests after which fresh entropy is required
+#define OSSL_DRBG_RESEED_INTERVAL 65536
+
+class OSSLDRBG
+{
+public:
+	// Constructor
+	OSSLDRBG();
+
+	// Destructor
+	virtual ~OSSLDRBG();
+
+	// Start over from the given entropy input of OSSL_DRBG_SEED_SIZE bytes
+	bool instantiate(const unsigned char* entropy);
+
+	// Mix in fresh entropy input of OSSL_DRBG_SEED_SIZE bytes
+	bool reseed(const unsigned char* entropy);
+
+	// Does the DRBG need fresh entropy before it can generate data?
+	bool needsReseed() const;
+
+	// Generate random data straight into the buffer of the caller
+	bool generate(unsigned char* data, size_t len);
+
+private:
+	// Replace the key and the counter block with the next three blocks of
+	// output, mixed with the provided data (if any)
+	bool update(const unsigned char* provided);
+
+	// Load the new key and counter block into the cipher context, so that
+	// the key schedule of the previous key is overwritten
+	bool rekey();
+
+	// Wipe the key schedule in the cipher context after a failure
+	void clearCTX();
+
+	// Add one to the counter block
+	void increment();
+
+	// The cipher context; it always holds the current key
+	EVP_CIPHER_CTX* ctx;
+
+	// The working state
+	unsigned char key[OSSL_DRBG_KEY_SIZE];
+	unsigned char v[OSSL_DRBG_BLOCK_SIZE];
+
+	// The number of requests since the last (re)seed
+	unsigned long requests;
+
+	bool instantiated;
+};
+
+#endif // !_SOFTHSM_V2_OSSLDRBG_H
@@ -175,12 +175,17 @@ bool OSSLDSA::signInit(PrivateKey* privateKey, const AsymMech::Type mechanism,
 
 bool OSSLDSA::signUpdate(const ByteString& dataToSign)
 {
-	if (!AsymmetricAlgorithm::signUpdate(dataToSign))
+	return signUpdate(dataToSign.const_byte_str(), dataToSign.size());
+}
+
+bool OSSLDSA::signUpdate(const unsigned char* dataToSign, size_t dataToSignLen)
+{
+	if (!AsymmetricAlgorithm::signUpdate(dataToSign, dataToSignLen))
 	{
 		return false;
 	}
 
-	if (!pCurrentHash->hashUpdate(dataToSign))
+	if (!pCurrentHash->hashUpdate(dataToSign, dataToSignLen))
 	{
 		delete pCurrentHash;
 		pCurrentHash = NULL;
@@ -364,12 +369,17 @@ bool OSSLDSA::verifyInit(PublicKey* publicKey, const AsymMech::Type mechanism,
 
 bool OSSLDSA::verifyUpdate(const ByteString& originalData)
 {
-	if (!AsymmetricAlgorithm::verifyUpdate(originalData))
+	return verifyUpdate(originalData.const_byte_str(), originalData.size());
+}
+
+bool OSSLDSA::verifyUpdate(const unsigned char* originalData, size_t originalDataLen)
+{
+	if (!AsymmetricAlgorithm::verifyUpdate(originalData, originalDataLen))
 	{
 		return false;
 	}
 
-	if (!pCurrentHash->hashUpdate(originalData))
+	if (!pCurrentHash->hashUpdate(originalData, originalDataLen))
 	{
 		delete pCurrentHash;
 		pCurrentHash = NULL;
@@ -207,6 +207,12 @@ DSA* OSSLDSAPrivateKey::getOSSLKey()
 	return dsa;
 }
 
+// Create the OpenSSL representation of the key up front
+bool OSSLDSAPrivateKey::prepare()
+{
+	return getOSSLKey() != NULL;
+}
+
 // Create the OpenSSL representation of the key
 void OSSLDSAPrivateKey::createOSSLKey()
 {
@@ -37,6 +37,7 @@
 #include "CryptoFactory.h"
 #include "ECParameters.h"
 #include "OSSLECKeyPair.h"
+#include "OSSLCryptoFactory.h"
 #include "OSSLUtil.h"
 #include <algorithm>
 #include <openssl/ecdh.h>
@@ -139,9 +140,7 @@ bool OSSLECDH::generateKeyPair(AsymmetricKeyPair** ppKeyPair, AsymmetricParamete
 		return false;
 	}
 
-	EC_GROUP* grp = OSSL::byteString2grp(params->getEC());
-	EC_KEY_set_group(eckey, grp);
-	EC_GROUP_free(grp);
+	OSSLCryptoFactory::i()->setECGroup(eckey, params->getEC());
 
 	if (!EC_KEY_generate_key(eckey))
 	{
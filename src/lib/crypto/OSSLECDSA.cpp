@@ -38,6 +38,7 @@
 #include "ECParameters.h"
 #include "OSSLECKeyPair.h"
 #include "OSSLComp.h"
+#include "OSSLCryptoFactory.h"
 #include "OSSLUtil.h"
 #include <algorithm>
 #include <openssl/ecdsa.h>
@@ -90,7 +91,10 @@ bool OSSLECDSA::sign(PrivateKey* privateKey, const ByteString& dataToSign,
 #endif
 
 #else
-	EC_KEY_set_method(eckey, EC_KEY_OpenSSL());
+	// The key may be shared with concurrent operations, only change
+	// the method when it is not already the OpenSSL implementation
+	if (EC_KEY_get_method(eckey) != EC_KEY_OpenSSL())
+		EC_KEY_set_method(eckey, EC_KEY_OpenSSL());
 #endif
 
 	// Perform the signature operation
@@ -295,9 +299,7 @@ bool OSSLECDSA::generateKeyPair(AsymmetricKeyPair** ppKeyPair, AsymmetricParamet
 		return false;
 	}
 
-	EC_GROUP* grp = OSSL::byteString2grp(params->getEC());
-	EC_KEY_set_group(eckey, grp);
-	EC_GROUP_free(grp);
+	OSSLCryptoFactory::i()->setECGroup(eckey, params->getEC());
 
 	if (!EC_KEY_generate_key(eckey))
 	{
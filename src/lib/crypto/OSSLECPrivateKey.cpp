@@ -34,6 +34,7 @@
 #ifdef WITH_ECC
 #include "log.h"
 #include "OSSLECPrivateKey.h"
+#include "OSSLCryptoFactory.h"
 #include "OSSLUtil.h"
 #include <openssl/bn.h>
 #include <openssl/x509.h>
@@ -126,9 +127,7 @@ void OSSLECPrivateKey::setEC(const ByteString& inEC)
 {
 	ECPrivateKey::setEC(inEC);
 
-	EC_GROUP* grp = OSSL::byteString2grp(inEC);
-	EC_KEY_set_group(eckey, grp);
-	EC_GROUP_free(grp);
+	OSSLCryptoFactory::i()->setECGroup(eckey, inEC);
 }
 
 // Encode into PKCS#8 DER
@@ -34,6 +34,7 @@
 #ifdef WITH_ECC
 #include "log.h"
 #include "OSSLECPublicKey.h"
+#include "OSSLCryptoFactory.h"
 #include "OSSLUtil.h"
 #include <openssl/bn.h>
 #include <string.h>
@@ -109,9 +110,7 @@ void OSSLECPublicKey::setEC(const ByteString& inEC)
 {
 	ECPublicKey::setEC(inEC);
 
-	EC_GROUP* grp = OSSL::byteString2grp(inEC);
-	EC_KEY_set_group(eckey, grp);
-	EC_GROUP_free(grp);
+	OSSLCryptoFactory::i()->setECGroup(eckey, inEC);
 }
 
 void OSSLECPublicKey::setQ(const ByteString& inQ)
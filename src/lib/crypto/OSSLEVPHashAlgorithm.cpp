@@ -48,12 +48,19 @@ bool OSSLEVPHashAlgorithm::hashInit()
 		return false;
 	}
 
-	// Initialize the context
-	curCTX = EVP_MD_CTX_new();
+	// Allocate the context for the first operation
+	if (curCTX == NULL)
+	{
+		curCTX = EVP_MD_CTX_new();
+	}
+
 	if (curCTX == NULL)
 	{
 		ERROR_MSG("Failed to allocate space for EVP_MD_CTX");
 
+		ByteString dummy;
+		HashAlgorithm::hashFinal(dummy);
+
 		return false;
 	}
 
@@ -62,9 +69,6 @@ bool OSSLEVPHashAlgorithm::hashInit()
 	{
 		ERROR_MSG("EVP_DigestInit failed");
 
-		EVP_MD_CTX_free(curCTX);
-		curCTX = NULL;
-
 		ByteString dummy;
 		HashAlgorithm::hashFinal(dummy);
 
@@ -76,24 +80,26 @@ bool OSSLEVPHashAlgorithm::hashInit()
 
 bool OSSLEVPHashAlgorithm::hashUpdate(const ByteString& data)
 {
-	if (!HashAlgorithm::hashUpdate(data))
+	return hashUpdate(data.const_byte_str(), data.size());
+}
+
+bool OSSLEVPHashAlgorithm::hashUpdate(const unsigned char* data, size_t dataLen)
+{
+	if (!HashAlgorithm::hashUpdate(data, dataLen))
 	{
 		return false;
 	}
 
 	// Continue digesting
-	if (data.size() == 0)
+	if (dataLen == 0)
 	{
 		return true;
 	}
 
-	if (!EVP_DigestUpdate(curCTX, (unsigned char*) data.const_byte_str(), data.size()))
+	if (!EVP_DigestUpdate(curCTX, data, dataLen))
 	{
 		ERROR_MSG("EVP_DigestUpdate failed");
 
-		EVP_MD_CTX_free(curCTX);
-		curCTX = NULL;
-
 		ByteString dummy;
 		HashAlgorithm::hashFinal(dummy);
 
@@ -117,17 +123,78 @@ bool OSSLEVPHashAlgorithm::hashFinal(ByteString& hashedData)
 	{
 		ERROR_MSG("EVP_DigestFinal failed");
 
-		EVP_MD_CTX_free(curCTX);
-		curCTX = NULL;
-
 		return false;
 	}
 
 	hashedData.resize(outLen);
 
-	EVP_MD_CTX_free(curCTX);
-	curCTX = NULL;
+	return true;
+}
+
+// The chain runs in the buffer of the result; after the first iteration
+// the digest is kept in the context instead of being looked up again
+bool OSSLEVPHashAlgorithm::hashIterated(const ByteString& data, unsigned long iterations, ByteString& hashedData)
+{
+	if ((iterations == 0) || !HashAlgorithm::hashInit())
+	{
+		return false;
+	}
+
+	// Allocate the context for the first operation
+	if (curCTX == NULL)
+	{
+		curCTX = EVP_MD_CTX_new();
+	}
+
+	ByteString dummy;
+
+	if (curCTX == NULL)
+	{
+		ERROR_MSG("Failed to allocate space for EVP_MD_CTX");
+
+		HashAlgorithm::hashFinal(dummy);
+
+		return false;
+	}
+
+	if (!EVP_DigestInit_ex(curCTX, getEVPHash(), NULL) ||
+	    !EVP_DigestUpdate(curCTX, data.const_byte_str(), data.size()))
+	{
+		ERROR_MSG("EVP digesting failed");
+
+		HashAlgorithm::hashFinal(dummy);
+
+		return false;
+	}
+
+	hashedData.resize(EVP_MD_size(getEVPHash()));
+	unsigned int outLen = hashedData.size();
+
+	bool isOK = EVP_DigestFinal_ex(curCTX, &hashedData[0], &outLen) &&
+		    (outLen == hashedData.size());
+
+	while (isOK && (--iterations > 0))
+	{
+		isOK = EVP_DigestInit_ex(curCTX, NULL, NULL) &&
+		       EVP_DigestUpdate(curCTX, hashedData.const_byte_str(), outLen) &&
+		       EVP_DigestFinal_ex(curCTX, &hashedData[0], &outLen);
+	}
+
+	HashAlgorithm::hashFinal(dummy);
+
+	if (!isOK)
+	{
+		ERROR_MSG("EVP digesting failed");
+
+		return false;
+	}
 
 	return true;
 }
 
+// Check if the instance can be handed out for a new operation
+bool OSSLEVPHashAlgorithm::isIdle() const
+{
+	return currentOperation == NONE;
+}
+
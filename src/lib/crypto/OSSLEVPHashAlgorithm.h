@@ -43,6 +43,7 @@ public:
 	// Base constructors
 	OSSLEVPHashAlgorithm() : HashAlgorithm() {
 		curCTX = NULL;
+		poolType = HashAlgo::Unknown;
 	}
 
 	// Destructor
@@ -51,14 +52,25 @@ public:
 	// Hashing functions
 	virtual bool hashInit();
 	virtual bool hashUpdate(const ByteString& data);
+	virtual bool hashUpdate(const unsigned char* data, size_t dataLen);
 	virtual bool hashFinal(ByteString& hashedData);
+	virtual bool hashIterated(const ByteString& data, unsigned long iterations, ByteString& hashedData);
 
 	virtual int getHashSize() = 0;
 protected:
 	virtual const EVP_MD* getEVPHash() const = 0;
 
 private:
-	// Current hashing context
+	// The crypto factory keeps idle instances for reuse
+	friend class OSSLCryptoFactory;
+
+	// Check if the instance can be handed out for a new operation
+	bool isIdle() const;
+
+	// The algorithm type the instance was handed out for
+	HashAlgo::Type poolType;
+
+	// Current hashing context; it is kept between operations
 	EVP_MD_CTX* curCTX;
 };
 
@@ -51,23 +51,11 @@ bool OSSLEVPMacAlgorithm::signInit(const SymmetricKey* key)
 		return false;
 	}
 
-	// Initialize the context
-	curCTX = HMAC_CTX_new();
-	if (curCTX == NULL)
-	{
-		ERROR_MSG("Failed to allocate space for HMAC_CTX");
-
-		return false;
-	}
-
 	// Initialize EVP signing
-	if (!HMAC_Init_ex(curCTX, key->getKeyBits().const_byte_str(), key->getKeyBits().size(), getEVPHash(), NULL))
+	if (!initCTX(key))
 	{
 		ERROR_MSG("HMAC_Init failed");
 
-		HMAC_CTX_free(curCTX);
-		curCTX = NULL;
-
 		ByteString dummy;
 		MacAlgorithm::signFinal(dummy);
 
@@ -79,20 +67,24 @@ bool OSSLEVPMacAlgorithm::signInit(const SymmetricKey* key)
 
 bool OSSLEVPMacAlgorithm::signUpdate(const ByteString& dataToSign)
 {
-	if (!MacAlgorithm::signUpdate(dataToSign))
+	return signUpdate(dataToSign.const_byte_str(), dataToSign.size());
+}
+
+bool OSSLEVPMacAlgorithm::signUpdate(const unsigned char* dataToSign, size_t dataToSignLen)
+{
+	if (!MacAlgorithm::signUpdate(dataToSign, dataToSignLen))
 	{
 		return false;
 	}
 
 	// The GOST implementation in OpenSSL will segfault if we update with zero length.
-	if (dataToSign.size() == 0) return true;
+	if (dataToSignLen == 0) return true;
 
-	if (!HMAC_Update(curCTX, dataToSign.const_byte_str(), dataToSign.size()))
+	if (!HMAC_Update(curCTX, dataToSign, dataToSignLen))
 	{
 		ERROR_MSG("HMAC_Update failed");
 
-		HMAC_CTX_free(curCTX);
-		curCTX = NULL;
+		clearCTX();
 
 		ByteString dummy;
 		MacAlgorithm::signFinal(dummy);
@@ -117,17 +109,13 @@ bool OSSLEVPMacAlgorithm::signFinal(ByteString& signature)
 	{
 		ERROR_MSG("HMAC_Final failed");
 
-		HMAC_CTX_free(curCTX);
-		curCTX = NULL;
+		clearCTX();
 
 		return false;
 	}
 
 	signature.resize(outLen);
 
-	HMAC_CTX_free(curCTX);
-	curCTX = NULL;
-
 	return true;
 }
 
@@ -140,23 +128,11 @@ bool OSSLEVPMacAlgorithm::verifyInit(const SymmetricKey* key)
 		return false;
 	}
 
-	// Initialize the context
-	curCTX = HMAC_CTX_new();
-	if (curCTX == NULL)
-	{
-		ERROR_MSG("Failed to allocate space for HMAC_CTX");
-
-		return false;
-	}
-
 	// Initialize EVP signing
-	if (!HMAC_Init_ex(curCTX, key->getKeyBits().const_byte_str(), key->getKeyBits().size(), getEVPHash(), NULL))
+	if (!initCTX(key))
 	{
 		ERROR_MSG("HMAC_Init failed");
 
-		HMAC_CTX_free(curCTX);
-		curCTX = NULL;
-
 		ByteString dummy;
 		MacAlgorithm::verifyFinal(dummy);
 
@@ -168,20 +144,24 @@ bool OSSLEVPMacAlgorithm::verifyInit(const SymmetricKey* key)
 
 bool OSSLEVPMacAlgorithm::verifyUpdate(const ByteString& originalData)
 {
-	if (!MacAlgorithm::verifyUpdate(originalData))
+	return verifyUpdate(originalData.const_byte_str(), originalData.size());
+}
+
+bool OSSLEVPMacAlgorithm::verifyUpdate(const unsigned char* originalData, size_t originalDataLen)
+{
+	if (!MacAlgorithm::verifyUpdate(originalData, originalDataLen))
 	{
 		return false;
 	}
 
 	// The GOST implementation in OpenSSL will segfault if we update with zero length.
-	if (originalData.size() == 0) return true;
+	if (originalDataLen == 0) return true;
 
-	if (!HMAC_Update(curCTX, originalData.const_byte_str(), originalData.size()))
+	if (!HMAC_Update(curCTX, originalData, originalDataLen))
 	{
 		ERROR_MSG("HMAC_Update failed");
 
-		HMAC_CTX_free(curCTX);
-		curCTX = NULL;
+		clearCTX();
 
 		ByteString dummy;
 		MacAlgorithm::verifyFinal(dummy);
@@ -207,14 +187,54 @@ bool OSSLEVPMacAlgorithm::verifyFinal(ByteString& signature)
 	{
 		ERROR_MSG("HMAC_Final failed");
 
-		HMAC_CTX_free(curCTX);
-		curCTX = NULL;
+		clearCTX();
 
 		return false;
 	}
 
-	HMAC_CTX_free(curCTX);
-	curCTX = NULL;
-
 	return macResult == signature;
 }
+
+// Check if the instance can be handed out for a new operation
+bool OSSLEVPMacAlgorithm::isIdle() const
+{
+	return currentKey == NULL;
+}
+
+// Set up the HMAC context for a new operation; the context is allocated once
+// and reused by the following operations
+bool OSSLEVPMacAlgorithm::initCTX(const SymmetricKey* key)
+{
+	if (curCTX == NULL)
+	{
+		curCTX = HMAC_CTX_new();
+
+		if (curCTX == NULL)
+		{
+			ERROR_MSG("Failed to allocate space for HMAC_CTX");
+
+			return false;
+		}
+	}
+
+	const ByteString& keyBits = key->getKeyBits();
+
+	if (!HMAC_Init_ex(curCTX, keyBits.const_byte_str(), keyBits.size(), getEVPHash(), NULL))
+	{
+		clearCTX();
+
+		return false;
+	}
+
+	return true;
+}
+
+// Discard the key pads of the previous operation; the context is cleansed
+// but stays allocated
+void OSSLEVPMacAlgorithm::clearCTX()
+{
+	if (curCTX != NULL)
+	{
+		HMAC_CTX_reset(curCTX);
+	}
+}
@@ -46,6 +46,7 @@ public:
 	// Constructor
 	OSSLEVPMacAlgorithm() {
 		curCTX = NULL;
+		poolType = MacAlgo::Unknown;
 	};
 
 	// Destructor
@@ -54,11 +55,13 @@ public:
 	// Signing functions
 	virtual bool signInit(const SymmetricKey* key);
 	virtual bool signUpdate(const ByteString& dataToSign);
+	virtual bool signUpdate(const unsigned char* dataToSign, size_t dataToSignLen);
 	virtual bool signFinal(ByteString& signature);
 
 	// Verification functions
 	virtual bool verifyInit(const SymmetricKey* key);
 	virtual bool verifyUpdate(const ByteString& originalData);
+	virtual bool verifyUpdate(const unsigned char* originalData, size_t originalDataLen);
 	virtual bool verifyFinal(ByteString& signature);
 
 	// Return the MAC size
@@ -69,7 +72,22 @@ protected:
 	virtual const EVP_MD* getEVPHash() const = 0;
 
 private:
-	// The current context
+	// The crypto factory keeps idle instances for reuse
+	friend class OSSLCryptoFactory;
+
+	// Check if the instance can be handed out for a new operation
+	bool isIdle() const;
+
+	// The algorithm type the instance was handed out for
+	MacAlgo::Type poolType;
+
+	// Set up the HMAC context for a new operation
+	bool initCTX(const SymmetricKey* key);
+
+	// Discard the key pads of the previous operation
+	void clearCTX();
+
+	// The current context; it is kept between operations
 	HMAC_CTX* curCTX;
 };
 
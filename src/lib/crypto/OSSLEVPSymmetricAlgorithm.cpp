@@ -34,12 +34,16 @@
 
 #include "config.h"
 #include "OSSLEVPSymmetricAlgorithm.h"
+#include "OSSLComp.h"
 #include "salloc.h"
+#include <openssl/crypto.h>
+#include <string.h>
 
 // Constructor
 OSSLEVPSymmetricAlgorithm::OSSLEVPSymmetricAlgorithm()
 {
 	pCurCTX = NULL;
+	poolType = SymAlgo::Unknown;
 }
 
 // Destructor
@@ -92,12 +96,10 @@ bool OSSLEVPSymmetricAlgorithm::encryptInit(const SymmetricKey* key, const SymMo
 		return false;
 	}
 
-	// Allocate the EVP context
-	pCurCTX = EVP_CIPHER_CTX_new();
-
-	if (pCurCTX == NULL)
+	// Set up the EVP context
+	if (!initCTX(cipher, 1, iv))
 	{
-		ERROR_MSG("Failed to allocate space for EVP_CIPHER_CTX");
+		ERROR_MSG("Failed to initialise EVP encrypt operation");
 
 		ByteString dummy;
 		SymmetricAlgorithm::encryptFinal(dummy);
@@ -105,53 +107,66 @@ bool OSSLEVPSymmetricAlgorithm::encryptInit(const SymmetricKey* key, const SymMo
 		return false;
 	}
 
-	int rv = EVP_EncryptInit(pCurCTX, cipher, (unsigned char*) currentKey->getKeyBits().const_byte_str(), iv.byte_str());
-
-	if (!rv)
-	{
-		ERROR_MSG("Failed to initialise EVP encrypt operation");
+	EVP_CIPHER_CTX_set_padding(pCurCTX, padding ? 1 : 0);
 
-		EVP_CIPHER_CTX_free(pCurCTX);
-		pCurCTX = NULL;
+	return true;
+}
 
-		ByteString dummy;
-		SymmetricAlgorithm::encryptFinal(dummy);
+bool OSSLEVPSymmetricAlgorithm::encryptUpdate(const ByteString& data, ByteString& encryptedData)
+{
+	// Prepare the output block
+	encryptedData.resize(data.size() + getBlockSize() - 1);
 
+	size_t outLen = encryptedData.size();
+	if (!encryptUpdate(data.const_byte_str(), data.size(), encryptedData.byte_str(), outLen))
+	{
 		return false;
 	}
 
-	EVP_CIPHER_CTX_set_padding(pCurCTX, padding ? 1 : 0);
+	// Resize the output block
+	encryptedData.resize(outLen);
 
 	return true;
 }
 
-bool OSSLEVPSymmetricAlgorithm::encryptUpdate(const ByteString& data, ByteString& encryptedData)
+bool OSSLEVPSymmetricAlgorithm::encryptUpdate(const unsigned char* data, size_t dataLen, unsigned char* encryptedData, size_t& encryptedDataLen)
 {
-	if (!SymmetricAlgorithm::encryptUpdate(data, encryptedData))
+	if (!SymmetricAlgorithm::encryptUpdate(data, dataLen, encryptedData, encryptedDataLen))
 	{
-		EVP_CIPHER_CTX_free(pCurCTX);
-		pCurCTX = NULL;
+		clearCTX();
 
 		return false;
 	}
 
-	if (data.size() == 0)
+	// The whole blocks of the buffered bytes and the new data are written
+	size_t blockSize = EVP_CIPHER_CTX_block_size(pCurCTX);
+	size_t maxLen = getBufferSize() - getBufferSize() % blockSize;
+
+	if (dataLen == 0)
 	{
-		encryptedData.resize(0);
+		encryptedDataLen = 0;
 
 		return true;
 	}
 
-	// Prepare the output block
-	encryptedData.resize(data.size() + getBlockSize() - 1);
+	if (encryptedDataLen < maxLen)
+	{
+		ERROR_MSG("The output buffer is too small");
+
+		clearCTX();
 
-	int outLen = encryptedData.size();
-	if (!EVP_EncryptUpdate(pCurCTX, &encryptedData[0], &outLen, (unsigned char*) data.const_byte_str(), data.size()))
+		ByteString dummy;
+		SymmetricAlgorithm::encryptFinal(dummy);
+
+		return false;
+	}
+
+	int outLen = 0;
+	if (!EVP_EncryptUpdate(pCurCTX, encryptedData, &outLen, data, dataLen))
 	{
 		ERROR_MSG("EVP_EncryptUpdate failed");
 
-		EVP_CIPHER_CTX_free(pCurCTX);
-		pCurCTX = NULL;
+		clearCTX();
 
 		ByteString dummy;
 		SymmetricAlgorithm::encryptFinal(dummy);
@@ -159,8 +174,7 @@ bool OSSLEVPSymmetricAlgorithm::encryptUpdate(const ByteString& data, ByteString
 		return false;
 	}
 
-	// Resize the output block
-	encryptedData.resize(outLen);
+	encryptedDataLen = outLen;
 	currentBufferSize -= outLen;
 
 	return true;
@@ -168,34 +182,58 @@ bool OSSLEVPSymmetricAlgorithm::encryptUpdate(const ByteString& data, ByteString
 
 bool OSSLEVPSymmetricAlgorithm::encryptFinal(ByteString& encryptedData)
 {
-	if (!SymmetricAlgorithm::encryptFinal(encryptedData))
-	{
-		EVP_CIPHER_CTX_free(pCurCTX);
-		pCurCTX = NULL;
+	// Prepare the output block
+	encryptedData.resize(getBlockSize());
 
+	size_t outLen = encryptedData.size();
+	if (!encryptFinal(encryptedData.byte_str(), outLen))
+	{
 		return false;
 	}
 
-	// Prepare the output block
-	encryptedData.resize(getBlockSize());
+	// Resize the output block
+	encryptedData.resize(outLen);
+
+	return true;
+}
+
+bool OSSLEVPSymmetricAlgorithm::encryptFinal(unsigned char* encryptedData, size_t& encryptedDataLen)
+{
+	if (!SymmetricAlgorithm::encryptFinal(encryptedData, encryptedDataLen))
+	{
+		clearCTX();
+
+		return false;
+	}
 
-	int outLen = encryptedData.size();
+	// The last block goes through a local buffer, the output buffer
+	// only needs room for the bytes that are actually produced
+	unsigned char block[EVP_MAX_BLOCK_LENGTH];
+	int outLen = 0;
 
-	if (!EVP_EncryptFinal(pCurCTX, &encryptedData[0], &outLen))
+	if (!EVP_EncryptFinal(pCurCTX, block, &outLen))
 	{
 		ERROR_MSG("EVP_EncryptFinal failed");
 
-		EVP_CIPHER_CTX_free(pCurCTX);
-		pCurCTX = NULL;
+		clearCTX();
 
 		return false;
 	}
 
-	// Resize the output block
-	encryptedData.resize(outLen);
+	if ((size_t)outLen > encryptedDataLen)
+	{
+		ERROR_MSG("The output buffer is too small");
 
-	EVP_CIPHER_CTX_free(pCurCTX);
-	pCurCTX = NULL;
+		clearCTX();
+
+		return false;
+	}
+
+	if (outLen > 0)
+	{
+		memcpy(encryptedData, block, outLen);
+	}
+	encryptedDataLen = outLen;
 
 	return true;
 }
@@ -244,12 +282,10 @@ bool OSSLEVPSymmetricAlgorithm::decryptInit(const SymmetricKey* key, const SymMo
 		return false;
 	}
 
-	// Allocate the EVP context
-	pCurCTX = EVP_CIPHER_CTX_new();
-
-	if (pCurCTX == NULL)
+	// Set up the EVP context
+	if (!initCTX(cipher, 0, iv))
 	{
-		ERROR_MSG("Failed to allocate space for EVP_CIPHER_CTX");
+		ERROR_MSG("Failed to initialise EVP decrypt operation");
 
 		ByteString dummy;
 		SymmetricAlgorithm::decryptFinal(dummy);
@@ -257,49 +293,85 @@ bool OSSLEVPSymmetricAlgorithm::decryptInit(const SymmetricKey* key, const SymMo
 		return false;
 	}
 
-	int rv = EVP_DecryptInit(pCurCTX, cipher, (unsigned char*) currentKey->getKeyBits().const_byte_str(), iv.byte_str());
-
-	if (!rv)
-	{
-		ERROR_MSG("Failed to initialise EVP decrypt operation");
+	EVP_CIPHER_CTX_set_padding(pCurCTX, padding ? 1 : 0);
 
-		EVP_CIPHER_CTX_free(pCurCTX);
-		pCurCTX = NULL;
+	return true;
+}
 
-		ByteString dummy;
-		SymmetricAlgorithm::decryptFinal(dummy);
+bool OSSLEVPSymmetricAlgorithm::decryptUpdate(const ByteString& encryptedData, ByteString& data)
+{
+	// Prepare the output block
+	data.resize(encryptedData.size() + getBlockSize());
 
+	size_t outLen = data.size();
+	if (!decryptUpdate(encryptedData.const_byte_str(), encryptedData.size(), data.byte_str(), outLen))
+	{
 		return false;
 	}
 
-	EVP_CIPHER_CTX_set_padding(pCurCTX, padding ? 1 : 0);
+	// Resize the output block
+	data.resize(outLen);
 
 	return true;
 }
 
-bool OSSLEVPSymmetricAlgorithm::decryptUpdate(const ByteString& encryptedData, ByteString& data)
+bool OSSLEVPSymmetricAlgorithm::decryptUpdate(const unsigned char* encryptedData, size_t encryptedDataLen, unsigned char* data, size_t& dataLen)
 {
-	if (!SymmetricAlgorithm::decryptUpdate(encryptedData, data))
+	if (!SymmetricAlgorithm::decryptUpdate(encryptedData, encryptedDataLen, data, dataLen))
 	{
-		EVP_CIPHER_CTX_free(pCurCTX);
-		pCurCTX = NULL;
+		clearCTX();
 
 		return false;
 	}
 
-	// Prepare the output block
-	data.resize(encryptedData.size() + getBlockSize());
+	// The whole blocks of the buffered bytes and the new data are written,
+	// except that with padding the last block is held back for the final call
+	size_t blockSize = EVP_CIPHER_CTX_block_size(pCurCTX);
+	size_t total = getBufferSize();
+	size_t maxLen = total - total % blockSize;
+
+	if (getPaddingMode() && (blockSize > 1) && (total > 0))
+	{
+		maxLen = (total - 1) - (total - 1) % blockSize;
+	}
+
+#if OPENSSL_VERSION_NUMBER < 0x30000000L
+	// Older versions write the held back block to the output before they
+	// take it back, so a buffer without room for it gets a staging buffer
+	size_t writeLen = total - total % blockSize;
+#else
+	size_t writeLen = maxLen;
+#endif
+
+	if (dataLen < maxLen)
+	{
+		ERROR_MSG("The output buffer is too small");
+
+		clearCTX();
+
+		ByteString dummy;
+		SymmetricAlgorithm::decryptFinal(dummy);
 
-	int outLen = data.size();
+		return false;
+	}
+
+	DEBUG_MSG("Decrypting %d bytes into buffer of %d bytes", encryptedDataLen, dataLen);
 
-	DEBUG_MSG("Decrypting %d bytes into buffer of %d bytes", encryptedData.size(), data.size());
+	ByteString staged;
+	unsigned char* out = data;
 
-	if (!EVP_DecryptUpdate(pCurCTX, &data[0], &outLen, (unsigned char*) encryptedData.const_byte_str(), encryptedData.size()))
+	if (dataLen < writeLen)
+	{
+		staged.resize(writeLen);
+		out = staged.byte_str();
+	}
+
+	int outLen = 0;
+	if (!EVP_DecryptUpdate(pCurCTX, out, &outLen, encryptedData, encryptedDataLen))
 	{
 		ERROR_MSG("EVP_DecryptUpdate failed");
 
-		EVP_CIPHER_CTX_free(pCurCTX);
-		pCurCTX = NULL;
+		clearCTX();
 
 		ByteString dummy;
 		SymmetricAlgorithm::decryptFinal(dummy);
@@ -307,10 +379,14 @@ bool OSSLEVPSymmetricAlgorithm::decryptUpdate(const ByteString& encryptedData, B
 		return false;
 	}
 
+	if ((out != data) && (outLen > 0))
+	{
+		memcpy(data, out, outLen);
+	}
+
 	DEBUG_MSG("Decrypt returned %d bytes of data", outLen);
 
-	// Resize the output block
-	data.resize(outLen);
+	dataLen = outLen;
 	currentBufferSize -= outLen;
 
 	return true;
@@ -318,36 +394,105 @@ bool OSSLEVPSymmetricAlgorithm::decryptUpdate(const ByteString& encryptedData, B
 
 bool OSSLEVPSymmetricAlgorithm::decryptFinal(ByteString& data)
 {
-	if (!SymmetricAlgorithm::decryptFinal(data))
-	{
-		EVP_CIPHER_CTX_free(pCurCTX);
-		pCurCTX = NULL;
+	// Prepare the output block
+	data.resize(getBlockSize());
 
+	size_t outLen = data.size();
+	if (!decryptFinal(data.byte_str(), outLen))
+	{
 		return false;
 	}
 
-	// Prepare the output block
-	data.resize(getBlockSize());
+	// Resize the output block
+	data.resize(outLen);
+
+	return true;
+}
+
+bool OSSLEVPSymmetricAlgorithm::decryptFinal(unsigned char* data, size_t& dataLen)
+{
+	if (!SymmetricAlgorithm::decryptFinal(data, dataLen))
+	{
+		clearCTX();
 
-	int outLen = data.size();
+		return false;
+	}
+
+	// The last block goes through a local buffer, the output buffer
+	// only needs room for the bytes that are actually produced
+	unsigned char block[EVP_MAX_BLOCK_LENGTH];
+	int outLen = 0;
 	int rv;
 
-	if (!(rv = EVP_DecryptFinal(pCurCTX, &data[0], &outLen)))
+	if (!(rv = EVP_DecryptFinal(pCurCTX, block, &outLen)))
 	{
 		ERROR_MSG("EVP_DecryptFinal failed (0x%08X)", rv);
 
-		EVP_CIPHER_CTX_free(pCurCTX);
-		pCurCTX = NULL;
+		clearCTX();
 
 		return false;
 	}
 
-	// Resize the output block
-	data.resize(outLen);
+	if ((size_t)outLen > dataLen)
+	{
+		ERROR_MSG("The output buffer is too small");
 
-	EVP_CIPHER_CTX_free(pCurCTX);
-	pCurCTX = NULL;
+		OPENSSL_cleanse(block, sizeof(block));
+		clearCTX();
+
+		return false;
+	}
+
+	if (outLen > 0)
+	{
+		memcpy(data, block, outLen);
+	}
+	dataLen = outLen;
+
+	OPENSSL_cleanse(block, sizeof(block));
 
 	return true;
 }
 
+
+// Check if the instance can be handed out for a new operation
+bool OSSLEVPSymmetricAlgorithm::isIdle() const
+{
+	return currentOperation == NONE;
+}
+
+// Set up the EVP context for a new operation; the context is allocated once
+// and reused by the following operations
+bool OSSLEVPSymmetricAlgorithm::initCTX(const EVP_CIPHER* cipher, int enc, const ByteString& iv)
+{
+	if (pCurCTX == NULL)
+	{
+		pCurCTX = EVP_CIPHER_CTX_new();
+
+		if (pCurCTX == NULL)
+		{
+			ERROR_MSG("Failed to allocate space for EVP_CIPHER_CTX");
+
+			return false;
+		}
+	}
+
+	if (!EVP_CipherInit_ex(pCurCTX, cipher, NULL, currentKey->getKeyBits().const_byte_str(), iv.const_byte_str(), enc))
+	{
+		clearCTX();
+
+		return false;
+	}
+
+	return true;
+}
+
+// Forget the key schedule of the previous operation; the context is
+// cleansed but stays allocated
+void OSSLEVPSymmetricAlgorithm::clearCTX()
+{
+	if (pCurCTX != NULL)
+	{
+		EVP_CIPHER_CTX_reset(pCurCTX);
+	}
+}
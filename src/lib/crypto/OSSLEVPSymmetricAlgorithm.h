@@ -52,11 +52,15 @@ public:
 	virtual bool encryptInit(const SymmetricKey* key, const SymMode::Type mode = SymMode::CBC, const ByteString& IV = ByteString(), bool padding = true);
 	virtual bool encryptUpdate(const ByteString& data, ByteString& encryptedData);
 	virtual bool encryptFinal(ByteString& encryptedData);
+	virtual bool encryptUpdate(const unsigned char* data, size_t dataLen, unsigned char* encryptedData, size_t& encryptedDataLen);
+	virtual bool encryptFinal(unsigned char* encryptedData, size_t& encryptedDataLen);
 
 	// Decryption functions
 	virtual bool decryptInit(const SymmetricKey* key, const SymMode::Type mode = SymMode::CBC, const ByteString& IV = ByteString(), bool padding = true);
 	virtual bool decryptUpdate(const ByteString& encryptedData, ByteString& data);
 	virtual bool decryptFinal(ByteString& data);
+	virtual bool decryptUpdate(const unsigned char* encryptedData, size_t encryptedDataLen, unsigned char* data, size_t& dataLen);
+	virtual bool decryptFinal(unsigned char* data, size_t& dataLen);
 
 	// Return the block size
 	virtual size_t getBlockSize() const = 0;
@@ -66,7 +70,22 @@ protected:
 	virtual const EVP_CIPHER* getCipher() const = 0;
 
 private:
-	// The current EVP context
+	// The crypto factory keeps idle instances for reuse
+	friend class OSSLCryptoFactory;
+
+	// Check if the instance can be handed out for a new operation
+	bool isIdle() const;
+
+	// The algorithm type the instance was handed out for
+	SymAlgo::Type poolType;
+
+	// Set up the EVP context for a new operation
+	bool initCTX(const EVP_CIPHER* cipher, int enc, const ByteString& iv);
+
+	// Forget the key schedule of the previous operation
+	void clearCTX();
+
+	// The EVP context; it is kept between operations
 	EVP_CIPHER_CTX* pCurCTX;
 };
 
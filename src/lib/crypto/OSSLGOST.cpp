@@ -184,12 +184,17 @@ bool OSSLGOST::signInit(PrivateKey* privateKey, const AsymMech::Type mechanism,
 
 bool OSSLGOST::signUpdate(const ByteString& dataToSign)
 {
-	if (!AsymmetricAlgorithm::signUpdate(dataToSign))
+	return signUpdate(dataToSign.const_byte_str(), dataToSign.size());
+}
+
+bool OSSLGOST::signUpdate(const unsigned char* dataToSign, size_t dataToSignLen)
+{
+	if (!AsymmetricAlgorithm::signUpdate(dataToSign, dataToSignLen))
 	{
 		return false;
 	}
 
-	if (!EVP_DigestUpdate(curCTX, dataToSign.const_byte_str(), dataToSign.size()))
+	if (!EVP_DigestUpdate(curCTX, dataToSign, dataToSignLen))
 	{
 		ERROR_MSG("EVP_DigestUpdate failed");
 
@@ -368,12 +373,17 @@ bool OSSLGOST::verifyInit(PublicKey* publicKey, const AsymMech::Type mechanism,
 
 bool OSSLGOST::verifyUpdate(const ByteString& originalData)
 {
-	if (!AsymmetricAlgorithm::verifyUpdate(originalData))
+	return verifyUpdate(originalData.const_byte_str(), originalData.size());
+}
+
+bool OSSLGOST::verifyUpdate(const unsigned char* originalData, size_t originalDataLen)
+{
+	if (!AsymmetricAlgorithm::verifyUpdate(originalData, originalDataLen))
 	{
 		return false;
 	}
 
-	if (!EVP_DigestUpdate(curCTX, originalData.const_byte_str(), originalData.size()))
+	if (!EVP_DigestUpdate(curCTX, originalData, originalDataLen))
 	{
 		ERROR_MSG("EVP_DigestUpdate failed");
 
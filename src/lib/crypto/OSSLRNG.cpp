@@ -31,22 +31,149 @@
  *****************************************************************************/
 
 #include "config.h"
+#include "log.h"
 #include "OSSLRNG.h"
+#include "osthread.h"
 #include <openssl/rand.h>
+#ifndef _WIN32
+#include <unistd.h>
+#endif
 
-// Generate random data
-bool OSSLRNG::generateRandom(ByteString& data, const size_t len)
+// The identity of the process, to notice a fork()
+static unsigned long getProcessID()
+{
+#ifndef _WIN32
+	return (unsigned long) getpid();
+#else
+	return 0;
+#endif
+}
+
+// Constructor
+OSSLRNG::OSSLRNG()
+{
+	seedGeneration = 0;
+	threadStatesMutex = MutexFactory::i()->getMutex();
+
+	if (OSCreateThreadKey(&threadKey, releaseThreadState) != CKR_OK)
+	{
+		WARNING_MSG("Using the OpenSSL RNG without thread DRBGs");
+
+		threadKey = NULL;
+	}
+}
+
+// Destructor
+OSSLRNG::~OSSLRNG()
 {
-	data.wipe(len);
+	// Returns once the threads that are exiting have released their state
+	if (threadKey != NULL) OSDestroyThreadKey(threadKey);
+
+	// The states of threads that are still alive
+	for (std::set<ThreadState*>::iterator i = threadStates.begin(); i != threadStates.end(); i++)
+	{
+		delete *i;
+	}
 
+	MutexFactory::i()->recycleMutex(threadStatesMutex);
+}
+
+// Generate random data
+bool OSSLRNG::generateRandom(unsigned char* data, const size_t len)
+{
 	if (len == 0)
 		return true;
-	return RAND_bytes(&data[0], len) == 1;
+
+#ifndef WITH_FIPS
+	ThreadState* state = getThreadState();
+
+	if (state != NULL)
+	{
+		unsigned long pid = getProcessID();
+
+		// Take fresh entropy when due, in a new process or after seeding
+		if (state->drbg.needsReseed() ||
+		    (state->pid != pid) ||
+		    (state->seedGeneration != seedGeneration))
+		{
+			unsigned char entropy[OSSL_DRBG_SEED_SIZE];
+			unsigned long generation = seedGeneration;
+
+			bool rv = (RAND_bytes(entropy, sizeof(entropy)) == 1) &&
+				  (state->pid == pid ? state->drbg.reseed(entropy)
+						     : state->drbg.instantiate(entropy));
+
+			OPENSSL_cleanse(entropy, sizeof(entropy));
+
+			if (rv)
+			{
+				state->pid = pid;
+				state->seedGeneration = generation;
+			}
+		}
+
+		if (state->drbg.generate(data, len)) return true;
+	}
+#endif
+
+	// The FIPS module and threads without a DRBG use the OpenSSL RNG directly
+	return RAND_bytes(data, len) == 1;
 }
 
 // Seed the random pool
 void OSSLRNG::seed(ByteString& seedData)
 {
 	RAND_seed(seedData.byte_str(), seedData.size());
+
+	// Make the thread DRBGs take in the new seed
+#ifdef __GNUC__
+	__sync_fetch_and_add(&seedGeneration, 1);
+#else
+	MutexLocker lock(threadStatesMutex);
+
+	seedGeneration++;
+#endif
+}
+
+// Get the state of the calling thread
+OSSLRNG::ThreadState* OSSLRNG::getThreadState()
+{
+	if (threadKey == NULL) return NULL;
+
+	ThreadState* state = (ThreadState*) OSGetThreadValue(threadKey);
+
+	if (state != NULL) return state;
+
+	// The DRBG is seeded with its first request
+	state = new ThreadState();
+	state->owner = this;
+	state->seedGeneration = 0;
+	state->pid = 0;
+
+	if (OSSetThreadValue(threadKey, state) != CKR_OK)
+	{
+		delete state;
+
+		return NULL;
+	}
+
+	MutexLocker lock(threadStatesMutex);
+
+	threadStates.insert(state);
+
+	return state;
 }
 
+// Release the state of a thread that exits
+/*static*/ void OSSLRNG::releaseThreadState(void* state)
+{
+	ThreadState* threadState = (ThreadState*) state;
+
+	{
+		MutexLocker lock(threadState->owner->threadStatesMutex);
+
+		threadState->owner->threadStates.erase(threadState);
+	}
+
+	delete threadState;
+}
@@ -28,6 +28,11 @@
  OSSLRNG.h
 
  OpenSSL random number generator class
+
+ Each thread generates its random data with its own DRBG, which takes its
+ entropy from the OpenSSL RNG. The DRBG of a thread is reseeded after a
+ number of requests, in a child process after fork() and after the RNG was
+ seeded explicitly.
  *****************************************************************************/
 
 #ifndef _SOFTHSM_V2_OSSLRNG_H
@@ -36,17 +41,51 @@
 #include "config.h"
 #include "ByteString.h"
 #include "RNG.h"
+#include "OSSLDRBG.h"
+#include "MutexFactory.h"
+#include <set>
 
 class OSSLRNG : public RNG
 {
 public:
+	// Constructor
+	OSSLRNG();
+
+	// Destructor
+	virtual ~OSSLRNG();
+
 	// Generate random data
-	virtual bool generateRandom(ByteString& data, const size_t len);
+	using RNG::generateRandom;
+	virtual bool generateRandom(unsigned char* data, const size_t len);
 
 	// Seed the random pool
 	virtual void seed(ByteString& seedData);
 
 private:
+	// The DRBG of a thread
+	struct ThreadState
+	{
+		OSSLRNG* owner;
+		OSSLDRBG drbg;
+		unsigned long seedGeneration;
+		unsigned long pid;
+	};
+
+	// Get the state of the calling thread
+	ThreadState* getThreadState();
+
+	// Release the state of a thread that exits
+	static void releaseThreadState(void* state);
+
+	// The key of the thread states; NULL if they are not available
+	void* threadKey;
+
+	// The thread states, for the ones that are left at destruction
+	std::set<ThreadState*> threadStates;
+	Mutex* threadStatesMutex;
+
+	// Changed when the RNG is seeded explicitly
+	volatile unsigned long seedGeneration;
 };
 
 #endif // !_SOFTHSM_V2_OSSLRNG_H
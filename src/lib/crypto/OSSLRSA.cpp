@@ -99,17 +99,8 @@ bool OSSLRSA::sign(PrivateKey* privateKey, const ByteString& dataToSign,
 
 		RSA* rsa = osslKey->getOSSLKey();
 
-		if (!RSA_blinding_on(rsa, NULL))
-		{
-			ERROR_MSG("Failed to turn on blinding for OpenSSL RSA key");
-
-			return false;
-		}
-
 		int sigLen = RSA_private_encrypt(dataToSign.size(), (unsigned char*) dataToSign.const_byte_str(), &signature[0], rsa, RSA_PKCS1_PADDING);
 
-		RSA_blinding_off(rsa);
-
 		if (sigLen == -1)
 		{
 			ERROR_MSG("An error occurred while performing a PKCS #1 signature");
@@ -148,17 +139,8 @@ bool OSSLRSA::sign(PrivateKey* privateKey, const ByteString& dataToSign,
 
 		RSA* rsa = osslKey->getOSSLKey();
 
-		if (!RSA_blinding_on(rsa, NULL))
-		{
-			ERROR_MSG("Failed to turn on blinding for OpenSSL RSA key");
-
-			return false;
-		}
-
 		int sigLen = RSA_private_encrypt(dataToSign.size(), (unsigned char*) dataToSign.const_byte_str(), &signature[0], rsa, RSA_NO_PADDING);
 
-		RSA_blinding_off(rsa);
-
 		if (sigLen == -1)
 		{
 			ERROR_MSG("An error occurred while performing a raw RSA signature");
@@ -380,12 +362,17 @@ bool OSSLRSA::signInit(PrivateKey* privateKey, const AsymMech::Type mechanism,
 
 bool OSSLRSA::signUpdate(const ByteString& dataToSign)
 {
-	if (!AsymmetricAlgorithm::signUpdate(dataToSign))
+	return signUpdate(dataToSign.const_byte_str(), dataToSign.size());
+}
+
+bool OSSLRSA::signUpdate(const unsigned char* dataToSign, size_t dataToSignLen)
+{
+	if (!AsymmetricAlgorithm::signUpdate(dataToSign, dataToSignLen))
 	{
 		return false;
 	}
 
-	if (!pCurrentHash->hashUpdate(dataToSign))
+	if (!pCurrentHash->hashUpdate(dataToSign, dataToSignLen))
 	{
 		delete pCurrentHash;
 		pCurrentHash = NULL;
@@ -396,7 +383,7 @@ bool OSSLRSA::signUpdate(const ByteString& dataToSign)
 		return false;
 	}
 
-	if ((pSecondHash != NULL) && !pSecondHash->hashUpdate(dataToSign))
+	if ((pSecondHash != NULL) && !pSecondHash->hashUpdate(dataToSign, dataToSignLen))
 	{
 		delete pCurrentHash;
 		pCurrentHash = NULL;
@@ -504,15 +491,6 @@ bool OSSLRSA::signFinal(ByteString& signature)
 	// Perform the signature operation
 	unsigned int sigLen = signature.size();
 
-	RSA* rsa = pk->getOSSLKey();
-
-	if (!RSA_blinding_on(rsa, NULL))
-	{
-		ERROR_MSG("Failed to turn blinding on for OpenSSL RSA key");
-
-		return false;
-	}
-
 	bool rv;
 	int result;
 
@@ -559,8 +537,6 @@ bool OSSLRSA::signFinal(ByteString& signature)
 		}
 	}
 
-	RSA_blinding_off(rsa);
-
 	signature.resize(sigLen);
 
 	return rv;
@@ -853,12 +829,17 @@ bool OSSLRSA::verifyInit(PublicKey* publicKey, const AsymMech::Type mechanism,
 
 bool OSSLRSA::verifyUpdate(const ByteString& originalData)
 {
-	if (!AsymmetricAlgorithm::verifyUpdate(originalData))
+	return verifyUpdate(originalData.const_byte_str(), originalData.size());
+}
+
+bool OSSLRSA::verifyUpdate(const unsigned char* originalData, size_t originalDataLen)
+{
+	if (!AsymmetricAlgorithm::verifyUpdate(originalData, originalDataLen))
 	{
 		return false;
 	}
 
-	if (!pCurrentHash->hashUpdate(originalData))
+	if (!pCurrentHash->hashUpdate(originalData, originalDataLen))
 	{
 		delete pCurrentHash;
 		pCurrentHash = NULL;
@@ -869,7 +850,7 @@ bool OSSLRSA::verifyUpdate(const ByteString& originalData)
 		return false;
 	}
 
-	if ((pSecondHash != NULL) && !pSecondHash->hashUpdate(originalData))
+	if ((pSecondHash != NULL) && !pSecondHash->hashUpdate(originalData, originalDataLen))
 	{
 		delete pCurrentHash;
 		pCurrentHash = NULL;
@@ -276,6 +276,12 @@ RSA* OSSLRSAPrivateKey::getOSSLKey()
 	return rsa;
 }
 
+// Create the OpenSSL representation of the key up front
+bool OSSLRSAPrivateKey::prepare()
+{
+	return getOSSLKey() != NULL;
+}
+
 // Create the OpenSSL representation of the key
 void OSSLRSAPrivateKey::createOSSLKey()
 {
@@ -316,5 +322,12 @@ void OSSLRSAPrivateKey::createOSSLKey()
 	RSA_set0_factors(rsa, bn_p, bn_q);
 	RSA_set0_crt_params(rsa, bn_dmp1, bn_dmq1, bn_iqmp);
 	RSA_set0_key(rsa, bn_n, bn_e, bn_d);
+
+	// Blinding is turned on once here rather than around every operation,
+	// so that the key can be used by several operations at the same time
+	if (!RSA_blinding_on(rsa, NULL))
+	{
+		ERROR_MSG("Failed to turn on blinding for OpenSSL RSA key");
+	}
 }
 
@@ -72,6 +72,9 @@ public:
 	// Decode from PKCS#8 BER
 	virtual bool PKCS8Decode(const ByteString& ber);
 
+	// Create the OpenSSL representation of the key up front
+	virtual bool prepare();
+
 	// Set from OpenSSL representation
 	virtual void setFromOSSL(const RSA* inRSA);
 
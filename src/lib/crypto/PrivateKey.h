@@ -66,6 +66,10 @@ public:
 
 	// Decode from PKCS#8 BER
 	virtual bool PKCS8Decode(const ByteString& ber) = 0;
+
+	// Create the crypto library representation of the key up front, so
+	// that the key can be shared between concurrent operations
+	virtual bool prepare() { return true; }
 };
 
 #endif // !_SOFTHSM_V2_PRIVATEKEY_H
@@ -55,7 +55,15 @@ public:
 	virtual ~RNG() { }
 
 	// Generate random data
-	virtual bool generateRandom(ByteString& data, const size_t len) = 0;
+	virtual bool generateRandom(ByteString& data, const size_t len)
+	{
+		data.wipe(len);
+
+		return (len == 0) || generateRandom(&data[0], len);
+	}
+
+	// Generate random data straight into the buffer of the caller
+	virtual bool generateRandom(unsigned char* data, const size_t len) = 0;
 
 	// Seed the random pool
 	virtual void seed(ByteString& seedData) = 0;
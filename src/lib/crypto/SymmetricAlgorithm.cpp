@@ -87,6 +87,34 @@ bool SymmetricAlgorithm::encryptFinal(ByteString& /*encryptedData*/)
 	return true;
 }
 
+bool SymmetricAlgorithm::encryptUpdate(const unsigned char* /*data*/, size_t dataLen, unsigned char* /*encryptedData*/, size_t& /*encryptedDataLen*/)
+{
+	if (currentOperation != ENCRYPT)
+	{
+		return false;
+	}
+
+	currentBufferSize += dataLen;
+
+	return true;
+}
+
+bool SymmetricAlgorithm::encryptFinal(unsigned char* /*encryptedData*/, size_t& /*encryptedDataLen*/)
+{
+	if (currentOperation != ENCRYPT)
+	{
+		return false;
+	}
+
+	currentKey = NULL;
+	currentCipherMode = SymMode::Unknown;
+	currentPaddingMode = true;
+	currentOperation = NONE;
+	currentBufferSize = 0;
+
+	return true;
+}
+
 bool SymmetricAlgorithm::decryptInit(const SymmetricKey* key, const SymMode::Type mode /* = SymMode::CBC */, const ByteString& /*IV = ByteString() */, bool padding /* = true */)
 {
 	if ((key == NULL) || (currentOperation != NONE))
@@ -132,6 +160,34 @@ bool SymmetricAlgorithm::decryptFinal(ByteString& /*data*/)
 	return true;
 }
 
+bool SymmetricAlgorithm::decryptUpdate(const unsigned char* /*encryptedData*/, size_t encryptedDataLen, unsigned char* /*data*/, size_t& /*dataLen*/)
+{
+	if (currentOperation != DECRYPT)
+	{
+		return false;
+	}
+
+	currentBufferSize += encryptedDataLen;
+
+	return true;
+}
+
+bool SymmetricAlgorithm::decryptFinal(unsigned char* /*data*/, size_t& /*dataLen*/)
+{
+	if (currentOperation != DECRYPT)
+	{
+		return false;
+	}
+
+	currentKey = NULL;
+	currentCipherMode = SymMode::Unknown;
+	currentPaddingMode = true;
+	currentOperation = NONE;
+	currentBufferSize = 0;
+
+	return true;
+}
+
 // Key factory
 void SymmetricAlgorithm::recycleKey(SymmetricKey* toRecycle)
 {
@@ -85,11 +85,23 @@ public:
 	virtual bool encryptUpdate(const ByteString& data, ByteString& encryptedData);
 	virtual bool encryptFinal(ByteString& encryptedData);
 
+	// Encryption functions that work on the buffers of the caller, the length
+	// holds the size of the output buffer and returns the number of bytes
+	// written. An update writes at most getBufferSize() + dataLen bytes, for
+	// block modes only the whole blocks of them, and the final call at most
+	// getBlockSize() bytes.
+	virtual bool encryptUpdate(const unsigned char* data, size_t dataLen, unsigned char* encryptedData, size_t& encryptedDataLen);
+	virtual bool encryptFinal(unsigned char* encryptedData, size_t& encryptedDataLen);
+
 	// Decryption functions
 	virtual bool decryptInit(const SymmetricKey* key, const SymMode::Type mode = SymMode::CBC, const ByteString& IV = ByteString(), bool padding = true);
 	virtual bool decryptUpdate(const ByteString& encryptedData, ByteString& data);
 	virtual bool decryptFinal(ByteString& data);
 
+	// Decryption functions that work on the buffers of the caller
+	virtual bool decryptUpdate(const unsigned char* encryptedData, size_t encryptedDataLen, unsigned char* data, size_t& dataLen);
+	virtual bool decryptFinal(unsigned char* data, size_t& dataLen);
+
 	// Wrap/Unwrap keys
 	virtual bool wrapKey(const SymmetricKey* key, const SymWrap::Type mode, const ByteString& in, ByteString& out) = 0;
 
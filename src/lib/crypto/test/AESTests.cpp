@@ -630,6 +630,125 @@ void AESTests::testWrap(const char testKeK[][128], const char testKey[][128], co
 }
 
 // RFC 3394 tests
+void AESTests::testReuse()
+{
+	ByteString keyData1("0102030405060708090A0B0C0D0E0F10");
+	ByteString keyData2("404142434445464748494A4B4C4D4E4F");
+	ByteString IV1("69A1D7C1D1A3FBD0FC4C6C6D0B49A3D1");
+	ByteString IV2("D3B8A8E8B93C4A23E8E09F4A8DEB21E6");
+	ByteString plainText("4938673409687134684698438657403986439058740935874395813968496846");
+
+	AESKey aesKey1(128);
+	CPPUNIT_ASSERT(aesKey1.setKeyBits(keyData1));
+	AESKey aesKey2(128);
+	CPPUNIT_ASSERT(aesKey2.setKeyBits(keyData2));
+
+	ByteString cipherText1, cipherText2, cipherText3, shsmText, OB;
+
+	// Encrypt with the first key
+	CPPUNIT_ASSERT(aes->encryptInit(&aesKey1, SymMode::CBC, IV1));
+	CPPUNIT_ASSERT(aes->encryptUpdate(plainText, OB));
+	cipherText1 += OB;
+	CPPUNIT_ASSERT(aes->encryptFinal(OB));
+	cipherText1 += OB;
+
+	// Repeat with the same key and a different IV
+	CPPUNIT_ASSERT(aes->encryptInit(&aesKey1, SymMode::CBC, IV2));
+	CPPUNIT_ASSERT(aes->encryptUpdate(plainText, OB));
+	cipherText2 += OB;
+	CPPUNIT_ASSERT(aes->encryptFinal(OB));
+	cipherText2 += OB;
+
+	CPPUNIT_ASSERT(cipherText1 != cipherText2);
+
+	// Switch to the second key
+	CPPUNIT_ASSERT(aes->encryptInit(&aesKey2, SymMode::CBC, IV1));
+	CPPUNIT_ASSERT(aes->encryptUpdate(plainText, OB));
+	cipherText3 += OB;
+	CPPUNIT_ASSERT(aes->encryptFinal(OB));
+	cipherText3 += OB;
+
+	CPPUNIT_ASSERT(cipherText1 != cipherText3);
+
+	// Leave an operation unfinished and hand the instance back
+	CPPUNIT_ASSERT(aes->encryptInit(&aesKey2, SymMode::CBC, IV2));
+	CPPUNIT_ASSERT(aes->encryptUpdate(plainText, OB));
+	CryptoFactory::i()->recycleSymmetricAlgorithm(aes);
+
+	// A recycled instance must be usable for a new operation
+	for (int i = 0; i < 2; i++)
+	{
+		aes = CryptoFactory::i()->getSymmetricAlgorithm(SymAlgo::AES);
+		CPPUNIT_ASSERT(aes != NULL);
+
+		shsmText.wipe();
+		CPPUNIT_ASSERT(aes->encryptInit(&aesKey1, SymMode::CBC, IV1));
+		CPPUNIT_ASSERT(aes->encryptUpdate(plainText, OB));
+		shsmText += OB;
+		CPPUNIT_ASSERT(aes->encryptFinal(OB));
+		shsmText += OB;
+
+		CPPUNIT_ASSERT(shsmText == cipherText1);
+
+		shsmText.wipe();
+		CPPUNIT_ASSERT(aes->decryptInit(&aesKey2, SymMode::CBC, IV1));
+		CPPUNIT_ASSERT(aes->decryptUpdate(cipherText3, OB));
+		shsmText += OB;
+		CPPUNIT_ASSERT(aes->decryptFinal(OB));
+		shsmText += OB;
+
+		CPPUNIT_ASSERT(shsmText == plainText);
+
+		CryptoFactory::i()->recycleSymmetricAlgorithm(aes);
+	}
+
+	aes = CryptoFactory::i()->getSymmetricAlgorithm(SymAlgo::AES);
+	CPPUNIT_ASSERT(aes != NULL);
+}
+
+void AESTests::testBuffers()
+{
+	ByteString keyData("0102030405060708090A0B0C0D0E0F10");
+	ByteString IV("69A1D7C1D1A3FBD0FC4C6C6D0B49A3D1");
+	ByteString plainText("4938673409687134684698438657403986439058740935874395813968496846AB");
+
+	AESKey aesKey(128);
+	CPPUNIT_ASSERT(aesKey.setKeyBits(keyData));
+
+	// Reference result using the ByteString interface
+	ByteString cipherText, OB;
+	CPPUNIT_ASSERT(aes->encryptInit(&aesKey, SymMode::CBC, IV));
+	CPPUNIT_ASSERT(aes->encryptUpdate(plainText, OB));
+	cipherText += OB;
+	CPPUNIT_ASSERT(aes->encryptFinal(OB));
+	cipherText += OB;
+	CPPUNIT_ASSERT(cipherText.size() == 48);
+
+	// Encrypt into the buffer of the caller
+	unsigned char buffer[64];
+	size_t updateLen = sizeof(buffer);
+	size_t finalLen;
+	CPPUNIT_ASSERT(aes->encryptInit(&aesKey, SymMode::CBC, IV));
+	CPPUNIT_ASSERT(aes->encryptUpdate(plainText.const_byte_str(), plainText.size(), buffer, updateLen));
+	finalLen = sizeof(buffer) - updateLen;
+	CPPUNIT_ASSERT(aes->encryptFinal(buffer + updateLen, finalLen));
+	CPPUNIT_ASSERT(ByteString(buffer, updateLen + finalLen) == cipherText);
+
+	// Decrypt in place
+	updateLen = cipherText.size();
+	CPPUNIT_ASSERT(aes->decryptInit(&aesKey, SymMode::CBC, IV));
+	CPPUNIT_ASSERT(aes->decryptUpdate(buffer, cipherText.size(), buffer, updateLen));
+	finalLen = cipherText.size() - updateLen;
+	CPPUNIT_ASSERT(aes->decryptFinal(buffer + updateLen, finalLen));
+	CPPUNIT_ASSERT(ByteString(buffer, updateLen + finalLen) == plainText);
+
+	// An output buffer that is too small ends the operation
+	updateLen = 16;
+	CPPUNIT_ASSERT(aes->encryptInit(&aesKey, SymMode::CBC, IV));
+	CPPUNIT_ASSERT(!aes->encryptUpdate(plainText.const_byte_str(), plainText.size(), buffer, updateLen));
+	CPPUNIT_ASSERT(!aes->encryptFinal(OB));
+}
+
 void AESTests::testWrapWoPad()
 {
 	char testKeK[][128] = {
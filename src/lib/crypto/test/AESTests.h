@@ -42,6 +42,8 @@ class AESTests : public CppUnit::TestFixture
 	CPPUNIT_TEST(testBlockSize);
 	CPPUNIT_TEST(testCBC);
 	CPPUNIT_TEST(testECB);
+	CPPUNIT_TEST(testReuse);
+	CPPUNIT_TEST(testBuffers);
 #ifdef HAVE_AES_KEY_WRAP
 	CPPUNIT_TEST(testWrapWoPad);
 #endif
@@ -54,6 +56,8 @@ public:
 	void testBlockSize();
 	void testCBC();
 	void testECB();
+	void testReuse();
+	void testBuffers();
 	void testWrapWoPad();
 	void testWrapPad();
 
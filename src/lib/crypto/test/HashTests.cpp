@@ -267,3 +267,63 @@ void HashTests::testSHA512()
 	hash = NULL;
 	rng = NULL;
 }
+
+void HashTests::testIterated()
+{
+	// The salt and password of RFC4880::PBEDeriveKey
+	ByteString data = ByteString("0102030405060708") + ByteString((const unsigned char*) "1234", 4);
+
+	struct
+	{
+		HashAlgo::Type algorithm;
+		unsigned long iterations;
+		const char* result;
+	}
+	vectors[] = {
+		{ HashAlgo::SHA256, 1, "CA5A65D6CD9D88CC63703811A33307250272E3D8C9F515E55DCE92B005966632" },
+		{ HashAlgo::SHA256, 1500, "5C9769FE193E838945608B37FC08E1B18B8B62AF29E3B9FE06A22CEE196BA909" },
+		{ HashAlgo::SHA512, 2, "A41787F8F9ECA400284A84C2A064448022E841AD61639631C723B009E3472FF0680A4B95B448AC4F6684C47FA465D3B59540F560B66AC57D6AE636BE04B3419C" },
+		{ HashAlgo::SHA1, 3, "B1FC18A6345F57B09A06F165F8C8DDC748849E21" }
+	};
+
+	for (size_t i = 0; i < sizeof(vectors) / sizeof(vectors[0]); i++)
+	{
+		CPPUNIT_ASSERT((hash = CryptoFactory::i()->getHashAlgorithm(vectors[i].algorithm)) != NULL);
+
+		ByteString shsmHash;
+
+		CPPUNIT_ASSERT(hash->hashIterated(data, vectors[i].iterations, shsmHash));
+		CPPUNIT_ASSERT(shsmHash == ByteString(vectors[i].result));
+
+		// The same chain step by step
+		ByteString stepHash;
+
+		CPPUNIT_ASSERT(hash->hashInit());
+		CPPUNIT_ASSERT(hash->hashUpdate(data));
+		CPPUNIT_ASSERT(hash->hashFinal(stepHash));
+
+		for (unsigned long j = 1; j < vectors[i].iterations; j++)
+		{
+			CPPUNIT_ASSERT(hash->hashInit());
+			CPPUNIT_ASSERT(hash->hashUpdate(stepHash));
+			CPPUNIT_ASSERT(hash->hashFinal(stepHash));
+		}
+
+		CPPUNIT_ASSERT(shsmHash == stepHash);
+
+		// The result can also replace the data
+		CPPUNIT_ASSERT(hash->hashIterated(stepHash, 1, stepHash));
+		CPPUNIT_ASSERT(hash->hashIterated(shsmHash, 1, shsmHash));
+		CPPUNIT_ASSERT(shsmHash == stepHash);
+
+		// Not during another operation or without iterations
+		CPPUNIT_ASSERT(!hash->hashIterated(data, 0, shsmHash));
+		CPPUNIT_ASSERT(hash->hashInit());
+		CPPUNIT_ASSERT(!hash->hashIterated(data, 1, shsmHash));
+		CPPUNIT_ASSERT(hash->hashFinal(shsmHash));
+
+		CryptoFactory::i()->recycleHashAlgorithm(hash);
+
+		hash = NULL;
+	}
+}
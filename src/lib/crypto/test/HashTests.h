@@ -48,6 +48,7 @@ class HashTests : public CppUnit::TestFixture
 	CPPUNIT_TEST(testSHA256);
 	CPPUNIT_TEST(testSHA384);
 	CPPUNIT_TEST(testSHA512);
+	CPPUNIT_TEST(testIterated);
 	CPPUNIT_TEST_SUITE_END();
 
 public:
@@ -59,6 +60,7 @@ public:
 	void testSHA256();
 	void testSHA384();
 	void testSHA512();
+	void testIterated();
 
 	void setUp();
 	void tearDown();
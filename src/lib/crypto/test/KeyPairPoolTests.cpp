@@ -0,0 +1,229 @@
+/*
+ * Copyright (c) 2016 SURFnet bv
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+/*****************************************************************************
+ KeyPairPoolTests.cpp
+
+ Contains test cases to test the key pair pool
+ *****************************************************************************/
+
+#include <stdlib.h>
+#include <cppunit/extensions/HelperMacros.h>
+#include "KeyPairPoolTests.h"
+#include "CryptoFactory.h"
+#include "RSAPublicKey.h"
+#include "ECPublicKey.h"
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+CPPUNIT_TEST_SUITE_REGISTRATION(KeyPairPoolTests);
+
+// Give the worker threads some time
+static void idle()
+{
+#ifdef _WIN32
+	Sleep(10);
+#else
+	usleep(10000);
+#endif
+}
+
+void KeyPairPoolTests::setUp()
+{
+	pool = new KeyPairPool();
+}
+
+void KeyPairPoolTests::tearDown()
+{
+	delete pool;
+
+	fflush(stdout);
+}
+
+AsymmetricKeyPair* KeyPairPoolTests::waitRSA(const RSAParameters& params)
+{
+	AsymmetricKeyPair* kp = NULL;
+
+	for (int i = 0; kp == NULL && i < 6000; i++)
+	{
+		kp = pool->takeRSA(params);
+		if (kp == NULL) idle();
+	}
+
+	return kp;
+}
+
+AsymmetricKeyPair* KeyPairPoolTests::waitEC(const ECParameters& params)
+{
+	AsymmetricKeyPair* kp = NULL;
+
+	for (int i = 0; kp == NULL && i < 6000; i++)
+	{
+		kp = pool->takeEC(params);
+		if (kp == NULL) idle();
+	}
+
+	return kp;
+}
+
+void KeyPairPoolTests::testConfiguration()
+{
+	CPPUNIT_ASSERT(pool->isEmpty());
+
+	// Empty specifications add nothing
+	CPPUNIT_ASSERT(pool->configureRSA(""));
+	CPPUNIT_ASSERT(pool->configureEC(""));
+	CPPUNIT_ASSERT(pool->isEmpty());
+
+	CPPUNIT_ASSERT(pool->configureRSA("1024:2, 2048:3:1"));
+	CPPUNIT_ASSERT(pool->configureEC("P-256:1,06052B81040022:1"));
+	CPPUNIT_ASSERT(!pool->isEmpty());
+
+	// The same entry cannot be added twice
+	CPPUNIT_ASSERT(!pool->configureRSA("1024:65537:1"));
+	CPPUNIT_ASSERT(!pool->configureEC("prime256v1:1"));
+
+	// Malformed entries
+	CPPUNIT_ASSERT(!pool->configureRSA("1024"));
+	CPPUNIT_ASSERT(!pool->configureRSA("1024:0"));
+	CPPUNIT_ASSERT(!pool->configureRSA("1024:x:1"));
+	CPPUNIT_ASSERT(!pool->configureRSA("1024:3:1:1"));
+	CPPUNIT_ASSERT(!pool->configureEC("P-255:1"));
+	CPPUNIT_ASSERT(!pool->configureEC("P-384"));
+	CPPUNIT_ASSERT(!pool->configureEC("06052B8104002:1"));
+
+	// Nothing is ready before the pool is started
+	RSAParameters p;
+	p.setE("010001");
+	p.setBitLength(1024);
+	CPPUNIT_ASSERT(pool->takeRSA(p) == NULL);
+}
+
+void KeyPairPoolTests::testTake()
+{
+	CPPUNIT_ASSERT(pool->configureRSA("1024:2, 1024:3:1"));
+	CPPUNIT_ASSERT(pool->configureEC("P-256:1"));
+	CPPUNIT_ASSERT(pool->start(2));
+
+	// Entries cannot be added to a running pool
+	CPPUNIT_ASSERT(!pool->configureRSA("1536:1"));
+
+	AsymmetricAlgorithm* rsa = CryptoFactory::i()->getAsymmetricAlgorithm(AsymAlgo::RSA);
+	CPPUNIT_ASSERT(rsa != NULL);
+
+	// The exponent is matched by value
+	RSAParameters p;
+	p.setE("00010001");
+	p.setBitLength(1024);
+
+	for (int i = 0; i < 3; i++)
+	{
+		AsymmetricKeyPair* kp = waitRSA(p);
+		CPPUNIT_ASSERT(kp != NULL);
+
+		RSAPublicKey* pub = (RSAPublicKey*) kp->getPublicKey();
+		CPPUNIT_ASSERT(pub->getBitLength() == 1024);
+		CPPUNIT_ASSERT(pub->getE() == ByteString("010001"));
+
+		rsa->recycleKeyPair(kp);
+	}
+
+	p.setE("03");
+	AsymmetricKeyPair* kp = waitRSA(p);
+	CPPUNIT_ASSERT(kp != NULL);
+	CPPUNIT_ASSERT(((RSAPublicKey*) kp->getPublicKey())->getE() == ByteString("03"));
+	rsa->recycleKeyPair(kp);
+
+	// Parameters that are not in the pool
+	p.setBitLength(2048);
+	CPPUNIT_ASSERT(pool->takeRSA(p) == NULL);
+
+	CryptoFactory::i()->recycleAsymmetricAlgorithm(rsa);
+
+#ifdef WITH_ECC
+	AsymmetricAlgorithm* ecdsa = CryptoFactory::i()->getAsymmetricAlgorithm(AsymAlgo::ECDSA);
+	CPPUNIT_ASSERT(ecdsa != NULL);
+
+	ECParameters ecp;
+	ecp.setEC(ByteString("06082A8648CE3D030107"));
+	kp = waitEC(ecp);
+	CPPUNIT_ASSERT(kp != NULL);
+	CPPUNIT_ASSERT(((ECPublicKey*) kp->getPublicKey())->getEC() == ecp.getEC());
+	ecdsa->recycleKeyPair(kp);
+
+	CryptoFactory::i()->recycleAsymmetricAlgorithm(ecdsa);
+#endif
+}
+
+void KeyPairPoolTests::testStop()
+{
+	// Stopping waits for the key pairs that are being generated
+	CPPUNIT_ASSERT(pool->configureRSA("2048:4"));
+	CPPUNIT_ASSERT(pool->start(2));
+	pool->stop();
+
+	RSAParameters p;
+	p.setE("010001");
+	p.setBitLength(2048);
+
+	// Take the remaining key pairs; none are added after stopping
+	AsymmetricKeyPair* kp;
+	while ((kp = pool->takeRSA(p)) != NULL)
+	{
+		delete kp;
+	}
+	idle();
+	CPPUNIT_ASSERT(pool->takeRSA(p) == NULL);
+}
+
+void KeyPairPoolTests::testLifetime()
+{
+	// Ready key pairs are only kept for the configured number of seconds
+	pool->setLifetime(1);
+	CPPUNIT_ASSERT(pool->configureRSA("1024:1"));
+	CPPUNIT_ASSERT(pool->start(1));
+
+	RSAParameters p;
+	p.setE("010001");
+	p.setBitLength(1024);
+
+	AsymmetricKeyPair* kp = waitRSA(p);
+	CPPUNIT_ASSERT(kp != NULL);
+	delete kp;
+
+	// The key pair that is ready when stopping is wiped once it is too old
+	pool->stop();
+#ifdef _WIN32
+	Sleep(1100);
+#else
+	usleep(1100000);
+#endif
+	CPPUNIT_ASSERT(pool->takeRSA(p) == NULL);
+}
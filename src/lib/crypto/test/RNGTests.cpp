@@ -35,8 +35,17 @@
 #include "RNGTests.h"
 #include "CryptoFactory.h"
 #include "RNG.h"
+#include "osthread.h"
+#ifdef WITH_OPENSSL
+#include "OSSLDRBG.h"
+#endif
 #include "ent.h"
 #include <stdio.h>
+#include <string.h>
+#ifndef _WIN32
+#include <unistd.h>
+#include <sys/wait.h>
+#endif
 
 CPPUNIT_TEST_SUITE_REGISTRATION(RNGTests);
 
@@ -83,3 +92,156 @@ void RNGTests::testEnt()
 	CPPUNIT_ASSERT(serialCorrelation <= 0.001);
 }
 
+
+void RNGTests::testBuffer()
+{
+	// The buffer is larger than one DRBG request and is surrounded by guards
+	const size_t len = 70000;
+	unsigned char* a = new unsigned char[len + 2];
+	unsigned char* b = new unsigned char[len + 2];
+
+	memset(a, 0xA5, len + 2);
+	memset(b, 0xA5, len + 2);
+
+	CPPUNIT_ASSERT(rng->generateRandom(a + 1, len));
+	CPPUNIT_ASSERT(rng->generateRandom(b + 1, len));
+	CPPUNIT_ASSERT((a[0] == 0xA5) && (a[len + 1] == 0xA5));
+	CPPUNIT_ASSERT((b[0] == 0xA5) && (b[len + 1] == 0xA5));
+	CPPUNIT_ASSERT(memcmp(a + 1, b + 1, len) != 0);
+
+	// An empty request leaves the buffer alone
+	a[1] = 0xA5;
+	CPPUNIT_ASSERT(rng->generateRandom(a + 1, 0));
+	CPPUNIT_ASSERT(a[1] == 0xA5);
+
+	// Requests of odd sizes follow each other without repeating output
+	CPPUNIT_ASSERT(rng->generateRandom(a + 1, 17));
+	CPPUNIT_ASSERT(rng->generateRandom(b + 1, 17));
+	CPPUNIT_ASSERT(memcmp(a + 1, b + 1, 17) != 0);
+
+	delete[] a;
+	delete[] b;
+}
+
+// Generate some random data on another thread
+struct RNGThreadData
+{
+	RNG* rng;
+	unsigned char data[2][32];
+	bool rv;
+};
+
+static void* generateOnThread(void* arg)
+{
+	RNGThreadData* threadData = (RNGThreadData*) arg;
+
+	threadData->rv = threadData->rng->generateRandom(threadData->data[0], 32) &&
+			 threadData->rng->generateRandom(threadData->data[1], 32);
+
+	return NULL;
+}
+
+void RNGTests::testThreads()
+{
+	const size_t threads = 4;
+	RNGThreadData threadData[threads];
+	CK_VOID_PTR handles[threads];
+
+	for (size_t i = 0; i < threads; i++)
+	{
+		threadData[i].rng = rng;
+		threadData[i].rv = false;
+		CPPUNIT_ASSERT(OSCreateThread(&handles[i], generateOnThread, &threadData[i]) == CKR_OK);
+	}
+
+	for (size_t i = 0; i < threads; i++)
+	{
+		CPPUNIT_ASSERT(OSJoinThread(handles[i]) == CKR_OK);
+		CPPUNIT_ASSERT(threadData[i].rv);
+	}
+
+	// No two threads produce the same output
+	for (size_t i = 0; i < threads * 2; i++)
+	{
+		for (size_t j = i + 1; j < threads * 2; j++)
+		{
+			CPPUNIT_ASSERT(memcmp(threadData[i / 2].data[i % 2], threadData[j / 2].data[j % 2], 32) != 0);
+		}
+	}
+}
+
+void RNGTests::testFork()
+{
+#ifndef _WIN32
+	unsigned char parent[32];
+	unsigned char child[32];
+	int fds[2];
+
+	// Make sure that the state of this thread exists before the fork
+	CPPUNIT_ASSERT(rng->generateRandom(parent, sizeof(parent)));
+
+	CPPUNIT_ASSERT(pipe(fds) == 0);
+
+	pid_t pid = fork();
+	CPPUNIT_ASSERT(pid >= 0);
+
+	if (pid == 0)
+	{
+		bool rv = rng->generateRandom(child, sizeof(child)) &&
+			  (write(fds[1], child, sizeof(child)) == (ssize_t) sizeof(child));
+
+		_exit(rv ? 0 : 1);
+	}
+
+	close(fds[1]);
+
+	CPPUNIT_ASSERT(rng->generateRandom(parent, sizeof(parent)));
+	CPPUNIT_ASSERT(read(fds[0], child, sizeof(child)) == (ssize_t) sizeof(child));
+	close(fds[0]);
+
+	int status;
+	CPPUNIT_ASSERT(waitpid(pid, &status, 0) == pid);
+	CPPUNIT_ASSERT(WIFEXITED(status) && (WEXITSTATUS(status) == 0));
+
+	// The child does not repeat the output of the parent
+	CPPUNIT_ASSERT(memcmp(parent, child, sizeof(parent)) != 0);
+#endif
+}
+
+void RNGTests::testDRBG()
+{
+#ifdef WITH_OPENSSL
+	// CTR_DRBG with AES-256 and without derivation function; the first
+	// output is the one of the NIST example for this entropy input
+	ByteString entropy = "000102030405060708090A0B0C0D0E0F101112131415161718191A1B1C1D1E1F202122232425262728292A2B2C2D2E2F";
+	ByteString reseed = "808182838485868788898A8B8C8D8E8F909192939495969798999A9B9C9D9E9FA0A1A2A3A4A5A6A7A8A9AAABACADAEAF";
+	ByteString first = "061550234D158C5EC95595FE04EF7A25767F2E24CC2BC479D09D86DC9ABCFDE7056A8C266F9EF97ED08541DBD2E1FFA19810F5392D076276EF41277C3AB6E94A";
+	ByteString second = "04562AD35E8ECAFAAFDA16981CDAA14760";
+	ByteString afterReseed = "2B69F283086D6FA57A5538A3182FEEDB760A2320E2F105FEA183BABCD7795312";
+	ByteString output;
+	OSSLDRBG drbg;
+
+	// Nothing is generated before the DRBG is instantiated
+	unsigned char byte;
+
+	CPPUNIT_ASSERT(drbg.needsReseed());
+	CPPUNIT_ASSERT(!drbg.generate(&byte, 1));
+
+	CPPUNIT_ASSERT(drbg.instantiate(entropy.const_byte_str()));
+	CPPUNIT_ASSERT(!drbg.needsReseed());
+
+	output.resize(first.size());
+	CPPUNIT_ASSERT(drbg.generate(&output[0], output.size()));
+	CPPUNIT_ASSERT(output == first);
+
+	output.resize(second.size());
+	CPPUNIT_ASSERT(drbg.generate(&output[0], output.size()));
+	CPPUNIT_ASSERT(output == second);
+
+	CPPUNIT_ASSERT(drbg.reseed(reseed.const_byte_str()));
+
+	output.resize(afterReseed.size());
+	CPPUNIT_ASSERT(drbg.generate(&output[0], output.size()));
+	CPPUNIT_ASSERT(output == afterReseed);
+#endif
+}
@@ -41,11 +41,19 @@ class RNGTests : public CppUnit::TestFixture
 	CPPUNIT_TEST_SUITE(RNGTests);
 	CPPUNIT_TEST(testSimpleComparison);
 	CPPUNIT_TEST(testEnt);
+	CPPUNIT_TEST(testBuffer);
+	CPPUNIT_TEST(testThreads);
+	CPPUNIT_TEST(testFork);
+	CPPUNIT_TEST(testDRBG);
 	CPPUNIT_TEST_SUITE_END();
 
 public:
 	void testSimpleComparison();
 	void testEnt();
+	void testBuffer();
+	void testThreads();
+	void testFork();
+	void testDRBG();
 
 	void setUp();
 	void tearDown();
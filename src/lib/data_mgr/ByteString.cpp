@@ -31,27 +31,53 @@
  *****************************************************************************/
 
 #include <algorithm>
+#include <new>
 #include <string>
 #include <stdio.h>
+#include <string.h>
 #include "config.h"
 #include "log.h"
 #include "ByteString.h"
+#include "SecureMemoryRegistry.h"
+
+// Wipe bytes in a way that is not optimised away for memory that is about to
+// go out of scope
+static void wipeBytes(unsigned char* bytes, size_t len)
+{
+	volatile unsigned char* p = bytes;
+
+	while (len--) *p++ = 0x00;
+}
 
 // Constructors
 ByteString::ByteString()
 {
+	byteString = inlineBytes;
+	length = 0;
+	capacity = BYTESTRING_INLINE_SIZE;
+	memset(inlineBytes, 0x00, BYTESTRING_INLINE_SIZE);
 }
 
 ByteString::ByteString(const unsigned char* bytes, const size_t bytesLen)
 {
-	byteString.resize(bytesLen);
+	byteString = inlineBytes;
+	length = 0;
+	capacity = BYTESTRING_INLINE_SIZE;
+	memset(inlineBytes, 0x00, BYTESTRING_INLINE_SIZE);
+
+	resize(bytesLen);
 
 	if (bytesLen > 0)
-		memcpy(&byteString[0], bytes, bytesLen);
+		memcpy(byteString, bytes, bytesLen);
 }
 
 ByteString::ByteString(const char* hexString)
 {
+	byteString = inlineBytes;
+	length = 0;
+	capacity = BYTESTRING_INLINE_SIZE;
+	memset(inlineBytes, 0x00, BYTESTRING_INLINE_SIZE);
+
 	std::string hex = std::string(hexString);
 
 	if (hex.size() % 2 != 0)
@@ -59,6 +85,8 @@ ByteString::ByteString(const char* hexString)
 		hex = "0" + hex;
 	}
 
+	reserve(hex.size() / 2);
+
 	for (size_t i = 0; i < hex.size(); i += 2)
 	{
 		std::string byteStr;
@@ -73,6 +101,11 @@ ByteString::ByteString(const char* hexString)
 
 ByteString::ByteString(const unsigned long longValue)
 {
+	byteString = inlineBytes;
+	length = 0;
+	capacity = BYTESTRING_INLINE_SIZE;
+	memset(inlineBytes, 0x00, BYTESTRING_INLINE_SIZE);
+
 	unsigned long setValue = longValue;
 
 	// Convert the value to a big-endian byte string; N.B.: this code assumes that unsigned long
@@ -86,41 +119,159 @@ ByteString::ByteString(const unsigned long longValue)
 	// read the storage of a 64-bit version and vice versa under the assumption that the stored
 	// values never exceed 32-bits, which is likely since these values are only used to encode
 	// byte string lengths)
-	unsigned char byteStrIn[8];
-	
 	for (size_t i = 0; i < 8; i++)
 	{
-		byteStrIn[7-i] = (unsigned char) (setValue & 0xFF);
+		inlineBytes[7-i] = (unsigned char) (setValue & 0xFF);
 		setValue >>= 8;
 	}
 
-	byteString.resize(8);
-	memcpy(&byteString[0], byteStrIn, 8);
+	length = 8;
 }
 
 ByteString::ByteString(const ByteString& in)
 {
-	this->byteString = in.byteString;
+	byteString = inlineBytes;
+	length = 0;
+	capacity = BYTESTRING_INLINE_SIZE;
+	memset(inlineBytes, 0x00, BYTESTRING_INLINE_SIZE);
+
+	resize(in.length);
+
+	if (in.length > 0)
+		memcpy(byteString, in.byteString, in.length);
+}
+
+#ifdef HAVE_CXX11
+ByteString::ByteString(ByteString&& in) noexcept
+{
+	byteString = inlineBytes;
+	length = 0;
+	capacity = BYTESTRING_INLINE_SIZE;
+	memset(inlineBytes, 0x00, BYTESTRING_INLINE_SIZE);
+
+	swap(in);
+}
+#endif
+
+// Destructor
+ByteString::~ByteString()
+{
+	if (isInline())
+	{
+		wipeBytes(inlineBytes, length);
+	}
+	else
+	{
+		release();
+	}
+}
+
+// Assignment
+ByteString& ByteString::operator=(const ByteString& in)
+{
+	if (this == &in) return *this;
+
+	if (in.length > capacity)
+	{
+		// Drop the old contents instead of copying them to the new allocation
+		wipe();
+		reserve(in.length);
+	}
+
+	resize(in.length);
+
+	if (in.length > 0)
+		memcpy(byteString, in.byteString, in.length);
+
+	return *this;
+}
+
+#ifdef HAVE_CXX11
+ByteString& ByteString::operator=(ByteString&& in) noexcept
+{
+	if (this == &in) return *this;
+
+	// Leave the moved-from string empty
+	wipe();
+	if (!isInline()) release();
+
+	swap(in);
+
+	return *this;
+}
+#endif
+
+// Exchange the contents with another byte string; inline bytes are copied,
+// secure allocations change owner
+void ByteString::swap(ByteString& other)
+{
+	if (this == &other) return;
+
+	bool thisInline = isInline();
+	bool otherInline = other.isInline();
+
+	if (thisInline && otherInline)
+	{
+		unsigned char tmp[BYTESTRING_INLINE_SIZE];
+
+		memcpy(tmp, inlineBytes, BYTESTRING_INLINE_SIZE);
+		memcpy(inlineBytes, other.inlineBytes, BYTESTRING_INLINE_SIZE);
+		memcpy(other.inlineBytes, tmp, BYTESTRING_INLINE_SIZE);
+		wipeBytes(tmp, BYTESTRING_INLINE_SIZE);
+	}
+	else if (thisInline)
+	{
+		memcpy(other.inlineBytes, inlineBytes, BYTESTRING_INLINE_SIZE);
+		wipeBytes(inlineBytes, BYTESTRING_INLINE_SIZE);
+		byteString = other.byteString;
+		other.byteString = other.inlineBytes;
+	}
+	else if (otherInline)
+	{
+		memcpy(inlineBytes, other.inlineBytes, BYTESTRING_INLINE_SIZE);
+		wipeBytes(other.inlineBytes, BYTESTRING_INLINE_SIZE);
+		other.byteString = byteString;
+		byteString = inlineBytes;
+	}
+	else
+	{
+		std::swap(byteString, other.byteString);
+	}
+
+	std::swap(length, other.length);
+	std::swap(capacity, other.capacity);
 }
 
 // Append data
 ByteString& ByteString::operator+=(const ByteString& append)
 {
-	size_t curLen = byteString.size();
-	size_t toAdd = append.byteString.size();
+	size_t curLen = length;
+	size_t toAdd = append.length;
 	size_t newLen = curLen + toAdd;
 
-	byteString.resize(newLen);
+	// Grow geometrically for strings that are built piece by piece
+	if (newLen > capacity)
+	{
+		reserve(std::max(newLen, 2 * capacity));
+	}
 
+	// The source is read after growing, as it may be this string
 	if (toAdd > 0)
-		memcpy(&byteString[curLen], &append.byteString[0], toAdd);
+		memcpy(byteString + curLen, append.byteString, toAdd);
+
+	length = newLen;
 
 	return *this;
 }
 
 ByteString& ByteString::operator+=(const unsigned char byte)
 {
-	byteString.push_back(byte);
+	if (length == capacity)
+	{
+		reserve(2 * capacity);
+	}
+
+	byteString[length++] = byte;
 
 	return *this;
 }
@@ -141,15 +292,15 @@ ByteString& ByteString::operator^=(const ByteString& rhs)
 // Return a substring
 ByteString ByteString::substr(const size_t start, const size_t len /* = SIZE_T_MAX */) const
 {
-	size_t retLen = std::min(len, byteString.size() - start);
-
-	if (start >= byteString.size())
+	if (start >= length)
 	{
 		return ByteString();
 	}
 	else
 	{
-		return ByteString(&byteString[start], retLen);
+		size_t retLen = std::min(len, length - start);
+
+		return ByteString(byteString + start, retLen);
 	}
 }
 
@@ -187,13 +338,13 @@ unsigned char& ByteString::operator[](size_t pos)
 // Return the byte string data
 unsigned char* ByteString::byte_str()
 {
-	return &byteString[0];
+	return byteString;
 }
 
 // Return the const byte string
 const unsigned char* ByteString::const_byte_str() const
 {
-	return (const unsigned char*) &byteString[0];
+	return (const unsigned char*) byteString;
 }
 
 // Return a hexadecimal character representation of the string
@@ -202,7 +353,7 @@ std::string ByteString::hex_str() const
 	std::string rv;
 	char hex[3];
 
-	for (size_t i = 0; i < byteString.size(); i++)
+	for (size_t i = 0; i < length; i++)
 	{
 		sprintf(hex, "%02X", byteString[i]);
 
@@ -218,7 +369,7 @@ unsigned long ByteString::long_val() const
 	// Convert the first 8 bytes of the string to an unsigned long value
 	unsigned long rv = 0;
 
-	for (size_t i = 0; i < std::min(size_t(8), byteString.size()); i++)
+	for (size_t i = 0; i < std::min(size_t(8), length); i++)
 	{
 		rv <<= 8;
 		rv += byteString[i];
@@ -242,17 +393,14 @@ ByteString ByteString::split(size_t len)
 {
 	ByteString rv = substr(0, len);
 
-	size_t newSize = (byteString.size() > len) ? (byteString.size() - len) : 0;
+	size_t newSize = (length > len) ? (length - len) : 0;
 
 	if (newSize > 0)
 	{
-		for (size_t i = 0; i < newSize; i++)
-		{
-			byteString[i] = byteString[i + len];
-		}
+		memmove(byteString, byteString + len, newSize);
 	}
 
-	byteString.resize(newSize);
+	resize(newSize);
 
 	return rv;
 }
@@ -260,11 +408,11 @@ ByteString ByteString::split(size_t len)
 // The size of the byte string in bits
 size_t ByteString::bits() const
 {
-	size_t bits = byteString.size() * 8;
+	size_t bits = length * 8;
 
 	if (bits == 0) return 0;
 
-	for (size_t i = 0; i < byteString.size(); i++)
+	for (size_t i = 0; i < length; i++)
 	{
 		unsigned char byte = byteString[i];
 
@@ -287,20 +435,30 @@ size_t ByteString::bits() const
 // The size of the byte string in bytes
 size_t ByteString::size() const
 {
-	return byteString.size();
+	return length;
 }
 
+// Resize; new bytes are zero and the bytes that are cut off are wiped
 void ByteString::resize(const size_t newSize)
 {
-	byteString.resize(newSize);
+	if (newSize > capacity)
+	{
+		reserve(newSize);
+	}
+	else if (newSize < length)
+	{
+		wipeBytes(byteString + newSize, length - newSize);
+	}
+
+	length = newSize;
 }
 
 void ByteString::wipe(const size_t newSize /* = 0 */)
 {
 	this->resize(newSize);
 
-	if (!byteString.empty())
-		memset(&byteString[0], 0x00, byteString.size());
+	if (length > 0)
+		memset(byteString, 0x00, length);
 }
 
 // Comparison
@@ -315,7 +473,7 @@ bool ByteString::operator==(const ByteString& compareTo) const
 		return true;
 	}
 
-	return (memcmp(&byteString[0], &compareTo.byteString[0], this->size()) == 0);
+	return (memcmp(byteString, compareTo.byteString, this->size()) == 0);
 }
 
 bool ByteString::operator!=(const ByteString& compareTo) const
@@ -329,7 +487,7 @@ bool ByteString::operator!=(const ByteString& compareTo) const
 		return false;
 	}
 
-	return (memcmp(&byteString[0], &compareTo.byteString[0], this->size()) != 0);
+	return (memcmp(byteString, compareTo.byteString, this->size()) != 0);
 }
 
 // XOR data
@@ -338,9 +496,11 @@ ByteString operator^(const ByteString& lhs, const ByteString& rhs)
 	size_t xorLen = std::min(lhs.size(), rhs.size());
 	ByteString rv;
 
+	rv.resize(xorLen);
+
 	for (size_t i = 0; i < xorLen; i++)
 	{
-		rv += lhs.const_byte_str()[i] ^ rhs.const_byte_str()[i];
+		rv[i] = lhs.const_byte_str()[i] ^ rhs.const_byte_str()[i];
 	}
 
 	return rv;
@@ -363,3 +523,50 @@ ByteString ByteString::serialise() const
 	return rv;
 }
 
+// Make room for at least the given number of bytes
+void ByteString::reserve(const size_t newCapacity)
+{
+	if (newCapacity <= capacity) return;
+
+	unsigned char* newBytes = (unsigned char*) SecureMemoryRegistry::i()->allocate(newCapacity);
+	if (newBytes == NULL)
+	{
+		ERROR_MSG("Could not allocate %d bytes of secure memory", newCapacity);
+
+		throw std::bad_alloc();
+	}
+
+	memcpy(newBytes, byteString, length);
+	memset(newBytes + length, 0x00, newCapacity - length);
+
+	if (isInline())
+	{
+		wipeBytes(inlineBytes, length);
+	}
+	else
+	{
+		SecureMemoryRegistry::i()->release(byteString, capacity);
+	}
+
+	byteString = newBytes;
+	capacity = newCapacity;
+}
+
+// Release the secure allocation and return to the inline buffer
+void ByteString::release()
+{
+	if (isInline()) return;
+
+	// The registry wipes the memory before it is released
+	SecureMemoryRegistry::i()->release(byteString, capacity);
+
+	byteString = inlineBytes;
+	length = 0;
+	capacity = BYTESTRING_INLINE_SIZE;
+}
+
+// Check if the bytes are stored in the inline buffer
+bool ByteString::isInline() const
+{
+	return byteString == inlineBytes;
+}
@@ -28,6 +28,10 @@
  ByteString.h
 
  A string class for byte strings stored in securely allocated memory
+
+ Short byte strings are kept in a buffer inside the object, which is wiped
+ when it is no longer used. Only longer byte strings are allocated from the
+ secure memory registry.
  *****************************************************************************/
 
 #ifndef _SOFTHSM_V2_BYTESTRING_H
@@ -46,6 +50,9 @@
 #define SIZE_T_MAX ((size_t) -1)
 #endif // !SIZE_T_MAX
 
+// Byte strings up to this size do not need a secure allocation
+#define BYTESTRING_INLINE_SIZE 64
+
 class ByteString
 {
 public:
@@ -60,8 +67,22 @@ public:
 
 	ByteString(const ByteString& in);
 
+#ifdef HAVE_CXX11
+	ByteString(ByteString&& in) noexcept;
+#endif
+
 	// Destructor
-	virtual ~ByteString() { }
+	virtual ~ByteString();
+
+	// Assignment
+	ByteString& operator=(const ByteString& in);
+
+#ifdef HAVE_CXX11
+	ByteString& operator=(ByteString&& in) noexcept;
+#endif
+
+	// Exchange the contents with another byte string
+	void swap(ByteString& other);
 
 	// Append data
 	ByteString& operator+=(const ByteString& append);
@@ -116,7 +137,22 @@ public:
 	static ByteString chainDeserialise(ByteString& serialised);
 
 private:
-	std::vector<unsigned char, SecureAllocator<unsigned char> > byteString;
+	// Make room for at least the given number of bytes
+	void reserve(const size_t newCapacity);
+
+	// Release the secure allocation and return to the inline buffer
+	void release();
+
+	// Check if the bytes are stored in the inline buffer
+	bool isInline() const;
+
+	// The bytes of the string, either the inline buffer or a secure allocation
+	unsigned char* byteString;
+	size_t length;
+	size_t capacity;
+
+	// All bytes beyond the length of the string are kept zero
+	unsigned char inlineBytes[BYTESTRING_INLINE_SIZE];
 };
 
 // Add data
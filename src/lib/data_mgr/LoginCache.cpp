@@ -0,0 +1,314 @@
+/*
+ * Copyright (c) 2016 SURFnet bv
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+/*****************************************************************************
+ LoginCache.cpp
+
+ A per-process cache of successful logins
+ *****************************************************************************/
+
+#include "config.h"
+#include "log.h"
+#include "LoginCache.h"
+#include "SecureMemoryRegistry.h"
+#include "CryptoFactory.h"
+#include "MacAlgorithm.h"
+#include "SymmetricKey.h"
+#include "RNG.h"
+#include <string.h>
+
+// Initialise the one-and-only instance
+#ifdef HAVE_CXX11
+std::unique_ptr<LoginCache> LoginCache::instance(nullptr);
+#else
+std::auto_ptr<LoginCache> LoginCache::instance(NULL);
+#endif
+
+// Constructor
+LoginCache::LoginCache()
+{
+	table = NULL;
+	ttl = 0;
+	attached = false;
+	registered = false;
+	cacheMutex = NULL;
+}
+
+// Destructor
+LoginCache::~LoginCache()
+{
+	// The registry and the mutex factory may already be gone when the
+	// process exits, so neither is used; a mutex of a cache that is still
+	// attached then is left to the process exit
+	if (table != NULL)
+	{
+		SecureMemoryRegistry::zeroise(table, sizeof(Table));
+		SecureMemoryRegistry::releaseRegion(table, sizeof(Table));
+	}
+}
+
+// Return the one-and-only instance
+LoginCache* LoginCache::i()
+{
+	if (instance.get() == NULL)
+	{
+		instance.reset(new LoginCache());
+	}
+
+	return instance.get();
+}
+
+// This will destroy the one-and-only instance.
+void LoginCache::reset()
+{
+	if (instance.get() != NULL) instance->detach();
+
+	instance.reset();
+}
+
+// Start using the cache with the given lifetime of the entries
+void LoginCache::attach(unsigned long inTTL)
+{
+	if (cacheMutex == NULL) cacheMutex = MutexFactory::i()->getMutex();
+
+	MutexLocker lock(cacheMutex);
+
+	ttl = inTTL;
+	attached = true;
+
+	if (ttl == 0)
+	{
+		clearTable();
+	}
+	else if ((table != NULL) && !registered)
+	{
+		SecureMemoryRegistry::i()->add(table, sizeof(Table));
+		registered = true;
+	}
+}
+
+// Stop using the cache until the next attach; the mutex may have been
+// created with functions that the application supplied to C_Initialize
+void LoginCache::detach()
+{
+	if (!attached) return;
+
+	if (registered)
+	{
+		SecureMemoryRegistry::i()->remove(table);
+		registered = false;
+	}
+
+	attached = false;
+
+	MutexFactory::i()->recycleMutex(cacheMutex);
+	cacheMutex = NULL;
+}
+
+// Is the cache in use?
+bool LoginCache::isEnabled()
+{
+	return attached && (ttl > 0);
+}
+
+// Find the key for the PIN and the encrypted key blob
+bool LoginCache::lookup(const ByteString& encryptedKey, const ByteString& pin, ByteString& key)
+{
+	MutexLocker lock(cacheMutex);
+
+	if (!isEnabled() || (table == NULL)) return false;
+
+	ByteString verifierAndPad;
+
+	if (!derive(encryptedKey, pin, verifierAndPad)) return false;
+
+	const unsigned char* verifier = verifierAndPad.const_byte_str();
+	const unsigned char* pad = verifier + LOGIN_CACHE_VERIFIER_SIZE;
+	time_t now = time(NULL);
+
+	for (size_t i = 0; i < LOGIN_CACHE_SIZE; i++)
+	{
+		Entry& entry = table->entries[i];
+
+		// Expired entries are wiped when they are come across
+		if (!isLive(entry, now))
+		{
+			if (entry.expires != 0) SecureMemoryRegistry::zeroise(&entry, sizeof(Entry));
+
+			continue;
+		}
+
+		// Compare in constant time
+		unsigned char diff = 0;
+
+		for (size_t j = 0; j < LOGIN_CACHE_VERIFIER_SIZE; j++)
+		{
+			diff |= entry.verifier[j] ^ verifier[j];
+		}
+
+		if (diff != 0) continue;
+
+		key.resize(LOGIN_CACHE_KEY_SIZE);
+
+		for (size_t j = 0; j < LOGIN_CACHE_KEY_SIZE; j++)
+		{
+			key[j] = entry.key[j] ^ pad[j];
+		}
+
+		return true;
+	}
+
+	return false;
+}
+
+// Remember the key for the PIN and the encrypted key blob
+void LoginCache::store(const ByteString& encryptedKey, const ByteString& pin, const ByteString& key)
+{
+	MutexLocker lock(cacheMutex);
+
+	if (!isEnabled() || (key.size() != LOGIN_CACHE_KEY_SIZE)) return;
+
+	// The table and its secret are created with the first entry
+	if (table == NULL)
+	{
+		ByteString secret;
+		RNG* rng = CryptoFactory::i()->getRNG();
+
+		if ((rng == NULL) || !rng->generateRandom(secret, sizeof(table->secret))) return;
+
+		table = (Table*) SecureMemoryRegistry::allocateRegion(sizeof(Table));
+
+		if (table == NULL) return;
+
+		memset(table, 0, sizeof(Table));
+		memcpy(table->secret, secret.const_byte_str(), sizeof(table->secret));
+
+		SecureMemoryRegistry::i()->add(table, sizeof(Table));
+		registered = true;
+	}
+
+	ByteString verifierAndPad;
+
+	if (!derive(encryptedKey, pin, verifierAndPad)) return;
+
+	const unsigned char* verifier = verifierAndPad.const_byte_str();
+	const unsigned char* pad = verifier + LOGIN_CACHE_VERIFIER_SIZE;
+	time_t now = time(NULL);
+
+	// Replace the entry for the same login, an unused or expired entry,
+	// or else the oldest entry
+	Entry* slot = NULL;
+
+	for (size_t i = 0; i < LOGIN_CACHE_SIZE; i++)
+	{
+		Entry& entry = table->entries[i];
+
+		if (memcmp(entry.verifier, verifier, LOGIN_CACHE_VERIFIER_SIZE) == 0)
+		{
+			slot = &entry;
+			break;
+		}
+
+		if (!isLive(entry, now))
+		{
+			if ((slot == NULL) || isLive(*slot, now)) slot = &entry;
+		}
+		else if ((slot == NULL) || (isLive(*slot, now) && (entry.created < slot->created)))
+		{
+			slot = &entry;
+		}
+	}
+
+	memcpy(slot->verifier, verifier, LOGIN_CACHE_VERIFIER_SIZE);
+
+	for (size_t j = 0; j < LOGIN_CACHE_KEY_SIZE; j++)
+	{
+		slot->key[j] = key.const_byte_str()[j] ^ pad[j];
+	}
+
+	slot->created = now;
+	slot->expires = now + ttl;
+}
+
+// Drop all entries
+void LoginCache::clear()
+{
+	MutexLocker lock(cacheMutex);
+
+	clearTable();
+}
+
+// Wipe and release the table
+void LoginCache::clearTable()
+{
+	if (table == NULL) return;
+
+	if (registered)
+	{
+		SecureMemoryRegistry::i()->remove(table);
+		registered = false;
+	}
+
+	SecureMemoryRegistry::zeroise(table, sizeof(Table));
+	SecureMemoryRegistry::releaseRegion(table, sizeof(Table));
+
+	table = NULL;
+}
+
+// Compute the verifier and the pad of the key; both depend on the secret
+// of this process, the encrypted key blob and the PIN
+bool LoginCache::derive(const ByteString& encryptedKey, const ByteString& pin, ByteString& verifierAndPad)
+{
+	MacAlgorithm* hmac = CryptoFactory::i()->getMacAlgorithm(MacAlgo::HMAC_SHA512);
+
+	if (hmac == NULL) return false;
+
+	SymmetricKey secretKey(sizeof(table->secret) * 8);
+	secretKey.setKeyBits(ByteString(table->secret, sizeof(table->secret)));
+
+	// The length of the blob separates it from the PIN
+	ByteString blobLength;
+	blobLength += (unsigned char) (encryptedKey.size() >> 8);
+	blobLength += (unsigned char) (encryptedKey.size() & 0xFF);
+
+	bool rv = hmac->signInit(&secretKey) &&
+		  hmac->signUpdate(blobLength) &&
+		  hmac->signUpdate(encryptedKey) &&
+		  hmac->signUpdate(pin) &&
+		  hmac->signFinal(verifierAndPad);
+
+	CryptoFactory::i()->recycleMacAlgorithm(hmac);
+
+	return rv && (verifierAndPad.size() == LOGIN_CACHE_VERIFIER_SIZE + LOGIN_CACHE_KEY_SIZE);
+}
+
+// Check if an entry is in use and has not expired; an entry is given up
+// when the clock goes back
+/*static*/ bool LoginCache::isLive(const Entry& entry, time_t now)
+{
+	return (entry.expires != 0) && (now >= entry.created) && (now < entry.expires);
+}
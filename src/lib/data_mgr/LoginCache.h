@@ -0,0 +1,133 @@
+/*
+ * Copyright (c) 2016 SURFnet bv
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+/*****************************************************************************
+ LoginCache.h
+
+ A per-process cache of successful logins. An entry maps a keyed verifier of
+ the PIN and the encrypted key blob to the token master key, masked with a
+ pad that is derived from the same PIN. A login that matches an entry that
+ has not yet expired costs one HMAC instead of the PBE key derivation. The
+ cache outlives C_Finalize so that an application that finalises and
+ initialises the library again can log in cheaply; its table is kept in
+ non-paged memory that is registered with the secure memory registry that
+ is current while the library is initialised.
+ *****************************************************************************/
+
+#ifndef _SOFTHSM_V2_LOGINCACHE_H
+#define _SOFTHSM_V2_LOGINCACHE_H
+
+#include "config.h"
+#include "ByteString.h"
+#include "MutexFactory.h"
+#include <memory>
+#include <time.h>
+
+// The maximum number of cached logins
+#define LOGIN_CACHE_SIZE 16
+
+// The size of the verifier and of the cached key
+#define LOGIN_CACHE_VERIFIER_SIZE 32
+#define LOGIN_CACHE_KEY_SIZE 32
+
+class LoginCache
+{
+public:
+	LoginCache();
+
+	virtual ~LoginCache();
+
+	static LoginCache* i();
+
+	static void reset();
+
+	// Start using the cache with the given lifetime of the entries in
+	// seconds; a lifetime of 0 disables the cache and drops all entries
+	void attach(unsigned long ttl);
+
+	// Stop using the cache until the next attach, keeping the entries
+	void detach();
+
+	// Is the cache in use?
+	bool isEnabled();
+
+	// Find the key for the PIN and the encrypted key blob
+	bool lookup(const ByteString& encryptedKey, const ByteString& pin, ByteString& key);
+
+	// Remember the key for the PIN and the encrypted key blob
+	void store(const ByteString& encryptedKey, const ByteString& pin, const ByteString& key);
+
+	// Drop all entries
+	void clear();
+
+private:
+	struct Entry
+	{
+		unsigned char verifier[LOGIN_CACHE_VERIFIER_SIZE];
+		unsigned char key[LOGIN_CACHE_KEY_SIZE];
+		time_t created;
+		time_t expires;
+	};
+
+	struct Table
+	{
+		unsigned char secret[64];
+		Entry entries[LOGIN_CACHE_SIZE];
+	};
+
+	// Wipe and release the table
+	void clearTable();
+
+	// Compute the verifier and the pad of the key
+	bool derive(const ByteString& encryptedKey, const ByteString& pin, ByteString& verifierAndPad);
+
+	// Check if an entry is in use and has not expired
+	static bool isLive(const Entry& entry, time_t now);
+
+	// The table with the secret and the entries; NULL while the cache is empty
+	Table* table;
+
+	// The lifetime of new entries in seconds
+	unsigned long ttl;
+
+	// Is the library initialised? The table is then registered with
+	// the current secure memory registry
+	bool attached;
+
+	// Is the table registered with the current secure memory registry?
+	bool registered;
+
+#ifdef HAVE_CXX11
+	static std::unique_ptr<LoginCache> instance;
+#else
+	static std::auto_ptr<LoginCache> instance;
+#endif
+
+	Mutex* cacheMutex;
+};
+
+#endif // !_SOFTHSM_V2_LOGINCACHE_H
@@ -67,14 +67,11 @@ bool RFC4880::PBEDeriveKey(const ByteString& password, ByteString& salt, AESKey*
 		return false;
 	}
 
-	// Perform the first iteration which takes as input the salt value and
-	// the password
+	// The first iteration takes as input the salt value and the password,
+	// the remaining iterations the result of the previous one
 	ByteString intermediate;
 
-	if (!hash->hashInit() ||
-	    !hash->hashUpdate(salt) ||
-	    !hash->hashUpdate(password) ||
-	    !hash->hashFinal(intermediate))
+	if (!hash->hashIterated(salt + password, iter, intermediate))
 	{
 		ERROR_MSG("Hashing failed");
 
@@ -83,21 +80,6 @@ bool RFC4880::PBEDeriveKey(const ByteString& password, ByteString& salt, AESKey*
 		return false;
 	}
 
-	// Perform the remaining iteration
-	while (--iter > 0)
-	{
-		if (!hash->hashInit() ||
-		    !hash->hashUpdate(intermediate) ||
-		    !hash->hashFinal(intermediate))
-		{
-			ERROR_MSG("Hashing failed");
-
-			CryptoFactory::i()->recycleHashAlgorithm(hash);
-
-			return false;
-		}
-	}
-
 	// Create the AES key instance
 	*ppKey = new AESKey(256);
 	(*ppKey)->setKeyBits(intermediate);
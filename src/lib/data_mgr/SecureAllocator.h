@@ -39,9 +39,6 @@
 #include <limits>
 #include <stdlib.h>
 #include <string.h>
-#if defined(SENSITIVE_NON_PAGED) && !defined(_WIN32)
-#include <sys/mman.h>
-#endif // SENSITIVE_NON_PAGED
 #include "config.h"
 #include "log.h"
 #include "SecureMemoryRegistry.h"
@@ -94,91 +91,15 @@ public:
 	// Allocate n elements of type T
 	inline pointer allocate(size_type n, const void* = NULL)
 	{
-#ifdef SENSITIVE_NON_PAGED
-		// Allocate memory on a page boundary
-#ifndef _WIN32
-		pointer r = (pointer) valloc(n * sizeof(T));
-#else
-		pointer r = (pointer) VirtualAlloc(NULL, n * sizeof(T), MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE);
-#endif
-
-		if (r == NULL)
-		{
-			ERROR_MSG("Out of memory");
-
-			return NULL;
-		}
-
-		// Lock the memory so it doesn't get swapped out
-#ifndef _WIN32
-		if (mlock((const void*) r, n * sizeof(T)) != 0)
-#else
-		if (VirtualLock((const void*) r, n * sizeof(T)) == 0)
-#endif
-		{
-			ERROR_MSG("Could not allocate non-paged memory for secure storage");
-
-			// Hmmm... best to not return any allocated space in this case
-#ifndef _WIN32
-			free(r);
-#else
-			VirtualFree((const void*) r, MEM_RELEASE);
-#endif
-
-			return NULL;
-		}
-
-		// Register the memory in the secure memory registry
-		SecureMemoryRegistry::i()->add(r, n * sizeof(T));
-
-		return r;
-#else
-		pointer r = (pointer)(::operator new(n * sizeof(T)));
-
-		if (r == NULL)
-		{
-			ERROR_MSG("Out of memory");
-
-			return NULL;
-		}
-
-		// Register the memory in the secure memory registry
-		SecureMemoryRegistry::i()->add(r, n * sizeof(T));
-
-		return r;
-#endif // SENSITIVE_NON_PAGED
+		// The secure memory registry hands out pooled or non-paged memory
+		return (pointer) SecureMemoryRegistry::i()->allocate(n * sizeof(T));
 	}
 
 	// Deallocate n elements of type T
 	inline void deallocate(pointer p, size_type n)
 	{
-#ifdef PARANOID
-		// First toggle all bits on
-		memset(p, 0xFF, n * sizeof(T));
-#endif // PARANOID
-
-		// Toggle all bits off
-		memset(p, 0x00, n * sizeof(T));
-
-		// Unregister the memory from the secure memory registry
-		SecureMemoryRegistry::i()->remove(p);
-
-#ifdef SENSITIVE_NON_PAGED
-#ifndef _WIN32
-		munlock((const void*) p, n * sizeof(T));
-#else
-		VirtualUnlock((const void*) p, n * sizeof(T));
-#endif
-
-#ifndef _WIN32
-		free(p);
-#else
-		VirtualFree((const void*) r, MEM_RELEASE);
-#endif
-#else
-		// Release the memory
-		::operator delete((void*) p);
-#endif // SENSITIVE_NON_PAGED
+		// The memory is wiped before it is released
+		SecureMemoryRegistry::i()->release((void*) p, n * sizeof(T));
 	}
 
 	// Initialise allocate storage with a value
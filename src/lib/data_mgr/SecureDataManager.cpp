@@ -45,22 +45,17 @@
 #include "AESKey.h"
 #include "SymmetricAlgorithm.h"
 #include "RFC4880.h"
+#include "LoginCache.h"
 
 // Constructors
 
 // Initialise the object; called by all constructors
 void SecureDataManager::initObject()
 {
-	// Get an RNG instance
-	rng = CryptoFactory::i()->getRNG();
-
-	// Get an AES implementation
-	aes = CryptoFactory::i()->getSymmetricAlgorithm(SymAlgo::AES);
-
 	// Initialise masking data
 	mask = new ByteString();
 
-	rng->generateRandom(*mask, 32);
+	CryptoFactory::i()->getRNG()->generateRandom(*mask, 32);
 
 	// Set the initial login state
 	soLoggedIn = userLoggedIn = false;
@@ -92,8 +87,11 @@ SecureDataManager::SecureDataManager(const ByteString& soPINBlob, const ByteStri
 // Destructor
 SecureDataManager::~SecureDataManager()
 {
-	// Recycle the AES instance
-	CryptoFactory::i()->recycleSymmetricAlgorithm(aes);
+	// Recycle the AES instances
+	for (std::vector<SymmetricAlgorithm*>::iterator i = aesPool.begin(); i != aesPool.end(); i++)
+	{
+		CryptoFactory::i()->recycleSymmetricAlgorithm(*i);
+	}
 
 	// Clean up the mask
 	delete mask;
@@ -107,7 +105,7 @@ bool SecureDataManager::pbeEncryptKey(const ByteString& passphrase, ByteString&
 	// Generate salt
 	ByteString salt;
 
-	if (!rng->generateRandom(salt, 8)) return false;
+	if (!CryptoFactory::i()->getRNG()->generateRandom(salt, 8)) return false;
 
 	// Derive the key using RFC4880 PBE
 	AESKey* pbeKey = NULL;
@@ -117,6 +115,15 @@ bool SecureDataManager::pbeEncryptKey(const ByteString& passphrase, ByteString&
 		return false;
 	}
 
+	SymmetricAlgorithm* aes = getAES();
+
+	if (aes == NULL)
+	{
+		delete pbeKey;
+
+		return false;
+	}
+
 	// Add the salt
 	encryptedKey.wipe();
 	encryptedKey += salt;
@@ -124,7 +131,13 @@ bool SecureDataManager::pbeEncryptKey(const ByteString& passphrase, ByteString&
 	// Generate random IV
 	ByteString IV;
 
-	if (!rng->generateRandom(IV, aes->getBlockSize())) return false;
+	if (!CryptoFactory::i()->getRNG()->generateRandom(IV, aes->getBlockSize()))
+	{
+		recycleAES(aes);
+		delete pbeKey;
+
+		return false;
+	}
 
 	// Add the IV
 	encryptedKey += IV;
@@ -134,6 +147,7 @@ bool SecureDataManager::pbeEncryptKey(const ByteString& passphrase, ByteString&
 
 	if (!aes->encryptInit(pbeKey, SymMode::CBC, IV))
 	{
+		recycleAES(aes);
 		delete pbeKey;
 
 		return false;
@@ -142,6 +156,7 @@ bool SecureDataManager::pbeEncryptKey(const ByteString& passphrase, ByteString&
 	// First, add the magic
 	if (!aes->encryptUpdate(magic, block))
 	{
+		recycleAES(aes);
 		delete pbeKey;
 
 		return false;
@@ -151,38 +166,38 @@ bool SecureDataManager::pbeEncryptKey(const ByteString& passphrase, ByteString&
 
 	// Then, add the key itself
 	ByteString key;
+	bool rv;
 
 	{
 		MutexLocker lock(dataMgrMutex);
 
 		unmask(key);
 
-		bool rv = aes->encryptUpdate(key, block);
+		rv = aes->encryptUpdate(key, block);
 
 		remask(key);
-	
-		if (!rv) 
-		{
-			delete pbeKey;
-		
-			return false;
-		}
 	}
 
-	encryptedKey += block;
-
-	// And finalise encryption
-	if (!aes->encryptFinal(block)) 
+	if (!rv)
 	{
+		recycleAES(aes);
 		delete pbeKey;
-		
+
 		return false;
 	}
 
 	encryptedKey += block;
 
+	// And finalise encryption
+	rv = aes->encryptFinal(block);
+
+	recycleAES(aes);
 	delete pbeKey;
 
+	if (!rv) return false;
+
+	encryptedKey += block;
+
 	return true;
 }
 
@@ -212,7 +227,7 @@ bool SecureDataManager::setSOPIN(const ByteString& soPIN)
 	{
 		ByteString key;
 
-		rng->generateRandom(key, 32);
+		CryptoFactory::i()->getRNG()->generateRandom(key, 32);
 
 		remask(key);
 	}
@@ -249,6 +264,21 @@ bool SecureDataManager::login(const ByteString& passphrase, const ByteString& en
 	// Log out first
 	this->logout();
 
+	// A recent login with the same passphrase skips the key derivation
+	ByteString cachedKey;
+
+	if (LoginCache::i()->lookup(encryptedKey, passphrase, cachedKey))
+	{
+		MutexLocker lock(dataMgrMutex);
+		remask(cachedKey);
+
+		return true;
+	}
+
+	SymmetricAlgorithm* aes = getAES();
+
+	if (aes == NULL) return false;
+
 	// First, take the salt from the encrypted key
 	ByteString salt = encryptedKey.substr(0,8);
 
@@ -263,6 +293,8 @@ bool SecureDataManager::login(const ByteString& passphrase, const ByteString& en
 
 	if (!RFC4880::PBEDeriveKey(passphrase, salt, &pbeKey))
 	{
+		recycleAES(aes);
+
 		return false;
 	}
 
@@ -271,17 +303,15 @@ bool SecureDataManager::login(const ByteString& passphrase, const ByteString& en
 	ByteString finalBlock;
 
 	// NOTE: The login will fail here if incorrect passphrase is supplied
-	if (!aes->decryptInit(pbeKey, SymMode::CBC, IV) ||
-	    !aes->decryptUpdate(encryptedKeyData, decryptedKeyData) ||
-	    !aes->decryptFinal(finalBlock))
-	{
-		delete pbeKey;
-
-		return false;
-	}
+	bool rv = aes->decryptInit(pbeKey, SymMode::CBC, IV) &&
+		  aes->decryptUpdate(encryptedKeyData, decryptedKeyData) &&
+		  aes->decryptFinal(finalBlock);
 
+	recycleAES(aes);
 	delete pbeKey;
 
+	if (!rv) return false;
+
 	decryptedKeyData += finalBlock;
 
 	// Check the magic
@@ -299,6 +329,8 @@ bool SecureDataManager::login(const ByteString& passphrase, const ByteString& en
 	// And mask the key
 	decryptedKeyData.wipe();
 
+	LoginCache::i()->store(encryptedKey, passphrase, key);
+
 	MutexLocker lock(dataMgrMutex);
 	remask(key);
 
@@ -332,8 +364,10 @@ void SecureDataManager::logout()
 // Decrypt the supplied data
 bool SecureDataManager::decrypt(const ByteString& encrypted, ByteString& plaintext)
 {
+	AESKey theKey(256);
+
 	// Check the object logged in state
-	if ((!userLoggedIn && !soLoggedIn) || (maskedKey.size() != 32))
+	if (!getKey(theKey))
 	{
 		return false;
 	}
@@ -345,81 +379,83 @@ bool SecureDataManager::decrypt(const ByteString& encrypted, ByteString& plainte
 		return true;
 	}
 
-	AESKey theKey(256);
-	ByteString unmaskedKey;
+	SymmetricAlgorithm* aes = getAES();
 
-	{
-		MutexLocker lock(dataMgrMutex);
+	if (aes == NULL) return false;
 
-		unmask(unmaskedKey);
+	bool rv = decrypt(aes, theKey, encrypted, plaintext);
 
-		theKey.setKeyBits(unmaskedKey);
+	recycleAES(aes);
 
-		remask(unmaskedKey);
-	}
-	
-	// Take the IV from the input data
-	ByteString IV = encrypted.substr(0, aes->getBlockSize());
+	return rv;
+}
 
-	if (IV.size() != aes->getBlockSize())
-	{
-		ERROR_MSG("Invalid IV in encrypted data");
+// Decrypt a batch of data using a single unmasking of the key
+bool SecureDataManager::decrypt(const std::vector<ByteString>& encrypted, std::vector<ByteString>& plaintext)
+{
+	AESKey theKey(256);
 
+	// Check the object logged in state
+	if (!getKey(theKey))
+	{
 		return false;
 	}
 
-	ByteString finalBlock;
+	SymmetricAlgorithm* aes = getAES();
 
-	if (!aes->decryptInit(&theKey, SymMode::CBC, IV) ||
-	    !aes->decryptUpdate(encrypted.substr(aes->getBlockSize()), plaintext) ||
-	    !aes->decryptFinal(finalBlock))
+	if (aes == NULL) return false;
+
+	plaintext.resize(encrypted.size());
+
+	bool rv = true;
+
+	for (size_t i = 0; rv && i < encrypted.size(); i++)
 	{
-		return false;
+		// Do not attempt decryption of empty byte strings
+		if (encrypted[i].size() == 0)
+		{
+			plaintext[i] = ByteString("");
+			continue;
+		}
+
+		rv = decrypt(aes, theKey, encrypted[i], plaintext[i]);
 	}
 
-	plaintext += finalBlock;
+	recycleAES(aes);
 
-	return true;
+	return rv;
 }
 
 // Encrypt the supplied data
 bool SecureDataManager::encrypt(const ByteString& plaintext, ByteString& encrypted)
 {
+	AESKey theKey(256);
+
 	// Check the object logged in state
-	if ((!userLoggedIn && !soLoggedIn) || (maskedKey.size() != 32))
+	if (!getKey(theKey))
 	{
 		return false;
 	}
 
-	AESKey theKey(256);
-	ByteString unmaskedKey;
-
-	{
-		MutexLocker lock(dataMgrMutex);
-
-		unmask(unmaskedKey);
+	SymmetricAlgorithm* aes = getAES();
 
-		theKey.setKeyBits(unmaskedKey);
-
-		remask(unmaskedKey);
-	}
+	if (aes == NULL) return false;
 
 	// Wipe encrypted data block
 	encrypted.wipe();
 
 	// Generate random IV
 	ByteString IV;
+	ByteString finalBlock;
 
-	if (!rng->generateRandom(IV, aes->getBlockSize())) return false;
+	bool rv = CryptoFactory::i()->getRNG()->generateRandom(IV, aes->getBlockSize()) &&
+		  aes->encryptInit(&theKey, SymMode::CBC, IV) &&
+		  aes->encryptUpdate(plaintext, encrypted) &&
+		  aes->encryptFinal(finalBlock);
 
-	ByteString finalBlock;
+	recycleAES(aes);
 
-	if (!aes->encryptInit(&theKey, SymMode::CBC, IV) ||
-	    !aes->encryptUpdate(plaintext, encrypted) ||
-	    !aes->encryptFinal(finalBlock))
-	{
-		return false;
-	}
+	if (!rv) return false;
 
 	encrypted += finalBlock;
 
@@ -452,12 +488,97 @@ void SecureDataManager::unmask(ByteString& key)
 void SecureDataManager::remask(ByteString& key)
 {
 	// Generate a new mask
-	rng->generateRandom(*mask, 32);
+	CryptoFactory::i()->getRNG()->generateRandom(*mask, 32);
 
 	key ^= *mask;
 	maskedKey = key;
 }
 
+// Get the key for decryption or encryption if someone is logged in
+bool SecureDataManager::getKey(AESKey& key)
+{
+	MutexLocker lock(dataMgrMutex);
+
+	if ((!userLoggedIn && !soLoggedIn) || (maskedKey.size() != 32))
+	{
+		return false;
+	}
+
+	ByteString unmaskedKey;
+
+	unmask(unmaskedKey);
+
+	key.setKeyBits(unmaskedKey);
+
+	remask(unmaskedKey);
+
+	return true;
+}
+
+// Decrypt the supplied data using the given AES instance and key
+bool SecureDataManager::decrypt(SymmetricAlgorithm* aes, AESKey& key, const ByteString& encrypted, ByteString& plaintext)
+{
+	// Take the IV from the input data
+	ByteString IV = encrypted.substr(0, aes->getBlockSize());
+
+	if (IV.size() != aes->getBlockSize())
+	{
+		ERROR_MSG("Invalid IV in encrypted data");
+
+		return false;
+	}
+
+	ByteString finalBlock;
+
+	if (!aes->decryptInit(&key, SymMode::CBC, IV) ||
+	    !aes->decryptUpdate(encrypted.substr(aes->getBlockSize()), plaintext) ||
+	    !aes->decryptFinal(finalBlock))
+	{
+		return false;
+	}
+
+	plaintext += finalBlock;
+
+	return true;
+}
+
+// Get an AES instance from the pool
+SymmetricAlgorithm* SecureDataManager::getAES()
+{
+	{
+		MutexLocker lock(dataMgrMutex);
+
+		if (!aesPool.empty())
+		{
+			SymmetricAlgorithm* aes = aesPool.back();
+			aesPool.pop_back();
+
+			return aes;
+		}
+	}
+
+	return CryptoFactory::i()->getSymmetricAlgorithm(SymAlgo::AES);
+}
+
+// Return an AES instance to the pool
+void SecureDataManager::recycleAES(SymmetricAlgorithm* aes)
+{
+	if (aes == NULL) return;
+
+	{
+		MutexLocker lock(dataMgrMutex);
+
+		if (aesPool.size() < SDM_AES_POOL_SIZE)
+		{
+			aesPool.push_back(aes);
+
+			return;
+		}
+	}
+
+	CryptoFactory::i()->recycleSymmetricAlgorithm(aes);
+}
+
 // Check if the SO is logged in
 bool SecureDataManager::isSOLoggedIn()
 {
@@ -37,6 +37,10 @@
  in; authentication using the SO PIN is required to be able to change the
  user PIN. The master key that is used to decrypt/encrypt sensitive attributes
  is stored in memory under a mask that is changed every time the key is used.
+
+ Encryption and decryption may be performed by several threads at the same
+ time; each operation takes an AES instance from a small pool so that the
+ threads do not share cipher state.
  *****************************************************************************/
 
 #ifndef _SOFTHSM_V2_SECUREDATAMANAGER_H
@@ -49,6 +53,10 @@
 #include "RNG.h"
 #include "SymmetricAlgorithm.h"
 #include "MutexFactory.h"
+#include <vector>
+
+// The maximum number of idle AES instances kept for reuse
+#define SDM_AES_POOL_SIZE 16
 
 class SecureDataManager
 {
@@ -87,6 +95,9 @@ public:
 	// Decrypt the supplied data
 	bool decrypt(const ByteString& encrypted, ByteString& plaintext);
 
+	// Decrypt a batch of data using a single unmasking of the key
+	bool decrypt(const std::vector<ByteString>& encrypted, std::vector<ByteString>& plaintext);
+
 	// Encrypt the supplied data
 	bool encrypt(const ByteString& plaintext, ByteString& encrypted);
 
@@ -112,6 +123,18 @@ private:
 	// Remask the key
 	void remask(ByteString& key);
 
+	// Get the key for decryption or encryption if someone is logged in
+	bool getKey(AESKey& key);
+
+	// Decrypt the supplied data using the given AES instance and key
+	bool decrypt(SymmetricAlgorithm* aes, AESKey& key, const ByteString& encrypted, ByteString& plaintext);
+
+	// Get an AES instance from the pool
+	SymmetricAlgorithm* getAES();
+
+	// Return an AES instance to the pool
+	void recycleAES(SymmetricAlgorithm* aes);
+
 	// The user PIN encrypted key
 	ByteString userEncryptedKey;
 
@@ -133,11 +156,8 @@ private:
 	// that is not logically linked to the masked key
 	ByteString* mask;
 
-	// Random number generator instance
-	RNG* rng;
-
-	// AES instance
-	SymmetricAlgorithm* aes;
+	// Idle AES instances
+	std::vector<SymmetricAlgorithm*> aesPool;
 
 	// Mutex
 	Mutex* dataMgrMutex;
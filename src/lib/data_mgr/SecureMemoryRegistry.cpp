@@ -30,23 +30,92 @@
  Implements a singleton class that keeps track of all securely allocated
  memory. This registry can be used to wipe securely allocated memory in case
  of a fatal exception
+
+ Small blocks are handed out from pooled arenas of fixed size blocks, which
+ are registered as a whole. Larger blocks are allocated and registered
+ individually.
  *****************************************************************************/
 
+#include "config.h"
 #include <stdlib.h>
 #include <string.h>
+#if defined(SENSITIVE_NON_PAGED) && !defined(_WIN32)
+#include <sys/mman.h>
+#endif // SENSITIVE_NON_PAGED
 #include "log.h"
 #include "SecureMemoryRegistry.h"
 
+// A plain pointer, so that it does not depend on the order of static destruction
+SecureMemoryRegistry::SizeClass* SecureMemoryRegistry::carriedOver = NULL;
+
 // Constructor
 SecureMemoryRegistry::SecureMemoryRegistry()
 {
 	SecMemRegistryMutex = MutexFactory::i()->getMutex();
+
+	for (size_t i = 0; i < SECURE_POOL_CLASSES; i++)
+	{
+		sizeClasses[i].mutex = MutexFactory::i()->getMutex();
+		sizeClasses[i].blocksize = SECURE_POOL_MIN_BLOCK << i;
+		sizeClasses[i].freeList = NULL;
+		sizeClasses[i].inUse = 0;
+
+		// Take over the arenas that the previous instance could not release
+		if (carriedOver != NULL)
+		{
+			sizeClasses[i].freeList = carriedOver[i].freeList;
+			sizeClasses[i].inUse = carriedOver[i].inUse;
+			sizeClasses[i].arenas.swap(carriedOver[i].arenas);
+		}
+	}
+
+	delete[] carriedOver;
+	carriedOver = NULL;
 }
 
 // Destructor
 SecureMemoryRegistry::~SecureMemoryRegistry()
 {
-	if (!registry.empty())
+	bool leak = !registry.empty();
+
+	for (size_t i = 0; i < SECURE_POOL_CLASSES; i++)
+	{
+		// Arenas with blocks that are still in use are handed to the next
+		// instance, which releases the blocks into its own free lists
+		if (sizeClasses[i].inUse > 0)
+		{
+			if (carriedOver == NULL)
+			{
+				carriedOver = new SizeClass[SECURE_POOL_CLASSES];
+
+				for (size_t j = 0; j < SECURE_POOL_CLASSES; j++)
+				{
+					carriedOver[j].mutex = NULL;
+					carriedOver[j].blocksize = SECURE_POOL_MIN_BLOCK << j;
+					carriedOver[j].freeList = NULL;
+					carriedOver[j].inUse = 0;
+				}
+			}
+
+			carriedOver[i].freeList = sizeClasses[i].freeList;
+			carriedOver[i].inUse = sizeClasses[i].inUse;
+			carriedOver[i].arenas.swap(sizeClasses[i].arenas);
+
+			DEBUG_MSG("Carrying over %d blocks of %d bytes to the next SecureMemoryRegistry", carriedOver[i].inUse, carriedOver[i].blocksize);
+		}
+		else
+		{
+			for (std::map<char*, size_t>::iterator j = sizeClasses[i].arenas.begin(); j != sizeClasses[i].arenas.end(); j++)
+			{
+				zeroise(j->first, j->second);
+				releaseRegion(j->first, j->second);
+			}
+		}
+
+		MutexFactory::i()->recycleMutex(sizeClasses[i].mutex);
+	}
+
+	if (leak)
 	{
 		ERROR_MSG("SecureMemoryRegistry is not empty: leak!");
 	}
@@ -77,6 +146,70 @@ void SecureMemoryRegistry::reset()
 	instance.reset();
 }
 
+// Allocate a block of secure memory
+void* SecureMemoryRegistry::allocate(size_t len)
+{
+	size_t index;
+
+	if (!sizeClassOf(len, index))
+	{
+		void* pointer = allocateRegion(len);
+
+		// Register the memory in the secure memory registry
+		if (pointer != NULL) add(pointer, len);
+
+		return pointer;
+	}
+
+	SizeClass& sizeClass = sizeClasses[index];
+	MutexLocker lock(sizeClass.mutex);
+
+	if (sizeClass.freeList == NULL && !addArena(sizeClass))
+	{
+		return NULL;
+	}
+
+	void* pointer = sizeClass.freeList;
+	sizeClass.freeList = *(void**) pointer;
+	*(void**) pointer = NULL;
+	sizeClass.inUse++;
+
+	return pointer;
+}
+
+// Wipe and release a block of secure memory; the length must match the allocation
+void SecureMemoryRegistry::release(void* pointer, size_t len)
+{
+	if (pointer == NULL) return;
+
+	zeroise(pointer, len);
+
+	size_t index;
+
+	if (!sizeClassOf(len, index))
+	{
+		// Unregister the memory from the secure memory registry
+		remove(pointer);
+
+		releaseRegion(pointer, len);
+
+		return;
+	}
+
+	SizeClass& sizeClass = sizeClasses[index];
+	MutexLocker lock(sizeClass.mutex);
+
+	// Blocks that do not come from the arenas of this size class are not reused
+	std::map<char*, size_t>::iterator i = sizeClass.arenas.upper_bound((char*) pointer);
+	if (i == sizeClass.arenas.begin()) return;
+	--i;
+	if ((char*) pointer >= i->first + i->second) return;
+
+	*(void**) pointer = sizeClass.freeList;
+	sizeClass.freeList = pointer;
+	sizeClass.inUse--;
+}
+
 // Register a block of memory
 void SecureMemoryRegistry::add(void* pointer, size_t blocksize)
 {
@@ -106,6 +239,23 @@ void SecureMemoryRegistry::wipe()
 {
 	MutexLocker lock(SecMemRegistryMutex);
 
+	for (size_t i = 0; i < SECURE_POOL_CLASSES; i++)
+	{
+		MutexLocker arenaLock(sizeClasses[i].mutex);
+
+		for (std::map<char*, size_t>::iterator j = sizeClasses[i].arenas.begin(); j != sizeClasses[i].arenas.end(); j++)
+		{
+			try
+			{
+				zeroise(j->first, j->second);
+			}
+			catch (...)
+			{
+				ERROR_MSG("Failed to wipe arena of %d bytes at 0x%x", j->second, j->first);
+			}
+		}
+	}
+
 	// Be very careful in this method to catch any weird exceptions that
 	// may occur since if we're in this method it means something has already
 	// gone pear shaped once before and we're exiting on a fatal exception
@@ -140,3 +290,118 @@ void SecureMemoryRegistry::wipe()
 	}
 }
 
+// Find the size class for pooled blocks of the given length
+/*static*/ bool SecureMemoryRegistry::sizeClassOf(size_t len, size_t& index)
+{
+	size_t blocksize = SECURE_POOL_MIN_BLOCK;
+
+	for (index = 0; index < SECURE_POOL_CLASSES; index++, blocksize <<= 1)
+	{
+		if (len <= blocksize) return true;
+	}
+
+	return false;
+}
+
+// Allocate a region of memory that will not be swapped out
+/*static*/ void* SecureMemoryRegistry::allocateRegion(size_t len)
+{
+#ifdef SENSITIVE_NON_PAGED
+	// Allocate memory on a page boundary
+#ifndef _WIN32
+	void* pointer = valloc(len);
+#else
+	void* pointer = VirtualAlloc(NULL, len, MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE);
+#endif
+
+	if (pointer == NULL)
+	{
+		ERROR_MSG("Out of memory");
+
+		return NULL;
+	}
+
+	// Lock the memory so it doesn't get swapped out
+#ifndef _WIN32
+	if (mlock((const void*) pointer, len) != 0)
+#else
+	if (VirtualLock(pointer, len) == 0)
+#endif
+	{
+		ERROR_MSG("Could not allocate non-paged memory for secure storage");
+
+		// Hmmm... best to not return any allocated space in this case
+#ifndef _WIN32
+		free(pointer);
+#else
+		VirtualFree(pointer, 0, MEM_RELEASE);
+#endif
+
+		return NULL;
+	}
+
+	return pointer;
+#else
+	void* pointer = malloc(len);
+
+	if (pointer == NULL)
+	{
+		ERROR_MSG("Out of memory");
+	}
+
+	return pointer;
+#endif // SENSITIVE_NON_PAGED
+}
+
+// Release a region of memory
+/*static*/ void SecureMemoryRegistry::releaseRegion(void* pointer, size_t len)
+{
+#ifdef SENSITIVE_NON_PAGED
+#ifndef _WIN32
+	munlock((const void*) pointer, len);
+	free(pointer);
+#else
+	VirtualUnlock(pointer, len);
+	VirtualFree(pointer, 0, MEM_RELEASE);
+#endif
+#else
+	(void) len;
+
+	free(pointer);
+#endif // SENSITIVE_NON_PAGED
+}
+
+// Overwrite the memory
+/*static*/ void SecureMemoryRegistry::zeroise(void* pointer, size_t len)
+{
+#ifdef PARANOID
+	// First toggle all bits on
+	memset(pointer, 0xFF, len);
+#endif // PARANOID
+
+	// Toggle all bits off
+	memset(pointer, 0x00, len);
+}
+
+// Carve a new arena into free blocks
+// Calling function must lock the mutex of the size class
+bool SecureMemoryRegistry::addArena(SizeClass& sizeClass)
+{
+	char* arena = (char*) allocateRegion(SECURE_POOL_ARENA_SIZE);
+	if (arena == NULL) return false;
+
+	memset(arena, 0x00, SECURE_POOL_ARENA_SIZE);
+
+	size_t blocks = SECURE_POOL_ARENA_SIZE / sizeClass.blocksize;
+	for (size_t i = blocks; i > 0; i--)
+	{
+		void* block = arena + (i - 1) * sizeClass.blocksize;
+
+		*(void**) block = sizeClass.freeList;
+		sizeClass.freeList = block;
+	}
+
+	sizeClass.arenas[arena] = SECURE_POOL_ARENA_SIZE;
+
+	return true;
+}
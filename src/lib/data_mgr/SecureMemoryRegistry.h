@@ -30,6 +30,10 @@
  Implements a singleton class that keeps track of all securely allocated
  memory. This registry can be used to wipe securely allocated memory in case
  of a fatal exception
+
+ Small blocks are handed out from pooled arenas of fixed size blocks, which
+ are registered as a whole. Larger blocks are allocated and registered
+ individually.
  *****************************************************************************/
 
 #ifndef _SOFTHSM_V2_SECUREMEMORYREGISTRY_H
@@ -40,6 +44,13 @@
 #include <memory>
 #include "MutexFactory.h"
 
+// The pooled block sizes are powers of two from 32 up to 4096 bytes
+#define SECURE_POOL_MIN_BLOCK 32
+#define SECURE_POOL_CLASSES 8
+
+// The size of the arenas from which the pooled blocks are carved
+#define SECURE_POOL_ARENA_SIZE 65536
+
 class SecureMemoryRegistry
 {
 public:
@@ -51,13 +62,45 @@ public:
 
 	static void reset();
 
+	void* allocate(size_t len);
+
+	void release(void* pointer, size_t len);
+
 	void add(void* pointer, size_t blocksize);
 
 	size_t remove(void* pointer);
 
 	void wipe();
 
+	// Secure memory outside the pools; callers that keep a region across
+	// registry instances register it with the current one themselves
+	static void* allocateRegion(size_t len);
+
+	static void releaseRegion(void* pointer, size_t len);
+
+	static void zeroise(void* pointer, size_t len);
+
 private:
+	// The pooled blocks of one size; free blocks are linked through their first bytes
+	struct SizeClass
+	{
+		Mutex* mutex;
+		size_t blocksize;
+		void* freeList;
+		size_t inUse;
+		std::map<char*, size_t> arenas;
+	};
+
+	static bool sizeClassOf(size_t len, size_t& index);
+
+	bool addArena(SizeClass& sizeClass);
+
+	SizeClass sizeClasses[SECURE_POOL_CLASSES];
+
+	// Arenas with blocks in use when the previous instance was destroyed;
+	// the next instance takes them over
+	static SizeClass* carriedOver;
+
 #ifdef HAVE_CXX11
 	static std::unique_ptr<SecureMemoryRegistry> instance;
 #else
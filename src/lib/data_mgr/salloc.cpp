@@ -34,93 +34,43 @@
 #include "log.h"
 #include "salloc.h"
 #include <limits>
-#if defined(SENSITIVE_NON_PAGED) && !defined(_WIN32)
-#include <sys/mman.h>
-#endif // SENSITIVE_NON_PAGED
 #include <string.h>
 #include "SecureMemoryRegistry.h"
 
+// The length of the block is kept in front of the returned memory, padded
+// to keep the returned memory aligned
+#define SALLOC_HEADER_SIZE 16
+
 // Allocate memory
 void* salloc(size_t len)
 {
-#ifdef SENSITIVE_NON_PAGED
-	// Allocate memory on a page boundary
-#ifndef _WIN32
-	void* ptr = (void*) valloc(len);
-#else
-	pointer r = (pointer) VirtualAlloc(NULL, n * sizeof(T), MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE);
-#endif
-
-	if (ptr == NULL)
+	if (len > std::numeric_limits<size_t>::max() - SALLOC_HEADER_SIZE)
 	{
 		ERROR_MSG("Out of memory");
 
 		return NULL;
 	}
 
-	// Lock the memory so it doesn't get swapped out
-#ifndef _WIN32
-	if (mlock((const void*) ptr, len) != 0)
-#else
-	if (VirtualLock((const void*) r, n * sizeof(T)) == 0)
-#endif
-	{
-		ERROR_MSG("Could not allocate non-paged memory for secure storage");
+	size_t blocksize = len + SALLOC_HEADER_SIZE;
+	unsigned char* block = (unsigned char*) SecureMemoryRegistry::i()->allocate(blocksize);
 
-		// Hmmm... best to not return any allocated space in this case
-#ifndef _WIN32
-		free(ptr);
-#else
-		VirtualFree((const void*) pre, MEM_RELEASE);
-#endif
+	if (block == NULL) return NULL;
 
-		return NULL;
-	}
+	memcpy(block, &blocksize, sizeof(blocksize));
 
-	// Register the memory in the secure memory registry
-	SecureMemoryRegistry::i()->add(ptr, len);
-
-	return ptr;
-#else
-	void* ptr = (void*) malloc(len);
-
-	if (ptr == NULL)
-	{
-		ERROR_MSG("Out of memory");
-
-		return NULL;
-	}
-
-	// Register the memory in the secure memory registry
-	SecureMemoryRegistry::i()->add(ptr, len);
-
-	return ptr;
-#endif // SENSITIVE_NON_PAGED
+	return block + SALLOC_HEADER_SIZE;
 }
 
 // Free memory
 void sfree(void* ptr)
 {
-	// Unregister the memory from the secure memory registry
-	size_t len = SecureMemoryRegistry::i()->remove(ptr);
-
-#ifdef PARANOID
-	// First toggle all bits on
-	memset(ptr, 0xFF, len);
-#endif // PARANOID
+	if (ptr == NULL) return;
 
-	// Toggle all bits off
-	memset(ptr, 0x00, len);
+	unsigned char* block = (unsigned char*) ptr - SALLOC_HEADER_SIZE;
+	size_t blocksize;
 
-#ifdef SENSITIVE_NON_PAGED
-#ifndef _WIN32
-	munlock((const void*) ptr, len);
-#else
-	VirtualFree((const void*) pre, MEM_RELEASE);
-#endif
+	memcpy(&blocksize, block, sizeof(blocksize));
 
-#endif // SENSITIVE_NON_PAGED
-
-	free(ptr);
+	// The memory is wiped before it is released
+	SecureMemoryRegistry::i()->release(block, blocksize);
 }
-
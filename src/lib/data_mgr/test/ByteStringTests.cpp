@@ -33,7 +33,9 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <cppunit/extensions/HelperMacros.h>
+#include <string.h>
 #include <string>
+#include <utility>
 #include "ByteStringTests.h"
 #include "ByteString.h"
 
@@ -354,3 +356,92 @@ void ByteStringTests::testSerialising()
 	CPPUNIT_ASSERT(d3 == b1);
 }
 
+void ByteStringTests::testStorage()
+{
+	unsigned char testData[200];
+
+	for (size_t i = 0; i < sizeof(testData); i++)
+	{
+		testData[i] = (unsigned char) i;
+	}
+
+	// Grow a string byte by byte across the size of the inline buffer
+	ByteString b1;
+
+	for (size_t i = 0; i < sizeof(testData); i++)
+	{
+		b1 += testData[i];
+
+		CPPUNIT_ASSERT(b1.size() == i + 1);
+		CPPUNIT_ASSERT(!memcmp(b1.const_byte_str(), testData, i + 1));
+	}
+
+	// Shrink it and grow it again; the new bytes must be zero
+	b1.resize(10);
+	CPPUNIT_ASSERT(b1 == ByteString(testData, 10));
+	b1.resize(100);
+	CPPUNIT_ASSERT(!memcmp(b1.const_byte_str(), testData, 10));
+	for (size_t i = 10; i < 100; i++)
+	{
+		CPPUNIT_ASSERT(b1[i] == 0x00);
+	}
+
+	// Append a string to itself
+	ByteString b2(testData, 40);
+	b2 += b2;
+	CPPUNIT_ASSERT(b2.size() == 80);
+	CPPUNIT_ASSERT(b2.substr(0, 40) == ByteString(testData, 40));
+	CPPUNIT_ASSERT(b2.substr(40) == ByteString(testData, 40));
+
+	// Assign between short and long strings
+	ByteString shortString(testData, 16);
+	ByteString longString(testData, 150);
+	ByteString b3 = shortString;
+
+	b3 = longString;
+	CPPUNIT_ASSERT(b3 == longString);
+	b3 = shortString;
+	CPPUNIT_ASSERT(b3 == shortString);
+	b3 = b3;
+	CPPUNIT_ASSERT(b3 == shortString);
+
+	// Swap all combinations of short and long strings
+	ByteString b4(shortString);
+	ByteString b5(longString);
+
+	b4.swap(b5);
+	CPPUNIT_ASSERT(b4 == longString);
+	CPPUNIT_ASSERT(b5 == shortString);
+	b4.swap(b5);
+	CPPUNIT_ASSERT(b4 == shortString);
+	CPPUNIT_ASSERT(b5 == longString);
+	b5.swap(b3);
+	CPPUNIT_ASSERT(b5 == shortString);
+	CPPUNIT_ASSERT(b3 == longString);
+	b5.swap(b4);
+	CPPUNIT_ASSERT(b5 == shortString);
+	CPPUNIT_ASSERT(b4 == shortString);
+
+#ifdef HAVE_CXX11
+	// Moving leaves the source empty
+	ByteString b6(std::move(b3));
+	CPPUNIT_ASSERT(b6 == longString);
+	CPPUNIT_ASSERT(b3.size() == 0);
+
+	ByteString b7(std::move(b4));
+	CPPUNIT_ASSERT(b7 == shortString);
+	CPPUNIT_ASSERT(b4.size() == 0);
+
+	b7 = std::move(b6);
+	CPPUNIT_ASSERT(b7 == longString);
+	CPPUNIT_ASSERT(b6.size() == 0);
+
+	b6 = std::move(b5);
+	CPPUNIT_ASSERT(b6 == shortString);
+	CPPUNIT_ASSERT(b5.size() == 0);
+
+	// A moved-from string can be used again
+	b5 += shortString;
+	CPPUNIT_ASSERT(b5 == shortString);
+#endif
+}
@@ -48,6 +48,7 @@ class ByteStringTests : public CppUnit::TestFixture
 	CPPUNIT_TEST(testSplitting);
 	CPPUNIT_TEST(testBits);
 	CPPUNIT_TEST(testSerialising);
+	CPPUNIT_TEST(testStorage);
 	CPPUNIT_TEST_SUITE_END();
 
 public:
@@ -61,6 +62,7 @@ public:
 	void testSplitting();
 	void testBits();
 	void testSerialising();
+	void testStorage();
 
 	void setUp();
 	void tearDown();
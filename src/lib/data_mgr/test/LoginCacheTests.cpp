@@ -0,0 +1,183 @@
+/*
+ * Copyright (c) 2016 SURFnet bv
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+/*****************************************************************************
+ LoginCacheTests.cpp
+
+ Contains test cases to test the login cache
+ *****************************************************************************/
+
+#include <stdlib.h>
+#include <string.h>
+#include <cppunit/extensions/HelperMacros.h>
+#include "LoginCacheTests.h"
+#include "LoginCache.h"
+#include "SecureDataManager.h"
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+CPPUNIT_TEST_SUITE_REGISTRATION(LoginCacheTests);
+
+void LoginCacheTests::setUp()
+{
+	LoginCache::i()->attach(60);
+}
+
+void LoginCacheTests::tearDown()
+{
+	LoginCache::i()->attach(0);
+	LoginCache::i()->detach();
+}
+
+void LoginCacheTests::testLookup()
+{
+	ByteString blob = "0102030405060708090A0B0C0D0E0F10";
+	ByteString otherBlob = "1102030405060708090A0B0C0D0E0F10";
+	ByteString pin = "3132333435363738"; // "12345678"
+	ByteString wrongPIN = "3132333435363739"; // "12345679"
+	ByteString key = "000102030405060708090A0B0C0D0E0F101112131415161718191A1B1C1D1E1F";
+	ByteString found;
+
+	// Nothing is found in an empty cache
+	CPPUNIT_ASSERT(!LoginCache::i()->lookup(blob, pin, found));
+
+	LoginCache::i()->store(blob, pin, key);
+
+	// Only the same PIN and blob find the key
+	CPPUNIT_ASSERT(LoginCache::i()->lookup(blob, pin, found));
+	CPPUNIT_ASSERT(found == key);
+	CPPUNIT_ASSERT(!LoginCache::i()->lookup(blob, wrongPIN, found));
+	CPPUNIT_ASSERT(!LoginCache::i()->lookup(otherBlob, pin, found));
+
+	// The blob and the PIN are not simply concatenated
+	CPPUNIT_ASSERT(!LoginCache::i()->lookup(blob + pin.substr(0, 1), pin.substr(1), found));
+
+	// Keys of another size are not cached
+	LoginCache::i()->store(otherBlob, pin, key.substr(1));
+	CPPUNIT_ASSERT(!LoginCache::i()->lookup(otherBlob, pin, found));
+
+	// The entries are kept while the cache is detached, but not used
+	LoginCache::i()->detach();
+	CPPUNIT_ASSERT(!LoginCache::i()->isEnabled());
+	CPPUNIT_ASSERT(!LoginCache::i()->lookup(blob, pin, found));
+	LoginCache::i()->attach(60);
+	CPPUNIT_ASSERT(LoginCache::i()->lookup(blob, pin, found));
+	CPPUNIT_ASSERT(found == key);
+
+	// Filling the cache pushes out the oldest entry
+	for (unsigned char i = 0; i < LOGIN_CACHE_SIZE; i++)
+	{
+		LoginCache::i()->store(otherBlob + i, pin, key);
+	}
+
+	CPPUNIT_ASSERT(!LoginCache::i()->lookup(blob, pin, found));
+	CPPUNIT_ASSERT(LoginCache::i()->lookup(otherBlob + (unsigned char) 0, pin, found));
+	CPPUNIT_ASSERT(LoginCache::i()->lookup(otherBlob + (unsigned char) (LOGIN_CACHE_SIZE - 1), pin, found));
+
+	// A lifetime of 0 drops the entries
+	LoginCache::i()->attach(0);
+	LoginCache::i()->attach(60);
+	CPPUNIT_ASSERT(!LoginCache::i()->lookup(otherBlob + (unsigned char) 0, pin, found));
+
+	// Also for the entries that were kept while the cache was detached
+	LoginCache::i()->store(blob, pin, key);
+	LoginCache::i()->detach();
+	LoginCache::i()->attach(0);
+	LoginCache::i()->attach(60);
+	CPPUNIT_ASSERT(!LoginCache::i()->lookup(blob, pin, found));
+
+	// Resetting the cache detaches it
+	LoginCache::i()->store(blob, pin, key);
+	LoginCache::reset();
+	CPPUNIT_ASSERT(!LoginCache::i()->isEnabled());
+}
+
+void LoginCacheTests::testExpiry()
+{
+	ByteString blob = "0102030405060708090A0B0C0D0E0F10";
+	ByteString pin = "3132333435363738"; // "12345678"
+	ByteString key = "000102030405060708090A0B0C0D0E0F101112131415161718191A1B1C1D1E1F";
+	ByteString found;
+
+	LoginCache::i()->attach(1);
+	LoginCache::i()->store(blob, pin, key);
+
+	CPPUNIT_ASSERT(LoginCache::i()->lookup(blob, pin, found));
+
+#ifdef _WIN32
+	Sleep(2000);
+#else
+	sleep(2);
+#endif
+
+	CPPUNIT_ASSERT(!LoginCache::i()->lookup(blob, pin, found));
+}
+
+void LoginCacheTests::testSecureDataManager()
+{
+	ByteString soPIN = "3132333435363738"; // "12345678"
+	ByteString userPIN = "4041424344454647"; // "ABCDEFGH"
+	ByteString wrongPIN = "4041424344454648"; // "ABCDEFGI"
+	ByteString plaintext = "010203040506070809";
+	ByteString encrypted;
+	ByteString decrypted;
+
+	// Set up a token key and encrypt some data with it
+	SecureDataManager s1;
+
+	CPPUNIT_ASSERT(s1.setSOPIN(soPIN));
+	CPPUNIT_ASSERT(s1.loginSO(soPIN));
+	CPPUNIT_ASSERT(s1.setUserPIN(userPIN));
+	CPPUNIT_ASSERT(s1.encrypt(plaintext, encrypted));
+
+	// The first login fills the cache, the second one uses it
+	SecureDataManager s2(s1.getSOPINBlob(), s1.getUserPINBlob());
+	SecureDataManager s3(s1.getSOPINBlob(), s1.getUserPINBlob());
+
+	CPPUNIT_ASSERT(s2.loginUser(userPIN));
+	CPPUNIT_ASSERT(s3.loginUser(userPIN));
+	CPPUNIT_ASSERT(s3.decrypt(encrypted, decrypted));
+	CPPUNIT_ASSERT(decrypted == plaintext);
+
+	// A wrong PIN still fails
+	CPPUNIT_ASSERT(!s3.loginUser(wrongPIN));
+	CPPUNIT_ASSERT(!s3.isUserLoggedIn());
+
+	// A changed PIN gives a new blob, so the old PIN no longer works
+	CPPUNIT_ASSERT(s3.loginUser(userPIN));
+	CPPUNIT_ASSERT(s3.setUserPIN(soPIN));
+
+	SecureDataManager s4(s3.getSOPINBlob(), s3.getUserPINBlob());
+
+	CPPUNIT_ASSERT(!s4.loginUser(userPIN));
+	CPPUNIT_ASSERT(s4.loginUser(soPIN));
+	CPPUNIT_ASSERT(s4.decrypt(encrypted, decrypted));
+	CPPUNIT_ASSERT(decrypted == plaintext);
+}
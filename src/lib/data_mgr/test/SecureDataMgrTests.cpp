@@ -32,6 +32,7 @@
 
 #include <stdlib.h>
 #include <string.h>
+#include <vector>
 #include <cppunit/extensions/HelperMacros.h>
 #include "SecureDataMgrTests.h"
 #include "SecureDataManager.h"
@@ -184,5 +185,27 @@ void SecureDataMgrTests::testSecureDataManager()
 	CPPUNIT_ASSERT(s2.encrypt(emptyPlaintext, encrypted));
 	CPPUNIT_ASSERT(s2.decrypt(encrypted, decrypted));
 	CPPUNIT_ASSERT(decrypted == emptyPlaintext);
+
+	// Check that a batch of data can be decrypted at once
+	std::vector<ByteString> batch;
+	std::vector<ByteString> decryptedBatch;
+
+	batch.push_back(encrypted2);
+	batch.push_back(ByteString());
+	batch.push_back(encrypted);
+
+	CPPUNIT_ASSERT(s2.decrypt(batch, decryptedBatch));
+	CPPUNIT_ASSERT(decryptedBatch.size() == 3);
+	CPPUNIT_ASSERT(decryptedBatch[0] == plaintext);
+	CPPUNIT_ASSERT(decryptedBatch[1].size() == 0);
+	CPPUNIT_ASSERT(decryptedBatch[2] == emptyPlaintext);
+
+	// A batch fails as a whole
+	batch.push_back(ByteString("0102"));
+	CPPUNIT_ASSERT(!s2.decrypt(batch, decryptedBatch));
+
+	s2.logout();
+	batch.pop_back();
+	CPPUNIT_ASSERT(!s2.decrypt(batch, decryptedBatch));
 }
 
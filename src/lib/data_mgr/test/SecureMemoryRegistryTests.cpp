@@ -0,0 +1,148 @@
+/*
+ * Copyright (c) 2016 SURFnet bv
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+/*****************************************************************************
+ SecureMemoryRegistryTests.cpp
+
+ Contains test cases to test the secure memory registry and its pooled arenas
+ *****************************************************************************/
+
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include <cppunit/extensions/HelperMacros.h>
+#include "SecureMemoryRegistryTests.h"
+#include "SecureMemoryRegistry.h"
+#include "salloc.h"
+
+CPPUNIT_TEST_SUITE_REGISTRATION(SecureMemoryRegistryTests);
+
+void SecureMemoryRegistryTests::setUp()
+{
+}
+
+void SecureMemoryRegistryTests::tearDown()
+{
+}
+
+void SecureMemoryRegistryTests::testPooledBlocks()
+{
+	SecureMemoryRegistry* registry = SecureMemoryRegistry::i();
+	CPPUNIT_ASSERT(registry != NULL);
+
+	// Blocks of different size classes do not overlap
+	unsigned char* block1 = (unsigned char*) registry->allocate(20);
+	unsigned char* block2 = (unsigned char*) registry->allocate(20);
+	unsigned char* block3 = (unsigned char*) registry->allocate(1000);
+	CPPUNIT_ASSERT(block1 != NULL);
+	CPPUNIT_ASSERT(block2 != NULL);
+	CPPUNIT_ASSERT(block3 != NULL);
+	CPPUNIT_ASSERT(block1 != block2);
+
+	memset(block1, 0x11, 20);
+	memset(block2, 0x22, 20);
+	memset(block3, 0x33, 1000);
+	for (size_t i = 0; i < 20; i++)
+	{
+		CPPUNIT_ASSERT(block1[i] == 0x11);
+		CPPUNIT_ASSERT(block2[i] == 0x22);
+	}
+
+	// A released block is wiped and handed out again
+	registry->release(block2, 20);
+	unsigned char* block4 = (unsigned char*) registry->allocate(24);
+	CPPUNIT_ASSERT(block4 == block2);
+	for (size_t i = sizeof(void*); i < 24; i++)
+	{
+		CPPUNIT_ASSERT(block4[i] == 0x00);
+	}
+
+	registry->release(block1, 20);
+	registry->release(block3, 1000);
+	registry->release(block4, 24);
+
+	// Exhaust more than one arena
+	std::vector<void*> blocks;
+	for (size_t i = 0; i < 2 * SECURE_POOL_ARENA_SIZE / SECURE_POOL_MIN_BLOCK; i++)
+	{
+		void* block = registry->allocate(SECURE_POOL_MIN_BLOCK);
+		CPPUNIT_ASSERT(block != NULL);
+		blocks.push_back(block);
+	}
+	for (size_t i = 0; i < blocks.size(); i++)
+	{
+		registry->release(blocks[i], SECURE_POOL_MIN_BLOCK);
+	}
+}
+
+void SecureMemoryRegistryTests::testLargeBlocks()
+{
+	SecureMemoryRegistry* registry = SecureMemoryRegistry::i();
+	size_t len = (SECURE_POOL_MIN_BLOCK << SECURE_POOL_CLASSES) + 1;
+
+	unsigned char* block = (unsigned char*) registry->allocate(len);
+	CPPUNIT_ASSERT(block != NULL);
+	memset(block, 0x44, len);
+
+	// Large blocks are registered individually
+	CPPUNIT_ASSERT(registry->remove(block) == len);
+	registry->add(block, len);
+
+	registry->release(block, len);
+}
+
+void SecureMemoryRegistryTests::testReset()
+{
+	unsigned char* block = (unsigned char*) SecureMemoryRegistry::i()->allocate(100);
+	CPPUNIT_ASSERT(block != NULL);
+	memset(block, 0x77, 100);
+
+	// The next instance takes over the arena of a block that is still in use
+	SecureMemoryRegistry::reset();
+	SecureMemoryRegistry* registry = SecureMemoryRegistry::i();
+	CPPUNIT_ASSERT(registry != NULL);
+	CPPUNIT_ASSERT(block[0] == 0x77);
+
+	registry->release(block, 100);
+	CPPUNIT_ASSERT(registry->allocate(100) == block);
+	registry->release(block, 100);
+}
+
+void SecureMemoryRegistryTests::testSalloc()
+{
+	unsigned char* small = (unsigned char*) salloc(16);
+	unsigned char* large = (unsigned char*) salloc(100000);
+	CPPUNIT_ASSERT(small != NULL);
+	CPPUNIT_ASSERT(large != NULL);
+
+	memset(small, 0x55, 16);
+	memset(large, 0x66, 100000);
+
+	sfree(small);
+	sfree(large);
+	sfree(NULL);
+}
@@ -41,105 +41,110 @@
  use the same handle manager and therefore there will never be e.g. a session
  with the same handle as an object.
 
+ The handle table is split into stripes on the handle value, each guarded by
+ its own mutex, so that concurrent lookups of sessions and objects only
+ contend when they happen to hit the same stripe. Issuing and removing handles
+ goes through a separate index mutex, which also guards per slot and per
+ session indexes of the issued handles. These indexes allow closing a session
+ or logging out of a token without scanning all handles.
+
+ Where the compiler offers atomic builtins, session and object lookups first
+ consult a fixed table of recently issued handles without taking any lock.
+ Each entry carries a sequence counter that writers make odd while they change
+ the entry; a reader that sees an odd or changed counter, or a different
+ handle, falls back to the locked stripe.
+
  *****************************************************************************/
 
 #include "HandleManager.h"
 #include "log.h"
 
+#include <algorithm>
+
 // Constructor
 HandleManager::HandleManager()
 {
-	handlesMutex = MutexFactory::i()->getMutex();
+	for (size_t i = 0; i < HANDLE_MANAGER_STRIPES; i++)
+	{
+		stripeMutex[i] = MutexFactory::i()->getMutex();
+	}
+	indexMutex = MutexFactory::i()->getMutex();
 	handleCounter = 0;
+
+	for (size_t i = 0; i < HANDLE_MANAGER_LOOKUP_SLOTS; i++)
+	{
+		lookupSlots[i].sequence = 0;
+		lookupSlots[i].handle = CK_INVALID_HANDLE;
+		lookupSlots[i].kind = CKH_INVALID;
+		lookupSlots[i].object = NULL_PTR;
+	}
 }
 
 // Destructor
 HandleManager::~HandleManager()
 {
-
-	MutexFactory::i()->recycleMutex(handlesMutex);
+	for (size_t i = 0; i < HANDLE_MANAGER_STRIPES; i++)
+	{
+		MutexFactory::i()->recycleMutex(stripeMutex[i]);
+	}
+	MutexFactory::i()->recycleMutex(indexMutex);
 }
 
 CK_SESSION_HANDLE HandleManager::addSession(CK_SLOT_ID slotID, CK_VOID_PTR session)
 {
-	MutexLocker lock(handlesMutex);
+	MutexLocker lock(indexMutex);
 
 	Handle h( CKH_SESSION, slotID );
 	h.object = session;
-	handles[++handleCounter] = h;
-	return (CK_SESSION_HANDLE)handleCounter;
+	CK_SESSION_HANDLE hSession = insertHandle(h);
+	slots[slotID].sessions.insert(hSession);
+	return hSession;
 }
 
 CK_VOID_PTR HandleManager::getSession(const CK_SESSION_HANDLE hSession)
 {
-	MutexLocker lock(handlesMutex);
+	CK_VOID_PTR session;
+	if (lookup(hSession, CKH_SESSION, session))
+		return session;
 
-	std::map< CK_ULONG, Handle>::iterator it = handles.find(hSession);
-	if (it == handles.end() || CKH_SESSION != it->second.kind)
+	size_t stripe = stripeOf(hSession);
+	MutexLocker lock(stripeMutex[stripe]);
+
+	std::map< CK_ULONG, Handle>::iterator it = handles[stripe].find(hSession);
+	if (it == handles[stripe].end() || CKH_SESSION != it->second.kind)
 		return NULL_PTR;
 	return it->second.object;
 }
 
 CK_OBJECT_HANDLE HandleManager::addSessionObject(CK_SLOT_ID slotID, CK_SESSION_HANDLE hSession, bool isPrivate, CK_VOID_PTR object)
 {
-	MutexLocker lock(handlesMutex);
-
-	// Return existing handle when the object has already been registered.
-	std::map< CK_VOID_PTR, CK_ULONG>::iterator oit = objects.find(object);
-	if (oit != objects.end()) {
-		std::map< CK_ULONG, Handle>::iterator hit = handles.find(oit->second);
-		if (hit == handles.end() || CKH_OBJECT != hit->second.kind || slotID != hit->second.slotID) {
-			objects.erase(oit);
-			return CK_INVALID_HANDLE;
-		} else
-			return oit->second;
-	}
-
-	Handle h( CKH_OBJECT, slotID, hSession );
-	h.isPrivate = isPrivate;
-	h.object = object;
-	handles[++handleCounter] = h;
-	objects[object] = handleCounter;
-	return (CK_OBJECT_HANDLE)handleCounter;
+	return addObject(slotID, hSession, isPrivate, object);
 }
 
 CK_OBJECT_HANDLE HandleManager::addTokenObject(CK_SLOT_ID slotID, bool isPrivate, CK_VOID_PTR object)
 {
-	MutexLocker lock(handlesMutex);
-
-	// Return existing handle when the object has already been registered.
-	std::map< CK_VOID_PTR, CK_ULONG>::iterator oit = objects.find(object);
-	if (oit != objects.end()) {
-		std::map< CK_ULONG, Handle>::iterator hit = handles.find(oit->second);
-		if (hit == handles.end() || CKH_OBJECT != hit->second.kind || slotID != hit->second.slotID) {
-			objects.erase(oit);
-			return CK_INVALID_HANDLE;
-		} else
-			return oit->second;
-	}
-
 	// Token objects are not associated with a specific session.
-	Handle h( CKH_OBJECT, slotID );
-	h.isPrivate = isPrivate;
-	h.object = object;
-	handles[++handleCounter] = h;
-	objects[object] = handleCounter;
-	return (CK_OBJECT_HANDLE)handleCounter;
+	return addObject(slotID, CK_INVALID_HANDLE, isPrivate, object);
 }
 
 CK_VOID_PTR HandleManager::getObject(const CK_OBJECT_HANDLE hObject)
 {
-	MutexLocker lock(handlesMutex);
+	CK_VOID_PTR object;
+	if (lookup(hObject, CKH_OBJECT, object))
+		return object;
+
+	size_t stripe = stripeOf(hObject);
+	MutexLocker lock(stripeMutex[stripe]);
 
-	std::map< CK_ULONG, Handle>::iterator it = handles.find(hObject);
-	if (it == handles.end() || CKH_OBJECT != it->second.kind )
+	std::map< CK_ULONG, Handle>::iterator it = handles[stripe].find(hObject);
+	if (it == handles[stripe].end() || CKH_OBJECT != it->second.kind )
 		return NULL_PTR;
 	return it->second.object;
 }
 
 CK_OBJECT_HANDLE HandleManager::getObjectHandle(CK_VOID_PTR object)
 {
-	MutexLocker lock(handlesMutex);
+	MutexLocker lock(indexMutex);
 
 	std::map< CK_VOID_PTR, CK_ULONG>::iterator it = objects.find(object);
 	if (it == objects.end())
@@ -149,50 +154,37 @@ CK_OBJECT_HANDLE HandleManager::getObjectHandle(CK_VOID_PTR object)
 
 void HandleManager::destroyObject(const CK_OBJECT_HANDLE hObject)
 {
-	MutexLocker lock(handlesMutex);
+	MutexLocker lock(indexMutex);
 
-	std::map< CK_ULONG, Handle>::iterator it = handles.find(hObject);
-	if (it != handles.end() && CKH_OBJECT == it->second.kind) {
-		objects.erase(it->second.object);
-		handles.erase(it);
-	}
+	removeObject(hObject);
 }
 
 void HandleManager::sessionClosed(const CK_SESSION_HANDLE hSession)
 {
 	CK_SLOT_ID slotID;
 	{
-		MutexLocker lock(handlesMutex);
+		MutexLocker lock(indexMutex);
 
-		std::map< CK_ULONG, Handle>::iterator it = handles.find(hSession);
-		if (it == handles.end() || CKH_SESSION != it->second.kind)
+		Handle h;
+		if (!removeHandle(hSession, CKH_SESSION, h))
 			return; // Unable to find the specified session.
 
-		slotID = it->second.slotID;
-
-		// session closed, so we can erase information about it.
-		handles.erase(it);
+		slotID = h.slotID;
+		slots[slotID].sessions.erase(hSession);
 
 		// Erase all session object handles associated with the given session handle.
-		CK_ULONG openSessionCount = 0;
-		for (it = handles.begin(); it != handles.end(); ) {
-			Handle &h = it->second;
-			if (CKH_SESSION == h.kind && slotID == h.slotID) {
-				++openSessionCount; // another session is open for this slotID.
-			} else {
-				if (CKH_OBJECT == h.kind && hSession == h.hSession) {
-					// A session object is present for the given session, so erase it.
-					objects.erase(it->second.object);
-					// Iterator post-incrementing (it++) will return a copy of the original it (which points to handle to be deleted).
-					handles.erase(it++);
-					continue;
-				}
-			}
-			++it;
+		std::map< CK_SESSION_HANDLE, std::set<CK_OBJECT_HANDLE> >::iterator sit = sessionObjects.find(hSession);
+		if (sit != sessionObjects.end()) {
+			std::set<CK_OBJECT_HANDLE> sessionHandles;
+			sessionHandles.swap(sit->second);
+			sessionObjects.erase(sit);
+
+			for (std::set<CK_OBJECT_HANDLE>::iterator it = sessionHandles.begin(); it != sessionHandles.end(); ++it)
+				removeObject(*it);
 		}
 
-		 // We are done when there are still sessions open.
-		if (openSessionCount)
+		// We are done when there are still sessions open.
+		if (!slots[slotID].sessions.empty())
 			return;
 	}
 
@@ -202,38 +194,214 @@ void HandleManager::sessionClosed(const CK_SESSION_HANDLE hSession)
 
 void HandleManager::allSessionsClosed(const CK_SLOT_ID slotID)
 {
-	MutexLocker lock(handlesMutex);
+	MutexLocker lock(indexMutex);
+
+	std::map< CK_SLOT_ID, SlotHandles>::iterator sit = slots.find(slotID);
+	if (sit == slots.end())
+		return;
+
+	SlotHandles slot;
+	std::swap(slot, sit->second);
+	slots.erase(sit);
 
 	// Erase all "session", "session object" and "token object" handles for a given slot id.
-	std::map< CK_ULONG, Handle>::iterator it;
-	for (it = handles.begin(); it != handles.end(); ) {
-		Handle &h = it->second;
-		if (slotID == h.slotID) {
-			if (CKH_OBJECT == it->second.kind)
-				objects.erase(it->second.object);
-			// Iterator post-incrementing (it++) will return a copy of the original it (which points to handle to be deleted).
-			handles.erase(it++);
+	Handle h;
+	std::set<CK_ULONG>::iterator it;
+	for (it = slot.sessions.begin(); it != slot.sessions.end(); ++it) {
+		removeHandle(*it, CKH_SESSION, h);
+		sessionObjects.erase(*it);
+	}
+	for (it = slot.objects.begin(); it != slot.objects.end(); ++it) {
+		if (!removeHandle(*it, CKH_OBJECT, h))
 			continue;
-		}
-		++it;
+		objects.erase(h.object);
+		// The session may have been registered without being opened on this slot.
+		forgetSessionObject(h.hSession, *it);
 	}
 }
 
 void HandleManager::tokenLoggedOut(const CK_SLOT_ID slotID)
 {
-	MutexLocker lock(handlesMutex);
+	MutexLocker lock(indexMutex);
+
+	std::map< CK_SLOT_ID, SlotHandles>::iterator sit = slots.find(slotID);
+	if (sit == slots.end())
+		return;
 
 	// Erase all private "token object" or "session object" handles for a given slot id.
-	std::map< CK_ULONG, Handle>::iterator it;
-	for (it = handles.begin(); it != handles.end(); ) {
-		Handle &h = it->second;
-		if (CKH_OBJECT == h.kind && slotID == h.slotID && h.isPrivate) {
-			// A private object is present for the given slotID so we need to remove it.
-			objects.erase(it->second.object);
-			// Iterator post-incrementing (it++) will return a copy of the original it (which points to handle to be deleted).
-			handles.erase(it++);
-			continue;
-		}
-		++it;
+	std::set<CK_OBJECT_HANDLE> privateObjects;
+	privateObjects.swap(sit->second.privateObjects);
+
+	std::set<CK_OBJECT_HANDLE>::iterator it;
+	for (it = privateObjects.begin(); it != privateObjects.end(); ++it)
+		removeObject(*it);
+}
+
+// Select the stripe of the handle table that holds the given handle
+/*static*/ size_t HandleManager::stripeOf(const CK_ULONG handle)
+{
+	return (size_t)(handle % HANDLE_MANAGER_STRIPES);
+}
+
+// Look up the handle without locking
+// Returns false when the lookup table cannot answer for the handle
+bool HandleManager::lookup(const CK_ULONG handle, const CK_HANDLE_KIND kind, CK_VOID_PTR& object)
+{
+#ifdef __GNUC__
+	const LookupSlot& slot = lookupSlots[handle % HANDLE_MANAGER_LOOKUP_SLOTS];
+
+	unsigned long sequence = slot.sequence;
+	if (sequence & 1) return false;
+	__sync_synchronize();
+
+	CK_ULONG slotHandle = slot.handle;
+	CK_HANDLE_KIND slotKind = slot.kind;
+	CK_VOID_PTR slotObject = slot.object;
+
+	__sync_synchronize();
+	if (slot.sequence != sequence || slotHandle != handle || handle == CK_INVALID_HANDLE)
+		return false;
+
+	// Handles are never reused, so a handle of another kind is invalid
+	object = (slotKind == kind) ? slotObject : NULL_PTR;
+	return true;
+#else
+	(void) handle;
+	(void) kind;
+	(void) object;
+	return false;
+#endif
+}
+
+// Write the lookup table entry at the given index
+// Calling function must lock the stripe mutex of the handles at the index
+void HandleManager::publish(const size_t index, const CK_ULONG handle, const CK_HANDLE_KIND kind, CK_VOID_PTR object)
+{
+#ifdef __GNUC__
+	LookupSlot& slot = lookupSlots[index];
+
+	slot.sequence++;
+	__sync_synchronize();
+	slot.handle = handle;
+	slot.kind = kind;
+	slot.object = object;
+	__sync_synchronize();
+	slot.sequence++;
+#else
+	(void) index;
+	(void) handle;
+	(void) kind;
+	(void) object;
+#endif
+}
+
+// Withdraw the handle from lookups without locking
+// Calling function must lock the stripe mutex of the handle
+void HandleManager::unpublish(const CK_ULONG handle)
+{
+	size_t index = handle % HANDLE_MANAGER_LOOKUP_SLOTS;
+	if (lookupSlots[index].handle != handle)
+		return;
+
+	publish(index, CK_INVALID_HANDLE, CKH_INVALID, NULL_PTR);
+}
+
+// Register the object or return the existing handle
+CK_OBJECT_HANDLE HandleManager::addObject(CK_SLOT_ID slotID, CK_SESSION_HANDLE hSession, bool isPrivate, CK_VOID_PTR object)
+{
+	MutexLocker lock(indexMutex);
+
+	// Return existing handle when the object has already been registered.
+	std::map< CK_VOID_PTR, CK_ULONG>::iterator oit = objects.find(object);
+	if (oit != objects.end()) {
+		size_t stripe = stripeOf(oit->second);
+		MutexLocker stripeLock(stripeMutex[stripe]);
+
+		std::map< CK_ULONG, Handle>::iterator hit = handles[stripe].find(oit->second);
+		if (hit == handles[stripe].end() || CKH_OBJECT != hit->second.kind || slotID != hit->second.slotID) {
+			objects.erase(oit);
+			return CK_INVALID_HANDLE;
+		} else
+			return oit->second;
 	}
+
+	Handle h( CKH_OBJECT, slotID, hSession );
+	h.isPrivate = isPrivate;
+	h.object = object;
+	CK_OBJECT_HANDLE hObject = insertHandle(h);
+	objects[object] = hObject;
+
+	SlotHandles& slot = slots[slotID];
+	slot.objects.insert(hObject);
+	if (isPrivate)
+		slot.privateObjects.insert(hObject);
+	if (hSession != CK_INVALID_HANDLE)
+		sessionObjects[hSession].insert(hObject);
+
+	return hObject;
+}
+
+// Issue a new handle
+// Calling function must lock the index mutex
+CK_ULONG HandleManager::insertHandle(const Handle& h)
+{
+	CK_ULONG handle = ++handleCounter;
+	size_t stripe = stripeOf(handle);
+	MutexLocker lock(stripeMutex[stripe]);
+
+	handles[stripe][handle] = h;
+	publish(handle % HANDLE_MANAGER_LOOKUP_SLOTS, handle, h.kind, h.object);
+	return handle;
+}
+
+// Remove the handle from the handle table when it is of the given kind
+// Calling function must lock the index mutex
+bool HandleManager::removeHandle(const CK_ULONG handle, const CK_HANDLE_KIND kind, Handle& h)
+{
+	size_t stripe = stripeOf(handle);
+	MutexLocker lock(stripeMutex[stripe]);
+
+	std::map< CK_ULONG, Handle>::iterator it = handles[stripe].find(handle);
+	if (it == handles[stripe].end() || kind != it->second.kind)
+		return false;
+
+	unpublish(handle);
+	h = it->second;
+	handles[stripe].erase(it);
+	return true;
+}
+
+// Remove the object handle and its entries in the indexes
+// Calling function must lock the index mutex
+void HandleManager::removeObject(const CK_OBJECT_HANDLE hObject)
+{
+	Handle h;
+	if (!removeHandle(hObject, CKH_OBJECT, h))
+		return;
+
+	objects.erase(h.object);
+
+	std::map< CK_SLOT_ID, SlotHandles>::iterator sit = slots.find(h.slotID);
+	if (sit != slots.end()) {
+		sit->second.objects.erase(hObject);
+		sit->second.privateObjects.erase(hObject);
+	}
+
+	forgetSessionObject(h.hSession, hObject);
+}
+
+// Remove the object handle from the index of the session
+// Calling function must lock the index mutex
+void HandleManager::forgetSessionObject(const CK_SESSION_HANDLE hSession, const CK_OBJECT_HANDLE hObject)
+{
+	if (hSession == CK_INVALID_HANDLE)
+		return;
+
+	std::map< CK_SESSION_HANDLE, std::set<CK_OBJECT_HANDLE> >::iterator it = sessionObjects.find(hSession);
+	if (it == sessionObjects.end())
+		return;
+
+	it->second.erase(hObject);
+	if (it->second.empty())
+		sessionObjects.erase(it);
 }
@@ -38,6 +38,14 @@
 #include "cryptoki.h"
 
 #include <map>
+#include <set>
+
+// Number of independently locked partitions of the handle table
+#define HANDLE_MANAGER_STRIPES 16
+
+// Number of entries in the table that serves lookups without locking,
+// a multiple of HANDLE_MANAGER_STRIPES
+#define HANDLE_MANAGER_LOOKUP_SLOTS 1024
 
 #define CK_INTERNAL_SESSION_HANDLE CK_SESSION_HANDLE
 
@@ -84,10 +92,52 @@ public:
     void tokenLoggedOut(const CK_SLOT_ID slotID);
 
 private:
-    Mutex* handlesMutex;
-    std::map< CK_ULONG, Handle> handles;
+    // An entry of the lookup table, published with a sequence counter that
+    // is odd while the entry is being written
+    struct LookupSlot
+    {
+        volatile unsigned long sequence;
+        volatile CK_ULONG handle;
+        volatile CK_HANDLE_KIND kind;
+        CK_VOID_PTR volatile object;
+    };
+
+    // The handles issued for a slot, used to invalidate them without scanning all handles
+    struct SlotHandles
+    {
+        std::set<CK_SESSION_HANDLE> sessions;
+        std::set<CK_OBJECT_HANDLE> objects;
+        std::set<CK_OBJECT_HANDLE> privateObjects;
+    };
+
+    // The handle table is partitioned on the handle value, so that lookups of
+    // different handles do not contend for the same mutex
+    Mutex* stripeMutex[HANDLE_MANAGER_STRIPES];
+    std::map< CK_ULONG, Handle> handles[HANDLE_MANAGER_STRIPES];
+
+    // Recently issued handles, read without locking. An entry is only
+    // written under the mutex of the stripe that its handles belong to.
+    LookupSlot lookupSlots[HANDLE_MANAGER_LOOKUP_SLOTS];
+
+    // Guards the handle counter, the object lookup and the slot and session indexes.
+    // When both are needed, this mutex is locked before a stripe mutex.
+    Mutex* indexMutex;
     std::map< CK_VOID_PTR, CK_ULONG> objects;
+    std::map< CK_SLOT_ID, SlotHandles> slots;
+    std::map< CK_SESSION_HANDLE, std::set<CK_OBJECT_HANDLE> > sessionObjects;
     CK_ULONG handleCounter;
+
+    static size_t stripeOf(const CK_ULONG handle);
+
+    bool lookup(const CK_ULONG handle, const CK_HANDLE_KIND kind, CK_VOID_PTR& object);
+    void publish(const size_t index, const CK_ULONG handle, const CK_HANDLE_KIND kind, CK_VOID_PTR object);
+    void unpublish(const CK_ULONG handle);
+
+    CK_OBJECT_HANDLE addObject(CK_SLOT_ID slotID, CK_SESSION_HANDLE hSession, bool isPrivate, CK_VOID_PTR object);
+    CK_ULONG insertHandle(const Handle& h);
+    bool removeHandle(const CK_ULONG handle, const CK_HANDLE_KIND kind, Handle& h);
+    void removeObject(const CK_OBJECT_HANDLE hObject);
+    void forgetSessionObject(const CK_SESSION_HANDLE hSession, const CK_OBJECT_HANDLE hObject);
 };
 
 #endif // !_SOFTHSM_V2_HANDLEMANAGER_H
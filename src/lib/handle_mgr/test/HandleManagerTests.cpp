@@ -32,6 +32,7 @@
 
 #include <stdlib.h>
 #include <string.h>
+#include <vector>
 #include <cppunit/extensions/HelperMacros.h>
 #include "HandleManagerTests.h"
 
@@ -175,4 +176,74 @@ void HandleManagerTests::testHandleManager()
 
 	CPPUNIT_ASSERT(NULL == handleManager->getSession(hSession));
 	CPPUNIT_ASSERT(NULL == handleManager->getSession(hSession2));
+
+	// Closing sessions and logging out only affects the handles of the given slot.
+	CK_SLOT_ID slotID2 = 5678;
+	hSession = handleManager->addSession(slotID, session);
+	hSession2 = handleManager->addSession(slotID2, session2);
+	hObject = handleManager->addSessionObject(slotID, hSession, false, object);
+	hObject2 = handleManager->addTokenObject(slotID2, true, object2);
+	hObject3 = handleManager->addSessionObject(slotID2, hSession2, true, object3);
+	CPPUNIT_ASSERT(hObject2 == handleManager->getObjectHandle(object2));
+
+	handleManager->tokenLoggedOut(slotID);
+	CPPUNIT_ASSERT(object2 == handleManager->getObject(hObject2));
+	CPPUNIT_ASSERT(object3 == handleManager->getObject(hObject3));
+
+	handleManager->sessionClosed(hSession);
+	CPPUNIT_ASSERT(NULL == handleManager->getObject(hObject));
+	CPPUNIT_ASSERT(session2 == handleManager->getSession(hSession2));
+	CPPUNIT_ASSERT(object2 == handleManager->getObject(hObject2));
+
+	handleManager->tokenLoggedOut(slotID2);
+	CPPUNIT_ASSERT(NULL == handleManager->getObject(hObject2));
+	CPPUNIT_ASSERT(NULL == handleManager->getObject(hObject3));
+	CPPUNIT_ASSERT(CK_INVALID_HANDLE == handleManager->getObjectHandle(object2));
+	CPPUNIT_ASSERT(session2 == handleManager->getSession(hSession2));
+
+	handleManager->sessionClosed(hSession2);
+	CPPUNIT_ASSERT(NULL == handleManager->getSession(hSession2));
+}
+
+void HandleManagerTests::testManyHandles()
+{
+	CK_SLOT_ID slotID = 1234;
+	const size_t count = 3 * HANDLE_MANAGER_LOOKUP_SLOTS;
+	std::vector<CK_ULONG> values(count);
+	std::vector<CK_OBJECT_HANDLE> hObjects(count);
+
+	// Later handles displace earlier ones from the lookup table
+	CK_SESSION_HANDLE hSession = handleManager->addSession(slotID, &values[0]);
+	for (size_t i = 0; i < count; i++)
+	{
+		hObjects[i] = handleManager->addSessionObject(slotID, hSession, (i % 2) == 0, &values[i]);
+		CPPUNIT_ASSERT(hObjects[i] != CK_INVALID_HANDLE);
+	}
+
+	CPPUNIT_ASSERT(&values[0] == handleManager->getSession(hSession));
+	CPPUNIT_ASSERT(NULL == handleManager->getObject(hSession));
+	CPPUNIT_ASSERT(NULL == handleManager->getSession(hObjects[0]));
+	for (size_t i = 0; i < count; i++)
+	{
+		CPPUNIT_ASSERT(&values[i] == handleManager->getObject(hObjects[i]));
+	}
+
+	// Removed handles are invalid whether or not they were in the lookup table
+	handleManager->destroyObject(hObjects[0]);
+	handleManager->destroyObject(hObjects[count - 1]);
+	CPPUNIT_ASSERT(NULL == handleManager->getObject(hObjects[0]));
+	CPPUNIT_ASSERT(NULL == handleManager->getObject(hObjects[count - 1]));
+
+	handleManager->tokenLoggedOut(slotID);
+	for (size_t i = 1; i < count - 1; i++)
+	{
+		CPPUNIT_ASSERT(((i % 2) == 0 ? NULL : &values[i]) == handleManager->getObject(hObjects[i]));
+	}
+
+	handleManager->sessionClosed(hSession);
+	CPPUNIT_ASSERT(NULL == handleManager->getSession(hSession));
+	for (size_t i = 0; i < count; i++)
+	{
+		CPPUNIT_ASSERT(NULL == handleManager->getObject(hObjects[i]));
+	}
 }
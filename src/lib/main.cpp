@@ -37,6 +37,7 @@
 #include "fatal.h"
 #include "cryptoki.h"
 #include "SoftHSM.h"
+#include "softhsm2_ext.h"
 
 // PKCS #11 function list
 //
@@ -118,6 +119,17 @@ static CK_FUNCTION_LIST functionList =
 	C_WaitForSlotEvent
 };
 
+// SoftHSM vendor extensions
+static CK_RV C_SignBatch(CK_SESSION_HANDLE hSession, CK_MECHANISM_PTR pMechanism, CK_OBJECT_HANDLE hKey, CK_ULONG ulCount, CK_BYTE_PTR* ppData, CK_ULONG_PTR pulDataLen, CK_BYTE_PTR* ppSignature, CK_ULONG_PTR pulSignatureLen);
+
+static CK_SOFTHSM_FUNCTION_LIST vendorFunctionList =
+{
+	// Version information
+	{ SOFTHSM_EXT_VERSION_MAJOR, SOFTHSM_EXT_VERSION_MINOR },
+	// Function pointers
+	C_SignBatch
+};
+
 // PKCS #11 initialisation function
 CK_RV C_Initialize(CK_VOID_PTR pInitArgs)
 {
@@ -1178,3 +1190,37 @@ CK_RV C_WaitForSlotEvent(CK_FLAGS flags, CK_SLOT_ID_PTR pSlot, CK_VOID_PTR pRese
 	return CKR_FUNCTION_FAILED;
 }
 
+// Return the list of SoftHSM vendor extensions
+CK_RV SoftHSM_GetFunctionList(CK_SOFTHSM_FUNCTION_LIST_PTR_PTR ppFunctionList)
+{
+	try
+	{
+		if (ppFunctionList == NULL_PTR) return CKR_ARGUMENTS_BAD;
+
+		*ppFunctionList = &vendorFunctionList;
+
+		return CKR_OK;
+	}
+	catch (...)
+	{
+		FatalException();
+	}
+
+	return CKR_FUNCTION_FAILED;
+}
+
+// Sign a batch of messages with the same key and mechanism
+static CK_RV C_SignBatch(CK_SESSION_HANDLE hSession, CK_MECHANISM_PTR pMechanism, CK_OBJECT_HANDLE hKey, CK_ULONG ulCount, CK_BYTE_PTR* ppData, CK_ULONG_PTR pulDataLen, CK_BYTE_PTR* ppSignature, CK_ULONG_PTR pulSignatureLen)
+{
+	try
+	{
+		return SoftHSM::i()->C_SignBatch(hSession, pMechanism, hKey, ulCount, ppData, pulDataLen, ppSignature, pulSignatureLen);
+	}
+	catch (...)
+	{
+		FatalException();
+	}
+
+	return CKR_FUNCTION_FAILED;
+}
+
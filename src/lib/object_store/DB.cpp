@@ -34,6 +34,7 @@
 #include "config.h"
 #include "OSPathSep.h"
 #include "log.h"
+#include "osthread.h"
 #include <cstdlib>
 #include <cstdio>
 #include <iostream>
@@ -178,8 +179,11 @@ class DB::Handle {
 public:
 	int _refcount;
 	sqlite3_stmt *_stmt;
+	// Set while the statement is in the statement cache of a connection;
+	// the reference count is then changed under this mutex
+	Mutex *_cacheMutex;
 	Handle(sqlite3_stmt *stmt)
-		: _refcount(1), _stmt(stmt)
+		: _refcount(1), _stmt(stmt), _cacheMutex(NULL)
 	{
 	}
 	~Handle()
@@ -193,6 +197,8 @@ public:
 
 	Handle *retain()
 	{
+		MutexLocker lock(_cacheMutex);
+
 		if (_refcount)
 		{
 			_refcount++;
@@ -202,13 +208,30 @@ public:
 	}
 	void release()
 	{
-		if (_refcount)
 		{
+			MutexLocker lock(_cacheMutex);
+
+			if (!_refcount)
+				return;
 			_refcount--;
 			if (_refcount)
+			{
+				// Only the statement cache holds on to the statement now,
+				// make sure it does not keep a read lock on the database.
+				// The cache only hands out a statement with a reference
+				// count of one, so it cannot be reused before the reset.
+				if (_refcount == 1 && _cacheMutex != NULL)
+					sqlite3_reset(_stmt);
 				return;
-			delete this;
+			}
 		}
+		delete this;
+	}
+	int refcount()
+	{
+		MutexLocker lock(_cacheMutex);
+
+		return _refcount;
 	}
 	bool reset()
 	{
@@ -289,7 +312,7 @@ bool DB::Statement::isValid()
 
 int DB::Statement::refcount()
 {
-	return _handle ? _handle->_refcount : 0;
+	return _handle ? _handle->refcount() : 0;
 }
 
 
@@ -721,14 +744,33 @@ DB::Connection *DB::Connection::Create(const std::string &dbdir, const std::stri
 
 DB::Connection::Connection(const std::string &dbdir, const std::string &dbname)
 	: _dbdir(dbdir)
+	, _dbname(dbname)
 	, _dbpath(dbdir + OS_PATHSEP + dbname)
 	, _db(NULL)
+	, _statementsMutex(MutexFactory::i()->getMutex())
+	, _cachedHandlesMutex(MutexFactory::i()->getMutex())
+	, _checkpoint(-1)
+	, _readerKey(NULL)
+	, _openReaders(0)
+	, _maxReaders(0)
+	, _readersMutex(MutexFactory::i()->getMutex())
 {
 }
 
 DB::Connection::~Connection()
 {
 	close();
+
+	// Threads that exit from now on leave their reader to be freed here;
+	// destroying the key waits for the threads that are releasing theirs
+	if (_readerKey != NULL)
+		OSDestroyThreadKey(_readerKey);
+	for (std::set<Reader*>::iterator it = _readers.begin(); it != _readers.end(); ++it)
+		delete *it;
+
+	MutexFactory::i()->recycleMutex(_readersMutex);
+	MutexFactory::i()->recycleMutex(_cachedHandlesMutex);
+	MutexFactory::i()->recycleMutex(_statementsMutex);
 }
 
 const std::string &DB::Connection::dbdir()
@@ -798,6 +840,35 @@ DB::Statement DB::Connection::prepare(const std::string &format, ...){
 	return Statement(stmt);
 }
 
+DB::Statement DB::Connection::prepareCached(const std::string &query)
+{
+	MutexLocker lock(_statementsMutex);
+
+	std::map<std::string,Statement>::iterator it = _statements.find(query);
+	if (it != _statements.end())
+	{
+		// The statement is in use when anyone but the cache holds on to it.
+		// The last user resets the statement and drops the reference count
+		// to one under the mutex of the cached handles. Nobody else can take
+		// a reference while the count is one, as the cache is locked.
+		if (it->second.refcount() != 1)
+			return prepare("%s", query.c_str());
+
+		Bindings statement(it->second);
+		if (!statement.reset() || !statement.clear())
+			return Statement();
+		return statement;
+	}
+
+	Statement statement = prepare("%s", query.c_str());
+	if (!statement.isValid())
+		return statement;
+
+	statement.handle()->_cacheMutex = _cachedHandlesMutex;
+	_statements[query] = statement;
+	return statement;
+}
+
 DB::Result DB::Connection::perform(DB::Statement &statement)
 {
 	return (statement.step()==Statement::ReturnCodeRow) ?  Result(statement) : Result();
@@ -861,6 +932,32 @@ bool DB::Connection::connect(const char *
 
 void DB::Connection::close()
 {
+	// The read connections are closed together with this connection. The
+	// readers stay with their threads, which may open a new connection.
+	{
+		MutexLocker lock(_readersMutex);
+
+		for (std::set<Reader*>::iterator it = _readers.begin(); it != _readers.end(); ++it)
+		{
+			delete (*it)->connection;
+			(*it)->connection = NULL;
+		}
+		_openReaders = 0;
+	}
+
+	// The cached statements have to be finalized before closing the database.
+	{
+		MutexLocker lock(_statementsMutex);
+
+		for (std::map<std::string,Statement>::iterator it = _statements.begin(); it != _statements.end(); ++it)
+		{
+			MutexLocker handleLock(_cachedHandlesMutex);
+
+			it->second.handle()->_cacheMutex = NULL;
+		}
+		_statements.clear();
+	}
+
 	if (_db) {
 		sqlite3_close(_db);
 		_db = NULL;
@@ -878,12 +975,225 @@ bool DB::Connection::setBusyTimeout(int ms)
 	return true;
 }
 
+bool DB::Connection::setJournal(bool wal, const std::string &synchronous, int checkpoint)
+{
+	const char *mode = wal ? "wal" : "delete";
+
+	Statement statement = prepare("pragma journal_mode=%s;", mode);
+	Result result = perform(statement);
+	if (!result.isValid())
+		return false;
+
+	// The journal mode cannot always be changed, e.g. write-ahead logging
+	// is not available on all file systems. The database remains usable.
+	const char *current = result.getString(1);
+	if (current == NULL || std::string(current) != mode)
+	{
+		WARNING_MSG("Could not set the journal mode of database %s to %s, it remains %s",
+			    _dbpath.c_str(), mode, current ? current : "unknown");
+	}
+	statement = Statement();
+
+	if (!setSynchronous(synchronous, checkpoint))
+		return false;
+
+	MutexLocker lock(_readersMutex);
+
+	_synchronous = synchronous;
+	_checkpoint = checkpoint;
+
+	return true;
+}
+
+// Apply the synchronous mode and the automatic checkpoint threshold; the
+// latter is left untouched when negative.
+bool DB::Connection::setSynchronous(const std::string &synchronous, int checkpoint)
+{
+	if (!synchronous.empty())
+	{
+		// Only accept the modes known to SQLite; the value ends up in a pragma
+		static const char *modes[] = { "off", "normal", "full", "extra" };
+
+		bool known = false;
+		for (size_t i = 0; i < sizeof(modes)/sizeof(modes[0]); ++i)
+		{
+			if (synchronous == modes[i])
+			{
+				known = true;
+				break;
+			}
+		}
+
+		if (!known)
+		{
+			DB::logError("Connection::setSynchronous: unknown synchronous mode \"%s\"", synchronous.c_str());
+			return false;
+		}
+
+		Statement statement = prepare("pragma synchronous=%s;", synchronous.c_str());
+		if (!execute(statement))
+			return false;
+	}
+
+	if (checkpoint >= 0)
+	{
+		Statement statement = prepare("pragma wal_autocheckpoint=%d;", checkpoint);
+		Result result = perform(statement);
+		if (!result.isValid() || result.getInt(1) != checkpoint)
+		{
+			DB::logError("Connection::setSynchronous: could not set the checkpoint threshold");
+			return false;
+		}
+	}
+
+	return true;
+}
+
+void DB::Connection::setMaxReaders(size_t maxReaders)
+{
+	MutexLocker lock(_readersMutex);
+
+	if (maxReaders > 0 && _readerKey == NULL &&
+	    OSCreateThreadKey(&_readerKey, releaseReader) != CKR_OK)
+	{
+		WARNING_MSG("Could not set up read connections to database %s", _dbpath.c_str());
+
+		_readerKey = NULL;
+		maxReaders = 0;
+	}
+
+	_maxReaders = maxReaders;
+}
+
+DB::Connection *DB::Connection::reader()
+{
+	// Uncommitted changes are only visible through this connection
+	if (inTransaction())
+		return this;
+
+	// The key is set up before the connection is shared and the reader of
+	// a thread is only changed by that thread, or once the connection is
+	// closed, so the lock is only needed to open a read connection
+	if (_readerKey == NULL)
+		return this;
+
+	Reader *reader = (Reader *) OSGetThreadValue(_readerKey);
+	if (reader != NULL && reader->connection != NULL)
+		return reader->connection;
+
+	MutexLocker lock(_readersMutex);
+
+	if (_openReaders >= _maxReaders)
+		return this;
+
+	// Open a new read connection for this thread. Should that fail, this
+	// connection is used until a later attempt succeeds.
+	Connection *connection = new Connection(_dbdir, _dbname);
+	bool opened = connection->connect() && connection->setSynchronous(_synchronous, _checkpoint);
+	if (opened)
+	{
+		Statement statement = connection->prepare("pragma query_only=1;");
+		opened = connection->execute(statement);
+	}
+	if (!opened)
+	{
+		WARNING_MSG("Could not open a read connection to database %s", _dbpath.c_str());
+
+		delete connection;
+		return this;
+	}
+
+	if (reader == NULL)
+	{
+		reader = new Reader();
+		reader->owner = this;
+		reader->connection = NULL;
+
+		if (OSSetThreadValue(_readerKey, reader) != CKR_OK)
+		{
+			delete reader;
+			delete connection;
+			return this;
+		}
+
+		_readers.insert(reader);
+	}
+
+	reader->connection = connection;
+	_openReaders++;
+
+	return connection;
+}
+
+/*static*/ void DB::Connection::releaseReader(void *reader)
+{
+	Reader *threadReader = (Reader *) reader;
+	Connection *owner = threadReader->owner;
+
+	{
+		MutexLocker lock(owner->_readersMutex);
+
+		owner->_readers.erase(threadReader);
+
+		if (threadReader->connection != NULL)
+		{
+			delete threadReader->connection;
+			owner->_openReaders--;
+		}
+	}
+
+	delete threadReader;
+}
+
 bool DB::Connection::tableExists(const std::string &tablename)
 {
 	Statement statement = prepare("select name from sqlite_master where type='table' and name='%s';",tablename.c_str());
 	return statement.step()==Statement::ReturnCodeRow && statement.step()==Statement::ReturnCodeDone;
 }
 
+bool DB::Connection::indexExists(const std::string &indexname)
+{
+	Statement statement = prepare("select name from sqlite_master where type='index' and name='%s';",indexname.c_str());
+	return statement.step()==Statement::ReturnCodeRow && statement.step()==Statement::ReturnCodeDone;
+}
+
+bool DB::Connection::columnExists(const std::string &tablename, const std::string &columnname)
+{
+	Statement statement = prepare("select name from pragma_table_info('%s') where name='%s';",tablename.c_str(),columnname.c_str());
+	return statement.step()==Statement::ReturnCodeRow && statement.step()==Statement::ReturnCodeDone;
+}
+
+bool DB::Connection::getSchemaVersion(int &version)
+{
+	Statement statement = prepare("pragma user_version;");
+	Result result = perform(statement);
+	if (!result.isValid())
+		return false;
+	version = result.getInt(1);
+	return true;
+}
+
+bool DB::Connection::setSchemaVersion(int version)
+{
+	Statement statement = prepare("pragma user_version=%d;",version);
+	return execute(statement);
+}
+
+bool DB::Connection::getDataVersion(long long &version)
+{
+	Statement statement = prepareCached("pragma data_version");
+	Result result = perform(statement);
+	if (!result.isValid())
+		return false;
+	version = result.getLongLong(1);
+	return true;
+}
+
+int DB::Connection::totalChanges()
+{
+	return sqlite3_total_changes(_db);
+}
+
 long long DB::Connection::lastInsertRowId()
 {
 	return sqlite3_last_insert_rowid(_db);
@@ -896,31 +1206,31 @@ bool DB::Connection::inTransaction()
 
 bool DB::Connection::beginTransactionRO()
 {
-	Statement statement = prepare("begin");
+	Statement statement = prepareCached("begin");
 	return statement.step()==Statement::ReturnCodeDone;
 }
 
 bool DB::Connection::endTransactionRO()
 {
-	Statement statement = prepare("end");
+	Statement statement = prepareCached("end");
 	return statement.step()==Statement::ReturnCodeDone;
 }
 
 bool DB::Connection::beginTransactionRW()
 {
-	Statement statement = prepare("begin immediate");
+	Statement statement = prepareCached("begin immediate");
 	return statement.step()==Statement::ReturnCodeDone;
 }
 
 bool DB::Connection::commitTransaction()
 {
-	Statement statement = prepare("commit");
+	Statement statement = prepareCached("commit");
 	return statement.step()==Statement::ReturnCodeDone;
 }
 
 bool DB::Connection::rollbackTransaction()
 {
-	Statement statement = prepare("rollback");
+	Statement statement = prepareCached("rollback");
 	return statement.step()==Statement::ReturnCodeDone;
 }
 
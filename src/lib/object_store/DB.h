@@ -36,7 +36,10 @@
 #include "config.h"
 
 #include <string>
+#include <map>
+#include <set>
 #include <sqlite3.h>
+#include "MutexFactory.h"
 
 namespace DB {
 
@@ -153,6 +156,13 @@ public:
 	const std::string &dbpath();
 
 	Statement prepare(const std::string &format, ...);
+
+	// Retrieve a prepared statement for a parameterised query from the
+	// statement cache of this connection, preparing it when needed. The
+	// statement is reset and all bindings are cleared. Values must be bound
+	// using Bindings and never be formatted into the query.
+	Statement prepareCached(const std::string &query);
+
 	Result perform(Statement &statement);
 	bool execute(Statement &statement);
 
@@ -160,6 +170,20 @@ public:
 	void close();
 
 	bool tableExists(const std::string &tablename);
+	bool indexExists(const std::string &indexname);
+	bool columnExists(const std::string &tablename, const std::string &columnname);
+
+	// Retrieve or record the version of the schema of the database
+	bool getSchemaVersion(int &version);
+	bool setSchemaVersion(int version);
+
+	// Retrieve a counter that changes whenever another connection (possibly
+	// in another process) has committed changes to the database.
+	bool getDataVersion(long long &version);
+
+	// Number of rows modified through this connection since it was opened.
+	int totalChanges();
+
 	long long lastInsertRowId();
 
 	bool inTransaction();
@@ -171,13 +195,66 @@ public:
 
 	// Set the busy timeout that the database layer will wait for a database lock to become available.
 	bool setBusyTimeout(int ms);
+
+	// Set the journal mode of the database and the synchronous mode and
+	// automatic checkpoint threshold (in pages) of this connection. With
+	// write-ahead logging readers and the writer do not block each other.
+	// The settings are also applied to the read connections.
+	bool setJournal(bool wal, const std::string &synchronous, int checkpoint);
+
+	// Allow up to the given number of read connections to be opened next
+	// to this connection.
+	void setMaxReaders(size_t maxReaders);
+
+	// Retrieve the read connection of the calling thread, opening it when
+	// needed. A read connection refuses to modify the database. Returns this
+	// connection when read connections are disabled or all of them are in
+	// use by other threads, and while a transaction is in progress on this
+	// connection, so that its uncommitted changes remain visible. The read
+	// connection is closed when its thread exits (on Windows only when
+	// this connection is closed).
+	Connection *reader();
 private:
 	std::string _dbdir;
+	std::string _dbname;
 	std::string _dbpath;
 	sqlite3 *_db;
 
+	// The cached prepared statements indexed by query
+	std::map<std::string,Statement> _statements;
+	Mutex *_statementsMutex;
+
+	// Guards the reference counts of the cached statements, which are
+	// shared between threads
+	Mutex *_cachedHandlesMutex;
+
+	// The synchronous mode and checkpoint threshold for the read connections
+	std::string _synchronous;
+	int _checkpoint;
+
+	// The read connection of a thread, kept as the value of the thread key
+	// of the connection it belongs to
+	struct Reader
+	{
+		Connection *owner;
+		Connection *connection;
+	};
+
+	// The read connections of the threads that use them; the thread key is
+	// created once read connections are allowed
+	void *_readerKey;
+	std::set<Reader*> _readers;
+	size_t _openReaders;
+	size_t _maxReaders;
+	Mutex *_readersMutex;
+
 	Connection(const std::string &dbdir, const std::string &dbname);
 
+	// Close the read connection of a thread that exits
+	static void releaseReader(void *reader);
+
+	bool setSynchronous(const std::string &synchronous, int checkpoint);
+
 	// disable evil constructors
 	Connection(const Connection &);
 	void operator=(const Connection&);
@@ -45,13 +45,13 @@
 
 // Create an object that can access a record, but don't do anything yet.
 DBObject::DBObject(DB::Connection *connection, ObjectStoreToken *token)
-	: _mutex(MutexFactory::i()->getMutex()), _connection(connection), _token(token), _objectId(0), _transaction(NULL)
+	: _mutex(MutexFactory::i()->getMutex()), _connection(connection), _token(token), _objectId(0), _transaction(NULL), _attributesLoaded(false), _versionConnection(NULL), _dataVersion(-1), _totalChanges(0), _generation(-1)
 {
 
 }
 
 DBObject::DBObject(DB::Connection *connection, ObjectStoreToken *token, long long objectId)
-	: _mutex(MutexFactory::i()->getMutex()), _connection(connection), _token(token), _objectId(objectId), _transaction(NULL)
+	: _mutex(MutexFactory::i()->getMutex()), _connection(connection), _token(token), _objectId(objectId), _transaction(NULL), _attributesLoaded(false), _versionConnection(NULL), _dataVersion(-1), _totalChanges(0), _generation(-1)
 {
 }
 
@@ -80,6 +80,17 @@ void DBObject::dropConnection()
 	_connection = NULL;
 }
 
+// The tables that hold the attributes of the objects
+static const char *attributeTables[] = {
+	"attribute_text",
+	"attribute_integer",
+	"attribute_binary",
+	"attribute_array",
+	"attribute_boolean",
+	"attribute_datetime",
+	"attribute_real"
+};
+
 // create tables to support storage of attributes for the DBObject
 bool DBObject::createTables()
 {
@@ -92,7 +103,7 @@ bool DBObject::createTables()
 	}
 
 	// Create the tables inside the database
-	DB::Statement cr_object = _connection->prepare("create table object (id integer primary key autoincrement);");
+	DB::Statement cr_object = _connection->prepare("create table object (id integer primary key autoincrement, generation integer not null default 0);");
 	if (!_connection->execute(cr_object))
 	{
 		ERROR_MSG("Failed to create \"object\" table");
@@ -197,6 +208,104 @@ bool DBObject::createTables()
 		return false;
 	}
 
+	// Attributes are always looked up by object and type
+	for (size_t i = 0; i < sizeof(attributeTables)/sizeof(attributeTables[0]); ++i)
+	{
+		if (!createIndex(attributeTables[i]) || !createTriggers(attributeTables[i]))
+			return false;
+	}
+
+	return true;
+}
+
+bool DBObject::createIndexes()
+{
+	MutexLocker lock(_mutex);
+
+	if (_connection == NULL)
+	{
+		ERROR_MSG("Object is not connected to the database.");
+		return false;
+	}
+
+	for (size_t i = 0; i < sizeof(attributeTables)/sizeof(attributeTables[0]); ++i)
+	{
+		if (!createIndex(attributeTables[i]))
+			return false;
+	}
+
+	return true;
+}
+
+// Create the index on (object_id,type) for the given attribute table
+// Calling function must lock the mutex
+bool DBObject::createIndex(const char *table)
+{
+	DB::Statement cr_index = _connection->prepare(
+		"create index if not exists %s_object_type on %s (object_id,type)",
+		table, table);
+	if (!_connection->execute(cr_index))
+	{
+		ERROR_MSG("Failed to create index on \"%s\" table", table);
+		return false;
+	}
+
+	return true;
+}
+
+bool DBObject::createGenerations()
+{
+	MutexLocker lock(_mutex);
+
+	if (_connection == NULL)
+	{
+		ERROR_MSG("Object is not connected to the database.");
+		return false;
+	}
+
+	if (!_connection->columnExists("object", "generation"))
+	{
+		DB::Statement alter_object = _connection->prepare(
+			"alter table object add column generation integer not null default 0");
+		if (!_connection->execute(alter_object))
+		{
+			ERROR_MSG("Failed to add the generation column to the \"object\" table");
+			return false;
+		}
+	}
+
+	for (size_t i = 0; i < sizeof(attributeTables)/sizeof(attributeTables[0]); ++i)
+	{
+		if (!createTriggers(attributeTables[i]))
+			return false;
+	}
+
+	return true;
+}
+
+// Create the triggers that advance the generation of an object whenever
+// one of its attributes in the given attribute table changes. Any writer
+// of the database, also one in another process, thereby lets readers know
+// that their cached attributes are outdated.
+// Calling function must lock the mutex
+bool DBObject::createTriggers(const char *table)
+{
+	static const char *events[] = { "insert", "update", "delete" };
+	static const char *rows[] = { "new", "new", "old" };
+
+	for (size_t i = 0; i < sizeof(events)/sizeof(events[0]); ++i)
+	{
+		DB::Statement cr_trigger = _connection->prepare(
+			"create trigger if not exists %s_%s_generation after %s on %s "
+			"begin update object set generation=generation+1 where id=%s.object_id; end",
+			table, events[i], events[i], table, rows[i]);
+		if (!_connection->execute(cr_trigger))
+		{
+			ERROR_MSG("Failed to create %s trigger on \"%s\" table", events[i], table);
+			return false;
+		}
+	}
+
 	return true;
 }
 
@@ -293,10 +402,9 @@ bool DBObject::find(long long objectId)
 	}
 
 	// find the object in the database for the given object_id
-	DB::Statement statement = _connection->prepare(
-				"select id from object where id=%lld",
-				objectId);
-	if (!statement.isValid()) {
+	DB::Statement statement = _connection->prepareCached(
+				"select id from object where id=?");
+	if (!statement.isValid() || !DB::Bindings(statement).bindInt64(1, objectId)) {
 		ERROR_MSG("Preparing object selection statement failed");
 		return false;
 	}
@@ -307,6 +415,11 @@ bool DBObject::find(long long objectId)
 		return false;
 	}
 
+	if (_objectId != objectId)
+	{
+		dropAttributes();
+	}
+
 	_objectId = objectId;
 	return true;
 }
@@ -321,13 +434,15 @@ bool DBObject::insert()
 		return false;
 	}
 
-	DB::Statement statement = _connection->prepare("insert into object default values");
+	DB::Statement statement = _connection->prepareCached("insert into object default values");
 
 	if (!_connection->execute(statement)) {
 		ERROR_MSG("Failed to insert a new object");
 		return false;
 	}
 
+	dropAttributes();
+
 	_objectId = _connection->lastInsertRowId();
 	return _objectId != 0;
 }
@@ -342,13 +457,15 @@ bool DBObject::remove()
 		return false;
 	}
 
-	DB::Statement statement = _connection->prepare("delete from object where id=%lld",_objectId);
+	DB::Statement statement = _connection->prepareCached("delete from object where id=?");
 
-	if (!_connection->execute(statement)) {
+	if (!DB::Bindings(statement).bindInt64(1, _objectId) || !_connection->execute(statement)) {
 		ERROR_MSG("Failed to remove an existing object");
 		return false;
 	}
 
+	dropAttributes();
+
 	_objectId = 0;
 	return true;
 }
@@ -360,37 +477,6 @@ long long DBObject::objectId()
 	return _objectId;
 }
 
-static bool isModifiable(CK_ATTRIBUTE_TYPE type)
-{
-	switch (type) {
-	case CKA_LABEL:
-	case CKA_TRUSTED:
-	case CKA_ID:
-	case CKA_ISSUER:
-	case CKA_SERIAL_NUMBER:
-	case CKA_START_DATE:
-	case CKA_END_DATE:
-	case CKA_DERIVE:
-	case CKA_SUBJECT:
-	case CKA_ENCRYPT:
-	case CKA_VERIFY:
-	case CKA_VERIFY_RECOVER:
-	case CKA_WRAP:
-	case CKA_SENSITIVE:
-	case CKA_DECRYPT:
-	case CKA_SIGN:
-	case CKA_SIGN_RECOVER:
-	case CKA_UNWRAP:
-	case CKA_EXTRACTABLE:
-	case CKA_OS_TOKENFLAGS:
-	case CKA_OS_SOPIN:
-	case CKA_OS_USERPIN:
-		return true;
-	default:
-		return false;
-	}
-}
-
 enum AttributeKind {
 	akUnknown,
 	akBoolean,
@@ -658,7 +744,143 @@ static bool encodeArray(ByteString& value, const std::map<CK_ATTRIBUTE_TYPE,OSAt
 	return true;
 }
 
-OSAttribute *DBObject::accessAttribute(CK_ATTRIBUTE_TYPE type)
+// Bind the attribute type and the object id to two consecutive parameters of a statement
+static bool bindAttribute(DB::Statement &statement, int index, CK_ATTRIBUTE_TYPE type, long long objectId)
+{
+	DB::Bindings bindings(statement);
+
+	return bindings.bindInt64(index, static_cast<long long>(type)) &&
+	       bindings.bindInt64(index + 1, objectId);
+}
+
+// Load all attributes of the object from all attribute tables in one go.
+// Attributes that have been retrieved before are left untouched.
+// Calling function must lock the mutex
+bool DBObject::loadAttributes(DB::Connection *connection)
+{
+	DB::Statement statement = connection->prepareCached(
+		"select type,value,1 from attribute_boolean where object_id=?1 "
+		"union all select type,value,2 from attribute_integer where object_id=?1 "
+		"union all select type,value,3 from attribute_binary where object_id=?1 "
+		"union all select type,value,4 from attribute_array where object_id=?1");
+	if (!statement.isValid() || !DB::Bindings(statement).bindInt64(1, _objectId))
+	{
+		return false;
+	}
+
+	// A failed step must not be mistaken for the end of the attributes
+	DB::Statement::ReturnCode rv = statement.step();
+	if (rv == DB::Statement::ReturnCodeDone)
+	{
+		// The object has no attributes at all
+		return true;
+	}
+	if (rv != DB::Statement::ReturnCodeRow)
+	{
+		return false;
+	}
+
+	DB::Result result(statement);
+	do
+	{
+		CK_ATTRIBUTE_TYPE type = static_cast<CK_ATTRIBUTE_TYPE>(result.getULongLong(1));
+
+		if (_attributes.find(type) != _attributes.end())
+			continue;
+
+		OSAttribute *attr = NULL;
+		switch (result.getInt(3))
+		{
+			case 1:
+				attr = new OSAttribute(result.getInt(2) != 0);
+				break;
+			case 2:
+				attr = new OSAttribute(static_cast<unsigned long>(result.getULongLong(2)));
+				break;
+			case 3:
+				attr = new OSAttribute(ByteString(result.getBinary(2), result.getFieldLength(2)));
+				break;
+			case 4:
+			{
+				std::map<CK_ATTRIBUTE_TYPE,OSAttribute> value;
+				if (!decodeArray(value, result.getBinary(2), result.getFieldLength(2)))
+				{
+					return false;
+				}
+				attr = new OSAttribute(value);
+				break;
+			}
+		}
+
+		if (attr != NULL)
+		{
+			_attributes[type] = attr;
+		}
+	}
+	while ((rv = statement.step()) == DB::Statement::ReturnCodeRow);
+
+	return rv == DB::Statement::ReturnCodeDone;
+}
+
+// Drop the cached attributes when the object may have been changed since
+// they were retrieved. Changes made by other connections are detected by the
+// data version of the database, changes made through the given connection by
+// its change counter. Only when either has moved is the generation of the
+// object itself consulted, so the attributes stay cached as long as nobody
+// touches this particular object.
+// Calling function must lock the mutex
+void DBObject::validateAttributes(DB::Connection *connection)
+{
+	long long dataVersion = -1;
+	if (!connection->getDataVersion(dataVersion))
+	{
+		dropAttributes();
+		return;
+	}
+
+	// The counters of different connections cannot be compared
+	int totalChanges = connection->totalChanges();
+	if (connection == _versionConnection && dataVersion == _dataVersion && totalChanges == _totalChanges)
+		return;
+
+	long long generation = -1;
+	DB::Statement statement = connection->prepareCached("select generation from object where id=?");
+	if (statement.isValid() && DB::Bindings(statement).bindInt64(1, _objectId))
+	{
+		DB::Result result = connection->perform(statement);
+		if (result.isValid())
+		{
+			generation = result.getLongLong(1);
+		}
+	}
+
+	// Without a generation the object has to be assumed to be changed
+	if (generation == -1 || generation != _generation)
+	{
+		dropAttributes();
+	}
+
+	_versionConnection = connection;
+	_dataVersion = dataVersion;
+	_totalChanges = totalChanges;
+	_generation = generation;
+}
+
+// Forget all cached attributes
+// Calling function must lock the mutex
+void DBObject::dropAttributes()
+{
+	for (std::map<CK_ATTRIBUTE_TYPE,OSAttribute*>::iterator it = _attributes.begin(); it!=_attributes.end(); ++it) {
+		delete it->second;
+	}
+	_attributes.clear();
+	_attributesLoaded = false;
+
+	// Validate the next time the attributes are needed
+	_dataVersion = -1;
+}
+
+OSAttribute *DBObject::accessAttribute(DB::Connection *connection, CK_ATTRIBUTE_TYPE type)
 {
 	switch (attributeKind(type))
 	{
@@ -667,15 +889,13 @@ OSAttribute *DBObject::accessAttribute(CK_ATTRIBUTE_TYPE type)
 		case akBoolean:
 		{
 			// try to find the attribute in the boolean attribute table
-			DB::Statement statement = _connection->prepare(
-				"select value from attribute_boolean where type=%lu and object_id=%lld",
-				type,
-				_objectId);
-			if (!statement.isValid())
+			DB::Statement statement = connection->prepareCached(
+				"select value from attribute_boolean where type=? and object_id=?");
+			if (!statement.isValid() || !bindAttribute(statement, 1, type, _objectId))
 			{
 				return NULL;
 			}
-			DB::Result result = _connection->perform(statement);
+			DB::Result result = connection->perform(statement);
 			if (!result.isValid())
 			{
 				return NULL;
@@ -708,15 +928,13 @@ OSAttribute *DBObject::accessAttribute(CK_ATTRIBUTE_TYPE type)
 		case akInteger:
 		{
 			// try to find the attribute in the integer attribute table
-			DB::Statement statement = _connection->prepare(
-				"select value from attribute_integer where type=%lu and object_id=%lld",
-				type,
-				_objectId);
-			if (!statement.isValid())
+			DB::Statement statement = connection->prepareCached(
+				"select value from attribute_integer where type=? and object_id=?");
+			if (!statement.isValid() || !bindAttribute(statement, 1, type, _objectId))
 			{
 				return NULL;
 			}
-			DB::Result result = _connection->perform(statement);
+			DB::Result result = connection->perform(statement);
 			if (!result.isValid())
 			{
 				return NULL;
@@ -749,15 +967,13 @@ OSAttribute *DBObject::accessAttribute(CK_ATTRIBUTE_TYPE type)
 		case akBinary:
 		{
 			// try to find the attribute in the binary attribute table
-			DB::Statement statement = _connection->prepare(
-				"select value from attribute_binary where type=%lu and object_id=%lld",
-				type,
-				_objectId);
-			if (!statement.isValid())
+			DB::Statement statement = connection->prepareCached(
+				"select value from attribute_binary where type=? and object_id=?");
+			if (!statement.isValid() || !bindAttribute(statement, 1, type, _objectId))
 			{
 				return NULL;
 			}
-			DB::Result result = _connection->perform(statement);
+			DB::Result result = connection->perform(statement);
 			if (!result.isValid())
 			{
 				return NULL;
@@ -792,15 +1008,13 @@ OSAttribute *DBObject::accessAttribute(CK_ATTRIBUTE_TYPE type)
 		case akArray:
 		{
 			// try to find the attribute in the array attribute table
-			DB::Statement statement = _connection->prepare(
-				"select value from attribute_array where type=%lu and object_id=%lld",
-				type,
-				_objectId);
-			if (!statement.isValid())
+			DB::Statement statement = connection->prepareCached(
+				"select value from attribute_array where type=? and object_id=?");
+			if (!statement.isValid() || !bindAttribute(statement, 1, type, _objectId))
 			{
 				return NULL;
 			}
-			DB::Result result = _connection->perform(statement);
+			DB::Result result = connection->perform(statement);
 			if (!result.isValid())
 			{
 				return NULL;
@@ -872,17 +1086,47 @@ OSAttribute* DBObject::getAttributeDB(CK_ATTRIBUTE_TYPE type)
 			return it->second;
 	}
 
-	// If the attribute exists and is non-modifiable then return a previously retrieved attribute value.
-	if (!isModifiable(type))
+	// Outside a transaction the attributes are read through the read
+	// connection of the calling thread, so readers do not queue up behind
+	// each other on the connection of the token.
+	DB::Connection *connection = _transaction ? _connection : _connection->reader();
+
+	validateAttributes(connection);
+
+	// Return a previously retrieved attribute value
+	std::map<CK_ATTRIBUTE_TYPE,OSAttribute*>::iterator it =	 _attributes.find(type);
+	if (it != _attributes.end())
+	{
+		return it->second;
+	}
+
+	// Attributes are usually needed together, so retrieve all of them at
+	// once. This is not done during a transaction, as the values could
+	// still be rolled back.
+	if (!_attributesLoaded && _transaction == NULL)
 	{
-		std::map<CK_ATTRIBUTE_TYPE,OSAttribute*>::iterator it =	 _attributes.find(type);
+		if (!loadAttributes(connection))
+		{
+			dropAttributes();
+			return accessAttribute(connection, type);
+		}
+
+		_attributesLoaded = true;
+
+		it = _attributes.find(type);
 		if (it != _attributes.end())
 		{
 			return it->second;
 		}
 	}
 
-	return accessAttribute(type);
+	// All attributes of the object are known, so it does not have this one
+	if (_attributesLoaded)
+	{
+		return NULL;
+	}
+
+	return accessAttribute(connection, type);
 }
 
 // Check if the specified attribute exists
@@ -1006,30 +1250,30 @@ bool DBObject::setAttribute(CK_ATTRIBUTE_TYPE type, const OSAttribute& attribute
 		if (attr->isBooleanAttribute())
 		{
 			// update boolean attribute
-			statement = _connection->prepare(
-					"update attribute_boolean set value=%d where type=%lu and object_id=%lld",
-					attribute.getBooleanValue() ? 1 : 0,
-					type,
-					_objectId);
+			statement = _connection->prepareCached(
+					"update attribute_boolean set value=? where type=? and object_id=?");
+			if (!DB::Bindings(statement).bindInt(1, attribute.getBooleanValue() ? 1 : 0))
+			{
+				return false;
+			}
 			bindByteString = false;
 		}
 		else if (attr->isUnsignedLongAttribute())
 		{
 			// update integer attribute
-			statement = _connection->prepare(
-					"update attribute_integer set value=%lld where type=%lu and object_id=%lld",
-					static_cast<long long>(attribute.getUnsignedLongValue()),
-					type,
-					_objectId);
+			statement = _connection->prepareCached(
+					"update attribute_integer set value=? where type=? and object_id=?");
+			if (!DB::Bindings(statement).bindInt64(1, static_cast<long long>(attribute.getUnsignedLongValue())))
+			{
+				return false;
+			}
 			bindByteString = false;
 		}
 		else if (attr->isByteStringAttribute())
 		{
 			// update binary attribute
-			statement = _connection->prepare(
-					"update attribute_binary set value=? where type=%lu and object_id=%lld",
-					type,
-					_objectId);
+			statement = _connection->prepareCached(
+					"update attribute_binary set value=? where type=? and object_id=?");
 			//bindByteString = true;
 		}
 		else if (attr->isArrayAttribute())
@@ -1041,10 +1285,8 @@ bool DBObject::setAttribute(CK_ATTRIBUTE_TYPE type, const OSAttribute& attribute
 				return false;
 			}
 
-			statement = _connection->prepare(
-					"update attribute_array set value=? where type=%lu and object_id=%lld",
-					type,
-					_objectId);
+			statement = _connection->prepareCached(
+					"update attribute_array set value=? where type=? and object_id=?");
 			DB::Bindings(statement).bindBlob(1, value.const_byte_str(), value.size(), SQLITE_TRANSIENT);
 			bindByteString = false;
 		}
@@ -1057,7 +1299,7 @@ bool DBObject::setAttribute(CK_ATTRIBUTE_TYPE type, const OSAttribute& attribute
 		// Statement is valid when a prepared statement has been attached to it.
 		if (statement.isValid())
 		{
-			if (!_connection->execute(statement))
+			if (!bindAttribute(statement, 2, type, _objectId) || !_connection->execute(statement))
 			{
 				ERROR_MSG("Failed to update attribute %lu for object %lld",type,_objectId);
 				return false;
@@ -1082,29 +1324,23 @@ bool DBObject::setAttribute(CK_ATTRIBUTE_TYPE type, const OSAttribute& attribute
 	if (attribute.isBooleanAttribute())
 	{
 		// Could not update it, so we need to insert it.
-		statement = _connection->prepare(
-					"insert into attribute_boolean (value,type,object_id) values (%d,%lu,%lld)",
-					attribute.getBooleanValue() ? 1 : 0,
-					type,
-					_objectId);
+		statement = _connection->prepareCached(
+					"insert into attribute_boolean (value,type,object_id) values (?,?,?)");
+		DB::Bindings(statement).bindInt(1, attribute.getBooleanValue() ? 1 : 0);
 
 	}
 	else if (attribute.isUnsignedLongAttribute())
 	{
 		// Could not update it, so we need to insert it.
-		statement = _connection->prepare(
-					"insert into attribute_integer (value,type,object_id) values (%lld,%lu,%lld)",
-					static_cast<long long>(attribute.getUnsignedLongValue()),
-					type,
-					_objectId);
+		statement = _connection->prepareCached(
+					"insert into attribute_integer (value,type,object_id) values (?,?,?)");
+		DB::Bindings(statement).bindInt64(1, static_cast<long long>(attribute.getUnsignedLongValue()));
 	}
 	else if (attribute.isByteStringAttribute())
 	{
 		// Could not update it, so we need to insert it.
-		statement = _connection->prepare(
-					"insert into attribute_binary (value,type,object_id) values (?,%lu,%lld)",
-					type,
-					_objectId);
+		statement = _connection->prepareCached(
+					"insert into attribute_binary (value,type,object_id) values (?,?,?)");
 
 		DB::Bindings(statement).bindBlob(1, attribute.getByteStringValue().const_byte_str(), attribute.getByteStringValue().size(), SQLITE_STATIC);
 	}
@@ -1117,17 +1353,15 @@ bool DBObject::setAttribute(CK_ATTRIBUTE_TYPE type, const OSAttribute& attribute
 			return false;
 		}
 
-		statement = _connection->prepare(
-				"insert into attribute_array (value,type,object_id) values (?,%lu,%lld)",
-				type,
-				_objectId);
+		statement = _connection->prepareCached(
+				"insert into attribute_array (value,type,object_id) values (?,?,?)");
 		DB::Bindings(statement).bindBlob(1, value.const_byte_str(), value.size(), SQLITE_TRANSIENT);
 	}
 
 	// Statement is valid when a prepared statement has been attached to it.
 	if (statement.isValid())
 	{
-		if (!_connection->execute(statement))
+		if (!bindAttribute(statement, 2, type, _objectId) || !_connection->execute(statement))
 		{
 			ERROR_MSG("Failed to insert attribute %lu for object %lld",type,_objectId);
 			return false;
@@ -1171,40 +1405,32 @@ bool DBObject::deleteAttribute(CK_ATTRIBUTE_TYPE type)
 	if (attr->isBooleanAttribute())
 	{
 		// delete boolean attribute
-		statement = _connection->prepare(
-				"delete from attribute_boolean where type=%lu and object_id=%lld",
-				type,
-				_objectId);
+		statement = _connection->prepareCached(
+				"delete from attribute_boolean where type=? and object_id=?");
 	}
 	else if (attr->isUnsignedLongAttribute())
 	{
 		// delete integer attribute
-		statement = _connection->prepare(
-				"delete from attribute_integer where type=%lu and object_id=%lld",
-				type,
-				_objectId);
+		statement = _connection->prepareCached(
+				"delete from attribute_integer where type=? and object_id=?");
 	}
 	else if (attr->isByteStringAttribute())
 	{
 		// delete binary attribute
-		statement = _connection->prepare(
-				"delete from attribute_binary where type=%lu and object_id=%lld",
-				type,
-				_objectId);
+		statement = _connection->prepareCached(
+				"delete from attribute_binary where type=? and object_id=?");
 	}
 	else if (attr->isArrayAttribute())
 	{
 		// delete array attribute
-		statement = _connection->prepare(
-				"delete from attribute_array where type=%lu and object_id=%lld",
-				type,
-				_objectId);
+		statement = _connection->prepareCached(
+				"delete from attribute_array where type=? and object_id=?");
 	}
 
 	// Statement is valid when a prepared statement has been attached to it.
 	if (statement.isValid())
 	{
-		if (!_connection->execute(statement))
+		if (!bindAttribute(statement, 1, type, _objectId) || !_connection->execute(statement))
 		{
 			ERROR_MSG("Failed to delete attribute %lu for object %lld",type,_objectId);
 			return false;
@@ -1300,7 +1526,16 @@ bool DBObject::commitTransaction()
 	// Copy the values from the internally stored transaction to the _attributes field.
 	for (std::map<CK_ATTRIBUTE_TYPE,OSAttribute*>::iterator it = _transaction->begin(); it!=_transaction->end(); ++it) {
 		std::map<CK_ATTRIBUTE_TYPE,OSAttribute*>::iterator attr_it = _attributes.find(it->first);
-		if (attr_it == _attributes.end())
+		if (it->second == NULL)
+		{
+			// The attribute was deleted during the transaction
+			if (attr_it != _attributes.end())
+			{
+				delete attr_it->second;
+				_attributes.erase(attr_it);
+			}
+		}
+		else if (attr_it == _attributes.end())
 		{
 			_attributes[it->first] = it->second;
 		}
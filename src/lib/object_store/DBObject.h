@@ -65,6 +65,14 @@ public:
 	// drop tables that support storage of attributes for the object.
 	bool dropTables();
 
+	// create the indexes on (object_id,type) of the attribute tables when
+	// they are missing.
+	bool createIndexes();
+
+	// add the generation column to the object table together with the
+	// triggers that maintain it when they are missing.
+	bool createGenerations();
+
 	// Find an existing object.
 	bool find(long long objectId);
 
@@ -134,8 +142,22 @@ private:
 	std::map<CK_ATTRIBUTE_TYPE,OSAttribute*> _attributes;
 	std::map<CK_ATTRIBUTE_TYPE,OSAttribute*> *_transaction;
 
+	// Have all attributes been loaded in one go?
+	bool _attributesLoaded;
+
+	// The state of the database when the cached attributes were validated
+	DB::Connection *_versionConnection;
+	long long _dataVersion;
+	int _totalChanges;
+	long long _generation;
+
+	bool loadAttributes(DB::Connection *connection);
+	void validateAttributes(DB::Connection *connection);
+	void dropAttributes();
+	bool createIndex(const char *table);
+	bool createTriggers(const char *table);
 	OSAttribute* getAttributeDB(CK_ATTRIBUTE_TYPE type);
-	OSAttribute* accessAttribute(CK_ATTRIBUTE_TYPE type);
+	OSAttribute* accessAttribute(DB::Connection *connection, CK_ATTRIBUTE_TYPE type);
 };
 
 #endif // !_SOFTHSM_V2_DBOBJECT_H
@@ -35,6 +35,7 @@
 
 #include "config.h"
 #include "log.h"
+#include "Configuration.h"
 #include "OSAttributes.h"
 #include "OSAttribute.h"
 #include "OSPathSep.h"
@@ -58,6 +59,18 @@
 const char * const DBTOKEN_FILE = "sqlite3.db";
 const long long DBTOKEN_OBJECT_TOKENINFO = 1;
 
+// The version of the database schema, recorded in the user_version of the database
+//  0 : attribute tables without indexes
+//  2 : attribute tables indexed on (object_id,type)
+//  3 : objects carry a generation that is advanced by triggers on every attribute change
+const int DBTOKEN_SCHEMA_VERSION = 3;
+
+// The defaults for the connections to the token database
+const bool DBTOKEN_WAL = true;
+const char * const DBTOKEN_SYNCHRONOUS = "full";
+const int DBTOKEN_CHECKPOINT = 1000;
+const int DBTOKEN_READERS = 4;
+
 // Constructor for creating a new token.
 DBToken::DBToken(const std::string &baseDir, const std::string &tokenName, const ByteString &label, const ByteString &serial)
 	: _connection(NULL), _tokenMutex(NULL)
@@ -109,12 +122,17 @@ DBToken::DBToken(const std::string &baseDir, const std::string &tokenName, const
 		return;
 	}
 
+	setupConnection();
+
 	// Create a DBObject for the established connection to the database.
 	DBObject tokenObject(_connection);
 
 	// First create the tables that support storage of object attributes and then insert the object containing
 	// the token info into the database.
-	if (!tokenObject.createTables() || !tokenObject.insert() || tokenObject.objectId()!=DBTOKEN_OBJECT_TOKENINFO)
+	if (!tokenObject.createTables() ||
+		!_connection->setSchemaVersion(DBTOKEN_SCHEMA_VERSION) ||
+		!tokenObject.insert() ||
+		tokenObject.objectId()!=DBTOKEN_OBJECT_TOKENINFO)
 	{
 		tokenObject.dropConnection();
 
@@ -199,6 +217,8 @@ DBToken::DBToken(const std::string &baseDir, const std::string &tokenName)
 		return;
 	}
 
+	setupConnection();
+
 	// Find the DBObject for the established connection to the database.
 	DBObject tokenObject(_connection);
 
@@ -215,6 +235,12 @@ DBToken::DBToken(const std::string &baseDir, const std::string &tokenName)
 		return;
 	}
 
+	// The token remains usable with an older schema, only slower
+	if (!migrateSchema())
+	{
+		WARNING_MSG("Failed to update the schema of the token database at \"%s\"", tokenPath.c_str());
+	}
+
 	_tokenMutex = MutexFactory::i()->getMutex();
 
 	// Success!
@@ -617,11 +643,13 @@ void DBToken::getObjects(std::set<OSObject*> &objects)
 {
 	if (_connection == NULL) return;
 
-	if (!_connection->beginTransactionRO()) return;
+	DB::Connection *connection = _connection->reader();
+
+	if (!connection->beginTransactionRO()) return;
 
-	DB::Statement statement = _connection->prepare("select id from object limit -1 offset 1");
+	DB::Statement statement = connection->prepareCached("select id from object limit -1 offset 1");
 
-	DB::Result result = _connection->perform(statement);
+	DB::Result result = connection->perform(statement);
 
 	if (result.isValid())
 	{
@@ -644,7 +672,7 @@ void DBToken::getObjects(std::set<OSObject*> &objects)
 		} while (result.nextRow());
 	}
 
-	_connection->endTransactionRO();
+	connection->endTransactionRO();
 }
 
 // Create a new object
@@ -872,3 +900,66 @@ bool DBToken::resetToken(const ByteString& label)
 
 	return true;
 }
+
+// Apply the configured journal mode, synchronous mode and checkpoint policy
+// to the connection and allow it to open read connections for concurrent readers
+void DBToken::setupConnection()
+{
+	bool wal = Configuration::i()->getBool("objectstore.db.wal", DBTOKEN_WAL);
+	std::string synchronous = Configuration::i()->getString("objectstore.db.synchronous", DBTOKEN_SYNCHRONOUS);
+	int checkpoint = Configuration::i()->getInt("objectstore.db.checkpoint", DBTOKEN_CHECKPOINT);
+	int readers = Configuration::i()->getInt("objectstore.db.readers", DBTOKEN_READERS);
+
+	if (!_connection->setJournal(wal, synchronous, checkpoint < 0 ? DBTOKEN_CHECKPOINT : checkpoint))
+	{
+		WARNING_MSG("Failed to configure the connection to the token database at \"%s\"", _connection->dbpath().c_str());
+	}
+
+	_connection->setMaxReaders(readers < 0 ? 0 : readers);
+}
+
+// Bring the schema of a database created by an older version up to date
+bool DBToken::migrateSchema()
+{
+	int version = 0;
+	if (!_connection->getSchemaVersion(version))
+	{
+		ERROR_MSG("Failed to read the schema version of the token database");
+		return false;
+	}
+
+	if (version >= DBTOKEN_SCHEMA_VERSION)
+		return true;
+
+	if (!_connection->beginTransactionRW())
+	{
+		ERROR_MSG("Failed to start a transaction for updating the token database schema");
+		return false;
+	}
+
+	// Check again, another process may have updated the schema in the meantime
+	if (!_connection->getSchemaVersion(version))
+	{
+		_connection->rollbackTransaction();
+		return false;
+	}
+
+	if (version >= DBTOKEN_SCHEMA_VERSION)
+	{
+		_connection->rollbackTransaction();
+		return true;
+	}
+
+	DEBUG_MSG("Updating token database schema from version %d to %d", version, DBTOKEN_SCHEMA_VERSION);
+
+	DBObject tables(_connection);
+	if (!tables.createIndexes() ||
+		!tables.createGenerations() ||
+		!_connection->setSchemaVersion(DBTOKEN_SCHEMA_VERSION))
+	{
+		_connection->rollbackTransaction();
+		return false;
+	}
+
+	return _connection->commitTransaction();
+}
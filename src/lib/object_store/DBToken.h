@@ -116,6 +116,12 @@ public:
 	virtual bool resetToken(const ByteString& label);
 
 private:
+	// Configure the connection to the database
+	void setupConnection();
+
+	// Bring the schema of a database created by an older version up to date
+	bool migrateSchema();
+
 	DB::Connection *_connection;
 
 	// All the objects ever associated with this token
@@ -128,7 +128,7 @@ bool Directory::refresh()
 		// Convert the name of the entry to a C++ string
 		std::string name(entry->d_name);
 
-#if defined(_DIRENT_HAVE_D_TYPE) && defined(_BSD_SOURCE)
+#if defined(_DIRENT_HAVE_D_TYPE) && (defined(_BSD_SOURCE) || defined(_DEFAULT_SOURCE))
 		// Determine the type of the entry
 		switch(entry->d_type)
 		{
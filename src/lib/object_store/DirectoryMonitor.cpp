@@ -0,0 +1,163 @@
+/*
+ * Copyright (c) 2016 SURFnet bv
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+/*****************************************************************************
+ DirectoryMonitor.cpp
+
+ Reports which files in a directory have been changed, created or removed.
+ On systems with inotify the kernel delivers the changes; elsewhere the
+ monitor is inactive and the caller has to rescan the directory itself.
+ *****************************************************************************/
+
+#include "config.h"
+#include "DirectoryMonitor.h"
+#include "log.h"
+#include <string>
+#include <map>
+#ifdef HAVE_SYS_INOTIFY_H
+#include <sys/inotify.h>
+#include <errno.h>
+#include <limits.h>
+#include <unistd.h>
+#endif
+
+#ifdef HAVE_SYS_INOTIFY_H
+// The events that indicate a change to a file in the directory
+#define MONITOR_EVENTS (IN_CREATE | IN_DELETE | IN_MODIFY | IN_CLOSE_WRITE | IN_MOVED_FROM | IN_MOVED_TO)
+
+// The events that indicate the directory itself is gone
+#define MONITOR_GONE (IN_DELETE_SELF | IN_MOVE_SELF | IN_IGNORED | IN_UNMOUNT)
+#endif
+
+// Constructor
+DirectoryMonitor::DirectoryMonitor(std::string inPath)
+{
+	path = inPath;
+	active = false;
+	fd = -1;
+
+#ifdef HAVE_SYS_INOTIFY_H
+	fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+
+	if (fd == -1)
+	{
+		DEBUG_MSG("Could not monitor %s; falling back to polling", path.c_str());
+
+		return;
+	}
+
+	if (inotify_add_watch(fd, path.c_str(), MONITOR_EVENTS | IN_DELETE_SELF | IN_MOVE_SELF | IN_ONLYDIR) == -1)
+	{
+		DEBUG_MSG("Could not monitor %s; falling back to polling", path.c_str());
+
+		close(fd);
+		fd = -1;
+
+		return;
+	}
+
+	active = true;
+#endif
+}
+
+// Destructor
+DirectoryMonitor::~DirectoryMonitor()
+{
+#ifdef HAVE_SYS_INOTIFY_H
+	if (fd != -1)
+	{
+		close(fd);
+	}
+#endif
+}
+
+// Are changes to the directory being reported?
+bool DirectoryMonitor::isActive()
+{
+	return active;
+}
+
+// Retrieve the files that changed since the last call
+bool DirectoryMonitor::getChanges(std::map<std::string, bool>& changes)
+{
+	if (!active) return false;
+
+#ifdef HAVE_SYS_INOTIFY_H
+	char buffer[16 * (sizeof(struct inotify_event) + NAME_MAX + 1)]
+		__attribute__ ((aligned(__alignof__(struct inotify_event))));
+
+	for (;;)
+	{
+		ssize_t len = read(fd, buffer, sizeof(buffer));
+
+		if (len == -1)
+		{
+			if (errno == EINTR) continue;
+
+			// No more pending events
+			if (errno == EAGAIN || errno == EWOULDBLOCK) return true;
+
+			ERROR_MSG("Could not read changes of %s; falling back to polling", path.c_str());
+
+			active = false;
+
+			return false;
+		}
+
+		for (char* p = buffer; p < buffer + len; )
+		{
+			struct inotify_event* event = (struct inotify_event*) p;
+			p += sizeof(struct inotify_event) + event->len;
+
+			// The kernel dropped events
+			if (event->mask & IN_Q_OVERFLOW)
+			{
+				DEBUG_MSG("Missed changes of %s", path.c_str());
+
+				return false;
+			}
+
+			if (event->mask & MONITOR_GONE)
+			{
+				DEBUG_MSG("Stopped monitoring %s", path.c_str());
+
+				active = false;
+
+				return false;
+			}
+
+			if (event->len == 0) continue;
+
+			// The last event for a file determines whether it exists
+			changes[std::string(event->name)] = !(event->mask & (IN_DELETE | IN_MOVED_FROM));
+		}
+	}
+#else
+	return false;
+#endif
+}
+
@@ -0,0 +1,72 @@
+/*
+ * Copyright (c) 2016 SURFnet bv
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+/*****************************************************************************
+ DirectoryMonitor.h
+
+ Reports which files in a directory have been changed, created or removed.
+ On systems with inotify the kernel delivers the changes; elsewhere the
+ monitor is inactive and the caller has to rescan the directory itself.
+ *****************************************************************************/
+
+#ifndef _SOFTHSM_V2_DIRECTORYMONITOR_H
+#define _SOFTHSM_V2_DIRECTORYMONITOR_H
+
+#include "config.h"
+#include <string>
+#include <map>
+
+class DirectoryMonitor
+{
+public:
+	// Constructor
+	DirectoryMonitor(std::string inPath);
+
+	// Destructor
+	virtual ~DirectoryMonitor();
+
+	// Are changes to the directory being reported?
+	bool isActive();
+
+	// Retrieve the files that changed since the last call, along with
+	// whether the file still exists. Returns false if changes may have been
+	// lost, in which case the caller has to rescan the directory.
+	bool getChanges(std::map<std::string, bool>& changes);
+
+private:
+	// The directory path
+	std::string path;
+
+	// Is the monitor active
+	bool active;
+
+	// The inotify descriptor
+	int fd;
+};
+
+#endif // !_SOFTHSM_V2_DIRECTORYMONITOR_H
+
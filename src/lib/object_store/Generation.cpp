@@ -35,9 +35,9 @@
 #include "Generation.h"
 
 // Factory
-Generation* Generation::create(const std::string path, bool isToken /* = false */)
+Generation* Generation::create(const std::string path, bool isToken /* = false */, GenerationPage* page /* = NULL */)
 {
-	Generation* gen = new Generation(path, isToken);
+	Generation* gen = new Generation(path, isToken, page);
 	if ((gen != NULL) && isToken && (gen->genMutex == NULL))
 	{
 		delete gen;
@@ -92,6 +92,8 @@ bool Generation::wasUpdated()
 	{
 		MutexLocker lock(genMutex);
 
+		if (isUnchanged()) return false;
+
 		File genFile(path);
 
 		if (!genFile.isValid())
@@ -110,6 +112,8 @@ bool Generation::wasUpdated()
 	}
 	else
 	{
+		if (isUnchanged()) return false;
+
 		File objectFile(path);
 
 		if (!objectFile.isValid())
@@ -128,6 +132,56 @@ bool Generation::wasUpdated()
 	}
 }
 
+// The disk file only needs to be checked if the counter in the page moved;
+// not every writer reports to the page (an older library, a process that
+// crashed before reporting, or one without the page), so it is also checked
+// once the last check is GENERATION_RECHECK_INTERVAL seconds old
+bool Generation::isUnchanged()
+{
+	if (page == NULL) return false;
+
+	unsigned int counter = page->get(slot);
+	time_t now = time(NULL);
+
+	if (counter == pageValue && now - checked < GENERATION_RECHECK_INTERVAL)
+	{
+		return true;
+	}
+
+	pageValue = counter;
+	checked = now;
+
+	return false;
+}
+
+// Check from locked disk file that the target was not updated since
+// the last synchronisation; rewinds the file
+bool Generation::isCurrent(File &objectFile)
+{
+	if (isToken)
+	{
+		ERROR_MSG("Generation isCurrent() called for a token");
+
+		return false;
+	}
+
+	unsigned long onDisk;
+
+	if (!objectFile.readULong(onDisk))
+	{
+		if (objectFile.isEOF())
+		{
+			onDisk = 0;
+		}
+		else
+		{
+			return false;
+		}
+	}
+
+	return objectFile.seek(0L) && (onDisk == currentValue);
+}
+
 // Update
 void Generation::update()
 {
@@ -161,7 +215,11 @@ void Generation::commit()
 
 			pendingUpdate = false;
 
-			(void) genFile.writeULong(currentValue);
+			// The value must be readable before the counter moves
+			if (genFile.writeULong(currentValue) && genFile.flush() && (page != NULL))
+			{
+				page->increment(slot);
+			}
 
 			genFile.unlock();
 
@@ -175,6 +233,8 @@ void Generation::commit()
 		bOK = bOK && genFile.readULong(onDisk);
 		bOK = bOK && genFile.seek(0L);
 
+		bool isChanged = pendingUpdate;
+
 		if (pendingUpdate)
 		{
 			onDisk++;
@@ -186,16 +246,23 @@ void Generation::commit()
 		}
 
 		bOK = bOK && genFile.writeULong(onDisk);
+		bOK = bOK && genFile.flush();
 
 		if (bOK)
 		{
 			currentValue = onDisk;
 
 			pendingUpdate = false;
+
+			if (isChanged && (page != NULL)) page->increment(slot);
 		}
 
 		genFile.unlock();
 	}
+	else if (page != NULL)
+	{
+		page->increment(slot);
+	}
 }
 
 // Set the current value when read from disk
@@ -231,13 +298,26 @@ void Generation::rollback()
 }
 
 // Constructor
-Generation::Generation(const std::string inPath, bool inIsToken)
+Generation::Generation(const std::string inPath, bool inIsToken, GenerationPage* inPage)
 {
 	path = inPath;
 	isToken = inIsToken;
 	pendingUpdate = false;
 	currentValue = 0;
 	genMutex = NULL;
+	page = inPage;
+	slot = 0;
+	pageValue = 0;
+	checked = 0;
+
+	// The counter is read before the disk file, so that no later change
+	// is missed
+	if (page != NULL)
+	{
+		slot = isToken ? GenerationPage::TOKEN_SLOT : page->getSlot(path);
+		pageValue = page->get(slot);
+		checked = time(NULL);
+	}
 
 	if (isToken)
 	{
@@ -35,14 +35,20 @@
 
 #include "config.h"
 #include <string>
+#include <time.h>
 #include "File.h"
+#include "GenerationPage.h"
 #include "MutexFactory.h"
 
+// The number of seconds after which the disk file is checked again even if
+// the counter in the generation page did not move
+#define GENERATION_RECHECK_INTERVAL 1
+
 class Generation
 {
 public:
 	// Factory
-	static Generation* create(const std::string inPath, bool inIsToken = false);
+	static Generation* create(const std::string inPath, bool inIsToken = false, GenerationPage* inPage = NULL);
 
 	// Destructor
 	virtual ~Generation();
@@ -53,10 +59,15 @@ public:
 	// Check if the target was updated
 	bool wasUpdated();
 
+	// Check from locked disk file that the target was not updated since
+	// the last synchronisation; rewinds the file
+	bool isCurrent(File &objectfile);
+
 	// Note pending update
 	void update();
 
-	// Commit (for the token case)
+	// Commit (for the token case) and report the change to the
+	// generation page; objects commit after their file was written
 	void commit();
 
 	// Set the current value when read from disk
@@ -70,7 +81,10 @@ public:
 
 private:
 	// Constructor
-	Generation(const std::string path, bool isToken);
+	Generation(const std::string path, bool isToken, GenerationPage* page);
+
+	// Can the check of the disk file be skipped?
+	bool isUnchanged();
 
 	// The file path
 	std::string path;
@@ -84,6 +98,16 @@ private:
 	// Current value
 	unsigned long currentValue;
 
+	// The shared generation page, if any, and the slot of the target
+	GenerationPage* page;
+	unsigned long slot;
+
+	// The counter in the page when the disk file was last checked
+	unsigned int pageValue;
+
+	// When the disk file was last checked
+	time_t checked;
+
 	// For thread safeness
 	Mutex* genMutex;
 };
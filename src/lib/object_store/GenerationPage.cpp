@@ -0,0 +1,183 @@
+/*
+ * Copyright (c) 2016 SURFnet bv
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+/*****************************************************************************
+ GenerationPage.cpp
+
+ A page of change counters that the processes using a token share through a
+ memory mapped file in the token directory.
+ *****************************************************************************/
+
+#include "config.h"
+#include "GenerationPage.h"
+#include "log.h"
+#include "OSPathSep.h"
+#include <string>
+#if defined(HAVE_SYS_MMAN_H) && defined(__GNUC__)
+#define GENERATION_PAGE
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+// The size of the page
+#define PAGE_BYTES		4096
+
+// The first word identifies the layout of the page
+#define PAGE_MAGIC		0x53484731
+
+// The magic word and the token counter precede the object counters
+#define PAGE_SLOTS		(PAGE_BYTES / sizeof(unsigned int) - 1)
+
+// Factory
+/*static*/ GenerationPage* GenerationPage::create(const std::string path)
+{
+#ifdef GENERATION_PAGE
+	int fd = open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0600);
+
+	if (fd == -1)
+	{
+		WARNING_MSG("Could not open the generation page %s", path.c_str());
+
+		return NULL;
+	}
+
+	// Grow a new page; the other processes grow it to the same size
+	struct stat st;
+
+	if ((fstat(fd, &st) != 0) ||
+	    ((st.st_size < PAGE_BYTES) && (ftruncate(fd, PAGE_BYTES) != 0)))
+	{
+		WARNING_MSG("Could not size the generation page %s", path.c_str());
+
+		close(fd);
+
+		return NULL;
+	}
+
+	void* base = mmap(NULL, PAGE_BYTES, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+
+	close(fd);
+
+	if (base == MAP_FAILED)
+	{
+		WARNING_MSG("Could not map the generation page %s", path.c_str());
+
+		return NULL;
+	}
+
+	// The first process to map the page claims it
+	volatile unsigned int* magic = (volatile unsigned int*) base;
+
+	(void) __sync_bool_compare_and_swap(magic, 0, PAGE_MAGIC);
+
+	if (*magic != PAGE_MAGIC)
+	{
+		WARNING_MSG("The generation page %s has an unknown layout", path.c_str());
+
+		munmap(base, PAGE_BYTES);
+
+		return NULL;
+	}
+
+	GenerationPage* page = new GenerationPage();
+
+	page->base = base;
+	page->counters = magic + 1;
+
+	return page;
+#else
+	DEBUG_MSG("Generation pages are not supported; not mapping %s", path.c_str());
+
+	return NULL;
+#endif
+}
+
+// Destructor
+GenerationPage::~GenerationPage()
+{
+#ifdef GENERATION_PAGE
+	if (base != NULL)
+	{
+		munmap(base, PAGE_BYTES);
+	}
+#endif
+}
+
+// The counter slot for an object file; the token has a slot of its own
+// and objects that share a slot only cause each other to be checked
+unsigned long GenerationPage::getSlot(const std::string& path)
+{
+	// Processes may reach the token directory by different paths
+	std::string::size_type start = path.find_last_of(OS_PATHSEP);
+	start = (start == std::string::npos) ? 0 : start + 1;
+
+	// FNV-1a
+	unsigned long hash = 2166136261UL;
+
+	for (std::string::size_type i = start; i < path.size(); i++)
+	{
+		hash ^= (unsigned char) path[i];
+		hash = (hash * 16777619UL) & 0xFFFFFFFFUL;
+	}
+
+	return 1 + hash % (PAGE_SLOTS - 1);
+}
+
+// Read the counter of a slot
+unsigned int GenerationPage::get(unsigned long slot)
+{
+#ifdef GENERATION_PAGE
+	// Order the read before the file is checked
+	unsigned int value = counters[slot];
+
+	__sync_synchronize();
+
+	return value;
+#else
+	return counters[slot];
+#endif
+}
+
+// Increment the counter of a slot
+void GenerationPage::increment(unsigned long slot)
+{
+#ifdef GENERATION_PAGE
+	(void) __sync_add_and_fetch(&counters[slot], 1);
+#else
+	counters[slot]++;
+#endif
+}
+
+// Constructor
+GenerationPage::GenerationPage()
+{
+	base = NULL;
+	counters = NULL;
+}
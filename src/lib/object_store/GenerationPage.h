@@ -0,0 +1,76 @@
+/*
+ * Copyright (c) 2016 SURFnet bv
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+/*****************************************************************************
+ GenerationPage.h
+
+ A page of change counters that the processes using a token share through a
+ memory mapped file in the token directory. A process increments the counter
+ of the token or of an object file after it wrote the file; other processes
+ only need to read the file again if the counter changed. The generation
+ numbers in the files remain authoritative, the counters are hints.
+ *****************************************************************************/
+
+#ifndef _SOFTHSM_V2_GENERATIONPAGE_H
+#define _SOFTHSM_V2_GENERATIONPAGE_H
+
+#include "config.h"
+#include <string>
+
+class GenerationPage
+{
+public:
+	// Factory; returns NULL if the page cannot be mapped
+	static GenerationPage* create(const std::string path);
+
+	// Destructor
+	virtual ~GenerationPage();
+
+	// The counter slot of the token
+	static const unsigned long TOKEN_SLOT = 0;
+
+	// The counter slot for an object file
+	unsigned long getSlot(const std::string& path);
+
+	// Read the counter of a slot
+	unsigned int get(unsigned long slot);
+
+	// Increment the counter of a slot
+	void increment(unsigned long slot);
+
+private:
+	// Constructor
+	GenerationPage();
+
+	// The mapping
+	void* base;
+
+	// The counters in the mapping
+	volatile unsigned int* counters;
+};
+
+#endif // !_SOFTHSM_V2_GENERATIONPAGE_H
@@ -38,11 +38,14 @@
 #include "OSAttribute.h"
 #include "ObjectFile.h"
 #include "Directory.h"
+#include "DirectoryMonitor.h"
 #include "Generation.h"
+#include "GenerationPage.h"
 #include "UUID.h"
 #include "cryptoki.h"
 #include "OSToken.h"
 #include "OSPathSep.h"
+#include "Configuration.h"
 #include <vector>
 #include <string>
 #include <set>
@@ -55,15 +58,31 @@ OSToken::OSToken(const std::string inTokenPath)
 {
 	tokenPath = inTokenPath;
 
+	// Share the generation counters with the other processes if configured
+	page = NULL;
+	if (Configuration::i()->getBool("objectstore.genpage", false))
+	{
+		page = GenerationPage::create(tokenPath + OS_PATHSEP + "generation.page");
+	}
+
+	// Without the page, start monitoring before anything is read, so that
+	// no change is missed; reading a counter is cheaper than the monitor
+	monitor = NULL;
+	if ((page == NULL) && Configuration::i()->getBool("objectstore.monitor", true))
+	{
+		monitor = new DirectoryMonitor(tokenPath);
+	}
+
 	tokenDir = new Directory(tokenPath);
-	gen = Generation::create(tokenPath + OS_PATHSEP + "generation", true);
+	gen = Generation::create(tokenPath + OS_PATHSEP + "generation", true, page);
 	tokenObject = new ObjectFile(this, tokenPath + OS_PATHSEP + "token.object", tokenPath + OS_PATHSEP + "token.lock");
 	tokenMutex = MutexFactory::i()->getMutex();
 	valid = (gen != NULL) && (tokenMutex != NULL) && tokenDir->isValid() && tokenObject->valid;
 
-	DEBUG_MSG("Opened token %s", tokenPath.c_str());
+	// The objects are read when they are first needed
+	indexed = false;
 
-	index(true);
+	DEBUG_MSG("Opened token %s", tokenPath.c_str());
 }
 
 // Create a new token
@@ -140,9 +159,11 @@ OSToken::~OSToken()
 	}
 
 	delete tokenDir;
+	if (monitor != NULL) delete monitor;
 	if (gen != NULL) delete gen;
 	MutexFactory::i()->recycleMutex(tokenMutex);
 	delete tokenObject;
+	if (page != NULL) delete page;
 }
 
 // Set the SO PIN
@@ -311,7 +332,7 @@ bool OSToken::setTokenFlags(const CK_ULONG flags)
 // Retrieve objects
 std::set<OSObject*> OSToken::getObjects()
 {
-	index();
+	index(!isIndexed());
 
 	// Make sure that no other thread is in the process of changing
 	// the object list when we return it
@@ -322,7 +343,7 @@ std::set<OSObject*> OSToken::getObjects()
 
 void OSToken::getObjects(std::set<OSObject*> &inObjects)
 {
-	index();
+	index(!isIndexed());
 
 	// Make sure that no other thread is in the process of changing
 	// the object list when we return it
@@ -341,6 +362,10 @@ OSObject* OSToken::createObject()
 	std::string objectPath = tokenPath + OS_PATHSEP + objectUUID + ".object";
 	std::string lockPath = tokenPath + OS_PATHSEP + objectUUID + ".lock";
 
+	// Hold the lock while the file is created, so that indexing by another
+	// thread cannot pick up the new file before it is added
+	MutexLocker lock(tokenMutex);
+
 	// Create the new object file
 	ObjectFile* newObject = new ObjectFile(this, objectPath, lockPath, true);
 
@@ -354,11 +379,10 @@ OSObject* OSToken::createObject()
 	}
 
 	// Now add it to the set of objects
-	MutexLocker lock(tokenMutex);
-
 	objects.insert(newObject);
 	allObjects.insert(newObject);
 	currentFiles.insert(newObject->getFilename());
+	objectFiles[newObject->getFilename()] = newObject;
 
 	DEBUG_MSG("(0x%08X) Created new object %s (0x%08X)", this, objectPath.c_str(), newObject);
 
@@ -417,6 +441,8 @@ bool OSToken::deleteObject(OSObject* object)
 	}
 
 	objects.erase(object);
+	objectFiles.erase(objectFilename);
+	currentFiles.erase(objectFilename);
 
 	DEBUG_MSG("Deleted object %s", objectFilename.c_str());
 
@@ -573,11 +599,27 @@ bool OSToken::resetToken(const ByteString& label)
 	return true;
 }
 
-// Index the token
+// Index the token; the first time all objects are read
 bool OSToken::index(bool isFirstTime /* = false */)
 {
+	bool rescan = isFirstTime;
+
+	// Only the files reported by the directory monitor need to be looked at
+	if (!rescan && valid && isMonitored())
+	{
+		if (applyChanges()) return true;
+
+		rescan = true;
+	}
+
+	// Nothing more to keep up to date before the objects are first needed
+	if (!isFirstTime && !isIndexed())
+	{
+		return true;
+	}
+
 	// Check if re-indexing is required
-	if (!isFirstTime && (!valid || !gen->wasUpdated()))
+	if (!rescan && (!valid || !gen->wasUpdated()))
 	{
 		return true;
 	}
@@ -619,30 +661,27 @@ bool OSToken::index(bool isFirstTime /* = false */)
 	// No access to object mutable fields before
 	MutexLocker lock(tokenMutex);
 
-	if (!isFirstTime)
+	// The objects are read the first time; objects that were created before
+	// or by a concurrent first indexing are known already
+	indexed = true;
+
+	// First compute which files were added
+	for (std::set<std::string>::iterator i = newSet.begin(); i != newSet.end(); i++)
 	{
-		// First compute which files were added
-		for (std::set<std::string>::iterator i = newSet.begin(); i != newSet.end(); i++)
+		if (currentFiles.find(*i) == currentFiles.end())
 		{
-			if (currentFiles.find(*i) == currentFiles.end())
-			{
-				addedFiles.insert(*i);
-			}
+			addedFiles.insert(*i);
 		}
+	}
 
-		// Now compute which files were removed
-		for (std::set<std::string>::iterator i = currentFiles.begin(); i != currentFiles.end(); i++)
+	// Now compute which files were removed
+	for (std::set<std::string>::iterator i = currentFiles.begin(); i != currentFiles.end(); i++)
+	{
+		if (newSet.find(*i) == newSet.end())
 		{
-			if (newSet.find(*i) == newSet.end())
-			{
-				removedFiles.insert(*i);
-			}
+			removedFiles.insert(*i);
 		}
 	}
-	else
-	{
-		addedFiles = newSet;
-	}
 
 	currentFiles = newSet;
 
@@ -654,56 +693,126 @@ bool OSToken::index(bool isFirstTime /* = false */)
 	// Add new objects
 	for (std::set<std::string>::iterator i = addedFiles.begin(); i != addedFiles.end(); i++)
 	{
-		if ((i->find_last_of('.') == std::string::npos) ||
-		    (i->substr(i->find_last_of('.')) != ".object"))
-		{
-			continue;
-		}
-
-		std::string lockName(*i);
-		lockName.replace(lockName.find_last_of('.'), std::string::npos, ".lock");
+		addObjectFile(*i);
+	}
 
-		// Create a new token object for the added file
-		ObjectFile* newObject = new ObjectFile(this, tokenPath + OS_PATHSEP + *i, tokenPath + OS_PATHSEP + lockName);
+	// Remove deleted objects
+	for (std::set<std::string>::iterator i = removedFiles.begin(); i != removedFiles.end(); i++)
+	{
+		std::map<std::string, ObjectFile*>::iterator fileObject = objectFiles.find(*i);
+		if (fileObject == objectFiles.end()) continue;
 
-		DEBUG_MSG("(0x%08X) New object %s (0x%08X) added", this, newObject->getFilename().c_str(), newObject);
+		DEBUG_MSG("Removing object %s", i->c_str());
 
-		objects.insert(newObject);
-		allObjects.insert(newObject);
+		fileObject->second->invalidate();
+		objects.erase(fileObject->second);
+		objectFiles.erase(fileObject);
 	}
 
-	// Remove deleted objects
-	std::set<OSObject*> newObjects;
+	DEBUG_MSG("The token now contains %d objects", objects.size());
 
-	for (std::set<OSObject*>::iterator i = objects.begin(); i != objects.end(); i++)
+	return true;
+}
+
+// Apply the changes reported by the directory monitor; returns false if
+// changes may have been missed and the directory has to be rescanned
+bool OSToken::applyChanges()
+{
+	MutexLocker lock(tokenMutex);
+
+	std::map<std::string, bool> changes;
+
+	if (!monitor->getChanges(changes))
 	{
-		ObjectFile* fileObject = dynamic_cast<ObjectFile*>((*i));
-		if (fileObject == NULL)
+		// Any object file may have been changed
+		for (std::map<std::string, ObjectFile*>::iterator i = objectFiles.begin(); i != objectFiles.end(); i++)
 		{
-			ERROR_MSG("Object type not compatible with this token class 0x%08X", (*i));
+			i->second->markChanged();
+		}
+		tokenObject->markChanged();
 
-			return false;
+		return false;
+	}
+
+	for (std::map<std::string, bool>::iterator i = changes.begin(); i != changes.end(); i++)
+	{
+		const std::string& name = i->first;
+
+		if (!name.compare("token.object"))
+		{
+			tokenObject->markChanged();
+
+			continue;
+		}
+
+		// Ignore the lock files and the generation files
+		if ((name.size() <= 7) || name.substr(name.size() - 7).compare(".object"))
+		{
+			continue;
 		}
 
-		DEBUG_MSG("Processing %s (0x%08X)", fileObject->getFilename().c_str(), *i);
+		std::map<std::string, ObjectFile*>::iterator fileObject = objectFiles.find(name);
 
-		if (removedFiles.find(fileObject->getFilename()) == removedFiles.end())
+		if (i->second)
 		{
-			DEBUG_MSG("Adding object %s", fileObject->getFilename().c_str());
-			// This object gets to stay in the set
-			newObjects.insert(*i);
+			if (fileObject != objectFiles.end())
+			{
+				fileObject->second->markChanged();
+			}
+			else
+			{
+				addObjectFile(name);
+			}
 		}
 		else
 		{
-			fileObject->invalidate();
+			currentFiles.erase(name);
+
+			if (fileObject != objectFiles.end())
+			{
+				DEBUG_MSG("Removing object %s", name.c_str());
+
+				fileObject->second->invalidate();
+				objects.erase(fileObject->second);
+				objectFiles.erase(fileObject);
+			}
 		}
 	}
 
-	// Set the new objects
-	objects = newObjects;
+	return true;
+}
 
-	DEBUG_MSG("The token now contains %d objects", objects.size());
+// Are changes to the object files reported by the directory monitor?
+bool OSToken::isMonitored()
+{
+	return (monitor != NULL) && monitor->isActive();
+}
 
-	return true;
+// Have the objects of the token been read?
+bool OSToken::isIndexed()
+{
+	MutexLocker lock(tokenMutex);
+
+	return indexed;
+}
+
+// Add an object for the given file name
+// Calling function must lock the mutex
+ObjectFile* OSToken::addObjectFile(const std::string& name)
+{
+	std::string lockName(name);
+	lockName.replace(lockName.find_last_of('.'), std::string::npos, ".lock");
+
+	// Create a new token object for the added file
+	ObjectFile* newObject = new ObjectFile(this, tokenPath + OS_PATHSEP + name, tokenPath + OS_PATHSEP + lockName);
+
+	DEBUG_MSG("(0x%08X) New object %s (0x%08X) added", this, newObject->getFilename().c_str(), newObject);
+
+	objects.insert(newObject);
+	allObjects.insert(newObject);
+	currentFiles.insert(name);
+	objectFiles[name] = newObject;
+
+	return newObject;
 }
 
@@ -40,6 +40,7 @@
 #include "OSAttribute.h"
 #include "ObjectFile.h"
 #include "Directory.h"
+#include "DirectoryMonitor.h"
 #include "Generation.h"
 #include "UUID.h"
 #include "MutexFactory.h"
@@ -122,9 +123,24 @@ private:
 	// Index the token
 	bool index(bool isFirstTime = false);
 
+	// Apply the changes reported by the directory monitor
+	bool applyChanges();
+
+	// Are changes to the object files reported by the directory monitor?
+	bool isMonitored();
+
+	// Have the objects of the token been read?
+	bool isIndexed();
+
+	// Add an object for the given file name
+	ObjectFile* addObjectFile(const std::string& name);
+
 	// Is the token consistent and valid?
 	bool valid;
 
+	// Have the objects of the token been read? Guarded by the token mutex.
+	bool indexed;
+
 	// The token path
 	std::string tokenPath;
 
@@ -143,15 +159,24 @@ private:
 	// The current list of files
 	std::set<std::string> currentFiles;
 
+	// The current objects by file name
+	std::map<std::string, ObjectFile*> objectFiles;
+
 	// The token object
 	ObjectFile* tokenObject;
 
 	// Generation control
 	Generation* gen;
 
+	// Counters shared with other processes; NULL if disabled
+	GenerationPage* page;
+
 	// The directory object for this token
 	Directory* tokenDir;
 
+	// Reports changes in the token directory; NULL if disabled
+	DirectoryMonitor* monitor;
+
 	// For thread safeness
 	Mutex* tokenMutex;
 };
@@ -50,9 +50,11 @@
 ObjectFile::ObjectFile(OSToken* parent, std::string inPath, std::string inLockpath, bool isNew /* = false */)
 {
 	path = inPath;
-	gen = Generation::create(path);
+	gen = Generation::create(path, false, (parent != NULL) ? parent->page : NULL);
 	objectMutex = MutexFactory::i()->getMutex();
 	valid = (gen != NULL) && (objectMutex != NULL);
+	externalChange = false;
+	journalRecords = 0;
 	token = parent;
 	inTransaction = false;
 	transactionLockFile = NULL;
@@ -225,7 +227,7 @@ bool ObjectFile::setAttribute(CK_ATTRIBUTE_TYPE type, const OSAttribute& attribu
 		attributes[type] = new OSAttribute(attribute);
 	}
 
-	store();
+	storeAttribute(type);
 
 	return valid;
 }
@@ -277,6 +279,31 @@ void ObjectFile::invalidate()
 	discardAttributes();
 }
 
+// Check if the file may have been changed by another instance
+bool ObjectFile::hasChanged()
+{
+	// When the token reports changes, the file only needs to be
+	// checked after a change was reported
+	if ((token != NULL) && token->isMonitored())
+	{
+		MutexLocker lock(objectMutex);
+
+		if (!externalChange) return false;
+
+		externalChange = false;
+	}
+
+	return gen->wasUpdated();
+}
+
+// Note that the token saw the file change
+void ObjectFile::markChanged()
+{
+	MutexLocker lock(objectMutex);
+
+	externalChange = true;
+}
+
 // Refresh the object if necessary
 void ObjectFile::refresh(bool isFirstTime /* = false */)
 {
@@ -294,7 +321,7 @@ void ObjectFile::refresh(bool isFirstTime /* = false */)
 	}
 
 	// Check the generation
-	if (!isFirstTime && (!valid || !gen->wasUpdated()))
+	if (!isFirstTime && (!valid || !hasChanged()))
 	{
 		return;
 	}
@@ -317,6 +344,8 @@ void ObjectFile::refresh(bool isFirstTime /* = false */)
 
 	MutexLocker lock(objectMutex);
 
+	journalRecords = 0;
+
 	// Read back the generation number
 	unsigned long curGen;
 
@@ -386,6 +415,9 @@ void ObjectFile::refresh(bool isFirstTime /* = false */)
 			if (attributes[p11AttrType] != NULL)
 			{
 				delete attributes[p11AttrType];
+
+				// Superseded by a record appended later
+				journalRecords++;
 			}
 
 			attributes[p11AttrType] = new OSAttribute(value);
@@ -406,6 +438,9 @@ void ObjectFile::refresh(bool isFirstTime /* = false */)
 			if (attributes[p11AttrType] != NULL)
 			{
 				delete attributes[p11AttrType];
+
+				// Superseded by a record appended later
+				journalRecords++;
 			}
 
 			attributes[p11AttrType] = new OSAttribute(value);
@@ -426,6 +461,9 @@ void ObjectFile::refresh(bool isFirstTime /* = false */)
 			if (attributes[p11AttrType] != NULL)
 			{
 				delete attributes[p11AttrType];
+
+				// Superseded by a record appended later
+				journalRecords++;
 			}
 
 			attributes[p11AttrType] = new OSAttribute(value);
@@ -446,6 +484,9 @@ void ObjectFile::refresh(bool isFirstTime /* = false */)
 			if (attributes[p11AttrType] != NULL)
 			{
 				delete attributes[p11AttrType];
+
+				// Superseded by a record appended later
+				journalRecords++;
 			}
 
 			attributes[p11AttrType] = new OSAttribute(value);
@@ -510,84 +551,143 @@ bool ObjectFile::writeAttributes(File &objectFile)
 			continue;
 		}
 
-		unsigned long p11AttrType = i->first;
-
-		if (!objectFile.writeULong(p11AttrType))
+		if (!writeAttribute(objectFile, i->first, i->second))
 		{
-			DEBUG_MSG("Failed to write PKCS #11 attribute type to object %s", path.c_str());
-
 			objectFile.unlock();
 
 			return false;
 		}
+	}
 
-		if (i->second->isBooleanAttribute())
-		{
-			unsigned long osAttrType = BOOLEAN_ATTR;
-			bool value = i->second->getBooleanValue();
+	journalRecords = 0;
 
-			if (!objectFile.writeULong(osAttrType) || !objectFile.writeBool(value))
-			{
-				DEBUG_MSG("Failed to write attribute to object %s", path.c_str());
+	// Report the change once the file can be read
+	if (objectFile.flush()) gen->commit();
+	objectFile.unlock();
 
-				objectFile.unlock();
+	return true;
+}
 
-				return false;
-			}
-		}
-		else if (i->second->isUnsignedLongAttribute())
-		{
-			unsigned long osAttrType = ULONG_ATTR;
-			unsigned long value = i->second->getUnsignedLongValue();
+// Append the record of a single attribute to the object file; the whole
+// object is written instead if the file was changed by another instance or
+// if superseded records take up more space than the current attributes
+// called with objectFile locked and returns with objectFile unlocked
+bool ObjectFile::appendAttribute(File &objectFile, CK_ATTRIBUTE_TYPE type)
+{
+	std::map<CK_ATTRIBUTE_TYPE, OSAttribute*>::iterator i = attributes.find(type);
 
-			if (!objectFile.writeULong(osAttrType) || !objectFile.writeULong(value))
-			{
-				DEBUG_MSG("Failed to write attribute to object %s", path.c_str());
+	if ((i == attributes.end()) || (i->second == NULL) ||
+	    (journalRecords >= attributes.size()) ||
+	    !gen->isCurrent(objectFile))
+	{
+		return writeAttributes(objectFile);
+	}
 
-				objectFile.unlock();
+	// The record is flushed before the new generation is written, so that a
+	// process that dies can leave a torn record only behind the old
+	// generation. A complete record without the new generation is read as
+	// the latest value of the attribute; a torn record makes the object read
+	// as corrupt, as an interrupted full write does. As for the full write,
+	// the file is only flushed, not synced to the disk.
+	if (!objectFile.seek() || !writeAttribute(objectFile, type, i->second) || !objectFile.flush())
+	{
+		DEBUG_MSG("Failed to append attribute to object %s", path.c_str());
 
-				return false;
-			}
-		}
-		else if (i->second->isByteStringAttribute())
-		{
-			unsigned long osAttrType = BYTESTR_ATTR;
-			const ByteString& value = i->second->getByteStringValue();
+		objectFile.unlock();
 
-			if (!objectFile.writeULong(osAttrType) || !objectFile.writeByteString(value))
-			{
-				DEBUG_MSG("Failed to write attribute to object %s", path.c_str());
+		return false;
+	}
+
+	gen->update();
 
-				objectFile.unlock();
+	unsigned long newGen = gen->get();
 
-				return false;
-			}
-		}
-		else if (i->second->isArrayAttribute())
+	if (!objectFile.seek(0L) || !objectFile.writeULong(newGen))
+	{
+		DEBUG_MSG("Failed to write new generation number to object %s", path.c_str());
+
+		gen->rollback();
+
+		objectFile.unlock();
+
+		return false;
+	}
+
+	journalRecords++;
+
+	// Report the change once the file can be read
+	if (objectFile.flush()) gen->commit();
+	objectFile.unlock();
+
+	return true;
+}
+
+// Write the record of a single attribute
+bool ObjectFile::writeAttribute(File &objectFile, CK_ATTRIBUTE_TYPE type, const OSAttribute* attribute)
+{
+	unsigned long p11AttrType = type;
+
+	if (!objectFile.writeULong(p11AttrType))
+	{
+		DEBUG_MSG("Failed to write PKCS #11 attribute type to object %s", path.c_str());
+
+		return false;
+	}
+
+	if (attribute->isBooleanAttribute())
+	{
+		unsigned long osAttrType = BOOLEAN_ATTR;
+		bool value = attribute->getBooleanValue();
+
+		if (!objectFile.writeULong(osAttrType) || !objectFile.writeBool(value))
 		{
-			unsigned long osAttrType = ARRAY_ATTR;
-			const std::map<CK_ATTRIBUTE_TYPE,OSAttribute>& value = i->second->getArrayValue();
+			DEBUG_MSG("Failed to write attribute to object %s", path.c_str());
 
-			if (!objectFile.writeULong(osAttrType) || !objectFile.writeArray(value))
-			{
-				DEBUG_MSG("Failed to write attribute to object %s", path.c_str());
+			return false;
+		}
+	}
+	else if (attribute->isUnsignedLongAttribute())
+	{
+		unsigned long osAttrType = ULONG_ATTR;
+		unsigned long value = attribute->getUnsignedLongValue();
 
-				objectFile.unlock();
+		if (!objectFile.writeULong(osAttrType) || !objectFile.writeULong(value))
+		{
+			DEBUG_MSG("Failed to write attribute to object %s", path.c_str());
 
-				return false;
-			}
+			return false;
 		}
-		else
+	}
+	else if (attribute->isByteStringAttribute())
+	{
+		unsigned long osAttrType = BYTESTR_ATTR;
+		const ByteString& value = attribute->getByteStringValue();
+
+		if (!objectFile.writeULong(osAttrType) || !objectFile.writeByteString(value))
 		{
-			DEBUG_MSG("Unknown attribute type for object %s", path.c_str());
+			DEBUG_MSG("Failed to write attribute to object %s", path.c_str());
 
-			objectFile.unlock();
+			return false;
+		}
+	}
+	else if (attribute->isArrayAttribute())
+	{
+		unsigned long osAttrType = ARRAY_ATTR;
+		const std::map<CK_ATTRIBUTE_TYPE,OSAttribute>& value = attribute->getArrayValue();
+
+		if (!objectFile.writeULong(osAttrType) || !objectFile.writeArray(value))
+		{
+			DEBUG_MSG("Failed to write attribute to object %s", path.c_str());
 
 			return false;
 		}
 	}
+	else
+	{
+		DEBUG_MSG("Unknown attribute type for object %s", path.c_str());
 
-	objectFile.unlock();
+		return false;
+	}
 
 	return true;
 }
@@ -645,6 +745,41 @@ void ObjectFile::store(bool isCommit /* = false */)
 	valid = true;
 }
 
+// Write a single changed attribute to background storage
+void ObjectFile::storeAttribute(CK_ATTRIBUTE_TYPE type)
+{
+	// Check if we're in the middle of a transaction
+	if (inTransaction)
+	{
+		return;
+	}
+
+	if (!valid)
+	{
+		DEBUG_MSG("Cannot write back an invalid object %s", path.c_str());
+
+		return;
+	}
+
+	File objectFile(path, true, true, true, false);
+
+	if (!objectFile.isValid())
+	{
+		DEBUG_MSG("Cannot open object %s for writing", path.c_str());
+
+		valid = false;
+
+		return;
+	}
+
+	objectFile.lock();
+
+	MutexLocker lock(objectMutex);
+	File lockFile(lockpath, false, true, true);
+
+	valid = appendAttribute(objectFile, type);
+}
+
 // Discard the cached attributes
 void ObjectFile::discardAttributes()
 {
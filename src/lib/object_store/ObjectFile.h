@@ -116,11 +116,22 @@ private:
 	// Refresh the object if necessary
 	void refresh(bool isFirstTime = false);
 
+	// Check if the file may have been changed by another instance
+	bool hasChanged();
+
+	// Note that the token saw the file change
+	void markChanged();
+
 	// Write the object to background storage
 	void store(bool isCommit = false);
 
-	// Store subroutine
+	// Write a single changed attribute to background storage
+	void storeAttribute(CK_ATTRIBUTE_TYPE type);
+
+	// Store subroutines
 	bool writeAttributes(File &objectFile);
+	bool appendAttribute(File &objectFile, CK_ATTRIBUTE_TYPE type);
+	bool writeAttribute(File &objectFile, CK_ATTRIBUTE_TYPE type, const OSAttribute* attribute);
 
 	// Discard the cached attributes
 	void discardAttributes();
@@ -135,9 +146,16 @@ private:
 	// The object's raw attributes
 	std::map<CK_ATTRIBUTE_TYPE, OSAttribute*> attributes;
 
+	// The number of superseded or appended attribute records in the
+	// object file since it was last written in full
+	size_t journalRecords;
+
 	// The object's validity state
 	bool valid;
 
+	// Was a change to the file reported since the last refresh?
+	bool externalChange;
+
 	// The token this object is associated with
 	OSToken* token;
 
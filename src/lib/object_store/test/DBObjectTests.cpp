@@ -531,6 +531,43 @@ void test_a_dbobject_with_an_object::can_refresh_attributes()
 	}
 }
 
+void test_a_dbobject_with_an_object::should_cache_unchanged_attributes()
+{
+	ByteString label1 = "4C4142454C31";
+	ByteString label2 = "4C4142454C32";
+	ByteString label3 = "4C4142454C33";
+
+	DBObject testObject(connection);
+	CPPUNIT_ASSERT(testObject.find(1));
+	CPPUNIT_ASSERT(testObject.setAttribute(CKA_LABEL, label1));
+	CPPUNIT_ASSERT(testObject.getByteStringValue(CKA_LABEL) == label1);
+	CPPUNIT_ASSERT(!testObject.attributeExists(CKA_ID));
+
+	// Change the label behind the back of the object without advancing its
+	// generation; the cached label is still used
+	DB::Statement statement = connection2->prepare("drop trigger attribute_binary_update_generation");
+	CPPUNIT_ASSERT(connection2->execute(statement));
+	statement = connection2->prepare("update attribute_binary set value=x'%s' where object_id=1", label2.hex_str().c_str());
+	CPPUNIT_ASSERT(connection2->execute(statement));
+	statement = DB::Statement();
+
+	CPPUNIT_ASSERT(testObject.getByteStringValue(CKA_LABEL) == label1);
+
+	// A change made through another connection is picked up
+	DBObject testObject2(connection2);
+	CPPUNIT_ASSERT(testObject2.createGenerations());
+	CPPUNIT_ASSERT(testObject2.find(1));
+	CPPUNIT_ASSERT(testObject2.getByteStringValue(CKA_LABEL) == label2);
+	CPPUNIT_ASSERT(testObject2.setAttribute(CKA_LABEL, label3));
+	CPPUNIT_ASSERT(testObject.getByteStringValue(CKA_LABEL) == label3);
+
+	// And so is the deletion of an attribute
+	CPPUNIT_ASSERT(testObject2.deleteAttribute(CKA_LABEL));
+	CPPUNIT_ASSERT(!testObject.attributeExists(CKA_LABEL));
+	CPPUNIT_ASSERT(testObject.setAttribute(CKA_LABEL, label1));
+	CPPUNIT_ASSERT(testObject2.getByteStringValue(CKA_LABEL) == label1);
+}
+
 void test_a_dbobject_with_an_object::should_cleanup_statements_during_transactions()
 {
 	// Create an object for accessing object 1 on the first connection.
@@ -627,19 +664,16 @@ void test_a_dbobject_with_an_object::should_use_transactions()
 	// Commit the transaction
 	CPPUNIT_ASSERT(testObject.commitTransaction());
 
-	// Verify that non-modifiable attributes did not propagate but modifiable attributes
-	// have now changed on the other instance
+	// Verify that the attributes have now changed on the other instance
 	CPPUNIT_ASSERT(testObject2.getAttribute(CKA_TOKEN).isBooleanAttribute());
 	CPPUNIT_ASSERT(testObject2.getAttribute(CKA_PRIME_BITS).isUnsignedLongAttribute());
 	CPPUNIT_ASSERT(testObject2.getAttribute(CKA_VALUE_BITS).isUnsignedLongAttribute());
 	CPPUNIT_ASSERT(testObject2.getAttribute(CKA_ID).isByteStringAttribute());
 
-	// NOTE: 3 attributes below cannot be modified after creation and therefore are not required to propagate.
-	CPPUNIT_ASSERT(testObject2.getAttribute(CKA_TOKEN).getBooleanValue() != value1a);
-	CPPUNIT_ASSERT(testObject2.getAttribute(CKA_PRIME_BITS).getUnsignedLongValue() != value2a);
-	CPPUNIT_ASSERT(testObject2.getAttribute(CKA_VALUE_BITS).getUnsignedLongValue() != value3a);
-
-	// CKA_ID attribute can be modified after creation and therefore should have propagated.
+	// The cached attributes are dropped because the generation of the object has advanced
+	CPPUNIT_ASSERT(testObject2.getAttribute(CKA_TOKEN).getBooleanValue() == value1a);
+	CPPUNIT_ASSERT(testObject2.getAttribute(CKA_PRIME_BITS).getUnsignedLongValue() == value2a);
+	CPPUNIT_ASSERT(testObject2.getAttribute(CKA_VALUE_BITS).getUnsignedLongValue() == value3a);
 	CPPUNIT_ASSERT(testObject2.getAttribute(CKA_ID).getByteStringValue() == value4a);
 
 	// Start transaction on object
@@ -67,6 +67,7 @@ class test_a_dbobject_with_an_object : public test_a_dbobject
 	CPPUNIT_TEST(should_store_mixed_attributes);
 	CPPUNIT_TEST(should_store_double_attributes);
 	CPPUNIT_TEST(can_refresh_attributes);
+	CPPUNIT_TEST(should_cache_unchanged_attributes);
 	CPPUNIT_TEST(should_cleanup_statements_during_transactions);
 	CPPUNIT_TEST(should_use_transactions);
 	CPPUNIT_TEST(should_fail_to_delete);
@@ -83,6 +84,7 @@ public:
 	void should_store_mixed_attributes();
 	void should_store_double_attributes();
 	void can_refresh_attributes();
+	void should_cache_unchanged_attributes();
 	void should_cleanup_statements_during_transactions();
 	void should_use_transactions();
 	void should_fail_to_delete();
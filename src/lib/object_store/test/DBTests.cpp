@@ -34,6 +34,7 @@
 #include <string.h>
 #include <cppunit/extensions/HelperMacros.h>
 #include "DBTests.h"
+#include "osthread.h"
 
 CPPUNIT_TEST_SUITE_REGISTRATION(test_a_db);
 
@@ -145,6 +146,35 @@ void test_a_db_with_a_connection::maintains_correct_refcounts()
 	result = DB::Result();
 	CPPUNIT_ASSERT_EQUAL(statement.refcount(), 1);
 }
+
+void test_a_db_with_a_connection::caches_prepared_statements()
+{
+	DB::Statement statement = connection->prepareCached("PRAGMA database_list;");
+	CPPUNIT_ASSERT(statement.isValid());
+
+	// Referenced by the cache as well
+	CPPUNIT_ASSERT_EQUAL(statement.refcount(), 2);
+
+	// A statement that is in use is not handed out again
+	DB::Statement statement1 = connection->prepareCached("PRAGMA database_list;");
+	CPPUNIT_ASSERT(statement1.isValid());
+	CPPUNIT_ASSERT(statement1.handle() != statement.handle());
+	CPPUNIT_ASSERT_EQUAL(statement1.refcount(), 1);
+
+	DB::Result result = connection->perform(statement);
+	CPPUNIT_ASSERT(result.isValid());
+
+	// Once released the cached statement is handed out again, reset
+	DB::Handle *handle = statement.handle();
+	result = DB::Result();
+	statement = DB::Statement();
+
+	DB::Statement statement2 = connection->prepareCached("PRAGMA database_list;");
+	CPPUNIT_ASSERT(statement2.handle() == handle);
+	result = connection->perform(statement2);
+	CPPUNIT_ASSERT(result.isValid());
+	CPPUNIT_ASSERT(!result.nextRow());
+}
 void test_a_db_with_a_connection::can_create_tables()
 {
 	CPPUNIT_ASSERT(!connection->tableExists("object"));
@@ -589,6 +619,150 @@ void test_a_db_with_a_connection_with_tables::supports_transactions()
 	CPPUNIT_ASSERT(connection->commitTransaction());
 }
 
+void test_a_db_with_a_connection_with_tables::supports_read_connections()
+{
+	CPPUNIT_ASSERT(connection->setJournal(true, "normal", 100));
+	{
+		DB::Statement statement = connection->prepare("pragma journal_mode");
+		DB::Result result = connection->perform(statement);
+		CPPUNIT_ASSERT_EQUAL(std::string(result.getString(1)), std::string("wal"));
+	}
+
+	// Unknown synchronous modes are refused
+	DB::LogErrorHandler eh = DB::setLogErrorHandler(dummy_print);
+	CPPUNIT_ASSERT(!connection->setJournal(true, "normal; drop table object", 100));
+	DB::setLogErrorHandler(eh);
+
+	// Without read connections all threads share the connection
+	CPPUNIT_ASSERT(connection->reader() == connection);
+
+	connection->setMaxReaders(1);
+	DB::Connection *reader = connection->reader();
+	CPPUNIT_ASSERT(reader != connection);
+	CPPUNIT_ASSERT(connection->reader() == reader);
+
+	// The read connection sees committed changes
+	can_insert_records();
+	{
+		DB::Statement statement = reader->prepare("select value from attribute_text where type=%d", 1234);
+		DB::Result result = reader->perform(statement);
+		CPPUNIT_ASSERT(result.isValid());
+		CPPUNIT_ASSERT_EQUAL(std::string(result.getString(1)), std::string("testing testing testing"));
+	}
+
+	// but cannot change anything
+	{
+		eh = DB::setLogErrorHandler(dummy_print);
+		DB::Statement statement = reader->prepare("delete from attribute_text");
+		CPPUNIT_ASSERT(!reader->execute(statement));
+		DB::setLogErrorHandler(eh);
+	}
+
+	// Uncommitted changes are only visible through the connection itself
+	CPPUNIT_ASSERT(connection->beginTransactionRW());
+	CPPUNIT_ASSERT(connection->reader() == connection);
+	CPPUNIT_ASSERT(connection->rollbackTransaction());
+	CPPUNIT_ASSERT(connection->reader() == reader);
+}
+
+// A thread that waits for the other readers and then queries the database
+// through its own read connection
+struct ReaderThread
+{
+	DB::Connection *connection;
+	Mutex *mutex;
+	size_t *started;
+	size_t threads;
+
+	CK_VOID_PTR thread;
+	DB::Connection *reader;
+	bool ok;
+};
+
+static void *readRecords(void *arg)
+{
+	ReaderThread *args = (ReaderThread *) arg;
+
+	args->reader = args->connection->reader();
+
+	// Make sure that all readers are in use at the same time
+	{
+		MutexLocker lock(args->mutex);
+		(*args->started)++;
+	}
+	for (;;)
+	{
+		MutexLocker lock(args->mutex);
+		if (*args->started == args->threads) break;
+	}
+
+	args->ok = true;
+	for (size_t i = 0; i < 100 && args->ok; i++)
+	{
+		DB::Statement statement = args->reader->prepare("select value from attribute_text where type=%d", 1234);
+		DB::Result result = args->reader->perform(statement);
+		args->ok = result.isValid() && std::string(result.getString(1)) == "testing testing testing";
+	}
+
+	return NULL;
+}
+
+static void runReaders(DB::Connection *connection, ReaderThread *threads, size_t count)
+{
+	Mutex *mutex = MutexFactory::i()->getMutex();
+	size_t started = 0;
+
+	for (size_t i = 0; i < count; i++)
+	{
+		threads[i].connection = connection;
+		threads[i].mutex = mutex;
+		threads[i].started = &started;
+		threads[i].threads = count;
+		threads[i].reader = NULL;
+		threads[i].ok = false;
+
+		CPPUNIT_ASSERT(OSCreateThread(&threads[i].thread, readRecords, &threads[i]) == CKR_OK);
+	}
+	for (size_t i = 0; i < count; i++)
+	{
+		CPPUNIT_ASSERT(OSJoinThread(threads[i].thread) == CKR_OK);
+	}
+
+	MutexFactory::i()->recycleMutex(mutex);
+}
+
+void test_a_db_with_a_connection_with_tables::supports_concurrent_read_connections()
+{
+	CPPUNIT_ASSERT(connection->setJournal(true, "normal", 100));
+	can_insert_records();
+
+	connection->setMaxReaders(2);
+
+	// Concurrent threads get their own read connections
+	ReaderThread threads[3];
+	runReaders(connection, threads, 3);
+
+	size_t readers = 0;
+	for (size_t i = 0; i < 3; i++)
+	{
+		CPPUNIT_ASSERT(threads[i].ok);
+		if (threads[i].reader != connection) readers++;
+	}
+	CPPUNIT_ASSERT_EQUAL(readers, (size_t) 2);
+
+#ifndef _WIN32
+	// The read connections of threads that exited are available to new threads
+	runReaders(connection, threads, 2);
+
+	for (size_t i = 0; i < 2; i++)
+	{
+		CPPUNIT_ASSERT(threads[i].ok);
+		CPPUNIT_ASSERT(threads[i].reader != connection);
+	}
+	CPPUNIT_ASSERT(threads[0].reader != threads[1].reader);
+#endif
+}
+
 CPPUNIT_TEST_SUITE_REGISTRATION(test_a_db_with_a_connection_with_tables_with_a_second_connection_open);
 
 void test_a_db_with_a_connection_with_tables_with_a_second_connection_open::setUp()
@@ -62,6 +62,7 @@ class test_a_db_with_a_connection : public test_a_db
 	CPPUNIT_TEST(can_prepare_statements);
 	CPPUNIT_TEST(can_perform_statements);
 	CPPUNIT_TEST(maintains_correct_refcounts);
+	CPPUNIT_TEST(caches_prepared_statements);
 	CPPUNIT_TEST(can_create_tables);
 	CPPUNIT_TEST_SUITE_END();
 public:
@@ -71,6 +72,7 @@ public:
 	void can_prepare_statements();
 	void can_perform_statements();
 	void maintains_correct_refcounts();
+	void caches_prepared_statements();
 	void can_create_tables();
 protected:
 	DB::Connection *connection;
@@ -92,6 +94,8 @@ class test_a_db_with_a_connection_with_tables : public test_a_db_with_a_connecti
 	CPPUNIT_TEST(can_update_boolean_attribute_bound_value);
 	CPPUNIT_TEST(can_update_real_attribute_bound_value);
 	CPPUNIT_TEST(supports_transactions);
+	CPPUNIT_TEST(supports_read_connections);
+	CPPUNIT_TEST(supports_concurrent_read_connections);
 	CPPUNIT_TEST_SUITE_END();
 public:
 	void setUp();
@@ -107,6 +111,8 @@ public:
 	void will_not_insert_non_existing_attribute_on_update();
 	void can_update_boolean_attribute_bound_value();
 	void can_update_real_attribute_bound_value();
+	void supports_read_connections();
+	void supports_concurrent_read_connections();
 	void supports_transactions();
 protected:
 
@@ -232,6 +232,59 @@ void test_a_dbtoken::should_fail_to_open_nonexistant_tokens()
 	CPPUNIT_ASSERT(!doesntExist.isValid());
 }
 
+void test_a_dbtoken::should_migrate_unindexed_tokens()
+{
+	ByteString label = "40414243"; // ABCD
+	ByteString serial = "0102030405060708";
+	ByteString id = "112233445566";
+
+	// Create a token with an object on it
+	{
+		DBToken newToken("testdir", "oldToken", label, serial);
+		CPPUNIT_ASSERT(newToken.isValid());
+
+		OSObject* obj = newToken.createObject();
+		CPPUNIT_ASSERT(obj != NULL);
+		CPPUNIT_ASSERT(obj->setAttribute(CKA_ID, id));
+	}
+
+	// Turn it into a token as created by an older version
+	DB::Connection* connection = DB::Connection::Create("testdir/oldToken", "sqlite3.db");
+	CPPUNIT_ASSERT(connection != NULL);
+	CPPUNIT_ASSERT(connection->connect());
+
+	int version = 0;
+	CPPUNIT_ASSERT(connection->getSchemaVersion(version));
+	CPPUNIT_ASSERT(version > 0);
+	CPPUNIT_ASSERT(connection->indexExists("attribute_binary_object_type"));
+
+	DB::Statement statement = connection->prepare("drop index attribute_binary_object_type");
+	CPPUNIT_ASSERT(connection->execute(statement));
+	statement = connection->prepare("drop index attribute_integer_object_type");
+	CPPUNIT_ASSERT(connection->execute(statement));
+	CPPUNIT_ASSERT(connection->setSchemaVersion(0));
+	CPPUNIT_ASSERT(!connection->indexExists("attribute_binary_object_type"));
+
+	// Opening the token updates the schema
+	{
+		DBToken oldToken("testdir", "oldToken");
+		CPPUNIT_ASSERT(oldToken.isValid());
+
+		std::set<OSObject*> objects = oldToken.getObjects();
+		CPPUNIT_ASSERT(objects.size() == 1);
+		CPPUNIT_ASSERT((*objects.begin())->getByteStringValue(CKA_ID) == id);
+	}
+
+	CPPUNIT_ASSERT(connection->getSchemaVersion(version));
+	CPPUNIT_ASSERT(version > 0);
+	CPPUNIT_ASSERT(connection->indexExists("attribute_binary_object_type"));
+	CPPUNIT_ASSERT(connection->indexExists("attribute_integer_object_type"));
+
+	statement = DB::Statement();
+	connection->close();
+	delete connection;
+}
+
 void test_a_dbtoken::support_create_delete_objects()
 {
 	// Test IDs
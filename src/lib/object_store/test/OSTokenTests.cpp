@@ -32,6 +32,9 @@
 
 #include <stdlib.h>
 #include <string.h>
+#include <algorithm>
+#include <vector>
+#include <set>
 #include <cppunit/extensions/HelperMacros.h>
 #include "OSTokenTests.h"
 #include "OSToken.h"
@@ -40,8 +43,16 @@
 #include "Directory.h"
 #include "OSAttribute.h"
 #include "OSAttributes.h"
+#include "Configuration.h"
+#include "Generation.h"
 #include "cryptoki.h"
 
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
 CPPUNIT_TEST_SUITE_REGISTRATION(OSTokenTests);
 
 // FIXME: all pathnames in this file are *NIX/BSD specific
@@ -420,6 +431,32 @@ void OSTokenTests::testCreateDeleteObjects()
 		CPPUNIT_ASSERT(present4[j] == true);
 	}
 
+	// Change an object and check that the other instance picks up the change
+	ByteString newId = "ABCDEF";
+
+	for (std::set<OSObject*>::iterator i = objects.begin(); i != objects.end(); i++)
+	{
+		if ((*i)->getAttribute(CKA_ID).getByteStringValue() == id[0])
+		{
+			CPPUNIT_ASSERT((*i)->setAttribute(CKA_ID, OSAttribute(newId)));
+			break;
+		}
+	}
+
+	otherObjects = sameToken.getObjects();
+	bool present5 = false;
+
+	for (std::set<OSObject*>::iterator i = otherObjects.begin(); i != otherObjects.end(); i++)
+	{
+		CPPUNIT_ASSERT((*i)->isValid());
+
+		if ((*i)->getAttribute(CKA_ID).getByteStringValue() == newId)
+		{
+			present5 = true;
+		}
+	}
+
+	CPPUNIT_ASSERT(present5);
 
 	// Release the test token
 	delete testToken;
@@ -502,3 +539,133 @@ void OSTokenTests::testClearToken()
 	CPPUNIT_ASSERT(!clearedToken.isValid());
 }
 
+void OSTokenTests::testLazyObjects()
+{
+	ByteString label = "40414243"; // ABCD
+	ByteString serial = "0102030405060708";
+	ByteString id1 = "ABCDEF";
+	ByteString id2 = "FEDCBA";
+	ByteString id3 = "AABBCC";
+
+	OSToken* token = OSToken::createToken("testdir", "lazyToken", label, serial);
+	CPPUNIT_ASSERT(token != NULL);
+
+	OSObject* obj1 = token->createObject();
+	CPPUNIT_ASSERT(obj1 != NULL);
+	CPPUNIT_ASSERT(obj1->setAttribute(CKA_ID, id1));
+
+	// Open a second instance; its objects are not read yet
+	OSToken* lazyToken = OSToken::accessToken("testdir", "lazyToken");
+	CPPUNIT_ASSERT(lazyToken != NULL);
+	CPPUNIT_ASSERT(lazyToken->isValid());
+
+	ByteString retrievedLabel;
+	CPPUNIT_ASSERT(lazyToken->getTokenLabel(retrievedLabel));
+	CPPUNIT_ASSERT(retrievedLabel == label);
+
+	// Objects created in the meantime by either instance are all found
+	OSObject* obj2 = token->createObject();
+	CPPUNIT_ASSERT(obj2 != NULL);
+	CPPUNIT_ASSERT(obj2->setAttribute(CKA_ID, id2));
+
+	OSObject* obj3 = lazyToken->createObject();
+	CPPUNIT_ASSERT(obj3 != NULL);
+	CPPUNIT_ASSERT(obj3->setAttribute(CKA_ID, id3));
+
+	std::set<OSObject*> objects = lazyToken->getObjects();
+	CPPUNIT_ASSERT(objects.size() == 3);
+	CPPUNIT_ASSERT(objects.find(obj3) != objects.end());
+
+	bool present[3] = { false, false, false };
+	for (std::set<OSObject*>::iterator i = objects.begin(); i != objects.end(); i++)
+	{
+		ByteString retrievedId = (*i)->getAttribute(CKA_ID).getByteStringValue();
+
+		present[0] |= (retrievedId == id1);
+		present[1] |= (retrievedId == id2);
+		present[2] |= (retrievedId == id3);
+	}
+
+	CPPUNIT_ASSERT(present[0] && present[1] && present[2]);
+
+	delete lazyToken;
+	delete token;
+}
+
+void OSTokenTests::testGenerationPage()
+{
+	ByteString label = "40414243"; // ABCD
+	ByteString serial = "0102030405060708";
+	ByteString userPIN = "0201020304";
+	ByteString userPIN2 = "0403020102";
+	ByteString id1 = "ABCDEF";
+	ByteString id2 = "FEDCBA";
+
+	// Only the generations report changes between the instances
+	Configuration::i()->setBool("objectstore.genpage", true);
+	Configuration::i()->setBool("objectstore.monitor", false);
+
+	OSToken* token = OSToken::createToken("testdir", "pageToken", label, serial);
+	CPPUNIT_ASSERT(token != NULL);
+
+	OSToken* sameToken = OSToken::accessToken("testdir", "pageToken");
+	CPPUNIT_ASSERT(sameToken != NULL);
+	CPPUNIT_ASSERT(sameToken->isValid());
+
+	// Both instances share the page
+	Directory tokenDir("testdir/pageToken");
+	std::vector<std::string> files = tokenDir.getFiles();
+	CPPUNIT_ASSERT(std::find(files.begin(), files.end(), "generation.page") != files.end());
+
+	// An object created by one instance is found by the other
+	OSObject* obj = token->createObject();
+	CPPUNIT_ASSERT(obj != NULL);
+	CPPUNIT_ASSERT(obj->setAttribute(CKA_ID, id1));
+
+	std::set<OSObject*> objects = sameToken->getObjects();
+	CPPUNIT_ASSERT(objects.size() == 1);
+	OSObject* sameObj = *objects.begin();
+	CPPUNIT_ASSERT(sameObj->isValid());
+	CPPUNIT_ASSERT(sameObj->getAttribute(CKA_ID).getByteStringValue() == id1);
+
+	// Changes to the object and the token are seen by the other instance
+	CPPUNIT_ASSERT(obj->setAttribute(CKA_ID, id2));
+	CPPUNIT_ASSERT(sameObj->isValid());
+	CPPUNIT_ASSERT(sameObj->getAttribute(CKA_ID).getByteStringValue() == id2);
+
+	CPPUNIT_ASSERT(sameObj->setAttribute(CKA_ID, id1));
+	CPPUNIT_ASSERT(obj->isValid());
+	CPPUNIT_ASSERT(obj->getAttribute(CKA_ID).getByteStringValue() == id1);
+
+	CPPUNIT_ASSERT(token->setUserPIN(userPIN));
+	ByteString retrievedPIN;
+	CPPUNIT_ASSERT(sameToken->getUserPIN(retrievedPIN));
+	CPPUNIT_ASSERT(retrievedPIN == userPIN);
+
+	// A change that is not reported to the page is seen after a while
+	Configuration::i()->setBool("objectstore.genpage", false);
+	OSToken* otherToken = OSToken::accessToken("testdir", "pageToken");
+	CPPUNIT_ASSERT(otherToken != NULL);
+	CPPUNIT_ASSERT(otherToken->setUserPIN(userPIN2));
+	delete otherToken;
+	Configuration::i()->setBool("objectstore.genpage", true);
+
+#ifdef _WIN32
+	Sleep((GENERATION_RECHECK_INTERVAL + 1) * 1000);
+#else
+	sleep(GENERATION_RECHECK_INTERVAL + 1);
+#endif
+	CPPUNIT_ASSERT(sameToken->getUserPIN(retrievedPIN));
+	CPPUNIT_ASSERT(retrievedPIN == userPIN2);
+
+	// A deleted object disappears from the other instance
+	CPPUNIT_ASSERT(token->deleteObject(obj));
+	CPPUNIT_ASSERT(sameToken->getObjects().empty());
+	CPPUNIT_ASSERT(!sameObj->isValid());
+
+	delete sameToken;
+	delete token;
+
+	Configuration::i()->setBool("objectstore.genpage", false);
+	Configuration::i()->setBool("objectstore.monitor", true);
+}
@@ -607,6 +607,132 @@ void ObjectFileTests::testRefresh()
 	}
 }
 
+void ObjectFileTests::testUpdatedAttr()
+{
+	// Create test object instance
+#ifndef _WIN32
+	ObjectFile testObject(NULL, "testdir/test.object", "testdir/test.lock", true);
+#else
+	ObjectFile testObject(NULL, "testdir\\test.object", "testdir\\test.lock", true);
+#endif
+
+	CPPUNIT_ASSERT(testObject.isValid());
+
+	ByteString value1 = "010203040506070809";
+	ByteString value2 = "0A0B0C0D0E0F";
+
+	CPPUNIT_ASSERT(testObject.setAttribute(CKA_TOKEN, OSAttribute(true)));
+	CPPUNIT_ASSERT(testObject.setAttribute(CKA_ID, OSAttribute(value1)));
+	CPPUNIT_ASSERT(testObject.setAttribute(CKA_LABEL, OSAttribute(value2)));
+
+	// Update a single attribute many times
+	for (unsigned long i = 0; i < 100; i++)
+	{
+		CPPUNIT_ASSERT(testObject.setAttribute(CKA_PRIME_BITS, OSAttribute(i)));
+	}
+
+	// Create secondary instance for the same object
+#ifndef _WIN32
+	ObjectFile testObject2(NULL, "testdir/test.object", "testdir/test.lock");
+#else
+	ObjectFile testObject2(NULL, "testdir\\test.object", "testdir\\test.lock");
+#endif
+
+	CPPUNIT_ASSERT(testObject2.isValid());
+
+	// Check that it sees the latest values
+	CPPUNIT_ASSERT(testObject2.getBooleanValue(CKA_TOKEN, false));
+	CPPUNIT_ASSERT(testObject2.getByteStringValue(CKA_ID) == value1);
+	CPPUNIT_ASSERT(testObject2.getByteStringValue(CKA_LABEL) == value2);
+	CPPUNIT_ASSERT(testObject2.getUnsignedLongValue(CKA_PRIME_BITS, 0) == 99);
+
+	// Check that superseded values do not pile up in the object file
+#ifndef _WIN32
+	FILE* stream = fopen("testdir/test.object", "r");
+#else
+	FILE* stream = fopen("testdir\\test.object", "rb");
+#endif
+
+	CPPUNIT_ASSERT(stream != NULL);
+	CPPUNIT_ASSERT(!fseek(stream, 0, SEEK_END));
+
+	long size = ftell(stream);
+
+	fclose(stream);
+
+	CPPUNIT_ASSERT(size > 0);
+	CPPUNIT_ASSERT(size < 512);
+
+	// Changes by the secondary instance are seen by the first one
+	CPPUNIT_ASSERT(testObject2.setAttribute(CKA_PRIME_BITS, OSAttribute((unsigned long) 0x1234)));
+	CPPUNIT_ASSERT(testObject.isValid());
+	CPPUNIT_ASSERT(testObject.getUnsignedLongValue(CKA_PRIME_BITS, 0) == 0x1234);
+
+	// And the other way around
+	CPPUNIT_ASSERT(testObject.setAttribute(CKA_ID, OSAttribute(value2)));
+	CPPUNIT_ASSERT(testObject2.isValid());
+	CPPUNIT_ASSERT(testObject2.getByteStringValue(CKA_ID) == value2);
+	CPPUNIT_ASSERT(testObject2.getUnsignedLongValue(CKA_PRIME_BITS, 0) == 0x1234);
+}
+
+void ObjectFileTests::testInterruptedAppend()
+{
+#ifndef _WIN32
+	std::string path = "testdir/test.object";
+	std::string lockpath = "testdir/test.lock";
+#else
+	std::string path = "testdir\\test.object";
+	std::string lockpath = "testdir\\test.lock";
+#endif
+
+	{
+		ObjectFile testObject(NULL, path, lockpath, true);
+
+		CPPUNIT_ASSERT(testObject.isValid());
+		CPPUNIT_ASSERT(testObject.setAttribute(CKA_TOKEN, OSAttribute(true)));
+		CPPUNIT_ASSERT(testObject.setAttribute(CKA_PRIME_BITS, OSAttribute((unsigned long) 0x1234)));
+	}
+
+	// A process that dies between appending a record and updating the
+	// generation leaves a complete record, which is read as the latest value
+	{
+		File objectFile(path, true, true, false, false);
+
+		CPPUNIT_ASSERT(objectFile.isValid());
+		CPPUNIT_ASSERT(objectFile.seek());
+		CPPUNIT_ASSERT(objectFile.writeULong(CKA_PRIME_BITS));
+		CPPUNIT_ASSERT(objectFile.writeULong(0x2)); // ULONG_ATTR
+		CPPUNIT_ASSERT(objectFile.writeULong(0x5678));
+		CPPUNIT_ASSERT(objectFile.flush());
+	}
+
+	{
+		ObjectFile testObject(NULL, path, lockpath);
+
+		CPPUNIT_ASSERT(testObject.isValid());
+		CPPUNIT_ASSERT(testObject.getBooleanValue(CKA_TOKEN, false));
+		CPPUNIT_ASSERT(testObject.getUnsignedLongValue(CKA_PRIME_BITS, 0) == 0x5678);
+	}
+
+	// One that dies while appending a record leaves a torn record, which
+	// makes the object read as corrupt
+	{
+		File objectFile(path, true, true, false, false);
+
+		CPPUNIT_ASSERT(objectFile.isValid());
+		CPPUNIT_ASSERT(objectFile.seek());
+		CPPUNIT_ASSERT(objectFile.writeULong(CKA_PRIME_BITS));
+		CPPUNIT_ASSERT(objectFile.writeULong(0x2)); // ULONG_ATTR
+		CPPUNIT_ASSERT(objectFile.flush());
+	}
+
+	{
+		ObjectFile testObject(NULL, path, lockpath);
+
+		CPPUNIT_ASSERT(!testObject.isValid());
+	}
+}
+
 void ObjectFileTests::testCorruptFile()
 {
 #ifndef _WIN32
@@ -45,6 +45,8 @@ class ObjectFileTests : public CppUnit::TestFixture
 	CPPUNIT_TEST(testMixedAttr);
 	CPPUNIT_TEST(testDoubleAttr);
 	CPPUNIT_TEST(testRefresh);
+	CPPUNIT_TEST(testUpdatedAttr);
+	CPPUNIT_TEST(testInterruptedAppend);
 	CPPUNIT_TEST(testCorruptFile);
 	CPPUNIT_TEST(testTransactions);
 	CPPUNIT_TEST(testDestroyObjectFails);
@@ -58,6 +60,8 @@ public:
 	void testMixedAttr();
 	void testDoubleAttr();
 	void testRefresh();
+	void testUpdatedAttr();
+	void testInterruptedAppend();
 	void testCorruptFile();
 	void testTransactions();
 	void testDestroyObjectFails();
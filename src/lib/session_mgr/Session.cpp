@@ -53,6 +53,7 @@ Session::Session(Slot* inSlot, bool inIsReadWrite, CK_VOID_PTR inPApplication, C
 	allowMultiPartOp = false;
 	publicKey = NULL;
 	privateKey = NULL;
+	isCachedPrivateKey = false;
 	symmetricKey = NULL;
 	param = NULL;
 	paramLen = 0;
@@ -78,6 +79,7 @@ Session::Session()
 	allowMultiPartOp = false;
 	publicKey = NULL;
 	privateKey = NULL;
+	isCachedPrivateKey = false;
 	symmetricKey = NULL;
 	param = NULL;
 	paramLen = 0;
@@ -206,7 +208,7 @@ void Session::resetOp()
 		}
 		if (privateKey != NULL)
 		{
-			asymmetricCryptoOp->recyclePrivateKey(privateKey);
+			releasePrivateKey();
 			privateKey = NULL;
 		}
 		CryptoFactory::i()->recycleAsymmetricAlgorithm(asymmetricCryptoOp);
@@ -389,17 +391,32 @@ PublicKey* Session::getPublicKey()
 	return publicKey;
 }
 
-void Session::setPrivateKey(PrivateKey* inPrivateKey)
+void Session::setPrivateKey(PrivateKey* inPrivateKey, bool inIsCached /* = false */)
 {
 	if (asymmetricCryptoOp == NULL)
 		return;
 
 	if (privateKey != NULL)
 	{
-		asymmetricCryptoOp->recyclePrivateKey(privateKey);
+		releasePrivateKey();
 	}
 
 	privateKey = inPrivateKey;
+	isCachedPrivateKey = inIsCached && (inPrivateKey != NULL);
+}
+
+void Session::releasePrivateKey()
+{
+	if (isCachedPrivateKey && token != NULL)
+	{
+		token->getPrivateKeyCache()->release(privateKey);
+	}
+	else
+	{
+		asymmetricCryptoOp->recyclePrivateKey(privateKey);
+	}
+
+	isCachedPrivateKey = false;
 }
 
 PrivateKey* Session::getPrivateKey()
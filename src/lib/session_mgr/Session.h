@@ -113,7 +113,8 @@ public:
 	void setPublicKey(PublicKey* inPublicKey);
 	PublicKey* getPublicKey();
 
-	void setPrivateKey(PrivateKey* inPrivateKey);
+	// A cached key is owned by the token's private key cache
+	void setPrivateKey(PrivateKey* inPrivateKey, bool inIsCached = false);
 	PrivateKey* getPrivateKey();
 
 	void setSymmetricKey(SymmetricKey* inSymmetricKey);
@@ -160,6 +161,10 @@ private:
 	bool allowSinglePartOp;
 	PublicKey* publicKey;
 	PrivateKey* privateKey;
+	bool isCachedPrivateKey;
+
+	// Give the private key back to its owner
+	void releasePrivateKey();
 
 	// Symmetric Crypto
 	SymmetricKey* symmetricKey;
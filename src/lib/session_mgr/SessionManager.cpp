@@ -27,11 +27,14 @@
 /*****************************************************************************
  SessionManager.cpp
 
- Keeps track of the sessions within SoftHSM. The sessions are stored in a 
- vector. When a session is closed, its spot in the vector will be replaced
- with NULL. Because we want to keep track of the session ID which is 
- equal to its location in the vector. New sessions will first fill up the NULL
- locations and if there is no empty spots, then they are added to the end.
+ Keeps track of the sessions within SoftHSM. The session handle of a closed
+ session is put on a free list; new sessions first reuse the lowest free
+ handle and if there is none, they get the next unused one. The sessions are
+ spread over a number of separately locked partitions on their handle, and
+ the sessions of each slot are indexed so that slot-wide operations do not
+ need to look at the sessions of other slots. Where the compiler offers
+ atomic builtins, lookups are first served without locking from a table that
+ is published with sequence counters, as in the handle manager.
  *****************************************************************************/
 
 #include "SessionManager.h"
@@ -40,18 +43,35 @@
 // Constructor
 SessionManager::SessionManager()
 {
+	for (size_t i = 0; i < SESSION_MANAGER_STRIPES; i++)
+	{
+		stripeMutex[i] = MutexFactory::i()->getMutex();
+	}
 	sessionsMutex = MutexFactory::i()->getMutex();
+	handleCounter = 0;
+
+	for (size_t i = 0; i < SESSION_MANAGER_LOOKUP_SLOTS; i++)
+	{
+		lookupSlots[i].sequence = 0;
+		lookupSlots[i].handle = CK_INVALID_HANDLE;
+		lookupSlots[i].session = NULL;
+	}
 }
 
 // Destructor
 SessionManager::~SessionManager()
 {
-	std::vector<Session*> toDelete = sessions;
-	sessions.clear();
-
-	for (std::vector<Session*>::iterator i = toDelete.begin(); i != toDelete.end(); i++)
+	for (size_t i = 0; i < SESSION_MANAGER_STRIPES; i++)
 	{
-		if (*i != NULL) delete *i;
+		std::map<CK_SESSION_HANDLE, Session*> toDelete = sessions[i];
+		sessions[i].clear();
+
+		for (std::map<CK_SESSION_HANDLE, Session*>::iterator j = toDelete.begin(); j != toDelete.end(); j++)
+		{
+			delete j->second;
+		}
+
+		MutexFactory::i()->recycleMutex(stripeMutex[i]);
 	}
 
 	MutexFactory::i()->recycleMutex(sessionsMutex);
@@ -71,7 +91,7 @@ CK_RV SessionManager::openSession
 	if (slot == NULL) return CKR_SLOT_ID_INVALID;
 	if ((flags & CKF_SERIAL_SESSION) == 0) return CKR_SESSION_PARALLEL_NOT_SUPPORTED;
 
-	// Lock access to the vector
+	// Lock access to the handle allocation
 	MutexLocker lock(sessionsMutex);
 
 	// Get the token
@@ -89,24 +109,34 @@ CK_RV SessionManager::openSession
 	bool rwSession = ((flags & CKF_RW_SESSION) == CKF_RW_SESSION) ? true : false;
 	Session* session = new Session(slot, rwSession, pApplication, notify);
 
-	// First fill any empty spot in the list
-	for (size_t i = 0; i < sessions.size(); i++)
+	// First reuse the lowest free handle, or else take a new one
+	CK_SESSION_HANDLE hSession;
+	if (!freeHandles.empty())
 	{
-		if (sessions[i] != NULL)
-		{
-			continue;
-		}
+		hSession = *freeHandles.begin();
+		freeHandles.erase(freeHandles.begin());
+	}
+	else
+	{
+		hSession = ++handleCounter;
+	}
+
+	session->setHandle(hSession);
 
-		sessions[i] = session;
-		session->setHandle(i + 1);
-		*phSession = session->getHandle();
+	// Register the session with its slot
+	SlotSessions& slotSessions = slots[slot->getSlotID()];
+	slotSessions.sessions.insert(hSession);
+	if (!rwSession) slotSessions.roSessions++;
 
-		return CKR_OK;
+	// Publish the session
+	size_t stripe = stripeOf(hSession);
+	{
+		MutexLocker stripeLock(stripeMutex[stripe]);
+
+		sessions[stripe][hSession] = session;
+		publish(hSession, session);
 	}
 
-	// Or add it to the end
-	sessions.push_back(session);
-	session->setHandle(sessions.size());
 	*phSession = session->getHandle();
 
 	return CKR_OK;
@@ -117,39 +147,23 @@ CK_RV SessionManager::closeSession(CK_SESSION_HANDLE hSession)
 {
 	if (hSession == CK_INVALID_HANDLE) return CKR_SESSION_HANDLE_INVALID;
 
-	// Lock access to the vector
+	// Lock access to the handle allocation
 	MutexLocker lock(sessionsMutex);
 
-	// Check if we are out of range
-	if (hSession > sessions.size()) return CKR_SESSION_HANDLE_INVALID;
-
-	// Check if it is a closed session
-	unsigned long sessionID = hSession - 1;
-	if (sessions[sessionID] == NULL) return CKR_SESSION_HANDLE_INVALID;
-
-	// Check if this is the last session on the token
-	bool lastSession = true;
-	const CK_SLOT_ID slotID( sessions[sessionID]->getSlot()->getSlotID() );
-	for (size_t i = 0; i < sessions.size(); i++)
-	{
-		if (sessions[i] == NULL) continue;
-
-		if (sessions[i]->getSlot()->getSlotID() == slotID && i != sessionID)
-		{
-			lastSession = false;
-			break;
-		}
-	}
+	// Check if it is an open session
+	Session* session = getSession(hSession);
+	if (session == NULL) return CKR_SESSION_HANDLE_INVALID;
 
 	// Logout if this is the last session on the token
-	if (lastSession)
+	const CK_SLOT_ID slotID( session->getSlot()->getSlotID() );
+	std::map<CK_SLOT_ID, SlotSessions>::iterator it = slots.find(slotID);
+	if (it == slots.end() || it->second.sessions.size() <= 1)
 	{
-		sessions[sessionID]->getSlot()->getToken()->logout();
+		session->getSlot()->getToken()->logout();
 	}
 
 	// Close the session
-	delete sessions[sessionID];
-	sessions[sessionID] = NULL;
+	delete removeSession(hSession);
 
 	return CKR_OK;
 }
@@ -159,7 +173,7 @@ CK_RV SessionManager::closeAllSessions(Slot* slot)
 {
 	if (slot == NULL) return CKR_SLOT_ID_INVALID;
 
-	// Lock access to the vector
+	// Lock access to the handle allocation
 	MutexLocker lock(sessionsMutex);
 
 	// Get the token
@@ -167,15 +181,14 @@ CK_RV SessionManager::closeAllSessions(Slot* slot)
 	if (token == NULL) return CKR_TOKEN_NOT_PRESENT;
 
 	// Close all sessions on this slot
-	const CK_SLOT_ID slotID( slot->getSlotID() );
-	for (std::vector<Session*>::iterator i = sessions.begin(); i != sessions.end(); i++)
+	std::map<CK_SLOT_ID, SlotSessions>::iterator it = slots.find(slot->getSlotID());
+	if (it != slots.end())
 	{
-		if (*i == NULL) continue;
+		std::set<CK_SESSION_HANDLE> toClose = it->second.sessions;
 
-		if ((*i)->getSlot()->getSlotID() == slotID)
+		for (std::set<CK_SESSION_HANDLE>::iterator i = toClose.begin(); i != toClose.end(); i++)
 		{
-			delete *i;
-			*i = NULL;
+			delete removeSession(*i);
 		}
 	}
 
@@ -198,49 +211,126 @@ CK_RV SessionManager::getSessionInfo(CK_SESSION_HANDLE hSession, CK_SESSION_INFO
 // Get the session
 Session* SessionManager::getSession(CK_SESSION_HANDLE hSession)
 {
-	// Lock access to the vector
-	MutexLocker lock(sessionsMutex);
-
-	// We do not want to get a negative number below
+	// We do not want to look up the invalid handle
 	if (hSession == CK_INVALID_HANDLE) return NULL;
 
-	// Check if we are out of range
-	if (hSession > sessions.size()) return NULL;
+	Session* session;
+	if (lookup(hSession, session)) return session;
+
+	// Only the partition of the session is locked
+	size_t stripe = stripeOf(hSession);
+	MutexLocker lock(stripeMutex[stripe]);
+
+	std::map<CK_SESSION_HANDLE, Session*>::iterator it = sessions[stripe].find(hSession);
+	if (it == sessions[stripe].end()) return NULL;
 
-	return sessions[hSession - 1];
+	return it->second;
 }
 
 bool SessionManager::haveSession(CK_SLOT_ID slotID)
 {
-	// Lock access to the vector
+	// Lock access to the slot index
 	MutexLocker lock(sessionsMutex);
 
-	for (std::vector<Session*>::iterator i = sessions.begin(); i != sessions.end(); i++)
-	{
-		if (*i == NULL) continue;
-
-		if ((*i)->getSlot()->getSlotID() == slotID)
-		{
-			return true;
-		}
-	}
+	std::map<CK_SLOT_ID, SlotSessions>::iterator it = slots.find(slotID);
 
-	return false;
+	return it != slots.end() && !it->second.sessions.empty();
 }
 
 bool SessionManager::haveROSession(CK_SLOT_ID slotID)
 {
-	// Lock access to the vector
+	// Lock access to the slot index
 	MutexLocker lock(sessionsMutex);
 
-	for (std::vector<Session*>::iterator i = sessions.begin(); i != sessions.end(); i++)
+	std::map<CK_SLOT_ID, SlotSessions>::iterator it = slots.find(slotID);
+
+	return it != slots.end() && it->second.roSessions > 0;
+}
+
+// Return the partition of the session table that holds the given handle
+/*static*/ size_t SessionManager::stripeOf(CK_SESSION_HANDLE hSession)
+{
+	return (size_t)(hSession % SESSION_MANAGER_STRIPES);
+}
+
+// Look up the session without locking
+// Returns false when the lookup table cannot answer for the handle
+bool SessionManager::lookup(CK_SESSION_HANDLE hSession, Session*& session)
+{
+#ifdef __GNUC__
+	const LookupSlot& slot = lookupSlots[hSession % SESSION_MANAGER_LOOKUP_SLOTS];
+
+	unsigned long sequence = slot.sequence;
+	if (sequence & 1) return false;
+	__sync_synchronize();
+
+	CK_SESSION_HANDLE slotHandle = slot.handle;
+	Session* slotSession = slot.session;
+
+	__sync_synchronize();
+	if (slot.sequence != sequence || slotHandle != hSession) return false;
+
+	session = slotSession;
+	return true;
+#else
+	(void) hSession;
+	(void) session;
+	return false;
+#endif
+}
+
+// Make the session of the handle, or NULL for a closed one, available to
+// lookups without locking
+// Calling function must lock the stripe mutex of the handle
+void SessionManager::publish(CK_SESSION_HANDLE hSession, Session* session)
+{
+#ifdef __GNUC__
+	LookupSlot& slot = lookupSlots[hSession % SESSION_MANAGER_LOOKUP_SLOTS];
+
+	// A closed session only clears the entry if it still holds its handle
+	if (session == NULL && slot.handle != hSession) return;
+
+	slot.sequence++;
+	__sync_synchronize();
+	slot.handle = hSession;
+	slot.session = session;
+	__sync_synchronize();
+	slot.sequence++;
+#else
+	(void) hSession;
+	(void) session;
+#endif
+}
+
+// Remove the session from the table and the slot index and free its handle;
+// returns the session, which the caller must delete
+// Calling function must lock the mutex
+Session* SessionManager::removeSession(CK_SESSION_HANDLE hSession)
+{
+	Session* session = NULL;
+
+	size_t stripe = stripeOf(hSession);
 	{
-		if (*i == NULL) continue;
+		MutexLocker stripeLock(stripeMutex[stripe]);
 
-		if ((*i)->getSlot()->getSlotID() != slotID) continue;
+		std::map<CK_SESSION_HANDLE, Session*>::iterator it = sessions[stripe].find(hSession);
+		if (it == sessions[stripe].end()) return NULL;
 
-		if ((*i)->isRW() == false) return true;
+		session = it->second;
+		sessions[stripe].erase(it);
+		publish(hSession, NULL);
 	}
 
-	return false;
+	std::map<CK_SLOT_ID, SlotSessions>::iterator it = slots.find(session->getSlot()->getSlotID());
+	if (it != slots.end())
+	{
+		it->second.sessions.erase(hSession);
+		if (!session->isRW() && it->second.roSessions > 0) it->second.roSessions--;
+
+		if (it->second.sessions.empty()) slots.erase(it);
+	}
+
+	freeHandles.insert(hSession);
+
+	return session;
 }
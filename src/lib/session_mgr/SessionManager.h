@@ -38,8 +38,16 @@
 #include "MutexFactory.h"
 #include "config.h"
 #include "cryptoki.h"
+#include <map>
 #include <memory>
-#include <vector>
+#include <set>
+
+// Number of independently locked partitions of the session table
+#define SESSION_MANAGER_STRIPES 16
+
+// Number of entries in the table that serves lookups without locking,
+// a multiple of SESSION_MANAGER_STRIPES
+#define SESSION_MANAGER_LOOKUP_SLOTS 1024
 
 class SessionManager
 {
@@ -57,10 +65,46 @@ public:
 	bool haveROSession(CK_SLOT_ID slotID);
 
 private:
-	// The sessions
-	std::vector<Session*> sessions;
+	// The sessions that are open on a slot
+	struct SlotSessions
+	{
+		std::set<CK_SESSION_HANDLE> sessions;
+		size_t roSessions;
+
+		SlotSessions() : roSessions(0) { }
+	};
+
+	// An entry of the lookup table, published with a sequence counter that
+	// is odd while the entry is being written
+	struct LookupSlot
+	{
+		volatile unsigned long sequence;
+		volatile CK_SESSION_HANDLE handle;
+		Session* volatile session;
+	};
+
+	// The session table is partitioned on the session handle, so that
+	// lookups of different sessions do not contend for the same mutex
+	Mutex* stripeMutex[SESSION_MANAGER_STRIPES];
+	std::map<CK_SESSION_HANDLE, Session*> sessions[SESSION_MANAGER_STRIPES];
+
+	// The open sessions, read without locking. An entry is only written
+	// under the mutex of the stripe that its handles belong to.
+	LookupSlot lookupSlots[SESSION_MANAGER_LOOKUP_SLOTS];
+
+	// Guards the handle allocation and the slot index. When both are
+	// needed, this mutex is locked before a stripe mutex.
 	Mutex* sessionsMutex;
+	std::set<CK_SESSION_HANDLE> freeHandles;
+	CK_SESSION_HANDLE handleCounter;
+	std::map<CK_SLOT_ID, SlotSessions> slots;
+
+	static size_t stripeOf(CK_SESSION_HANDLE hSession);
+
+	bool lookup(CK_SESSION_HANDLE hSession, Session*& session);
+	void publish(CK_SESSION_HANDLE hSession, Session* session);
+
+	Session* removeSession(CK_SESSION_HANDLE hSession);
 };
 
 #endif // !_SOFTHSM_V2_SESSIONMANAGER_H
-
@@ -32,27 +32,133 @@
 
 #include <stdlib.h>
 #include <string.h>
+#include <vector>
 #include <cppunit/extensions/HelperMacros.h>
 #include "SessionManagerTests.h"
 #include "SessionManager.h"
+#include "SlotManager.h"
+#include "ObjectStore.h"
 #include "cryptoki.h"
 
 CPPUNIT_TEST_SUITE_REGISTRATION(SessionManagerTests);
 
 void SessionManagerTests::setUp()
 {
+	CPPUNIT_ASSERT(!system("mkdir testdir"));
 }
 
 void SessionManagerTests::tearDown()
 {
+#ifndef _WIN32
+	CPPUNIT_ASSERT(!system("rm -rf testdir"));
+#else
+	CPPUNIT_ASSERT(!system("rmdir /s /q testdir 2> nul"));
+#endif
 }
 
 void SessionManagerTests::testOpenClose()
 {
-	// TODO ???
+	// Create an object store with two tokens
+#ifndef _WIN32
+	ObjectStore store("./testdir");
+#else
+	ObjectStore store(".\\testdir");
+#endif
 
-	// CK_SESSION_HANDLE hSession;
-	// CK_RV rv;
-	// rv = SessionManager::i()->openSession()
-	// CPPUNIT_ASSERT(rv == CKR_OK);
+	ByteString label1 = "DEADBEEF";
+	ByteString label2 = "DEADC0FFEE";
+
+	CPPUNIT_ASSERT(store.newToken(label1) != NULL);
+	CPPUNIT_ASSERT(store.newToken(label2) != NULL);
+
+	SlotManager slotManager(&store);
+
+	CK_SLOT_ID slotList[10];
+	CK_ULONG ulCount = 10;
+
+	CPPUNIT_ASSERT(slotManager.getSlotList(&store, CK_TRUE, slotList, &ulCount) == CKR_OK);
+	CPPUNIT_ASSERT(ulCount == 3);
+
+	Slot* slot1 = slotManager.getSlot(slotList[0]);
+	Slot* slot2 = slotManager.getSlot(slotList[1]);
+
+	CPPUNIT_ASSERT(slot1 != NULL && slot1->getToken()->isInitialized());
+	CPPUNIT_ASSERT(slot2 != NULL && slot2->getToken()->isInitialized());
+
+	SessionManager sessionManager;
+	CK_SESSION_HANDLE hSession[4];
+
+	// Sessions need a slot and must be serial
+	CPPUNIT_ASSERT(sessionManager.openSession(NULL, CKF_SERIAL_SESSION, NULL_PTR, NULL_PTR, &hSession[0]) == CKR_SLOT_ID_INVALID);
+	CPPUNIT_ASSERT(sessionManager.openSession(slot1, 0, NULL_PTR, NULL_PTR, &hSession[0]) == CKR_SESSION_PARALLEL_NOT_SUPPORTED);
+
+	// Open sessions on both slots
+	CPPUNIT_ASSERT(sessionManager.openSession(slot1, CKF_SERIAL_SESSION | CKF_RW_SESSION, NULL_PTR, NULL_PTR, &hSession[0]) == CKR_OK);
+	CPPUNIT_ASSERT(sessionManager.openSession(slot1, CKF_SERIAL_SESSION, NULL_PTR, NULL_PTR, &hSession[1]) == CKR_OK);
+	CPPUNIT_ASSERT(sessionManager.openSession(slot2, CKF_SERIAL_SESSION | CKF_RW_SESSION, NULL_PTR, NULL_PTR, &hSession[2]) == CKR_OK);
+	CPPUNIT_ASSERT(sessionManager.openSession(slot1, CKF_SERIAL_SESSION | CKF_RW_SESSION, NULL_PTR, NULL_PTR, &hSession[3]) == CKR_OK);
+
+	for (CK_ULONG i = 0; i < 4; i++)
+	{
+		CPPUNIT_ASSERT(hSession[i] == i + 1);
+		CPPUNIT_ASSERT(sessionManager.getSession(hSession[i]) != NULL);
+		CPPUNIT_ASSERT(sessionManager.getSession(hSession[i])->getHandle() == hSession[i]);
+	}
+
+	CPPUNIT_ASSERT(sessionManager.getSession(CK_INVALID_HANDLE) == NULL);
+	CPPUNIT_ASSERT(sessionManager.getSession(5) == NULL);
+
+	CPPUNIT_ASSERT(sessionManager.haveSession(slotList[0]));
+	CPPUNIT_ASSERT(sessionManager.haveSession(slotList[1]));
+	CPPUNIT_ASSERT(!sessionManager.haveSession(slotList[2]));
+	CPPUNIT_ASSERT(sessionManager.haveROSession(slotList[0]));
+	CPPUNIT_ASSERT(!sessionManager.haveROSession(slotList[1]));
+
+	// Close the read-only session; its handle is reused first
+	CPPUNIT_ASSERT(sessionManager.closeSession(hSession[1]) == CKR_OK);
+	CPPUNIT_ASSERT(sessionManager.closeSession(hSession[1]) == CKR_SESSION_HANDLE_INVALID);
+	CPPUNIT_ASSERT(sessionManager.getSession(hSession[1]) == NULL);
+	CPPUNIT_ASSERT(!sessionManager.haveROSession(slotList[0]));
+
+	CPPUNIT_ASSERT(sessionManager.openSession(slot2, CKF_SERIAL_SESSION, NULL_PTR, NULL_PTR, &hSession[1]) == CKR_OK);
+	CPPUNIT_ASSERT(hSession[1] == 2);
+	CPPUNIT_ASSERT(sessionManager.haveROSession(slotList[1]));
+
+	// Close all sessions of the first slot
+	CPPUNIT_ASSERT(sessionManager.closeAllSessions(slot1) == CKR_OK);
+	CPPUNIT_ASSERT(!sessionManager.haveSession(slotList[0]));
+	CPPUNIT_ASSERT(sessionManager.getSession(hSession[0]) == NULL);
+	CPPUNIT_ASSERT(sessionManager.getSession(hSession[3]) == NULL);
+	CPPUNIT_ASSERT(sessionManager.getSession(hSession[1]) != NULL);
+	CPPUNIT_ASSERT(sessionManager.getSession(hSession[2]) != NULL);
+
+	// The lowest free handle is handed out again
+	CK_SESSION_HANDLE hNew;
+	CPPUNIT_ASSERT(sessionManager.openSession(slot1, CKF_SERIAL_SESSION, NULL_PTR, NULL_PTR, &hNew) == CKR_OK);
+	CPPUNIT_ASSERT(hNew == 1);
+
+	// Handles that share an entry of the lookup table are told apart
+	std::vector<CK_SESSION_HANDLE> hMany(2 * SESSION_MANAGER_LOOKUP_SLOTS);
+	for (size_t i = 0; i < hMany.size(); i++)
+	{
+		CPPUNIT_ASSERT(sessionManager.openSession(slot2, CKF_SERIAL_SESSION, NULL_PTR, NULL_PTR, &hMany[i]) == CKR_OK);
+	}
+	for (size_t i = 0; i < hMany.size(); i++)
+	{
+		CPPUNIT_ASSERT(sessionManager.getSession(hMany[i]) != NULL);
+		CPPUNIT_ASSERT(sessionManager.getSession(hMany[i])->getHandle() == hMany[i]);
+	}
+	for (size_t i = 0; i < hMany.size(); i++)
+	{
+		CPPUNIT_ASSERT(sessionManager.closeSession(hMany[i]) == CKR_OK);
+		CPPUNIT_ASSERT(sessionManager.getSession(hMany[i]) == NULL);
+	}
+	CPPUNIT_ASSERT(sessionManager.getSession(hNew) != NULL);
+
+	// Close the remaining sessions one by one
+	CPPUNIT_ASSERT(sessionManager.closeSession(hNew) == CKR_OK);
+	CPPUNIT_ASSERT(sessionManager.closeSession(hSession[1]) == CKR_OK);
+	CPPUNIT_ASSERT(sessionManager.haveSession(slotList[1]));
+	CPPUNIT_ASSERT(sessionManager.closeSession(hSession[2]) == CKR_OK);
+	CPPUNIT_ASSERT(!sessionManager.haveSession(slotList[1]));
 }
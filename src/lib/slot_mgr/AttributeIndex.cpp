@@ -0,0 +1,187 @@
+/*
+ * Copyright (c) 2016 SURFnet bv
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*****************************************************************************
+ AttributeIndex.cpp
+
+ Keeps keyed digests of the decrypted lookup attributes of the private
+ objects of a token, so that C_FindObjectsInit can match a template without
+ decrypting the attributes of every object.
+ *****************************************************************************/
+
+#include "config.h"
+#include "log.h"
+#include "CryptoFactory.h"
+#include "MacAlgorithm.h"
+#include "SymmetricKey.h"
+#include "RNG.h"
+#include "AttributeIndex.h"
+
+// Constructor
+AttributeIndex::AttributeIndex()
+{
+	keyGeneration = 0;
+	indexMutex = MutexFactory::i()->getMutex();
+}
+
+// Destructor
+AttributeIndex::~AttributeIndex()
+{
+	clear();
+
+	MutexFactory::i()->recycleMutex(indexMutex);
+}
+
+// Is the attribute kept in the index?
+/*static*/ bool AttributeIndex::isIndexed(CK_ATTRIBUTE_TYPE type)
+{
+	switch (type)
+	{
+		case CKA_ID:
+		case CKA_LABEL:
+		case CKA_SUBJECT:
+		case CKA_ISSUER:
+		case CKA_SERIAL_NUMBER:
+			return true;
+		default:
+			return false;
+	}
+}
+
+// Retrieve a copy of the digest key and its generation
+bool AttributeIndex::getKey(ByteString& keyBits, unsigned long& generation)
+{
+	MutexLocker lock(indexMutex);
+
+	if (digestKey.size() == 0)
+	{
+		if (!CryptoFactory::i()->getRNG()->generateRandom(digestKey, 32))
+		{
+			ERROR_MSG("Could not generate the attribute index key");
+
+			digestKey.wipe();
+
+			return false;
+		}
+	}
+
+	keyBits = digestKey;
+	generation = keyGeneration;
+
+	return true;
+}
+
+// Compute the keyed digest of a plaintext attribute value
+/*static*/ bool AttributeIndex::digest(const ByteString& keyBits, const ByteString& value, ByteString& digest)
+{
+	SymmetricKey digestKey(keyBits.size() * 8);
+	if (!digestKey.setKeyBits(keyBits)) return false;
+
+	MacAlgorithm* hmac = CryptoFactory::i()->getMacAlgorithm(MacAlgo::HMAC_SHA256);
+	if (hmac == NULL) return false;
+
+	bool rv = hmac->signInit(&digestKey) &&
+		  hmac->signUpdate(value) &&
+		  hmac->signFinal(digest);
+
+	CryptoFactory::i()->recycleMacAlgorithm(hmac);
+
+	return rv;
+}
+
+// Retrieve the digest of the attribute of the object
+bool AttributeIndex::lookup(OSObject* object, CK_ATTRIBUTE_TYPE type, const ByteString& storedValue, unsigned long generation, ByteString& digest)
+{
+	MutexLocker lock(indexMutex);
+
+	// The caller uses a key that has since been replaced
+	if (generation != keyGeneration) return false;
+
+	std::map<OSObject*, std::map<CK_ATTRIBUTE_TYPE, Entry> >::iterator i = entries.find(object);
+	if (i == entries.end()) return false;
+
+	std::map<CK_ATTRIBUTE_TYPE, Entry>::iterator j = i->second.find(type);
+	if (j == i->second.end()) return false;
+
+	// The attribute has been changed since the digest was computed
+	if (j->second.storedValue != storedValue) return false;
+
+	digest = j->second.digest;
+
+	return true;
+}
+
+// Add or replace the digest of the attribute of the object
+void AttributeIndex::update(OSObject* object, CK_ATTRIBUTE_TYPE type, const ByteString& storedValue, unsigned long generation, const ByteString& digest)
+{
+	MutexLocker lock(indexMutex);
+
+	// Digests computed with a previous key are useless
+	if (generation != keyGeneration || digestKey.size() == 0) return;
+
+	Entry& entry = entries[object][type];
+	entry.storedValue = storedValue;
+	entry.digest = digest;
+}
+
+// Forget the digests of the given object
+void AttributeIndex::invalidate(OSObject* object)
+{
+	MutexLocker lock(indexMutex);
+
+	entries.erase(object);
+}
+
+// Forget the digests of all objects that are not in the given set
+void AttributeIndex::prune(const std::set<OSObject*>& objects)
+{
+	MutexLocker lock(indexMutex);
+
+	std::map<OSObject*, std::map<CK_ATTRIBUTE_TYPE, Entry> >::iterator i = entries.begin();
+	while (i != entries.end())
+	{
+		if (objects.find(i->first) == objects.end())
+		{
+			entries.erase(i++);
+		}
+		else
+		{
+			++i;
+		}
+	}
+}
+
+// Forget all digests and the digest key
+void AttributeIndex::clear()
+{
+	MutexLocker lock(indexMutex);
+
+	entries.clear();
+
+	// Digests that are being computed with the old key are not stored
+	digestKey.wipe();
+	keyGeneration++;
+}
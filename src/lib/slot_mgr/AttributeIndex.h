@@ -0,0 +1,111 @@
+/*
+ * Copyright (c) 2016 SURFnet bv
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*****************************************************************************
+ AttributeIndex.h
+
+ Keeps keyed digests of the decrypted lookup attributes (CKA_ID, CKA_LABEL,
+ ...) of the private objects of a token, so that C_FindObjectsInit can match
+ a template without decrypting the attributes of every object. Each digest
+ is stored together with the encrypted attribute value it was computed
+ from; a changed object is detected by comparing the encrypted value. The
+ index is scoped to a login session and is cleared when the user logs out.
+
+ The digests are computed outside the lock of the index with a copy of the
+ digest key. Every new key has a new generation number, and digests from an
+ earlier generation are neither returned nor stored.
+ *****************************************************************************/
+
+#ifndef _SOFTHSM_V2_ATTRIBUTEINDEX_H
+#define _SOFTHSM_V2_ATTRIBUTEINDEX_H
+
+#include "config.h"
+#include "ByteString.h"
+#include "OSObject.h"
+#include "MutexFactory.h"
+#include "cryptoki.h"
+#include <map>
+#include <set>
+
+class AttributeIndex
+{
+public:
+	// Constructor
+	AttributeIndex();
+
+	// Destructor
+	virtual ~AttributeIndex();
+
+	// Is the attribute kept in the index?
+	static bool isIndexed(CK_ATTRIBUTE_TYPE type);
+
+	// Retrieve a copy of the digest key and its generation; the key is
+	// generated when it is first needed
+	bool getKey(ByteString& keyBits, unsigned long& generation);
+
+	// Compute the keyed digest of a plaintext attribute value
+	static bool digest(const ByteString& keyBits, const ByteString& value, ByteString& digest);
+
+	// Retrieve the digest of the attribute of the object; the stored value
+	// is the encrypted value as it is kept in the object store. Returns false
+	// if the digest is not in the index, is out of date or if the key of the
+	// given generation has been replaced.
+	bool lookup(OSObject* object, CK_ATTRIBUTE_TYPE type, const ByteString& storedValue, unsigned long generation, ByteString& digest);
+
+	// Add or replace the digest of the attribute of the object; it is ignored
+	// if the key of the given generation has been replaced
+	void update(OSObject* object, CK_ATTRIBUTE_TYPE type, const ByteString& storedValue, unsigned long generation, const ByteString& digest);
+
+	// Forget the digests of the given object
+	void invalidate(OSObject* object);
+
+	// Forget the digests of all objects that are not in the given set
+	void prune(const std::set<OSObject*>& objects);
+
+	// Forget all digests and the digest key
+	void clear();
+
+private:
+	struct Entry
+	{
+		ByteString storedValue;
+		ByteString digest;
+	};
+
+	// The digests per object and attribute
+	std::map<OSObject*, std::map<CK_ATTRIBUTE_TYPE, Entry> > entries;
+
+	// The key for the digests; generated when it is first needed
+	ByteString digestKey;
+
+	// Incremented whenever the key is discarded
+	unsigned long keyGeneration;
+
+	Mutex* indexMutex;
+};
+
+#endif // !_SOFTHSM_V2_ATTRIBUTEINDEX_H
+
@@ -0,0 +1,305 @@
+/*
+ * Copyright (c) 2016 SURFnet bv
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*****************************************************************************
+ PrivateKeyCache.cpp
+
+ Caches fully prepared private keys for the objects of a token, so that the
+ key material does not need to be decrypted and the crypto library key
+ rebuilt for every operation. The cache is scoped to a login session and is
+ cleared when the user logs out.
+
+ Keys are handed out by reference and may be in use by several sessions at
+ the same time. A key that is invalidated while still in use is kept until
+ the last user hands it back.
+ *****************************************************************************/
+
+#include "config.h"
+#include "log.h"
+#include "CryptoFactory.h"
+#include "SessionObject.h"
+#include "PrivateKeyCache.h"
+
+// Constructor
+PrivateKeyCache::PrivateKeyCache()
+{
+	useCounter = 0;
+	sessionObjectCount = 0;
+	lastExpiry = time(NULL);
+	cacheMutex = MutexFactory::i()->getMutex();
+}
+
+// Destructor
+PrivateKeyCache::~PrivateKeyCache()
+{
+	for (std::map<PrivateKey*, Entry*>::iterator i = keys.begin(); i != keys.end(); i++)
+	{
+		recycle(i->second);
+	}
+
+	objects.clear();
+	keys.clear();
+
+	MutexFactory::i()->recycleMutex(cacheMutex);
+}
+
+// Retrieve the prepared key for the given object
+PrivateKey* PrivateKeyCache::get(OSObject* object, AsymAlgo::Type algorithm, const ByteString& checkValue)
+{
+	MutexLocker lock(cacheMutex);
+
+	time_t now = time(NULL);
+	expire(now);
+
+	std::map<OSObject*, Entry*>::iterator i = objects.find(object);
+	if (i == objects.end()) return NULL;
+
+	Entry* entry = i->second;
+
+	// The object has been changed or replaced since the key was cached
+	if (entry->algorithm != algorithm || entry->checkValue != checkValue)
+	{
+		retire(entry);
+
+		return NULL;
+	}
+
+	entry->refCount++;
+	entry->lastUsed = ++useCounter;
+	entry->lastUsedTime = now;
+
+	return entry->privateKey;
+}
+
+// Add a prepared key for the given object
+PrivateKey* PrivateKeyCache::add(OSObject* object, AsymAlgo::Type algorithm, const ByteString& checkValue, PrivateKey* privateKey)
+{
+	if (privateKey == NULL) return NULL;
+
+	MutexLocker lock(cacheMutex);
+
+	time_t now = time(NULL);
+	expire(now);
+
+	std::map<OSObject*, Entry*>::iterator i = objects.find(object);
+	if (i != objects.end())
+	{
+		Entry* entry = i->second;
+
+		// Another thread has prepared the same key in the meantime
+		if (entry->algorithm == algorithm && entry->checkValue == checkValue)
+		{
+			recycleKey(algorithm, privateKey);
+
+			entry->refCount++;
+			entry->lastUsed = ++useCounter;
+			entry->lastUsedTime = now;
+
+			return entry->privateKey;
+		}
+
+		retire(entry);
+	}
+
+	if (objects.size() >= PRIVATE_KEY_CACHE_SIZE)
+	{
+		evict();
+	}
+
+	Entry* entry = new Entry();
+	entry->object = object;
+	entry->algorithm = algorithm;
+	entry->checkValue = checkValue;
+	entry->privateKey = privateKey;
+	entry->refCount = 1;
+	entry->lastUsed = ++useCounter;
+	entry->lastUsedTime = now;
+	entry->isSessionObject = (dynamic_cast<SessionObject*>(object) != NULL);
+	entry->isStale = false;
+
+	if (entry->isSessionObject) sessionObjectCount++;
+
+	objects[object] = entry;
+	keys[privateKey] = entry;
+
+	return privateKey;
+}
+
+// Hand back a key that was retrieved from the cache
+void PrivateKeyCache::release(PrivateKey* privateKey)
+{
+	if (privateKey == NULL) return;
+
+	MutexLocker lock(cacheMutex);
+
+	std::map<PrivateKey*, Entry*>::iterator i = keys.find(privateKey);
+	if (i == keys.end())
+	{
+		ERROR_MSG("Released a private key that is not in the cache");
+
+		return;
+	}
+
+	Entry* entry = i->second;
+
+	if (entry->refCount > 0) entry->refCount--;
+
+	// The idle time counts from the end of the operation
+	entry->lastUsedTime = time(NULL);
+
+	if (entry->isStale && entry->refCount == 0)
+	{
+		keys.erase(i);
+		recycle(entry);
+	}
+}
+
+// Forget the key for the given object
+void PrivateKeyCache::invalidate(OSObject* object)
+{
+	MutexLocker lock(cacheMutex);
+
+	std::map<OSObject*, Entry*>::iterator i = objects.find(object);
+	if (i == objects.end()) return;
+
+	retire(i->second);
+}
+
+// Forget the keys of session objects whose session was closed
+void PrivateKeyCache::removeClosedSessionObjects()
+{
+	MutexLocker lock(cacheMutex);
+
+	if (sessionObjectCount == 0) return;
+
+	std::map<OSObject*, Entry*>::iterator i = objects.begin();
+	while (i != objects.end())
+	{
+		Entry* entry = i->second;
+		i++;
+
+		// A session object is no longer valid once it has been removed
+		if (entry->isSessionObject && !entry->object->isValid())
+		{
+			retire(entry);
+		}
+	}
+}
+
+// Forget all keys
+void PrivateKeyCache::clear()
+{
+	MutexLocker lock(cacheMutex);
+
+	while (!objects.empty())
+	{
+		retire(objects.begin()->second);
+	}
+
+	useCounter = 0;
+}
+
+// Detach the entry from the object index
+// Calling function must lock the mutex
+void PrivateKeyCache::retire(Entry* entry)
+{
+	objects.erase(entry->object);
+	entry->isStale = true;
+
+	if (entry->isSessionObject) sessionObjectCount--;
+
+	if (entry->refCount == 0)
+	{
+		keys.erase(entry->privateKey);
+		recycle(entry);
+	}
+}
+
+// Make room for a new entry
+// Calling function must lock the mutex
+void PrivateKeyCache::evict()
+{
+	Entry* victim = NULL;
+
+	for (std::map<OSObject*, Entry*>::iterator i = objects.begin(); i != objects.end(); i++)
+	{
+		if (i->second->refCount > 0) continue;
+
+		if (victim == NULL || i->second->lastUsed < victim->lastUsed)
+		{
+			victim = i->second;
+		}
+	}
+
+	// All keys are in use; the cache temporarily grows beyond its size
+	if (victim == NULL) return;
+
+	retire(victim);
+}
+
+// Retire the entries that have not been used for too long
+// Calling function must lock the mutex
+void PrivateKeyCache::expire(time_t now)
+{
+	// Look at most once per second
+	if (now == lastExpiry) return;
+	lastExpiry = now;
+
+	std::map<OSObject*, Entry*>::iterator i = objects.begin();
+	while (i != objects.end())
+	{
+		Entry* entry = i->second;
+		i++;
+
+		if (entry->refCount == 0 && now - entry->lastUsedTime >= PRIVATE_KEY_CACHE_IDLE_TIME)
+		{
+			retire(entry);
+		}
+	}
+}
+
+// Recycle the key of the entry and delete the entry
+/*static*/ void PrivateKeyCache::recycle(Entry* entry)
+{
+	recycleKey(entry->algorithm, entry->privateKey);
+
+	delete entry;
+}
+
+// Recycle a key using the algorithm that created it
+/*static*/ void PrivateKeyCache::recycleKey(AsymAlgo::Type algorithm, PrivateKey* privateKey)
+{
+	AsymmetricAlgorithm* asymCrypto = CryptoFactory::i()->getAsymmetricAlgorithm(algorithm);
+	if (asymCrypto != NULL)
+	{
+		asymCrypto->recyclePrivateKey(privateKey);
+		CryptoFactory::i()->recycleAsymmetricAlgorithm(asymCrypto);
+	}
+	else
+	{
+		delete privateKey;
+	}
+}
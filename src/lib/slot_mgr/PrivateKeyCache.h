@@ -0,0 +1,141 @@
+/*
+ * Copyright (c) 2016 SURFnet bv
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*****************************************************************************
+ PrivateKeyCache.h
+
+ Caches fully prepared private keys for the objects of a token, so that the
+ key material does not need to be decrypted and the crypto library key
+ rebuilt for every operation. The cache is scoped to a login session and is
+ cleared when the user logs out.
+
+ The prepared keys live in the structures of the crypto library, not in
+ secure memory, and the library wipes their private components when they
+ are freed. Their lifetime is therefore bounded: a key that has not been
+ used for PRIVATE_KEY_CACHE_IDLE_TIME seconds is dropped at the next use of
+ the cache, and the keys of session objects are dropped when their session
+ is closed.
+ *****************************************************************************/
+
+#ifndef _SOFTHSM_V2_PRIVATEKEYCACHE_H
+#define _SOFTHSM_V2_PRIVATEKEYCACHE_H
+
+#include "config.h"
+#include "ByteString.h"
+#include "AsymmetricAlgorithm.h"
+#include "PrivateKey.h"
+#include "OSObject.h"
+#include "MutexFactory.h"
+#include <map>
+#include <time.h>
+
+// The maximum number of unused keys that are kept in the cache
+#define PRIVATE_KEY_CACHE_SIZE 256
+
+// The number of seconds an unused key is kept in the cache
+#define PRIVATE_KEY_CACHE_IDLE_TIME 300
+
+class PrivateKeyCache
+{
+public:
+	// Constructor
+	PrivateKeyCache();
+
+	// Destructor
+	virtual ~PrivateKeyCache();
+
+	// Retrieve the prepared key for the given object; the check value is built
+	// from the key material as it is stored in the object (before decryption)
+	// and must match the value the key was added with. Returns NULL if there is
+	// no matching key. A returned key must be handed back using release().
+	PrivateKey* get(OSObject* object, AsymAlgo::Type algorithm, const ByteString& checkValue);
+
+	// Add a prepared key for the given object; the cache takes ownership of the
+	// key. Returns the key to use, which is a key that was added concurrently by
+	// another thread if there is one. The returned key must be handed back
+	// using release().
+	PrivateKey* add(OSObject* object, AsymAlgo::Type algorithm, const ByteString& checkValue, PrivateKey* privateKey);
+
+	// Hand back a key that was retrieved from the cache
+	void release(PrivateKey* privateKey);
+
+	// Forget the key for the given object
+	void invalidate(OSObject* object);
+
+	// Forget the keys of session objects that have been removed because
+	// their session was closed
+	void removeClosedSessionObjects();
+
+	// Forget all keys; keys that are still in use are recycled on release
+	void clear();
+
+private:
+	struct Entry
+	{
+		OSObject* object;
+		AsymAlgo::Type algorithm;
+		ByteString checkValue;
+		PrivateKey* privateKey;
+		unsigned long refCount;
+		unsigned long lastUsed;
+		time_t lastUsedTime;
+		bool isSessionObject;
+		bool isStale;
+	};
+
+	// Detach the entry from the object index; the entry is recycled
+	// as soon as it is no longer in use
+	void retire(Entry* entry);
+
+	// Make room for a new entry by retiring the least recently used entry
+	void evict();
+
+	// Retire the entries that have not been used for too long
+	void expire(time_t now);
+
+	// Recycle the key of the entry and delete the entry
+	static void recycle(Entry* entry);
+
+	// Recycle a key using the algorithm that created it
+	static void recycleKey(AsymAlgo::Type algorithm, PrivateKey* privateKey);
+
+	// The entries indexed by the object and by the key
+	std::map<OSObject*, Entry*> objects;
+	std::map<PrivateKey*, Entry*> keys;
+
+	// Usage counter for eviction
+	unsigned long useCounter;
+
+	// The number of entries for session objects
+	unsigned long sessionObjectCount;
+
+	// The time of the last check for expired entries
+	time_t lastExpiry;
+
+	Mutex* cacheMutex;
+};
+
+#endif // !_SOFTHSM_V2_PRIVATEKEYCACHE_H
@@ -46,6 +46,8 @@ Token::Token()
 
 	token = NULL;
 	sdm = NULL;
+	privateKeyCache = new PrivateKeyCache();
+	attributeIndex = new AttributeIndex();
 	valid = false;
 }
 
@@ -61,6 +63,9 @@ Token::Token(ObjectStoreToken* inToken)
 	valid = token->getSOPIN(soPINBlob) && token->getUserPIN(userPINBlob);
 
 	sdm = new SecureDataManager(soPINBlob, userPINBlob);
+
+	privateKeyCache = new PrivateKeyCache();
+	attributeIndex = new AttributeIndex();
 }
 
 // Destructor
@@ -68,6 +73,9 @@ Token::~Token()
 {
 	if (sdm != NULL) delete sdm;
 
+	delete privateKeyCache;
+	delete attributeIndex;
+
 	MutexFactory::i()->recycleMutex(tokenMutex);
 }
 
@@ -194,6 +202,10 @@ void Token::logout()
 	if (sdm == NULL) return;
 
 	sdm->logout();
+
+	// Prepared keys and digests must not outlive the login
+	privateKeyCache->clear();
+	attributeIndex->clear();
 }
 
 // Change SO PIN
@@ -286,8 +298,7 @@ CK_RV Token::setUserPIN(ByteString& oldPIN, ByteString& newPIN)
 	if (!stayLoggedIn) newSdm->logout();
 
 	// Switch sdm
-	delete sdm;
-	sdm = newSdm;
+	replaceSDM(newSdm);
 
 	ByteString soPINBlob, userPINBlob;
 	valid = token->getSOPIN(soPINBlob) && token->getUserPIN(userPINBlob);
@@ -397,8 +408,11 @@ CK_RV Token::createToken(ObjectStore* objectStore, ByteString& soPIN, CK_UTF8CHA
 
 	valid = token->getSOPIN(soPINBlob) && token->getUserPIN(userPINBlob);
 
-	if (sdm != NULL) delete sdm;
-	sdm = new SecureDataManager(soPINBlob, userPINBlob);
+	replaceSDM(new SecureDataManager(soPINBlob, userPINBlob));
+
+	// The token objects are gone
+	privateKeyCache->clear();
+	attributeIndex->clear();
 
 	return CKR_OK;
 }
@@ -497,22 +511,96 @@ void Token::getObjects(std::set<OSObject *> &objects)
 	token->getObjects(objects);
 }
 
+// Encryption and decryption run outside the token lock, so that they can be
+// performed by several threads at the same time
 bool Token::decrypt(const ByteString &encrypted, ByteString &plaintext)
+{
+	SecureDataManager* current = acquireSDM();
+
+	if (current == NULL) return false;
+
+	bool rv = current->decrypt(encrypted,plaintext);
+
+	releaseSDM(current);
+
+	return rv;
+}
+
+bool Token::decrypt(const std::vector<ByteString> &encrypted, std::vector<ByteString> &plaintext)
+{
+	SecureDataManager* current = acquireSDM();
+
+	if (current == NULL) return false;
+
+	bool rv = current->decrypt(encrypted,plaintext);
+
+	releaseSDM(current);
+
+	return rv;
+}
+
+bool Token::encrypt(const ByteString &plaintext, ByteString &encrypted)
+{
+	SecureDataManager* current = acquireSDM();
+
+	if (current == NULL) return false;
+
+	bool rv = current->encrypt(plaintext,encrypted);
+
+	releaseSDM(current);
+
+	return rv;
+}
+
+PrivateKeyCache* Token::getPrivateKeyCache()
+{
+	return privateKeyCache;
+}
+
+AttributeIndex* Token::getAttributeIndex()
+{
+	return attributeIndex;
+}
+
+// Get the secure data manager for use outside the token lock
+SecureDataManager* Token::acquireSDM()
 {
 	// Lock access to the token
 	MutexLocker lock(tokenMutex);
 
-	if (sdm == NULL) return false;
+	if (sdm == NULL) return NULL;
 
-	return sdm->decrypt(encrypted,plaintext);
+	sdmUsers[sdm]++;
+
+	return sdm;
 }
 
-bool Token::encrypt(const ByteString &plaintext, ByteString &encrypted)
+// Hand back a secure data manager retrieved using acquireSDM
+void Token::releaseSDM(SecureDataManager* inSdm)
 {
 	// Lock access to the token
 	MutexLocker lock(tokenMutex);
 
-	if (sdm == NULL) return false;
+	std::map<SecureDataManager*, unsigned long>::iterator i = sdmUsers.find(inSdm);
+	if (i == sdmUsers.end()) return;
+
+	if (--i->second > 0) return;
+
+	sdmUsers.erase(i);
+
+	// The manager was replaced while it was in use
+	if (inSdm != sdm) delete inSdm;
+}
+
+// Replace the secure data manager
+// Calling function must lock the token
+void Token::replaceSDM(SecureDataManager* newSdm)
+{
+	// A manager that is still in use is deleted by its last user
+	if (sdm != NULL && sdmUsers.find(sdm) == sdmUsers.end())
+	{
+		delete sdm;
+	}
 
-	return sdm->encrypt(plaintext,encrypted);
+	sdm = newSdm;
 }
@@ -38,7 +38,10 @@
 #include "ObjectStore.h"
 #include "ObjectStoreToken.h"
 #include "SecureDataManager.h"
+#include "PrivateKeyCache.h"
+#include "AttributeIndex.h"
 #include "cryptoki.h"
+#include <map>
 #include <string>
 #include <vector>
 
@@ -89,9 +92,18 @@ public:
 	// Decrypt the supplied data
 	bool decrypt(const ByteString& encrypted, ByteString& plaintext);
 
+	// Decrypt a batch of data
+	bool decrypt(const std::vector<ByteString>& encrypted, std::vector<ByteString>& plaintext);
+
 	// Encrypt the supplied data
 	bool encrypt(const ByteString& plaintext, ByteString& encrypted);
 
+	// The cache of prepared private keys for the logged in user
+	PrivateKeyCache* getPrivateKeyCache();
+
+	// The index of the decrypted lookup attributes for the logged in user
+	AttributeIndex* getAttributeIndex();
+
 private:
 	// Token validity
 	bool valid;
@@ -102,6 +114,25 @@ private:
 	// The secure data manager for this token
 	SecureDataManager* sdm;
 
+	// The number of encryptions and decryptions in progress per secure data
+	// manager; a replaced manager is deleted when its last user is done
+	std::map<SecureDataManager*, unsigned long> sdmUsers;
+
+	// Get the secure data manager for use outside the token lock
+	SecureDataManager* acquireSDM();
+
+	// Hand back a secure data manager retrieved using acquireSDM
+	void releaseSDM(SecureDataManager* inSdm);
+
+	// Replace the secure data manager
+	void replaceSDM(SecureDataManager* newSdm);
+
+	// The prepared private keys; cleared on logout
+	PrivateKeyCache* privateKeyCache;
+
+	// The lookup attribute digests; cleared on logout
+	AttributeIndex* attributeIndex;
+
 	Mutex* tokenMutex;
 };
 
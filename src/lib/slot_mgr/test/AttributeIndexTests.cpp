@@ -0,0 +1,110 @@
+/*
+ * Copyright (c) 2016 SURFnet bv
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*****************************************************************************
+ AttributeIndexTests.cpp
+
+ Contains test cases to test the attribute index
+ *****************************************************************************/
+
+#include <stdlib.h>
+#include <string.h>
+#include <cppunit/extensions/HelperMacros.h>
+#include "AttributeIndexTests.h"
+#include "AttributeIndex.h"
+#include "SessionObject.h"
+
+CPPUNIT_TEST_SUITE_REGISTRATION(AttributeIndexTests);
+
+void AttributeIndexTests::setUp()
+{
+}
+
+void AttributeIndexTests::tearDown()
+{
+}
+
+void AttributeIndexTests::testLookup()
+{
+	AttributeIndex index;
+	SessionObject object(NULL, 1, 1);
+	ByteString keyBits, otherKeyBits;
+	unsigned long generation, otherGeneration;
+	ByteString storedValue = "0102030405";
+	ByteString value = "6c6162656c";
+	ByteString digest, otherDigest, found;
+
+	// The key stays the same until the index is cleared
+	CPPUNIT_ASSERT(index.getKey(keyBits, generation));
+	CPPUNIT_ASSERT(index.getKey(otherKeyBits, otherGeneration));
+	CPPUNIT_ASSERT(keyBits == otherKeyBits);
+	CPPUNIT_ASSERT(generation == otherGeneration);
+
+	CPPUNIT_ASSERT(AttributeIndex::digest(keyBits, value, digest));
+	CPPUNIT_ASSERT(AttributeIndex::digest(keyBits, value, otherDigest));
+	CPPUNIT_ASSERT(digest == otherDigest);
+
+	CPPUNIT_ASSERT(!index.lookup(&object, CKA_LABEL, storedValue, generation, found));
+	index.update(&object, CKA_LABEL, storedValue, generation, digest);
+	CPPUNIT_ASSERT(index.lookup(&object, CKA_LABEL, storedValue, generation, found));
+	CPPUNIT_ASSERT(found == digest);
+
+	// A changed stored value is a miss
+	CPPUNIT_ASSERT(!index.lookup(&object, CKA_LABEL, "0102030406", generation, found));
+
+	index.invalidate(&object);
+	CPPUNIT_ASSERT(!index.lookup(&object, CKA_LABEL, storedValue, generation, found));
+}
+
+void AttributeIndexTests::testClear()
+{
+	AttributeIndex index;
+	SessionObject object(NULL, 1, 1);
+	ByteString keyBits, newKeyBits;
+	unsigned long generation, newGeneration;
+	ByteString storedValue = "0102030405";
+	ByteString value = "6c6162656c";
+	ByteString digest, newDigest, found;
+
+	CPPUNIT_ASSERT(index.getKey(keyBits, generation));
+	CPPUNIT_ASSERT(AttributeIndex::digest(keyBits, value, digest));
+
+	// A digest of the old key that is stored after the clear is ignored
+	index.clear();
+	index.update(&object, CKA_LABEL, storedValue, generation, digest);
+
+	CPPUNIT_ASSERT(index.getKey(newKeyBits, newGeneration));
+	CPPUNIT_ASSERT(newGeneration != generation);
+	CPPUNIT_ASSERT(newKeyBits != keyBits);
+	CPPUNIT_ASSERT(!index.lookup(&object, CKA_LABEL, storedValue, newGeneration, found));
+
+	// Nor is a digest of the new key returned to a user of the old key
+	CPPUNIT_ASSERT(AttributeIndex::digest(newKeyBits, value, newDigest));
+	CPPUNIT_ASSERT(newDigest != digest);
+	index.update(&object, CKA_LABEL, storedValue, newGeneration, newDigest);
+	CPPUNIT_ASSERT(index.lookup(&object, CKA_LABEL, storedValue, newGeneration, found));
+	CPPUNIT_ASSERT(!index.lookup(&object, CKA_LABEL, storedValue, generation, found));
+}
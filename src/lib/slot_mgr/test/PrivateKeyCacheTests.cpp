@@ -0,0 +1,176 @@
+/*
+ * Copyright (c) 2016 SURFnet bv
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*****************************************************************************
+ PrivateKeyCacheTests.cpp
+
+ Contains test cases to test the private key cache
+ *****************************************************************************/
+
+#include <stdlib.h>
+#include <string.h>
+#include <cppunit/extensions/HelperMacros.h>
+#include "PrivateKeyCacheTests.h"
+#include "PrivateKeyCache.h"
+#include "SessionObject.h"
+#include "CryptoFactory.h"
+
+CPPUNIT_TEST_SUITE_REGISTRATION(PrivateKeyCacheTests);
+
+static PrivateKey* newRSAPrivateKey()
+{
+	AsymmetricAlgorithm* rsa = CryptoFactory::i()->getAsymmetricAlgorithm(AsymAlgo::RSA);
+	CPPUNIT_ASSERT(rsa != NULL);
+
+	PrivateKey* privateKey = rsa->newPrivateKey();
+	CryptoFactory::i()->recycleAsymmetricAlgorithm(rsa);
+	CPPUNIT_ASSERT(privateKey != NULL);
+
+	return privateKey;
+}
+
+void PrivateKeyCacheTests::setUp()
+{
+}
+
+void PrivateKeyCacheTests::tearDown()
+{
+}
+
+void PrivateKeyCacheTests::testHitAndMiss()
+{
+	PrivateKeyCache cache;
+	SessionObject object(NULL, 1, 1);
+	ByteString checkValue = "0102030405";
+	ByteString otherCheckValue = "0102030406";
+
+	// Nothing in the cache yet
+	CPPUNIT_ASSERT(cache.get(&object, AsymAlgo::RSA, checkValue) == NULL);
+
+	PrivateKey* privateKey = newRSAPrivateKey();
+	CPPUNIT_ASSERT(cache.add(&object, AsymAlgo::RSA, checkValue, privateKey) == privateKey);
+	cache.release(privateKey);
+
+	// The same key is returned as long as the key material is unchanged
+	CPPUNIT_ASSERT(cache.get(&object, AsymAlgo::RSA, checkValue) == privateKey);
+	cache.release(privateKey);
+
+	// A different algorithm or changed key material is a miss
+	CPPUNIT_ASSERT(cache.get(&object, AsymAlgo::DSA, checkValue) == NULL);
+	CPPUNIT_ASSERT(cache.get(&object, AsymAlgo::RSA, checkValue) == NULL);
+
+	privateKey = newRSAPrivateKey();
+	CPPUNIT_ASSERT(cache.add(&object, AsymAlgo::RSA, otherCheckValue, privateKey) == privateKey);
+	cache.release(privateKey);
+
+	CPPUNIT_ASSERT(cache.get(&object, AsymAlgo::RSA, checkValue) == NULL);
+}
+
+void PrivateKeyCacheTests::testInvalidate()
+{
+	PrivateKeyCache cache;
+	SessionObject object(NULL, 1, 1);
+	ByteString checkValue = "0102030405";
+
+	PrivateKey* privateKey = newRSAPrivateKey();
+	CPPUNIT_ASSERT(cache.add(&object, AsymAlgo::RSA, checkValue, privateKey) == privateKey);
+	cache.release(privateKey);
+
+	cache.invalidate(&object);
+
+	CPPUNIT_ASSERT(cache.get(&object, AsymAlgo::RSA, checkValue) == NULL);
+}
+
+void PrivateKeyCacheTests::testClearWhileInUse()
+{
+	PrivateKeyCache cache;
+	SessionObject object(NULL, 1, 1);
+	ByteString checkValue = "0102030405";
+
+	PrivateKey* privateKey = newRSAPrivateKey();
+	CPPUNIT_ASSERT(cache.add(&object, AsymAlgo::RSA, checkValue, privateKey) == privateKey);
+
+	// The key is still in use, so it must survive the clear
+	cache.clear();
+	CPPUNIT_ASSERT(privateKey->getBitLength() == 0);
+
+	CPPUNIT_ASSERT(cache.get(&object, AsymAlgo::RSA, checkValue) == NULL);
+
+	// Releasing the key recycles it
+	cache.release(privateKey);
+}
+
+void PrivateKeyCacheTests::testEviction()
+{
+	PrivateKeyCache cache;
+	SessionObject* objects[PRIVATE_KEY_CACHE_SIZE + 1];
+	ByteString checkValue = "0102030405";
+
+	for (size_t i = 0; i <= PRIVATE_KEY_CACHE_SIZE; i++)
+	{
+		objects[i] = new SessionObject(NULL, 1, 1);
+
+		PrivateKey* privateKey = newRSAPrivateKey();
+		CPPUNIT_ASSERT(cache.add(objects[i], AsymAlgo::RSA, checkValue, privateKey) == privateKey);
+		cache.release(privateKey);
+	}
+
+	// The least recently used key has been evicted
+	CPPUNIT_ASSERT(cache.get(objects[0], AsymAlgo::RSA, checkValue) == NULL);
+
+	PrivateKey* privateKey = cache.get(objects[PRIVATE_KEY_CACHE_SIZE], AsymAlgo::RSA, checkValue);
+	CPPUNIT_ASSERT(privateKey != NULL);
+	cache.release(privateKey);
+
+	for (size_t i = 0; i <= PRIVATE_KEY_CACHE_SIZE; i++)
+	{
+		delete objects[i];
+	}
+}
+
+void PrivateKeyCacheTests::testClosedSessionObjects()
+{
+	PrivateKeyCache cache;
+	SessionObject closedObject(NULL, 1, 1);
+	SessionObject openObject(NULL, 1, 2);
+	ByteString checkValue = "0102030405";
+
+	PrivateKey* closedKey = newRSAPrivateKey();
+	CPPUNIT_ASSERT(cache.add(&closedObject, AsymAlgo::RSA, checkValue, closedKey) == closedKey);
+	cache.release(closedKey);
+
+	PrivateKey* openKey = newRSAPrivateKey();
+	CPPUNIT_ASSERT(cache.add(&openObject, AsymAlgo::RSA, checkValue, openKey) == openKey);
+	cache.release(openKey);
+
+	// Only the key of the object of the closed session is dropped
+	CPPUNIT_ASSERT(closedObject.removeOnSessionClose(1));
+	cache.removeClosedSessionObjects();
+
+	CPPUNIT_ASSERT(cache.get(&closedObject, AsymAlgo::RSA, checkValue) == NULL);
+	CPPUNIT_ASSERT(cache.get(&openObject, AsymAlgo::RSA, checkValue) == openKey);
+	cache.release(openKey);
+}
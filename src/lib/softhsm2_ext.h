@@ -0,0 +1,94 @@
+/*
+ * Copyright (c) 2016 SURFnet bv
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+/*****************************************************************************
+ softhsm2_ext.h
+
+ The SoftHSM vendor extensions to PKCS #11. Include this file after pkcs11.h
+ and get the extension function list from the library using
+ SoftHSM_GetFunctionList, which can be looked up next to C_GetFunctionList.
+ *****************************************************************************/
+
+#ifndef _SOFTHSM_V2_SOFTHSM2_EXT_H
+#define _SOFTHSM_V2_SOFTHSM2_EXT_H
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+#if defined(_WIN32) || defined(CRYPTOKI_FORCE_WIN32)
+#pragma pack(push, cryptoki, 1)
+#endif
+
+#define SOFTHSM_EXT_VERSION_MAJOR 1
+#define SOFTHSM_EXT_VERSION_MINOR 0
+
+/* Sign ulCount messages with the same key and mechanism. The signing is spread
+ * over several threads if the library may create threads. The key and
+ * mechanism are checked as for C_SignInit and no other operation may be
+ * active in the session; no operation is active after the call.
+ *
+ * ppData and pulDataLen hold the messages. If ppSignature is NULL_PTR, the
+ * signature sizes are returned in pulSignatureLen. Otherwise pulSignatureLen
+ * holds the size of each buffer in ppSignature on input and the size of each
+ * signature on output. If any buffer is too small, nothing is signed,
+ * all sizes are set and CKR_BUFFER_TOO_SMALL is returned.
+ */
+typedef CK_RV (*CK_C_SignBatch)(
+	CK_SESSION_HANDLE hSession,
+	CK_MECHANISM_PTR pMechanism,
+	CK_OBJECT_HANDLE hKey,
+	CK_ULONG ulCount,
+	CK_BYTE_PTR* ppData,
+	CK_ULONG_PTR pulDataLen,
+	CK_BYTE_PTR* ppSignature,
+	CK_ULONG_PTR pulSignatureLen
+);
+
+typedef struct CK_SOFTHSM_FUNCTION_LIST {
+	CK_VERSION version;
+	CK_C_SignBatch C_SignBatch;
+} CK_SOFTHSM_FUNCTION_LIST;
+
+typedef CK_SOFTHSM_FUNCTION_LIST* CK_SOFTHSM_FUNCTION_LIST_PTR;
+typedef CK_SOFTHSM_FUNCTION_LIST_PTR* CK_SOFTHSM_FUNCTION_LIST_PTR_PTR;
+
+typedef CK_RV (*CK_SoftHSM_GetFunctionList)(CK_SOFTHSM_FUNCTION_LIST_PTR_PTR ppFunctionList);
+
+#ifdef CRYPTOKI_EXPORTS
+CK_RV CK_SPEC SoftHSM_GetFunctionList(CK_SOFTHSM_FUNCTION_LIST_PTR_PTR ppFunctionList);
+#endif
+
+#if defined(_WIN32) || defined(CRYPTOKI_FORCE_WIN32)
+#pragma pack(pop, cryptoki)
+#endif
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif /* !_SOFTHSM_V2_SOFTHSM2_EXT_H */
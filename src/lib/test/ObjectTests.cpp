@@ -1422,6 +1422,43 @@ void ObjectTests::testFindObjects()
 	CPPUNIT_ASSERT(rv == CKR_OK);
 	CPPUNIT_ASSERT(2 == ulObjectCount);
 	rv = CRYPTOKI_F_PTR( C_FindObjectsFinal(hSessionRW) );
+
+	// The handles of private objects were released on logout, so look up the private token object again
+	CK_BBOOL bTrue = CK_TRUE;
+	CK_ATTRIBUTE privateAttribs[] = {
+		{ CKA_LABEL, (CK_UTF8CHAR_PTR)pLabel, strlen(pLabel) },
+		{ CKA_PRIVATE, &bTrue, sizeof(bTrue) }
+	};
+	rv = CRYPTOKI_F_PTR( C_FindObjectsInit(hSessionRW,&privateAttribs[0],2) );
+	CPPUNIT_ASSERT(rv == CKR_OK);
+	rv = CRYPTOKI_F_PTR( C_FindObjects(hSessionRW,&hObjects[0],16,&ulObjectCount) );
+	CPPUNIT_ASSERT(rv == CKR_OK);
+	CPPUNIT_ASSERT(1 == ulObjectCount);
+	hObjectTokenPrivate = hObjects[0];
+	rv = CRYPTOKI_F_PTR( C_FindObjectsFinal(hSessionRW) );
+
+	// Change the label of the private token object, the old label should no longer find it
+	const char  *pNewLabel = "Label modified again";
+	CK_ATTRIBUTE newAttribs[] = {
+		{ CKA_LABEL, (CK_UTF8CHAR_PTR)pNewLabel, strlen(pNewLabel) }
+	};
+	rv = CRYPTOKI_F_PTR( C_SetAttributeValue (hSessionRW,hObjectTokenPrivate,&newAttribs[0],1) );
+	CPPUNIT_ASSERT(rv == CKR_OK);
+
+	rv = CRYPTOKI_F_PTR( C_FindObjectsInit(hSessionRW,&attribs[0],1) );
+	CPPUNIT_ASSERT(rv == CKR_OK);
+	rv = CRYPTOKI_F_PTR( C_FindObjects(hSessionRW,&hObjects[0],16,&ulObjectCount) );
+	CPPUNIT_ASSERT(rv == CKR_OK);
+	CPPUNIT_ASSERT(1 == ulObjectCount);
+	rv = CRYPTOKI_F_PTR( C_FindObjectsFinal(hSessionRW) );
+
+	rv = CRYPTOKI_F_PTR( C_FindObjectsInit(hSessionRW,&newAttribs[0],1) );
+	CPPUNIT_ASSERT(rv == CKR_OK);
+	rv = CRYPTOKI_F_PTR( C_FindObjects(hSessionRW,&hObjects[0],16,&ulObjectCount) );
+	CPPUNIT_ASSERT(rv == CKR_OK);
+	CPPUNIT_ASSERT(1 == ulObjectCount);
+	CPPUNIT_ASSERT(hObjects[0] == hObjectTokenPrivate);
+	rv = CRYPTOKI_F_PTR( C_FindObjectsFinal(hSessionRW) );
 }
 
 
@@ -43,6 +43,9 @@
 #include <stdlib.h>
 #include <string.h>
 #include "SignVerifyTests.h"
+#ifndef P11M
+#include "softhsm2_ext.h"
+#endif
 
 // CKA_TOKEN
 const CK_BBOOL ON_TOKEN = CK_TRUE;
@@ -674,3 +677,109 @@ void SignVerifyTests::testHmacSignVerify()
 #endif
 }
 
+#ifndef P11M
+void SignVerifyTests::testSignBatch()
+{
+	CK_RV rv;
+	CK_SESSION_HANDLE hSession;
+	CK_SOFTHSM_FUNCTION_LIST_PTR ext;
+	CK_C_INITIALIZE_ARGS initArgs;
+	const CK_ULONG count = 17;
+
+	// Use several threads, which requires locking
+	memset(&initArgs, 0, sizeof(initArgs));
+	initArgs.flags = CKF_OS_LOCKING_OK;
+	CRYPTOKI_F_PTR( C_Finalize(NULL_PTR) );
+	rv = CRYPTOKI_F_PTR( C_Initialize(&initArgs) );
+	CPPUNIT_ASSERT(rv == CKR_OK);
+
+	rv = SoftHSM_GetFunctionList(&ext);
+	CPPUNIT_ASSERT(rv == CKR_OK);
+	CPPUNIT_ASSERT(ext->version.major == SOFTHSM_EXT_VERSION_MAJOR);
+
+	rv = CRYPTOKI_F_PTR( C_OpenSession(m_initializedTokenSlotID, CKF_SERIAL_SESSION | CKF_RW_SESSION, NULL_PTR, NULL_PTR, &hSession) );
+	CPPUNIT_ASSERT(rv == CKR_OK);
+	rv = CRYPTOKI_F_PTR( C_Login(hSession,CKU_USER,m_userPin1,m_userPin1Length) );
+	CPPUNIT_ASSERT(rv==CKR_OK);
+
+	CK_OBJECT_HANDLE hPuk = CK_INVALID_HANDLE;
+	CK_OBJECT_HANDLE hPrk = CK_INVALID_HANDLE;
+	rv = generateRSA(hSession,IN_SESSION,IS_PUBLIC,IN_SESSION,IS_PRIVATE,hPuk,hPrk);
+	CPPUNIT_ASSERT(rv == CKR_OK);
+
+	// Messages of different lengths
+	CK_BYTE data[count][count + 1];
+	CK_BYTE signatures[count][256];
+	CK_BYTE_PTR ppData[count];
+	CK_ULONG ulDataLen[count];
+	CK_BYTE_PTR ppSignature[count];
+	CK_ULONG ulSignatureLen[count];
+	for (CK_ULONG i = 0; i < count; i++)
+	{
+		memset(data[i], (int) i, sizeof(data[i]));
+		ppData[i] = data[i];
+		ulDataLen[i] = i + 1;
+		ppSignature[i] = signatures[i];
+		ulSignatureLen[i] = 0;
+	}
+
+	CK_MECHANISM mechanisms[] = {
+		{ CKM_SHA256_RSA_PKCS, NULL_PTR, 0 },
+		{ CKM_RSA_PKCS, NULL_PTR, 0 }
+	};
+	for (size_t m = 0; m < sizeof(mechanisms)/sizeof(CK_MECHANISM); m++)
+	{
+		// Get the sizes
+		rv = ext->C_SignBatch(hSession,&mechanisms[m],hPrk,count,ppData,ulDataLen,NULL_PTR,ulSignatureLen);
+		CPPUNIT_ASSERT(rv == CKR_OK);
+		for (CK_ULONG i = 0; i < count; i++)
+		{
+			CPPUNIT_ASSERT(ulSignatureLen[i] == 1536 / 8);
+		}
+
+		// One buffer is too small
+		ulSignatureLen[3] = 1;
+		rv = ext->C_SignBatch(hSession,&mechanisms[m],hPrk,count,ppData,ulDataLen,ppSignature,ulSignatureLen);
+		CPPUNIT_ASSERT(rv == CKR_BUFFER_TOO_SMALL);
+		CPPUNIT_ASSERT(ulSignatureLen[3] == 1536 / 8);
+
+		// The signatures are those of C_Sign, as PKCS #1 v1.5 is deterministic
+		rv = ext->C_SignBatch(hSession,&mechanisms[m],hPrk,count,ppData,ulDataLen,ppSignature,ulSignatureLen);
+		CPPUNIT_ASSERT(rv == CKR_OK);
+		for (CK_ULONG i = 0; i < count; i++)
+		{
+			CK_BYTE signature[256];
+			CK_ULONG ulLen = sizeof(signature);
+
+			rv = CRYPTOKI_F_PTR( C_SignInit(hSession,&mechanisms[m],hPrk) );
+			CPPUNIT_ASSERT(rv == CKR_OK);
+			rv = CRYPTOKI_F_PTR( C_Sign(hSession,ppData[i],ulDataLen[i],signature,&ulLen) );
+			CPPUNIT_ASSERT(rv == CKR_OK);
+			CPPUNIT_ASSERT(ulLen == ulSignatureLen[i]);
+			CPPUNIT_ASSERT(memcmp(signature, ppSignature[i], ulLen) == 0);
+
+			rv = CRYPTOKI_F_PTR( C_VerifyInit(hSession,&mechanisms[m],hPuk) );
+			CPPUNIT_ASSERT(rv == CKR_OK);
+			rv = CRYPTOKI_F_PTR( C_Verify(hSession,ppData[i],ulDataLen[i],ppSignature[i],ulSignatureLen[i]) );
+			CPPUNIT_ASSERT(rv == CKR_OK);
+		}
+	}
+
+	// Not while another operation is active
+	rv = CRYPTOKI_F_PTR( C_SignInit(hSession,&mechanisms[0],hPrk) );
+	CPPUNIT_ASSERT(rv == CKR_OK);
+	rv = ext->C_SignBatch(hSession,&mechanisms[0],hPrk,count,ppData,ulDataLen,ppSignature,ulSignatureLen);
+	CPPUNIT_ASSERT(rv == CKR_OPERATION_ACTIVE);
+	rv = CRYPTOKI_F_PTR( C_SignFinal(hSession,signatures[0],&ulSignatureLen[0]) );
+	CPPUNIT_ASSERT(rv == CKR_OK);
+
+	// Only with a signing key
+	rv = ext->C_SignBatch(hSession,&mechanisms[0],hPuk,count,ppData,ulDataLen,ppSignature,ulSignatureLen);
+	CPPUNIT_ASSERT(rv == CKR_KEY_FUNCTION_NOT_PERMITTED);
+
+	// Not with MAC mechanisms
+	CK_MECHANISM hmac = { CKM_SHA256_HMAC, NULL_PTR, 0 };
+	rv = ext->C_SignBatch(hSession,&hmac,hPrk,count,ppData,ulDataLen,ppSignature,ulSignatureLen);
+	CPPUNIT_ASSERT(rv == CKR_MECHANISM_INVALID);
+}
+#endif
@@ -46,6 +46,9 @@ class SignVerifyTests : public TestsBase
 	CPPUNIT_TEST(testEcSignVerify);
 #endif
 	CPPUNIT_TEST(testHmacSignVerify);
+#ifndef P11M
+	CPPUNIT_TEST(testSignBatch);
+#endif
 	CPPUNIT_TEST_SUITE_END();
 
 public:
@@ -54,6 +57,9 @@ public:
 	void testEcSignVerify();
 #endif
 	void testHmacSignVerify();
+#ifndef P11M
+	void testSignBatch();
+#endif
 
 protected:
 	CK_RV generateRSA(CK_SESSION_HANDLE hSession, CK_BBOOL bTokenPuk, CK_BBOOL bPrivatePuk, CK_BBOOL bTokenPrk, CK_BBOOL bPrivatePrk, CK_OBJECT_HANDLE &hPuk, CK_OBJECT_HANDLE &hPrk);
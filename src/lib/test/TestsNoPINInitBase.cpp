@@ -37,6 +37,8 @@
 #include <sstream>
 
 #ifdef P11M
+#include "log.h"
+
 #ifdef _WIN32
 CK_FUNCTION_LIST_PTR FunctionList::getFunctionListPtr(const char*const libName,  HINSTANCE__* p11Library, const char*getFunctionList) {
 #else
@@ -151,6 +153,8 @@ TestsNoPINInitBase::~TestsNoPINInitBase() {
 #endif // _WIN32
 }
 
+int softLogLevels[LOG_SUBSYSTEM_COUNT];
+
 void softHSMLog(const int, const char*, const char*, const int, const char*, ...)
 {
 
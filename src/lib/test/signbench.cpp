@@ -0,0 +1,227 @@
+/*
+ * Copyright (c) 2016 SURFnet bv
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+/*****************************************************************************
+ signbench.cpp
+
+ Benchmark of RSA signing, one signature per C_Sign against the signatures of
+ one C_SignBatch call of the SoftHSM vendor function list.
+
+ Usage: signbench [bits] [count]
+ *****************************************************************************/
+
+#include <config.h>
+#include "cryptoki.h"
+#include "softhsm2_ext.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#ifndef _WIN32
+#include <sys/time.h>
+#else
+#include <windows.h>
+#include "setenv.h"
+#endif
+
+// The elapsed time in milliseconds
+static double now()
+{
+#ifndef _WIN32
+	struct timeval tv;
+
+	gettimeofday(&tv, NULL);
+	return tv.tv_sec * 1000.0 + tv.tv_usec / 1000.0;
+#else
+	return (double) GetTickCount();
+#endif
+}
+
+static int fail(const char* what, CK_RV rv)
+{
+	fprintf(stderr, "%s failed: 0x%08lX\n", what, rv);
+	return 1;
+}
+
+// Find the slot of the token with the given label, or of a free token
+static bool findSlot(CK_UTF8CHAR_PTR label, CK_SLOT_ID& slotID)
+{
+	std::vector<CK_SLOT_ID> slots(64);
+	CK_ULONG nrOfSlots = slots.size();
+	CK_TOKEN_INFO tokenInfo;
+
+	if (C_GetSlotList(CK_TRUE, &slots.front(), &nrOfSlots) != CKR_OK) return false;
+
+	for (CK_ULONG i = 0; i < nrOfSlots; i++)
+	{
+		if (C_GetTokenInfo(slots[i], &tokenInfo) != CKR_OK) continue;
+
+		if (label == NULL_PTR ?
+		    !(tokenInfo.flags & CKF_TOKEN_INITIALIZED) :
+		    memcmp(tokenInfo.label, label, sizeof(tokenInfo.label)) == 0)
+		{
+			slotID = slots[i];
+			return true;
+		}
+	}
+
+	return false;
+}
+
+int main(int argc, char** argv)
+{
+	CK_ULONG bits = argc > 1 ? strtoul(argv[1], NULL, 10) : 2048;
+	CK_ULONG count = argc > 2 ? strtoul(argv[2], NULL, 10) : 1000;
+	CK_UTF8CHAR soPin[] = "12345678";
+	CK_UTF8CHAR userPin[] = "1234";
+	CK_UTF8CHAR label[32];
+	CK_C_INITIALIZE_ARGS initArgs;
+	CK_SOFTHSM_FUNCTION_LIST_PTR ext;
+	CK_SLOT_ID slotID;
+	CK_SESSION_HANDLE hSession;
+	CK_RV rv;
+
+	if (bits == 0 || count == 0)
+	{
+		fprintf(stderr, "Usage: %s [bits] [count]\n", argv[0]);
+		return 1;
+	}
+
+#ifndef _WIN32
+	setenv("SOFTHSM2_CONF", "./softhsm2.conf", 1);
+#else
+	setenv("SOFTHSM2_CONF", ".\\softhsm2.conf", 1);
+#endif
+
+	// C_SignBatch only uses several threads if locking is enabled
+	memset(&initArgs, 0, sizeof(initArgs));
+	initArgs.flags = CKF_OS_LOCKING_OK;
+	rv = C_Initialize(&initArgs);
+	if (rv != CKR_OK) return fail("C_Initialize", rv);
+	rv = SoftHSM_GetFunctionList(&ext);
+	if (rv != CKR_OK) return fail("SoftHSM_GetFunctionList", rv);
+
+	// Use a fresh token in the first free slot
+	if (!findSlot(NULL_PTR, slotID)) return fail("Finding a free slot", CKR_SLOT_ID_INVALID);
+	memset(label, ' ', sizeof(label));
+	memcpy(label, "signbench", strlen("signbench"));
+	rv = C_InitToken(slotID, soPin, strlen((char*)soPin), label);
+	if (rv != CKR_OK) return fail("C_InitToken", rv);
+	C_Finalize(NULL_PTR);
+	rv = C_Initialize(&initArgs);
+	if (rv != CKR_OK) return fail("C_Initialize", rv);
+	// The slot ID changes when the token is initialized
+	if (!findSlot(label, slotID)) return fail("Finding the token", CKR_SLOT_ID_INVALID);
+
+	rv = C_OpenSession(slotID, CKF_SERIAL_SESSION | CKF_RW_SESSION, NULL_PTR, NULL_PTR, &hSession);
+	if (rv != CKR_OK) return fail("C_OpenSession", rv);
+	rv = C_Login(hSession, CKU_SO, soPin, strlen((char*)soPin));
+	if (rv != CKR_OK) return fail("C_Login", rv);
+	rv = C_InitPIN(hSession, userPin, strlen((char*)userPin));
+	if (rv != CKR_OK) return fail("C_InitPIN", rv);
+	C_Logout(hSession);
+	rv = C_Login(hSession, CKU_USER, userPin, strlen((char*)userPin));
+	if (rv != CKR_OK) return fail("C_Login", rv);
+
+	// Generate the key pair
+	CK_MECHANISM genMechanism = { CKM_RSA_PKCS_KEY_PAIR_GEN, NULL_PTR, 0 };
+	CK_BYTE publicExponent[] = { 0x01, 0x00, 0x01 };
+	CK_BBOOL bFalse = CK_FALSE;
+	CK_BBOOL bTrue = CK_TRUE;
+	CK_ATTRIBUTE pukAttribs[] = {
+		{ CKA_TOKEN, &bFalse, sizeof(bFalse) },
+		{ CKA_VERIFY, &bTrue, sizeof(bTrue) },
+		{ CKA_MODULUS_BITS, &bits, sizeof(bits) },
+		{ CKA_PUBLIC_EXPONENT, &publicExponent[0], sizeof(publicExponent) }
+	};
+	CK_ATTRIBUTE prkAttribs[] = {
+		{ CKA_TOKEN, &bFalse, sizeof(bFalse) },
+		{ CKA_PRIVATE, &bTrue, sizeof(bTrue) },
+		{ CKA_SIGN, &bTrue, sizeof(bTrue) }
+	};
+	CK_OBJECT_HANDLE hPuk, hPrk;
+	rv = C_GenerateKeyPair(hSession, &genMechanism,
+			       pukAttribs, sizeof(pukAttribs)/sizeof(CK_ATTRIBUTE),
+			       prkAttribs, sizeof(prkAttribs)/sizeof(CK_ATTRIBUTE),
+			       &hPuk, &hPrk);
+	if (rv != CKR_OK) return fail("C_GenerateKeyPair", rv);
+
+	// The messages and the signatures of both runs
+	CK_ULONG size = (bits + 7) / 8;
+	std::vector<CK_BYTE> data(count * 32);
+	std::vector<CK_BYTE> single(count * size);
+	std::vector<CK_BYTE> batch(count * size);
+	std::vector<CK_BYTE_PTR> ppData(count);
+	std::vector<CK_ULONG> ulDataLen(count, 32);
+	std::vector<CK_BYTE_PTR> ppSignature(count);
+	std::vector<CK_ULONG> ulSignatureLen(count, size);
+	rv = C_GenerateRandom(hSession, &data.front(), data.size());
+	if (rv != CKR_OK) return fail("C_GenerateRandom", rv);
+	for (CK_ULONG i = 0; i < count; i++)
+	{
+		ppData[i] = &data[i * 32];
+		ppSignature[i] = &batch[i * size];
+	}
+
+	CK_MECHANISM mechanism = { CKM_SHA256_RSA_PKCS, NULL_PTR, 0 };
+	double start = now();
+	for (CK_ULONG i = 0; i < count; i++)
+	{
+		CK_ULONG ulLen = size;
+
+		rv = C_SignInit(hSession, &mechanism, hPrk);
+		if (rv != CKR_OK) return fail("C_SignInit", rv);
+		rv = C_Sign(hSession, ppData[i], ulDataLen[i], &single[i * size], &ulLen);
+		if (rv != CKR_OK) return fail("C_Sign", rv);
+	}
+	double singleTime = now() - start;
+
+	start = now();
+	rv = ext->C_SignBatch(hSession, &mechanism, hPrk, count,
+			      &ppData.front(), &ulDataLen.front(),
+			      &ppSignature.front(), &ulSignatureLen.front());
+	if (rv != CKR_OK) return fail("C_SignBatch", rv);
+	double batchTime = now() - start;
+
+	// PKCS #1 v1.5 signatures are deterministic
+	if (single != batch)
+	{
+		fprintf(stderr, "The signatures of C_Sign and C_SignBatch differ\n");
+		return 1;
+	}
+
+	printf("RSA-%lu, %lu signatures\n", bits, count);
+	printf("C_Sign:      %10.1f ms %10.1f signatures/s\n",
+	       singleTime, singleTime > 0 ? count * 1000.0 / singleTime : 0.0);
+	printf("C_SignBatch: %10.1f ms %10.1f signatures/s\n",
+	       batchTime, batchTime > 0 ? count * 1000.0 / batchTime : 0.0);
+
+	C_CloseSession(hSession);
+	C_Finalize(NULL_PTR);
+
+	return 0;
+}